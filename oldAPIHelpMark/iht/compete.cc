@@ -26,6 +26,8 @@ auto ARGS = {
     // sss::I64_ARG("--key_ub", "The upper limit of the key range for operations"),
     sss::I64_ARG_OPT("--cache_depth", "The depth of the cache for the IHT", 0),
     sss::BOOL_ARG_OPT("--server", "If this node should send or receive data..."),
+    sss::I64_ARG_OPT("--srq_slots", "Receive every peer's requests through one SRQ and CQ with this many slots, at least 64 per peer to avoid RNR NAKs (0: per-connection receives)", 0),
+    sss::I64_ARG_OPT("--op_count", "How many insert/get/remove rounds a client runs through the IHT before signaling the server", 100),
 
 };
 
@@ -65,13 +67,19 @@ sss::StatusVal<unordered_map<int, Connection*>> init_cm(ConnectionManager* cm, P
 
     unordered_map<int, Connection*> connections;
 
-    // Test out the connection (deliver)
+    // Test out the connection (deliver). With a shared receiver, the acks all come through it instead
+    SharedReceiver* shared = cm->shared_receiver();
+    for (size_t acks = 0; shared != nullptr && acks < peers.size();) {
+      if (shared->TryReceive<AckProto>().has_value()) acks++;
+    }
     for (const auto &p : peers) {
       auto conn = cm->GetConnection(p.id);
       STATUSVAL_OR_DIE(conn);
-      auto got =
-          conn.val.value()->channel()->template Deliver<AckProto>();
-      RETURN_STATUSVAL_FROM_ERROR(got.status);
+      if (shared == nullptr) {
+        auto got =
+            conn.val.value()->channel()->template Deliver<AckProto>();
+        RETURN_STATUSVAL_FROM_ERROR(got.status);
+      }
       connections[p.id] = conn.val.value();
     }
     return {sss::Status::Ok(), connections};
@@ -140,7 +148,9 @@ int main(int argc, char **argv) {
 
     
     ConnectionManager* sender = new ConnectionManager(self_sender.id);
-    ConnectionManager* receiver = new ConnectionManager(self_receiver.id);
+    // Requests arrive on the receivers, so that is where the SRQ goes
+    SharedReceiverOptions shared_opts{.slots = uint32_t(args.iget("--srq_slots"))};
+    ConnectionManager* receiver = new ConnectionManager(self_receiver.id, MessengerOptions(), shared_opts);
     sss::StatusVal<unordered_map<int, Connection*>> s1 = init_cm(sender, self_sender, sends);
     ROME_ASSERT(s1.status.t == sss::Ok, "Connection manager 1 was setup incorrectly");
     unordered_map<int, Connection*> sender_map = s1.val.value();
@@ -149,6 +159,22 @@ int main(int argc, char **argv) {
     unordered_map<int, Connection*> receiver_map = s2.val.value();
     ROME_INFO("Init 2 cms!");
 
+    // Every node serves its part of the keys; clients run ops on keys spread over all of them
+    int node_id = args.iget("--node_id");
+    int node_count = args.iget("--node_count");
+    int op_count = args.iget("--op_count");
+    TwoSidedIHT<> iht(node_id, node_count, 0, std::max(1, op_count * node_count), sender_map, receiver_map, receiver->shared_receiver());
+    if (!args.bget("--server")){
+        int mismatches = 0;
+        for (int i = 0; i < op_count; i++){
+            int key = i * node_count + node_id;
+            mismatches += iht.insert(key, key).has_value();
+            mismatches += iht.get(key) != std::optional<int>(key);
+            mismatches += iht.remove(key) != std::optional<int>(key);
+        }
+        ROME_INFO("Ran {} IHT ops, {} mismatches (shared receiver: {})", 3 * op_count, mismatches, receiver->shared_receiver() != nullptr);
+    }
+
 
     if(args.bget("--server")){
         ROME_INFO("started server track");
@@ -151,8 +151,11 @@ class iht_carumap {
     // Grab the EList (use static cast because we are sure its an ELIST)
     EList* source = static_cast<EList *>(parent->buckets[pidx].base);
     for (size_t i = 0; i < source->count; ++i) {
-      // Hash to find the bucket
-      uint64_t b = level_hash(source->pairs[i].key, pdepth + 1, pcount);
+      // Hash to find the bucket.  This must match the traversal in get(),
+      // insert() and remove(), which hash with `depth + 1` and the size of
+      // the P-List they are in, and the new P-List is one level below
+      // `parent` and twice its size.
+      uint64_t b = level_hash(source->pairs[i].key, pdepth + 2, pcount * 2);
       // If we have a nullptr, make an Elist (might already be created by other nodes)
       if (p->buckets[b].base == nullptr)
         p->buckets[b].base = EList::make(ELIST_SIZE);
@@ -163,7 +166,8 @@ class iht_carumap {
     }
 
     // The caller locked the pointer to the E-List, so we can reclaim the E-List
-    delete source;
+    // (it came from malloc, in EList::make)
+    free(source);
     return p;
   }
 
@@ -29,6 +29,21 @@ enum {
     ERR = 7,
 };
 
+/// TwoSidedIHT partitions a key range over `count` nodes, each holding its
+/// part in a local iht_carumap, and forwards operations on remote keys over
+/// two-sided messages.
+///
+/// @tparam Conn A connection whose `channel()` has templated Send(),
+///              TryReceive() and Deliver() (see `Connection::RdmaChannel`).
+///              The default is the RDMA connection; rabia::SimNetwork's
+///              Connection runs the same code in one process, with requests
+///              on channel 0 (`receiver_map`) and responses on channel 1
+///              (`sender_map`), see src/rdma/bench/iht_sim_bench.cc.
+///
+/// If the receivers' ConnectionManager has a SharedReceiver, pass it in: one
+/// server thread then polls every peer's requests from its CQ, instead of a
+/// pool of threads each looping over every peer.
+template <class Conn = Connection>
 class TwoSidedIHT {
 private:
     // The reference to the node's internal data
@@ -41,8 +56,8 @@ private:
     std::vector<std::mutex*> lock_table_client;
     std::vector<std::mutex*> lock_table_server;
 
-    std::unordered_map<int, Connection*> sender_map;
-    std::unordered_map<int, Connection*> receiver_map;
+    std::unordered_map<int, Conn*> sender_map;
+    std::unordered_map<int, Conn*> receiver_map;
 
     /// convert a key to it's id. Will return -1 if it cannot be found
     int to_id(int key){
@@ -54,14 +69,41 @@ private:
 
     std::vector<std::thread> t;
     volatile bool stop_listening = false;
+
+    /// Apply a request to the local data, and make its response
+    IHTOPProto serve(const IHTOPProto& request){
+        auto op = request.op_type();
+        IHTOPProto response;
+        response.set_key(request.key());
+        response.set_value(request.value());
+        if (op == GET_REQ){
+            int answer;
+            bool has_key = internal_data_->get(request.key(), answer);
+            response.set_op_type(has_key ? GET_RES : ERR);
+            response.set_value(answer);
+        } else if (op == INS_REQ){
+            optional<int> old_key = internal_data_->insert(request.key(), request.value());
+            response.set_op_type(!old_key.has_value() ? INS_RES : ERR);
+            if (old_key.has_value()) response.set_value(old_key.value());
+        } else if (op == RMV_REQ){
+            int answer;
+            bool has_key = internal_data_->remove(request.key(), answer);
+            response.set_op_type(has_key ? RMV_RES : ERR);
+            response.set_value(answer);
+        } else {
+            ROME_ERROR("Request has unexpected opcode");
+        }
+        return response;
+    }
 public:
     TwoSidedIHT() = delete;
     ~TwoSidedIHT(){
         stop_listening = true;
-        delete internal_data_;
-        for(int i = 0; i < min(MAX_THREAD_POOL, count); i++){
-            t[i].join();
+        // The server threads use the map, so stop them before freeing it
+        for(auto &th : t){
+            th.join();
         }
+        delete internal_data_;
         // for(int i = 0; i < count; i++){
         //     delete lock_table_client[count];
         // }
@@ -72,7 +114,8 @@ public:
 
     /// IHT RPC. One per node
     /// Keyspace lower bound and upper bound is inclusive. So (0-100) means 101 numbers
-    TwoSidedIHT(int self_id, int count, int keyspace_lb, int keyspace_ub, std::unordered_map<int, Connection*>& sender_map, std::unordered_map<int, Connection*>& receiver_map) 
+    /// If `shared` is set, requests are received through it rather than through receiver_map
+    TwoSidedIHT(int self_id, int count, int keyspace_lb, int keyspace_ub, std::unordered_map<int, Conn*>& sender_map, std::unordered_map<int, Conn*>& receiver_map, SharedReceiver* shared = nullptr) 
         : self_id(self_id), count(count), keyspace_lb(keyspace_lb), keyspace_len(keyspace_ub - keyspace_lb){
         // create a map to represent the internal data of the node
         internal_data_ = new iht_carumap<int, int, 8, 64>();
@@ -87,6 +130,22 @@ public:
         this->sender_map = sender_map;
         this->receiver_map = receiver_map;
 
+        if (shared != nullptr){
+            // Every peer's requests come through one CQ, so one thread serves them all
+            t.push_back(std::thread([this, shared](){
+                while (!stop_listening) {
+                    auto maybe_req = shared->template TryReceive<IHTOPProto>();
+                    if (!maybe_req.has_value()) continue;
+                    int id = maybe_req->first;
+                    lock_table_server[id]->lock();
+                    sss::Status stat = this->sender_map[id]->channel()->Send(serve(maybe_req->second));
+                    lock_table_server[id]->unlock();
+                    ROME_ASSERT(stat.t == sss::Ok, "Operation failed");
+                }
+            }));
+            return;
+        }
+
         // todo: tune thread-pool size
         for(int i = 0; i < min(MAX_THREAD_POOL, count); i++){
             t.push_back(std::thread([&](int myid, int node_count){
@@ -97,39 +156,15 @@ public:
                         if (id == myid) continue; // skip my id
                         // Try to get a value
                         lock_table_server[id]->lock();
-                        std::optional<IHTOPProto> maybe_req = receiver_map[id]->channel()->TryReceive<IHTOPProto>();
+                        // NB: this->, since the constructor's parameters (which the threads outlive) shadow the maps
+                        std::optional<IHTOPProto> maybe_req = this->receiver_map[id]->channel()->template TryReceive<IHTOPProto>();
                         // value here referes to the optional and not the IHTOpProto itself...
                         if (!maybe_req.has_value()){
                             lock_table_server[id]->unlock();
                             continue;
                         }
-                        IHTOPProto request = maybe_req.value();
-                        auto op = request.op_type();
-                        
-                        // Do the request
-                        IHTOPProto response;
-                        response.set_key(request.key());
-                        response.set_value(request.value());
-                        if (op == GET_REQ){
-                            int answer;
-                            bool has_key = internal_data_->get(request.key(), answer);
-                            response.set_op_type(has_key ? GET_RES : ERR);
-                            response.set_value(answer);
-                        } else if (op == INS_REQ){
-                            optional<int> old_key = internal_data_->insert(request.key(), request.value());
-                            response.set_op_type(!old_key.has_value() ? INS_RES : ERR);
-                            if (old_key.has_value()) response.set_value(old_key.value());
-                        } else if (op == RMV_REQ){
-                            int answer;
-                            bool has_key = internal_data_->remove(request.key(), answer);
-                            response.set_op_type(has_key ? RMV_RES : ERR);
-                            response.set_value(answer);
-                        } else {
-                            ROME_ERROR("Request has unexpected opcode");
-                        }
-
-                        // Send the response
-                        sss::Status stat = sender_map[id]->channel()->Send(response);
+                        // Do the request and send the response
+                        sss::Status stat = this->sender_map[id]->channel()->Send(serve(maybe_req.value()));
                         lock_table_server[id]->unlock();
                         ROME_ASSERT(stat.t == sss::Ok, "Operation failed");
                     }
@@ -161,7 +196,7 @@ public:
         ROME_ASSERT(stat.t == sss::Ok, "Operation failed");
 
         /// Receive the result
-        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->Deliver<IHTOPProto>();
+        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->template Deliver<IHTOPProto>();
         lock_table_client[target_id]->unlock();
         ROME_ASSERT(maybe_result.status.t == sss::Ok, "Cannot get result");
         IHTOPProto result = maybe_result.val.value();
@@ -191,7 +226,7 @@ public:
         ROME_ASSERT(stat.t == sss::Ok, "Operation failed");
 
         /// Receive the result
-        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->Deliver<IHTOPProto>();
+        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->template Deliver<IHTOPProto>();
         lock_table_client[target_id]->unlock();
         ROME_ASSERT(maybe_result.status.t == sss::Ok, "Cannot get result");
         IHTOPProto result = maybe_result.val.value();
@@ -224,7 +259,7 @@ public:
         ROME_ASSERT(stat.t == sss::Ok, "Operation failed");
 
         /// Receive the result
-        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->Deliver<IHTOPProto>();
+        sss::StatusVal<IHTOPProto> maybe_result = sender_map[target_id]->channel()->template Deliver<IHTOPProto>();
         lock_table_client[target_id]->unlock();
         ROME_ASSERT(maybe_result.status.t == sss::Ok, "Cannot get result");
         IHTOPProto result = maybe_result.val.value();
@@ -1,17 +1,23 @@
 #pragma once
 
 #include <arpa/inet.h>
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <infiniband/verbs.h>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <netdb.h>
+#include <optional>
 #include <random>
 #include <rdma/rdma_cma.h>
 #include <rdma/rdma_verbs.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include <fcntl.h>
 
 #include "../logging/logging.h"
@@ -33,162 +39,351 @@ struct Message {
   size_t length;
 };
 
+/// Sizes of the buffers behind one connection's two-sided channel.  Both ends
+/// of a connection must agree on `slot_bytes`, and should agree on
+/// `recv_slots`: a sender keeps no more SENDs in flight than `recv_slots`,
+/// which it takes to be how many receives its peer posts.  Size `recv_slots`
+/// and `send_depth` together; SENDs beyond the peer's posted receives are
+/// not lost, but wait out RNR NAKs (see `DefaultQpAttr`), which costs far
+/// more than waiting for a completion.
+struct MessengerOptions {
+  uint32_t send_bytes = 1 << 11; // The send ring
+  uint32_t recv_slots = 64;      // Receives posted at once
+  uint32_t slot_bytes = 1 << 8;  // The most one receive (or fragment) holds
+  /// Messages up to this many bytes are cut into `slot_bytes` fragments;
+  /// larger ones are sent by rendezvous, and the receiver READs them
+  uint32_t rendezvous_bytes = 1 << 10;
+  uint32_t send_depth = 64; // Work requests in the SQ at once
+  /// Don't wait for each send to complete; only signal one in
+  /// `signal_every`, and reclaim the send ring from those completions
+  bool async_sends = false;
+  uint32_t signal_every = 16;
+};
+
+/// Names a send, so its sender can wait until the NIC is done with it
+struct SendToken {
+  uint64_t wr_id;
+};
+
+/// Receive buffers of `slot_bytes` each, in one registered region, posted to
+/// either a QP's own RQ or an SRQ.  Each receive's wr_id is its slot, so a
+/// completion says which slot to read however the slots were reposted.
+///
+/// NB: RecvSlots is only a view: neither the memory nor the queue is owned.
+class RecvSlots {
+  ibv_mr *mr_ = nullptr;    //! NOT OWNED
+  uint32_t slots_ = 0;      // How many slots `mr_` holds
+  uint32_t slot_bytes_ = 0; // The size of each
+  ibv_qp *qp_ = nullptr;    //! NOT OWNED; unused if `srq_` is set
+  ibv_srq *srq_ = nullptr;  //! NOT OWNED
+
+public:
+  RecvSlots() = default;
+  RecvSlots(ibv_mr *mr, uint32_t slots, uint32_t slot_bytes, ibv_qp *qp,
+            ibv_srq *srq)
+      : mr_(mr), slots_(slots), slot_bytes_(slot_bytes), qp_(qp), srq_(srq) {}
+
+  // Getters.
+  uint32_t slots() const { return slots_; }
+  uint32_t slot_bytes() const { return slot_bytes_; }
+  bool shared() const { return srq_ != nullptr; }
+  uint8_t *slot(uint32_t i) const {
+    return reinterpret_cast<uint8_t *>(mr_->addr) + size_t(i) * slot_bytes_;
+  }
+
+  /// Post a receive into slot `i`
+  void Repost(uint32_t i) {
+    ibv_sge sge;
+    sge.addr = reinterpret_cast<uint64_t>(slot(i));
+    sge.length = slot_bytes_;
+    sge.lkey = mr_->lkey;
+    ibv_recv_wr wr, *bad_wr;
+    std::memset(&wr, 0, sizeof(wr));
+    wr.wr_id = i;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    int ret = srq_ != nullptr ? ibv_post_srq_recv(srq_, &wr, &bad_wr)
+                              : ibv_post_recv(qp_, &wr, &bad_wr);
+    ROME_ASSERT(ret == 0, "Posting a receive: {}", strerror(ret));
+  }
+
+  /// Post a receive into every slot
+  void PostAll() {
+    for (uint32_t i = 0; i < slots_; ++i)
+      Repost(i);
+  }
+};
+
+/// TwoSidedRdmaMessenger carries messages of any size over the SEND/RECV
+/// verbs of one connection's QP.
+///
+/// A message shorter than `slot_bytes` goes out as one SEND.  A longer one,
+/// up to `rendezvous_bytes`, goes out as consecutive `slot_bytes` fragments,
+/// and the receiver glues them back together; the RC QP delivers them in
+/// order, and the sender holds its lock until the last one is out, so
+/// fragments of two messages never interleave.  Anything larger is sent by
+/// rendezvous: the sender registers the message where it is and SENDs a
+/// `Rendezvous` descriptor; the receiver RDMA-READs the payload and then
+/// RDMA-WRITEs the descriptor's sequence number into the sender's `done`
+/// word, which tells the sender it can release the buffer.  The immediate of
+/// each SEND says which of these it is (see `Kind`).
 ///
+/// SendInPlace() writes a message straight into the registered send buffer
+/// and SENDs it from there.  The buffer is a ring whose space comes back as
+/// the SENDs using it complete.  By default each send waits for its
+/// completion.  With `async_sends`, only one work request in `signal_every`
+/// is signaled and nothing waits: a signaled completion also accounts for
+/// every unsignaled one before it (the SQ completes in order), so the ring
+/// is reclaimed in bulk, when it or the SQ runs out of room.  PostInPlace()
+/// returns a SendToken that Wait() can block on.
 ///
 /// NB: This was formerly called TwoSidedRdmaMessenger
 class TwoSidedRdmaMessenger {
-  // [mfs] TODO: Make these arguments to the ctor?
-  static constexpr const uint32_t kCapacity = 1ul << 12;
-  static constexpr const uint32_t kRecvMaxBytes = 1ul << 8;
-  static_assert(kCapacity % 2 == 0, "Capacity must be divisible by two.");
+  /// What a SEND carries, in the top bits of its immediate
+  enum Kind : uint32_t {
+    kWhole = 0,        // A whole message
+    kFragment = 1,     // A fragment, with more to come
+    kLastFragment = 2, // The last fragment of a message
+    kRendezvous = 3,   // A `Rendezvous` describing a message to READ
+  };
+  static constexpr uint32_t kKindShift = 30;
+
+  /// Where a large message waits for its receiver to READ it
+  struct Rendezvous {
+    uint64_t addr;
+    uint64_t done_addr; // Where to WRITE `seq` once the READ completes
+    uint32_t rkey;
+    uint32_t done_rkey;
+    uint32_t length;
+    uint32_t seq;
+  };
 
+  /// A large message sent by rendezvous, kept until the receiver has READ it
+  struct Parcel {
+    std::unique_ptr<uint8_t[]> buffer;
+    ibv_mr *mr;
+    uint32_t seq;
+  };
+
+  /// The `done` word that peers WRITE to, and the word this end WRITEs from,
+  /// each on its own cache line after the rings
+  static constexpr uint32_t kWordBytes = 64;
+
+  const MessengerOptions opts_;
   RdmaMemory rm_;           // Remotely accessible memory for send/recv buffers.
   rdma_cm_id *id_;          // (unowned) pointer to the QP for sends/rcvs
   ibv_mr *send_mr_;         // Memory region identified by `kSendId`
   const int send_cap_;      // Capacity (in bytes) of the send buffer
   uint8_t *send_base_;      // Base address of send buffer
-  uint8_t *send_next_;      // Next un-posted address within send buffer
-  uint32_t send_total_ = 0; // Number of sends that were performed
-  ibv_mr *recv_mr_;         // Memory region identified by `kRecvId`
+  uint64_t send_head_ = 0;  // Bytes of the send buffer ever reserved
+  uint64_t send_tail_ = 0;  // Bytes of the send buffer ever reclaimed
+  uint64_t send_total_ = 0; // Number of sends that were performed
+  uint64_t send_done_ = 0;  // Sends known to have completed
+  uint64_t signaled_ = 0;   // One past the newest signaled send
   const int recv_cap_;      // Capacity (in bytes) of recv buffer
-  uint8_t *recv_base_;      // Base address of recv buffer
-  uint8_t *recv_next_;      // Next unposted address within recv buffer
-  uint32_t recv_total_ = 0; // Completed receives; helps track completion
+  RecvSlots own_slots_;     // The recv buffer, identified by `kRecvId`
+  RecvSlots *slots_;        // `own_slots_`, or a SharedReceiver's
+  ibv_mr *words_mr_;        // The `done` and `ack` words
+  volatile uint64_t *done_; // The last rendezvous the peer has READ
+  uint64_t *ack_;           // Source of this end's WRITEs to a peer's `done`
+
+  // Posting to the SQ and reaping its completions.  Receives take it too, to
+  // READ a rendezvous, so the two never steal each other's completions.
+  std::mutex send_mu_;
+  std::deque<Parcel> parcels_; // Large messages not READ yet, oldest first
+  uint32_t parcel_seq_ = 0;    // Rendezvous sent so far
+
+  /// A SEND that still needs its bytes of the send buffer
+  struct Posted {
+    uint64_t wr_id;
+    uint64_t end; // Where `send_tail_` moves once it completes
+  };
+  std::deque<Posted> posted_; // Oldest first
+
+  std::vector<uint8_t> partial_; // Fragments received so far
+
+  friend class SharedReceiver;
 
 public:
-  explicit TwoSidedRdmaMessenger(rdma_cm_id *id)
-      : rm_(kCapacity, std::nullopt, id->pd), id_(id), send_cap_(kCapacity / 2),
-        recv_cap_(kCapacity / 2) {
+  /// @param shared  If set, the QP receives through a SharedReceiver's SRQ
+  ///                and the messenger has no recv buffer of its own
+  explicit TwoSidedRdmaMessenger(rdma_cm_id *id,
+                                 MessengerOptions opts = MessengerOptions(),
+                                 RecvSlots *shared = nullptr)
+      : opts_(opts),
+        rm_(opts.send_bytes +
+                (shared ? 0 : opts.recv_slots * opts.slot_bytes) +
+                2 * kWordBytes,
+            std::nullopt, id->pd),
+        id_(id), send_cap_(opts.send_bytes),
+        recv_cap_(shared ? 0 : opts.recv_slots * opts.slot_bytes),
+        slots_(shared ? shared : &own_slots_) {
+    ROME_ASSERT(opts_.slot_bytes <= opts_.send_bytes,
+                "A fragment ({} bytes) must fit in the send ring ({} bytes)",
+                opts_.slot_bytes, opts_.send_bytes);
+    ROME_ASSERT(opts_.send_depth >= 2 && opts_.signal_every >= 1,
+                "Need at least 2 sends in flight, and to signal some");
+    ROME_ASSERT(opts_.slot_bytes > sizeof(Rendezvous),
+                "A slot ({} bytes) must hold a rendezvous descriptor",
+                opts_.slot_bytes);
     OK_OR_FAIL(rm_.RegisterMemoryRegion(kSendId, 0, send_cap_));
-    OK_OR_FAIL(rm_.RegisterMemoryRegion(kRecvId, send_cap_, recv_cap_));
+    OK_OR_FAIL(rm_.RegisterMemoryRegion(kWordsId, send_cap_ + recv_cap_,
+                                        2 * kWordBytes));
     auto t1 = rm_.GetMemoryRegion(kSendId);
     STATUSVAL_OR_DIE(t1);
     send_mr_ = t1.val.value();
-    auto t2 = rm_.GetMemoryRegion(kRecvId);
-    STATUSVAL_OR_DIE(t2);
-    recv_mr_ = t2.val.value();
+    if (shared == nullptr) {
+      OK_OR_FAIL(rm_.RegisterMemoryRegion(kRecvId, send_cap_, recv_cap_));
+      auto t2 = rm_.GetMemoryRegion(kRecvId);
+      STATUSVAL_OR_DIE(t2);
+      own_slots_ = RecvSlots(t2.val.value(), opts_.recv_slots,
+                             opts_.slot_bytes, id_->qp, nullptr);
+    }
+    auto t3 = rm_.GetMemoryRegion(kWordsId);
+    STATUSVAL_OR_DIE(t3);
+    words_mr_ = t3.val.value();
     send_base_ = reinterpret_cast<uint8_t *>(send_mr_->addr);
-    send_next_ = send_base_;
-    recv_base_ = reinterpret_cast<uint8_t *>(recv_mr_->addr);
-    recv_next_ = recv_base_;
-    PrepareRecvBuffer();
+    done_ = reinterpret_cast<volatile uint64_t *>(words_mr_->addr);
+    ack_ = reinterpret_cast<uint64_t *>(
+        reinterpret_cast<uint8_t *>(words_mr_->addr) + kWordBytes);
+    *done_ = 0;
+    if (shared == nullptr)
+      PrepareRecvBuffer();
   }
 
-  sss::Status SendMessage(const Message &msg) {
-    // The proto we send may not be larger than the maximum size received at the
-    // peer. We assume that everyone uses the same value, so we check what we
-    // know locally instead of doing something fancy to ask the remote node.
-    if (msg.length >= kRecvMaxBytes) {
-      sss::Status err = {sss::ResourceExhausted, ""};
-      err << "Message too large: expected<=" << kRecvMaxBytes
-          << ", actual=" << msg.length;
-      return err;
-    }
+  ~TwoSidedRdmaMessenger() {
+    for (auto &p : parcels_)
+      ibv_dereg_mr(p.mr);
+  }
 
-    // If the new message will not fit in remaining memory, then we reset the
-    // head pointer to the beginning.
-    auto tail = send_next_ + msg.length;
-    auto end = send_base_ + send_cap_;
-    if (tail > end) {
-      send_next_ = send_base_;
+  // Getters.
+  const MessengerOptions &options() const { return opts_; }
+
+  /// Reserve `len` bytes of the send buffer, have `write(uint8_t *)` fill
+  /// them in (e.g., serialize a proto there), and SEND the message straight
+  /// from the buffer: whole, or in fragments if it is `slot_bytes` or more.
+  /// A message above `rendezvous_bytes`, or too big for the send buffer, is
+  /// written to a buffer of its own instead and sent by rendezvous.
+  ///
+  /// @return A token for the message's last work request
+  template <class WriteFn>
+  sss::StatusVal<SendToken> PostInPlace(size_t len, WriteFn &&write) {
+    std::lock_guard<std::mutex> lock(send_mu_);
+    ReclaimParcels();
+    if (!FitsInRing(len)) {
+      Message msg{std::make_unique<uint8_t[]>(len), len};
+      write(msg.buffer.get());
+      auto sent = SendRendezvous(std::move(msg));
+      RETURN_STATUSVAL_FROM_ERROR(sent);
+      return {sss::Status::Ok(), SendToken{send_total_ - 1}};
     }
-    std::memcpy(send_next_, msg.buffer.get(), msg.length);
+    auto dst = Reserve(len);
+    RETURN_STATUSVAL_FROM_ERROR(dst.status);
+    write(dst.val.value());
+    auto sent = PostFrames(dst.val.value(), len);
+    RETURN_STATUSVAL_FROM_ERROR(sent);
+    return {sss::Status::Ok(), SendToken{send_total_ - 1}};
+  }
 
-    // Copy the proto into the send buffer.
-    ibv_sge sge;
-    std::memset(&sge, 0, sizeof(sge));
-    sge.addr = reinterpret_cast<uint64_t>(send_next_);
-    sge.length = msg.length;
-    sge.lkey = send_mr_->lkey;
+  /// PostInPlace(), for callers that don't want the token
+  template <class WriteFn>
+  sss::Status SendInPlace(size_t len, WriteFn &&write) {
+    return PostInPlace(len, std::forward<WriteFn>(write)).status;
+  }
 
-    // Note that we use a custom `ibv_send_wr` here since we want to add an
-    // immediate. Otherwise we could have just used `rdma_post_send()`.
-    ibv_send_wr wr;
-    std::memset(&wr, 0, sizeof(wr));
-    wr.send_flags = IBV_SEND_SIGNALED;
-    wr.num_sge = 1;
-    wr.sg_list = &sge;
-    wr.opcode = IBV_WR_SEND_WITH_IMM;
-    wr.wr_id = send_total_++;
+  /// Block until the NIC is done with the send `token` names
+  sss::Status Wait(SendToken token) {
+    std::lock_guard<std::mutex> lock(send_mu_);
+    return AwaitSend(token.wr_id);
+  }
 
-    ibv_send_wr *bad_wr;
-    {
-      int ret = ibv_post_send(id_->qp, &wr, &bad_wr);
-      if (ret != 0) {
-        sss::Status err = {sss::InternalError, ""};
-        err << "ibv_post_send(): " << strerror(errno);
-        return err;
-      }
-    }
+  /// Has the NIC finished with the send `token` names?  Doesn't poll.
+  bool Sent(SendToken token) const { return send_done_ > token.wr_id; }
 
-    // Assumes that the CQ associated with the SQ is synchronous.
-    ibv_wc wc;
-    int comps = rdma_get_send_comp(id_, &wc);
-    while (comps < 0 && errno == EAGAIN) {
-      comps = rdma_get_send_comp(id_, &wc);
+  /// Send `msg`, whole, in fragments, or by rendezvous, depending on its size
+  sss::Status SendMessage(Message msg) {
+    if (!FitsInRing(msg.length)) {
+      std::lock_guard<std::mutex> lock(send_mu_);
+      ReclaimParcels();
+      return SendRendezvous(std::move(msg));
     }
+    return SendInPlace(msg.length, [&](uint8_t *dst) {
+      std::memcpy(dst, msg.buffer.get(), msg.length);
+    });
+  }
 
-    if (comps < 0) {
-      sss::Status e = {sss::InternalError, {}};
-      return e << "rdma_get_send_comp: {}" << strerror(errno);
-    } else if (wc.status != IBV_WC_SUCCESS) {
-      sss::Status e = {sss::InternalError, {}};
-      return e << "rdma_get_send_comp(): " << ibv_wc_status_str(wc.status);
+  /// A received message, read where it landed in the receive buffer.  Its
+  /// slot is reposted when the Lease is dropped, and can't take another
+  /// message until then, so parse the message in place and let go of it.
+  /// A message that came in fragments or by rendezvous has a buffer of its
+  /// own instead, and the slots it came through are reposted already.
+  ///
+  /// NB: A Lease must not outlive the messenger (or SharedReceiver) it came
+  ///     from.
+  class Lease {
+    friend class TwoSidedRdmaMessenger;
+
+    RecvSlots *owner_ = nullptr; //! NOT OWNED
+    uint32_t slot_ = 0;
+    const uint8_t *data_ = nullptr;
+    size_t length_ = 0;
+    std::unique_ptr<uint8_t[]> owned_; // Set if the message isn't in a slot
+
+  public:
+    Lease() = default;
+    Lease(Lease &&o)
+        : owner_(std::exchange(o.owner_, nullptr)), slot_(o.slot_),
+          data_(o.data_), length_(o.length_), owned_(std::move(o.owned_)) {}
+    Lease &operator=(Lease &&o) {
+      Drop();
+      owner_ = std::exchange(o.owner_, nullptr);
+      slot_ = o.slot_;
+      data_ = o.data_;
+      length_ = o.length_;
+      owned_ = std::move(o.owned_);
+      return *this;
     }
+    ~Lease() { Drop(); }
 
-    send_next_ += msg.length;
-    return sss::Status::Ok();
-  }
+    // Getters.
+    const uint8_t *data() const { return data_; }
+    size_t length() const { return length_; }
+
+    /// Give the slot back, to be reposted
+    void Drop() {
+      if (owner_ != nullptr)
+        owner_->Repost(slot_);
+      owner_ = nullptr;
+      data_ = nullptr;
+      length_ = 0;
+      owned_.reset();
+    }
+  };
 
-  /// Non-blocking poll for work completion
-  /// Similar to TryDeliverMessage but instead of using rdma_get_recv_comp
-  /// it uses ibv_poll_cp
-  sss::StatusVal<Message> TryPollMessage(){
+  /// Non-blocking poll for a received message, with ibv_poll_cq()
+  sss::StatusVal<Lease> TryPollLease() {
+    if (slots_->shared())
+      return {{sss::FailedPrecondition, "Receive through the SharedReceiver"},
+              {}};
     ibv_wc wc;
     auto ret = ibv_poll_cq(id_->recv_cq, 1, &wc);
-    ret = (ret < 0) ? rdma_seterrno(ret) : ret;
+    // ibv_poll_cq() returns 0 when the CQ is empty
+    ret = (ret < 0) ? rdma_seterrno(ret) : ret == 0 ? (errno = EAGAIN, -1) : ret;
     if (ret < 0 && errno != EAGAIN) {
       sss::Status e = {sss::InternalError, {}};
       e << "rdma_get_recv_comp: " << strerror(errno);
       return {e, {}};
     } else if (ret < 0 && errno == EAGAIN) {
       return {{sss::Unavailable, "Retry"}, {}};
-    } else {
-      switch (wc.status) {
-      case IBV_WC_WR_FLUSH_ERR:
-        return {{sss::Aborted, "QP in error state"}, {}};
-      case IBV_WC_SUCCESS: {
-        // Prepare the response.
-        //
-        // [mfs] It looks like there's a lot of copying baked into the API?
-        // [esl] I was getting an error with the code that was previously here. The optional was throwing a bad_optional_access exception. I think the optional had to be constructed with a value. It might be better to refactor Message to make it moveable and construct in a series of steps instead of one long statement?
-        sss::StatusVal<Message> res = {sss::Status::Ok(), std::make_optional(Message{std::make_unique<uint8_t[]>(wc.byte_len), wc.byte_len})};
-        std::memcpy(res.val->buffer.get(), recv_next_, wc.byte_len);
-        ROME_TRACE("{} {}", res.val->buffer.get(), res.val->length);
-
-        // If the tail reached the end of the receive buffer then all posted
-        // wrs have been consumed and we can post new ones.
-        // `PrepareRecvBuffer` also handles resetting `recv_next_` to point to
-        // the base address of the receive buffer.
-        recv_total_++;
-        recv_next_ += kRecvMaxBytes;
-        if (recv_next_ > recv_base_ + (recv_cap_ - kRecvMaxBytes)) {
-          PrepareRecvBuffer();
-        }
-        return res;
-      }
-      default: {
-        sss::Status err = {sss::InternalError, {}};
-        err << "rdma_get_recv_comp(): " << ibv_wc_status_str(wc.status);
-        return {err, {}};
-      }
-      }
     }
+    return OnReceive(wc);
   }
 
-  // Attempts to deliver a sent message by checking for completed receives and
-  // then returning a `Message` containing a copy of the received buffer.
-  sss::StatusVal<Message> TryDeliverMessage() {
+  /// Non-blocking poll for a received message, with rdma_get_recv_comp()
+  sss::StatusVal<Lease> TryDeliverLease() {
+    if (slots_->shared())
+      return {{sss::FailedPrecondition, "Receive through the SharedReceiver"},
+              {}};
     ibv_wc wc;
     auto ret = rdma_get_recv_comp(id_, &wc);
     if (ret < 0 && errno != EAGAIN) {
@@ -197,60 +392,370 @@ public:
       return {e, {}};
     } else if (ret < 0 && errno == EAGAIN) {
       return {{sss::Unavailable, "Retry"}, {}};
-    } else {
-      switch (wc.status) {
-      case IBV_WC_WR_FLUSH_ERR:
-        return {{sss::Aborted, "QP in error state"}, {}};
-      case IBV_WC_SUCCESS: {
-        // Prepare the response.
-        //
-        // [mfs] It looks like there's a lot of copying baked into the API?
-        // [esl] I was getting an error with the code that was previously here. The optional was throwing a bad_optional_access exception. I think the optional had to be constructed with a value. It might be better to refactor Message to make it moveable and construct in a series of steps instead of one long statement?
-        sss::StatusVal<Message> res = {sss::Status::Ok(), std::make_optional(Message{std::make_unique<uint8_t[]>(wc.byte_len), wc.byte_len})};
-        std::memcpy(res.val->buffer.get(), recv_next_, wc.byte_len);
-        ROME_TRACE("{} {}", res.val->buffer.get(), res.val->length);
-
-        // If the tail reached the end of the receive buffer then all posted
-        // wrs have been consumed and we can post new ones.
-        // `PrepareRecvBuffer` also handles resetting `recv_next_` to point to
-        // the base address of the receive buffer.
-        recv_total_++;
-        recv_next_ += kRecvMaxBytes;
-        if (recv_next_ > recv_base_ + (recv_cap_ - kRecvMaxBytes)) {
-          PrepareRecvBuffer();
-        }
-        return res;
-      }
-      default: {
-        sss::Status err = {sss::InternalError, {}};
-        err << "rdma_get_recv_comp(): " << ibv_wc_status_str(wc.status);
-        return {err, {}};
-      }
-      }
     }
+    return OnReceive(wc);
+  }
+
+  /// Non-blocking poll for work completion
+  /// Similar to TryDeliverMessage but instead of using rdma_get_recv_comp
+  /// it uses ibv_poll_cp
+  sss::StatusVal<Message> TryPollMessage() { return Copy(TryPollLease()); }
+
+  // Attempts to deliver a sent message by checking for completed receives and
+  // then returning a `Message` containing a copy of the received buffer.
+  sss::StatusVal<Message> TryDeliverMessage() {
+    return Copy(TryDeliverLease());
   }
 
 private:
   // Memory region IDs.
   static constexpr char kSendId[] = "send";
   static constexpr char kRecvId[] = "recv";
+  static constexpr char kWordsId[] = "words";
+
+  /// How many send completions to reap at once
+  static constexpr int kReapBatch = 16;
+
+  /// Post `wr` to the SQ, asking for a completion if `signaled`.  Call with
+  /// `send_mu_` held, after MakeRoom() unless this is Flush().
+  sss::Status PostWr(ibv_send_wr &wr, bool signaled) {
+    wr.send_flags = signaled ? IBV_SEND_SIGNALED : 0;
+    wr.wr_id = send_total_;
+    ibv_send_wr *bad_wr;
+    int ret = ibv_post_send(id_->qp, &wr, &bad_wr);
+    if (ret != 0) {
+      sss::Status err = {sss::InternalError, ""};
+      err << "ibv_post_send(): " << strerror(errno);
+      return err;
+    }
+    ++send_total_;
+    if (signaled)
+      signaled_ = send_total_;
+    return sss::Status::Ok();
+  }
+
+  /// Wait until the SQ can take another work request and still keep one
+  /// entry free for Flush().  Call with `send_mu_` held.
+  sss::Status MakeRoom() {
+    while (send_total_ - send_done_ + 2 > opts_.send_depth) {
+      auto s = AwaitSend(send_total_ - 1);
+      RETURN_STATUS_ON_ERROR(s);
+    }
+    return sss::Status::Ok();
+  }
+
+  /// Post a signaled zero-length RDMA WRITE, which touches no memory, so
+  /// that a completion covers everything posted before it.  Call with
+  /// `send_mu_` held.
+  sss::Status Flush() {
+    ibv_send_wr wr;
+    std::memset(&wr, 0, sizeof(wr));
+    wr.opcode = IBV_WR_RDMA_WRITE;
+    return PostWr(wr, true);
+  }
+
+  /// Poll the send CQ once, and reclaim the send buffer behind whatever
+  /// completed.  Call with `send_mu_` held.
+  sss::Status ReapSends() {
+    ibv_wc wc[kReapBatch];
+    int n = ibv_poll_cq(id_->send_cq, kReapBatch, wc);
+    if (n < 0) {
+      sss::Status e = {sss::InternalError, {}};
+      return e << "ibv_poll_cq(): " << strerror(-n);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (wc[i].status != IBV_WC_SUCCESS) {
+        sss::Status e = {sss::InternalError, {}};
+        return e << "ibv_poll_cq(): " << ibv_wc_status_str(wc[i].status);
+      }
+      send_done_ = std::max(send_done_, wc[i].wr_id + 1);
+    }
+    if (n > 0)
+      ReclaimSends(send_done_ - 1);
+    return sss::Status::Ok();
+  }
+
+  /// Spin until work request `wr_id` has completed, flushing first if no
+  /// signaled one follows it.  Call with `send_mu_` held.
+  sss::Status AwaitSend(uint64_t wr_id) {
+    if (send_done_ > wr_id)
+      return sss::Status::Ok();
+    if (wr_id >= signaled_) {
+      auto flushed = Flush();
+      RETURN_STATUS_ON_ERROR(flushed);
+    }
+    while (send_done_ <= wr_id) {
+      auto s = ReapSends();
+      RETURN_STATUS_ON_ERROR(s);
+    }
+    return sss::Status::Ok();
+  }
+
+  /// Post `wr` and spin until it completes.  Call with `send_mu_` held.
+  sss::Status PostAndWait(ibv_send_wr &wr) {
+    auto room = MakeRoom();
+    RETURN_STATUS_ON_ERROR(room);
+    auto posted = PostWr(wr, true);
+    RETURN_STATUS_ON_ERROR(posted);
+    return AwaitSend(send_total_ - 1);
+  }
 
-  // Reset the receive buffer and post `ibv_recv_wr` on the RQ. This should only
-  // be called when all posted receives have corresponding completions,
-  // otherwise there may be a race on memory by posted recvs.
-  void PrepareRecvBuffer() {
-    ROME_ASSERT(recv_total_ % (recv_cap_ / kRecvMaxBytes) == 0,
-                "Unexpected number of completions from RQ");
-    // Prepare the recv buffer for incoming messages with the assumption that
-    // the maximum received message will be `max_recv_` bytes long.
-    for (auto curr = recv_base_;
-         curr <= recv_base_ + (recv_cap_ - kRecvMaxBytes);
-         curr += kRecvMaxBytes) {
-      RDMA_CM_ASSERT(rdma_post_recv, id_, nullptr, curr, kRecvMaxBytes,
-                     recv_mr_);
-    }
-    recv_next_ = recv_base_;
+  /// Should a message of `len` bytes go through the send buffer, rather
+  /// than by rendezvous?
+  bool FitsInRing(size_t len) const {
+    return len <= opts_.rendezvous_bytes && len <= size_t(send_cap_);
   }
+
+  /// Reserve `len` contiguous bytes of the send buffer.  Space is reclaimed
+  /// only as the SENDs that use it complete, never by wrapping over it, so a
+  /// message is never overwritten while the NIC may still be reading it.
+  /// Once the buffer drains, a message that would have to skip to the start
+  /// starts a new lap there instead, so any `len` up to the capacity fits.
+  /// Call with `send_mu_` held.
+  sss::StatusVal<uint8_t *> Reserve(size_t len) {
+    const uint64_t cap = send_cap_;
+    // A message that would run past the end goes at the start instead
+    auto skip = [&]() -> uint64_t {
+      const uint64_t at = send_head_ % cap;
+      return at + len > cap ? cap - at : 0;
+    };
+    if (send_head_ + skip() + len - send_tail_ > cap && !posted_.empty()) {
+      // Everything posted so far completes no later than the newest send
+      auto s = AwaitSend(posted_.back().wr_id);
+      RETURN_STATUSVAL_FROM_ERROR(s);
+    }
+    if (send_tail_ == send_head_ && skip() > 0)
+      send_head_ = send_tail_ = (send_head_ / cap + 1) * cap;
+    const uint64_t pad = skip();
+    if (send_head_ + pad + len - send_tail_ > cap) {
+      sss::Status err = {sss::ResourceExhausted, ""};
+      err << "Send buffer is full: " << len << " bytes wanted";
+      return {err, {}};
+    }
+    send_head_ += pad;
+    uint8_t *dst = send_base_ + send_head_ % cap;
+    send_head_ += len;
+    return {sss::Status::Ok(), dst};
+  }
+
+  /// Move `send_tail_` past every SEND up to and including `wr_id`.  Call
+  /// with `send_mu_` held.
+  void ReclaimSends(uint64_t wr_id) {
+    while (!posted_.empty() && posted_.front().wr_id <= wr_id) {
+      send_tail_ = posted_.front().end;
+      posted_.pop_front();
+    }
+  }
+
+  /// SEND `len` bytes that were just reserved at `buf`: whole if they fit in
+  /// a slot, in fragments if not.  Call with `send_mu_` held.
+  sss::Status PostFrames(uint8_t *buf, size_t len) {
+    const uint64_t start = send_head_ - len;
+    if (len < opts_.slot_bytes)
+      return PostSend(buf, len, start + len, kWhole);
+    for (size_t off = 0; off < len; off += opts_.slot_bytes) {
+      const size_t n = std::min<size_t>(opts_.slot_bytes, len - off);
+      auto s = PostSend(buf + off, n, start + off + n,
+                        off + n < len ? kFragment : kLastFragment);
+      RETURN_STATUS_ON_ERROR(s);
+    }
+    return sss::Status::Ok();
+  }
+
+  /// SEND the `len` bytes of the send buffer at `buf` as `kind`; the buffer
+  /// is reclaimed up to `end` when it completes.  Call with `send_mu_` held.
+  sss::Status PostSend(uint8_t *buf, size_t len, uint64_t end, Kind kind) {
+    ibv_sge sge;
+    std::memset(&sge, 0, sizeof(sge));
+    sge.addr = reinterpret_cast<uint64_t>(buf);
+    sge.length = len;
+    sge.lkey = send_mr_->lkey;
+
+    // Note that we use a custom `ibv_send_wr` here since we want to add an
+    // immediate. Otherwise we could have just used `rdma_post_send()`.
+    ibv_send_wr wr;
+    std::memset(&wr, 0, sizeof(wr));
+    wr.num_sge = 1;
+    wr.sg_list = &sge;
+    wr.opcode = IBV_WR_SEND_WITH_IMM;
+    wr.imm_data = htonl(uint32_t(kind) << kKindShift);
+    auto room = MakeRoom();
+    RETURN_STATUS_ON_ERROR(room);
+    // Each SEND in flight may be holding one of the peer's receives
+    while (posted_.size() >= opts_.recv_slots) {
+      auto s = AwaitSend(posted_.front().wr_id);
+      RETURN_STATUS_ON_ERROR(s);
+    }
+    posted_.push_back({send_total_, end});
+    auto posted = PostWr(wr, !opts_.async_sends ||
+                                 (send_total_ + 1) % opts_.signal_every == 0);
+    if (posted.t != sss::Ok) {
+      posted_.pop_back();
+      return posted;
+    }
+    if (!opts_.async_sends)
+      return AwaitSend(send_total_ - 1);
+    return sss::Status::Ok();
+  }
+
+  /// Register `msg` where it is and SEND a `Rendezvous` describing it.  Call
+  /// with `send_mu_` held.
+  sss::Status SendRendezvous(Message msg) {
+    if (msg.length > std::numeric_limits<uint32_t>::max()) {
+      sss::Status err = {sss::ResourceExhausted, ""};
+      err << "Message too large: " << msg.length;
+      return err;
+    }
+    ibv_mr *mr = ibv_reg_mr(id_->pd, msg.buffer.get(), msg.length,
+                            IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ);
+    if (mr == nullptr) {
+      sss::Status err = {sss::InternalError, ""};
+      err << "ibv_reg_mr(): " << strerror(errno);
+      return err;
+    }
+    auto dst = Reserve(sizeof(Rendezvous));
+    if (dst.status.t != sss::Ok) {
+      ibv_dereg_mr(mr);
+      return dst.status;
+    }
+    Rendezvous r;
+    r.addr = reinterpret_cast<uint64_t>(msg.buffer.get());
+    r.rkey = mr->rkey;
+    r.length = msg.length;
+    r.done_addr = reinterpret_cast<uint64_t>(done_);
+    r.done_rkey = words_mr_->rkey;
+    r.seq = ++parcel_seq_;
+    parcels_.push_back({std::move(msg.buffer), mr, r.seq});
+    std::memcpy(dst.val.value(), &r, sizeof(r));
+    return PostSend(dst.val.value(), sizeof(r), send_head_, kRendezvous);
+  }
+
+  /// Release the large messages that the peer has finished READing.  Call
+  /// with `send_mu_` held.
+  void ReclaimParcels() {
+    const uint64_t done = *done_;
+    while (!parcels_.empty() && parcels_.front().seq <= done) {
+      ibv_dereg_mr(parcels_.front().mr);
+      parcels_.pop_front();
+    }
+  }
+
+  /// READ the message `r` describes from the peer, then tell it so
+  sss::StatusVal<Message> Fetch(const Rendezvous &r) {
+    Message msg{std::make_unique<uint8_t[]>(r.length), r.length};
+    ibv_mr *mr = ibv_reg_mr(id_->pd, msg.buffer.get(), r.length,
+                            IBV_ACCESS_LOCAL_WRITE);
+    if (mr == nullptr) {
+      sss::Status err = {sss::InternalError, ""};
+      err << "ibv_reg_mr(): " << strerror(errno);
+      return {err, {}};
+    }
+    std::lock_guard<std::mutex> lock(send_mu_);
+    ibv_sge sge;
+    std::memset(&sge, 0, sizeof(sge));
+    sge.addr = reinterpret_cast<uint64_t>(msg.buffer.get());
+    sge.length = r.length;
+    sge.lkey = mr->lkey;
+    ibv_send_wr wr;
+    std::memset(&wr, 0, sizeof(wr));
+    wr.num_sge = 1;
+    wr.sg_list = &sge;
+    wr.opcode = IBV_WR_RDMA_READ;
+    wr.wr.rdma.remote_addr = r.addr;
+    wr.wr.rdma.rkey = r.rkey;
+    auto read = PostAndWait(wr);
+    ibv_dereg_mr(mr);
+    RETURN_STATUSVAL_FROM_ERROR(read);
+
+    *ack_ = r.seq;
+    sge.addr = reinterpret_cast<uint64_t>(ack_);
+    sge.length = sizeof(*ack_);
+    sge.lkey = words_mr_->lkey;
+    std::memset(&wr, 0, sizeof(wr));
+    wr.num_sge = 1;
+    wr.sg_list = &sge;
+    wr.opcode = IBV_WR_RDMA_WRITE;
+    wr.wr.rdma.remote_addr = r.done_addr;
+    wr.wr.rdma.rkey = r.done_rkey;
+    auto written = PostAndWait(wr);
+    RETURN_STATUSVAL_FROM_ERROR(written);
+    return {sss::Status::Ok(), std::move(msg)};
+  }
+
+  /// A copy of the message `lease` holds, which lets the slot go
+  static sss::StatusVal<Message> Copy(sss::StatusVal<Lease> lease) {
+    if (lease.status.t != sss::Ok)
+      return {lease.status, {}};
+    Lease &l = lease.val.value();
+    if (l.owned_ != nullptr)
+      return {sss::Status::Ok(), Message{std::move(l.owned_), l.length_}};
+    Message msg{std::make_unique<uint8_t[]>(l.length_), l.length_};
+    std::memcpy(msg.buffer.get(), l.data_, l.length_);
+    return {sss::Status::Ok(), std::move(msg)};
+  }
+
+  /// Take the receive that `wc` completed, and return the message it
+  /// finishes, or Unavailable if it was a fragment with more to come.  The
+  /// slot is leased to the caller if it holds a whole message, and reposted
+  /// right away if not.
+  sss::StatusVal<Lease> OnReceive(const ibv_wc &wc) {
+    switch (wc.status) {
+    case IBV_WC_WR_FLUSH_ERR:
+      return {{sss::Aborted, "QP in error state"}, {}};
+    case IBV_WC_SUCCESS:
+      break;
+    default: {
+      sss::Status err = {sss::InternalError, {}};
+      err << "rdma_get_recv_comp(): " << ibv_wc_status_str(wc.status);
+      return {err, {}};
+    }
+    }
+    const uint32_t slot = wc.wr_id;
+    const uint8_t *data = slots_->slot(slot);
+    const uint32_t len = wc.byte_len;
+    const Kind kind = (wc.wc_flags & IBV_WC_WITH_IMM)
+                          ? Kind(ntohl(wc.imm_data) >> kKindShift)
+                          : kWhole;
+    ROME_TRACE("{} {}", fmt::ptr(data), len);
+    Lease lease;
+    switch (kind) {
+    case kWhole:
+      lease.owner_ = slots_;
+      lease.slot_ = slot;
+      lease.data_ = data;
+      lease.length_ = len;
+      return {sss::Status::Ok(), std::move(lease)};
+    case kFragment:
+      partial_.insert(partial_.end(), data, data + len);
+      slots_->Repost(slot);
+      return {{sss::Unavailable, "Retry"}, {}};
+    case kLastFragment:
+      partial_.insert(partial_.end(), data, data + len);
+      slots_->Repost(slot);
+      lease.length_ = partial_.size();
+      lease.owned_ = std::make_unique<uint8_t[]>(partial_.size());
+      std::memcpy(lease.owned_.get(), partial_.data(), partial_.size());
+      partial_.clear();
+      break;
+    case kRendezvous: {
+      Rendezvous r;
+      std::memcpy(&r, data, sizeof(r));
+      slots_->Repost(slot);
+      auto msg = Fetch(r);
+      RETURN_STATUSVAL_FROM_ERROR(msg.status);
+      lease.length_ = msg.val->length;
+      lease.owned_ = std::move(msg.val->buffer);
+      break;
+    }
+    }
+    lease.data_ = lease.owned_.get();
+    return {sss::Status::Ok(), std::move(lease)};
+  }
+
+  // Post a receive on the RQ for every slot of the receive buffer, with the
+  // assumption that the maximum received message will be `slot_bytes` bytes
+  // long.  After this, each slot is reposted on its own, as its Lease goes.
+  void PrepareRecvBuffer() { own_slots_.PostAll(); }
 };
 
 // Contains the necessary information for communicating between nodes. This
@@ -259,6 +764,7 @@ private:
 // for 2-sided message-passing.
 class Connection {
   class RdmaChannel {
+    friend class SharedReceiver;
 
     TwoSidedRdmaMessenger messenger;
 
@@ -267,7 +773,8 @@ class Connection {
 
   public:
     ~RdmaChannel() {}
-    explicit RdmaChannel(rdma_cm_id *id) : messenger(id), id_(id) {}
+    RdmaChannel(rdma_cm_id *id, MessengerOptions opts, RecvSlots *shared)
+        : messenger(id, opts, shared), id_(id) {}
 
     // No copy or move.
     RdmaChannel(const RdmaChannel &c) = delete;
@@ -276,27 +783,39 @@ class Connection {
     // Getters.
     rdma_cm_id *id() const { return id_; }
 
+    /// Serialize `proto` straight into the messenger's send buffer and send
+    /// it from there
     template <typename ProtoType> sss::Status Send(const ProtoType &proto) {
-      Message msg{std::make_unique<uint8_t[]>(proto.ByteSizeLong()),
-                  proto.ByteSizeLong()};
-      proto.SerializeToArray(msg.buffer.get(), msg.length);
-      return messenger.SendMessage(msg);
+      return Post(proto).status;
     }
 
+    /// Send(), returning a token to Wait() on
+    template <typename ProtoType>
+    sss::StatusVal<SendToken> Post(const ProtoType &proto) {
+      return messenger.PostInPlace(proto.ByteSizeLong(), [&](uint8_t *dst) {
+        proto.SerializeWithCachedSizesToArray(dst);
+      });
+    }
+
+    /// Block until the NIC is done with a Post()ed message
+    sss::Status Wait(SendToken token) { return messenger.Wait(token); }
+
   private:
     template <typename ProtoType> sss::StatusVal<ProtoType> TryDeliver() {
-      auto msg_or = messenger.TryDeliverMessage();
-      if (msg_or.status.t == sss::Ok) {
+      auto lease_or = messenger.TryDeliverLease();
+      if (lease_or.status.t == sss::Ok) {
         ProtoType proto;
-        proto.ParseFromArray(msg_or.val.value().buffer.get(),
-                             msg_or.val.value().length);
+        proto.ParseFromArray(lease_or.val.value().data(),
+                             lease_or.val.value().length());
         return {sss::Status::Ok(), proto};
       } else {
-        return {msg_or.status, {}};
+        return {lease_or.status, {}};
       }
     }
 
   public:
+    using Lease = TwoSidedRdmaMessenger::Lease;
+
     template <typename ProtoType> sss::StatusVal<ProtoType> Deliver() {
       auto p = this->TryDeliver<ProtoType>();
       while (p.status.t == sss::Unavailable) {
@@ -305,17 +824,26 @@ class Connection {
       return p;
     }
 
+    /// Parses the message straight out of the receive buffer
     template <typename ProtoType> std::optional<ProtoType> TryReceive() {
-      auto msg_or = messenger.TryPollMessage();
-      if (msg_or.status.t == sss::Ok) {
+      auto lease_or = messenger.TryPollLease();
+      if (lease_or.status.t == sss::Ok) {
         ProtoType proto;
-        proto.ParseFromArray(msg_or.val.value().buffer.get(),
-                             msg_or.val.value().length);
+        proto.ParseFromArray(lease_or.val.value().data(),
+                             lease_or.val.value().length());
         return proto;
       } else {
         return nullopt;
       }
     }
+
+    /// The next message, in place, for callers that read it without a proto
+    std::optional<Lease> TryReceiveLease() {
+      auto lease_or = messenger.TryPollLease();
+      if (lease_or.status.t == sss::Ok)
+        return std::move(lease_or.val);
+      return nullopt;
+    }
   };
 
   // [mfs] These should probably be template parameters
@@ -336,9 +864,12 @@ class Connection {
 public:
   Connection()
       : src_id_(std::numeric_limits<uint32_t>::max()),
-        dst_id_(std::numeric_limits<uint32_t>::max()), channel_(nullptr) {}
-  Connection(uint32_t src_id, uint32_t dst_id, rdma_cm_id *channel_id)
-      : src_id_(src_id), dst_id_(dst_id), channel_(channel_id) {}
+        dst_id_(std::numeric_limits<uint32_t>::max()),
+        channel_(nullptr, MessengerOptions(), nullptr) {}
+  Connection(uint32_t src_id, uint32_t dst_id, rdma_cm_id *channel_id,
+             MessengerOptions opts = MessengerOptions(),
+             RecvSlots *shared = nullptr)
+      : src_id_(src_id), dst_id_(dst_id), channel_(channel_id, opts, shared) {}
 
   Connection(const Connection &) = delete;
   Connection(Connection &&c) = delete;
@@ -351,6 +882,132 @@ public:
   RdmaChannel *channel() { return &channel_; }
 };
 
+struct SharedReceiverOptions {
+  /// Receives posted at once; 0 disables it.  Every peer may have up to its
+  /// `recv_slots` SENDs in flight, so fewer than their sum can mean RNR NAKs
+  uint32_t slots = 0;
+  uint32_t slot_bytes = 1 << 8; // No less than any peer's `slot_bytes`
+};
+
+/// SharedReceiver lets all of a ConnectionManager's connections receive
+/// through one SRQ and one receive CQ.  Receive memory is then `slots`
+/// slots however many peers there are, and one thread can poll every peer
+/// at once: each completion names its QP, which leads straight to the
+/// Connection (and its messenger, which reassembles fragments and READs
+/// rendezvous) it came from.
+///
+/// The connections' own TryReceive()/Deliver() return FailedPrecondition;
+/// use TryReceive() here instead.
+class SharedReceiver {
+public:
+  using Options = SharedReceiverOptions;
+
+  /// A message, and the peer that sent it
+  struct Delivery {
+    uint32_t from;
+    TwoSidedRdmaMessenger::Lease lease;
+  };
+
+private:
+  const Options opts_;
+  RdmaMemory rm_;
+  ibv_srq *srq_ = nullptr;
+  ibv_cq *cq_ = nullptr;
+  RecvSlots slots_;
+
+  // Guards `sources_`, and keeps one thread at a time in a messenger's
+  // reassembly
+  std::mutex mu_;
+  std::unordered_map<uint32_t, Connection *> sources_; // By QP number
+
+  static constexpr char kRecvId[] = "shared_recv";
+
+public:
+  SharedReceiver(ibv_pd *pd, Options opts)
+      : opts_(opts), rm_(opts.slots * opts.slot_bytes, std::nullopt, pd) {
+    OK_OR_FAIL(rm_.RegisterMemoryRegion(kRecvId, 0,
+                                        opts_.slots * opts_.slot_bytes));
+    auto mr = rm_.GetMemoryRegion(kRecvId);
+    STATUSVAL_OR_DIE(mr);
+    ibv_srq_init_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.attr.max_wr = opts_.slots;
+    attr.attr.max_sge = 1;
+    srq_ = ibv_create_srq(pd, &attr);
+    ROME_ASSERT(srq_ != nullptr, "ibv_create_srq(): {}", strerror(errno));
+    cq_ = ibv_create_cq(pd->context, opts_.slots, nullptr, nullptr, 0);
+    ROME_ASSERT(cq_ != nullptr, "ibv_create_cq(): {}", strerror(errno));
+    slots_ = RecvSlots(mr.val.value(), opts_.slots, opts_.slot_bytes, nullptr,
+                       srq_);
+    slots_.PostAll();
+  }
+
+  SharedReceiver(const SharedReceiver &) = delete;
+  SharedReceiver(SharedReceiver &&) = delete;
+
+  /// NB: Destroy the QPs that use it first
+  ~SharedReceiver() {
+    ibv_destroy_srq(srq_);
+    ibv_destroy_cq(cq_);
+  }
+
+  // Getters.
+  ibv_srq *srq() const { return srq_; }
+  ibv_cq *cq() const { return cq_; }
+  RecvSlots *slots() { return &slots_; }
+
+  /// Start dispatching `conn`'s receives
+  void Add(Connection *conn) {
+    std::lock_guard<std::mutex> lock(mu_);
+    sources_[conn->id()->qp->qp_num] = conn;
+  }
+
+  void Remove(Connection *conn) {
+    std::lock_guard<std::mutex> lock(mu_);
+    sources_.erase(conn->id()->qp->qp_num);
+  }
+
+  /// The next message from any peer.  Unavailable if there is none yet (or
+  /// the completion was a fragment of one).
+  sss::StatusVal<Delivery> TryPollLease() {
+    std::lock_guard<std::mutex> lock(mu_);
+    ibv_wc wc;
+    int n = ibv_poll_cq(cq_, 1, &wc);
+    if (n < 0) {
+      sss::Status e = {sss::InternalError, {}};
+      e << "ibv_poll_cq(): " << strerror(-n);
+      return {e, {}};
+    } else if (n == 0) {
+      return {{sss::Unavailable, "Retry"}, {}};
+    }
+    auto it = sources_.find(wc.qp_num);
+    if (wc.status != IBV_WC_SUCCESS || it == sources_.end()) {
+      // The SRQ only gets the slot back if someone reposts it
+      slots_.Repost(wc.wr_id);
+      if (it == sources_.end())
+        return {{sss::Unavailable, "Retry"}, {}};
+    }
+    auto lease = it->second->channel()->messenger.OnReceive(wc);
+    if (lease.status.t != sss::Ok)
+      return {lease.status, {}};
+    return {sss::Status::Ok(),
+            Delivery{it->second->dst_id(), std::move(lease.val.value())}};
+  }
+
+  /// The next message from any peer, parsed straight out of its slot, and
+  /// the peer's id
+  template <typename ProtoType>
+  std::optional<std::pair<uint32_t, ProtoType>> TryReceive() {
+    auto got = TryPollLease();
+    if (got.status.t != sss::Ok)
+      return std::nullopt;
+    std::pair<uint32_t, ProtoType> res;
+    res.first = got.val->from;
+    res.second.ParseFromArray(got.val->lease.data(), got.val->lease.length());
+    return res;
+  }
+};
+
 /// [mfs] This should be a has-a RdmaReceiverInterface, since I was able to make
 ///       the inheritance private.
 class ConnectionManager {
@@ -368,6 +1025,10 @@ class ConnectionManager {
   uint32_t my_id_;
   std::unique_ptr<RdmaBroker<ConnectionManager>> broker_;
 
+  // Set if the connections share an SRQ (created once `broker_` has a PD)
+  SharedReceiverOptions shared_opts_;
+  std::unique_ptr<SharedReceiver> shared_;
+
   // Maintains connection information for a given Internet address. A connection
   // manager only maintains a single connection per node. Nodes are identified
   // by a string representing their IP address.
@@ -383,6 +1044,10 @@ class ConnectionManager {
 
   rdma_cm_id *loopback_id_ = nullptr;
 
+  // How to size each connection's two-sided channel
+  MessengerOptions messenger_opts_;
+  std::unordered_map<uint32_t, MessengerOptions> peer_messenger_opts_;
+
 public:
   ~ConnectionManager() {
     ROME_TRACE("Shutting down: {}", fmt::ptr(this));
@@ -428,8 +1093,19 @@ public:
     Release();
   }
 
-  explicit ConnectionManager(uint32_t my_id)
-      : accepting_(false), my_id_(my_id), broker_(nullptr), mu_(kUnlocked) {}
+  /// @param shared  If `shared.slots` is set, every connection receives
+  ///                through one SharedReceiver (see shared_receiver())
+  explicit ConnectionManager(uint32_t my_id,
+                             MessengerOptions opts = MessengerOptions(),
+                             SharedReceiverOptions shared = {})
+      : accepting_(false), my_id_(my_id), broker_(nullptr),
+        shared_opts_(shared), mu_(kUnlocked), messenger_opts_(opts) {}
+
+  /// Size the channel to `peer_id` differently from the rest.  Both ends must
+  /// agree on `slot_bytes`.  Call before Start().
+  void SetMessengerOptions(uint32_t peer_id, MessengerOptions opts) {
+    peer_messenger_opts_[peer_id] = opts;
+  }
 
   sss::Status Start(std::string_view addr, std::optional<uint16_t> port) {
     if (accepting_) {
@@ -437,10 +1113,17 @@ public:
     }
     accepting_ = true;
 
+    // Peers that connect before the SRQ exists are turned away, and retry
+    while (!Acquire(my_id_))
+      std::this_thread::yield();
     broker_ = RdmaBroker<ConnectionManager>::Create(addr, port, this);
     if (broker_ == nullptr) {
+      Release();
       return {sss::InternalError, "Failed to create broker"};
     }
+    if (shared_opts_.slots > 0)
+      shared_ = std::make_unique<SharedReceiver>(pd(), shared_opts_);
+    Release();
     return {sss::Ok, {}};
   }
 
@@ -448,6 +1131,12 @@ public:
   std::string address() const { return broker_->address(); }
   uint16_t port() const { return broker_->port(); }
   ibv_pd *pd() const { return broker_->pd(); }
+  /// Where every connection receives, if they share an SRQ (else null)
+  SharedReceiver *shared_receiver() const { return shared_.get(); }
+  const MessengerOptions &messenger_options(uint32_t peer_id) const {
+    auto it = peer_messenger_opts_.find(peer_id);
+    return it == peer_messenger_opts_.end() ? messenger_opts_ : it->second;
+  }
 
   // `RdmaReceiverInterface` implementation
   void OnConnectRequest(rdma_cm_id *id, rdma_cm_event *event) {
@@ -490,7 +1179,7 @@ public:
       }
 
       // Create a new QP for the connection.
-      ibv_qp_init_attr init_attr = DefaultQpInitAttr();
+      ibv_qp_init_attr init_attr = QpInitAttr(messenger_options(peer_id));
       ROME_ASSERT(id->qp == nullptr, "QP already allocated...?");
       RDMA_CM_ASSERT(rdma_create_qp, id, pd(), &init_attr);
     } else {
@@ -509,14 +1198,14 @@ public:
     std::memset(&context->conn_param, 0, sizeof(context->conn_param));
     context->conn_param.private_data = &context->node_id;
     context->conn_param.private_data_len = sizeof(context->node_id);
-    context->conn_param.rnr_retry_count = 1; // Retry forever
+    // A peer may send several fragments before this end reposts receives
+    context->conn_param.rnr_retry_count = 7; // Retry forever
     context->conn_param.retry_count = 7;
     context->conn_param.responder_resources = 8;
     context->conn_param.initiator_depth = 8;
     id->context = context;
 
-    auto it =
-        established_.emplace(peer_id, new Connection(my_id_, peer_id, id));
+    auto it = established_.emplace(peer_id, NewConnection(peer_id, id));
     ROME_ASSERT_DEBUG(it.second, "Insertion failed");
 
     ROME_TRACE("[OnConnectRequest] (Node {}) peer={}, id={}", my_id_, peer_id,
@@ -546,6 +1235,8 @@ public:
     if (auto conn = established_.find(peer_id);
         conn != established_.end() && conn->second->id() == id) {
       ROME_TRACE("(Node {}) Disconnected from node {}", my_id_, peer_id);
+      if (shared_ != nullptr)
+        shared_->Remove(conn->second.get());
       established_.erase(peer_id);
     }
     Release();
@@ -592,7 +1283,7 @@ public:
         return {err, {}};
       }
 
-      ibv_qp_init_attr init_attr = DefaultQpInitAttr();
+      ibv_qp_init_attr init_attr = QpInitAttr(messenger_options(peer_id));
       auto err = rdma_create_ep(&id, resolved, pd(), &init_attr);
       rdma_freeaddrinfo(resolved);
       if (err) {
@@ -619,7 +1310,7 @@ public:
       conn_param.private_data = &my_id_;
       conn_param.private_data_len = sizeof(my_id_);
       conn_param.retry_count = 7;
-      conn_param.rnr_retry_count = 1;
+      conn_param.rnr_retry_count = 7; // Retry forever
       conn_param.responder_resources = 8;
       conn_param.initiator_depth = 8;
 
@@ -679,16 +1370,16 @@ public:
 
           RDMA_CM_CHECK_TOVAL(fcntl, event_channel->fd, F_SETFL,
                               fcntl(event_channel->fd, F_GETFL) | O_SYNC);
-          RDMA_CM_CHECK_TOVAL(fcntl, id->recv_cq->channel->fd, F_SETFL,
-                              fcntl(id->recv_cq->channel->fd, F_GETFL) |
-                                  O_NONBLOCK);
+          if (shared_ == nullptr)
+            RDMA_CM_CHECK_TOVAL(fcntl, id->recv_cq->channel->fd, F_SETFL,
+                                fcntl(id->recv_cq->channel->fd, F_GETFL) |
+                                    O_NONBLOCK);
           RDMA_CM_CHECK_TOVAL(fcntl, id->send_cq->channel->fd, F_SETFL,
                               fcntl(id->send_cq->channel->fd, F_GETFL) |
                                   O_NONBLOCK);
 
           // Allocate a new control channel to be used with this connection
-          auto iter = established_.emplace(peer_id,
-                                           new Connection(my_id_, peer_id, id));
+          auto iter = established_.emplace(peer_id, NewConnection(peer_id, id));
           ROME_ASSERT(iter.second, "Unexepected error");
           auto *new_conn = established_[peer_id].get();
           Release();
@@ -741,11 +1432,8 @@ public:
   }
 
 private:
-  // The size of each memory region dedicated to a single connection.
-  static constexpr int kCapacity = 1 << 12; // 4 KiB
-  static constexpr int kMaxRecvBytes = 64;
-
-  static constexpr int kMaxWr = kCapacity / kMaxRecvBytes;
+  // Work requests per queue.  The RQ grows to fit `recv_slots` if needed.
+  static constexpr int kMaxWr = 64;
   static constexpr int kMaxSge = 1;
   static constexpr int kMaxInlineData = 0;
 
@@ -786,10 +1474,16 @@ private:
 
   inline void Release() { mu_ = kUnlocked; }
 
-  static ibv_qp_init_attr DefaultQpInitAttr() {
+  ibv_qp_init_attr QpInitAttr(const MessengerOptions &opts) const {
     ibv_qp_init_attr init_attr;
     std::memset(&init_attr, 0, sizeof(init_attr));
-    init_attr.cap.max_send_wr = init_attr.cap.max_recv_wr = kMaxWr;
+    init_attr.cap.max_send_wr = std::max<uint32_t>(kMaxWr, opts.send_depth);
+    init_attr.cap.max_recv_wr = std::max<uint32_t>(kMaxWr, opts.recv_slots);
+    if (shared_ != nullptr) {
+      init_attr.srq = shared_->srq();
+      init_attr.recv_cq = shared_->cq();
+      init_attr.cap.max_recv_wr = 0;
+    }
     init_attr.cap.max_send_sge = init_attr.cap.max_recv_sge = kMaxSge;
     init_attr.cap.max_inline_data = kMaxInlineData;
     init_attr.sq_sig_all = 0; // Must request completions.
@@ -797,6 +1491,16 @@ private:
     return init_attr;
   }
 
+  /// A Connection to `peer_id` over `id`, sized for that peer, and
+  /// dispatched by the SharedReceiver if there is one
+  Connection *NewConnection(uint32_t peer_id, rdma_cm_id *id) {
+    auto *conn = new Connection(my_id_, peer_id, id, messenger_options(peer_id),
+                                shared_ ? shared_->slots() : nullptr);
+    if (shared_ != nullptr)
+      shared_->Add(conn);
+    return conn;
+  }
+
   static ibv_qp_attr DefaultQpAttr() {
     ibv_qp_attr attr;
     std::memset(&attr, 0, sizeof(attr));
@@ -804,12 +1508,14 @@ private:
                            IBV_ACCESS_REMOTE_WRITE | IBV_ACCESS_REMOTE_ATOMIC;
     attr.max_dest_rd_atomic = 8;
     attr.path_mtu = IBV_MTU_4096;
+    // A SEND that finds no receive posted is NAKed and retried after this
+    // (about 0.6ms), so the senders' windows should fit in the receives
     attr.min_rnr_timer = 12;
     attr.rq_psn = 0;
     attr.sq_psn = 0;
     attr.timeout = 12;
     attr.retry_cnt = 7;
-    attr.rnr_retry = 1;
+    attr.rnr_retry = 7; // Retry forever
     attr.max_rd_atomic = 8;
     return attr;
   }
@@ -858,13 +1564,15 @@ private:
     ROME_TRACE("Loopback: IBV_QPS_RTS");
     RDMA_CM_CHECK_TOVAL(ibv_modify_qp, id->qp, &attr, attr_mask);
 
-    RDMA_CM_CHECK_TOVAL(fcntl, id->recv_cq->channel->fd, F_SETFL,
-                        fcntl(id->recv_cq->channel->fd, F_GETFL) | O_NONBLOCK);
+    if (shared_ == nullptr)
+      RDMA_CM_CHECK_TOVAL(fcntl, id->recv_cq->channel->fd, F_SETFL,
+                          fcntl(id->recv_cq->channel->fd, F_GETFL) |
+                              O_NONBLOCK);
     RDMA_CM_CHECK_TOVAL(fcntl, id->send_cq->channel->fd, F_SETFL,
                         fcntl(id->send_cq->channel->fd, F_GETFL) | O_NONBLOCK);
 
     // Allocate a new control channel to be used with this connection
-    auto it = established_.emplace(my_id_, new Connection(my_id_, my_id_, id));
+    auto it = established_.emplace(my_id_, NewConnection(my_id_, id));
     ROME_ASSERT(it.second, "Unexepected error");
     Release();
     // TODO: isn't it racy to access established_ after releasing the lock?
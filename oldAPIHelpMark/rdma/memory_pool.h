@@ -472,16 +472,30 @@ public:
       RETURN_STATUS_ON_ERROR(status);
     }
 
-    // Get all peers' memory regions
+    // Get all peers' memory regions.  Connections that receive through a
+    // SharedReceiver can't Deliver() on their own, so take them from it.
+    auto *shared = connection_manager_->shared_receiver();
+    std::unordered_map<uint32_t, RemoteObjectProto> regions;
+    while (shared != nullptr && regions.size() < peers.size()) {
+      auto got = shared->template TryReceive<RemoteObjectProto>();
+      if (got.has_value())
+        regions.emplace(got->first, got->second);
+    }
     for (const auto &p : peers) {
       auto conn = connection_manager_->GetConnection(p.id);
       STATUSVAL_OR_DIE(conn);
-      auto got =
-          conn.val.value()->channel()->template Deliver<RemoteObjectProto>();
-      RETURN_STATUSVAL_ON_ERROR(got);
+      RemoteObjectProto region;
+      if (shared != nullptr) {
+        region = regions[p.id];
+      } else {
+        auto got =
+            conn.val.value()->channel()->template Deliver<RemoteObjectProto>();
+        RETURN_STATUSVAL_ON_ERROR(got);
+        region = got.val.value();
+      }
       // [mfs] I don't understand why we use mr_->lkey?
-      conn_info_.emplace(p.id, conn_info_t{conn.val.value(),
-                                           got.val.value().rkey(), mr_->lkey});
+      conn_info_.emplace(p.id,
+                         conn_info_t{conn.val.value(), region.rkey(), mr_->lkey});
     }
 
     return {sss::Ok, {}};
@@ -17,10 +17,17 @@ class rdma_capability {
   internal::MemoryPool<internal::ConnectionManager> pool;
 
 public:
-  explicit rdma_capability(const Peer &self)
+  /// @param opts    How every two-sided channel is sized
+  /// @param shared  If `shared.slots` is set, every connection receives
+  ///                through one SRQ and CQ (see shared_receiver())
+  explicit rdma_capability(
+      const Peer &self,
+      internal::MessengerOptions opts = internal::MessengerOptions(),
+      internal::SharedReceiverOptions shared = {})
       : //    cm(my_id),
         pool(self, std::unique_ptr<internal::ConnectionManager>(
-                       new internal::ConnectionManager((self.id)))) {}
+                       new internal::ConnectionManager(self.id, opts,
+                                                       shared))) {}
 
   // TODO: Why can't we merge this into the constructor?
   //
@@ -95,6 +102,21 @@ public:
     return got;
   }
 
+  /// Where every peer's messages arrive, if the capability was built with
+  /// SharedReceiverOptions (else null).  Recv() and TryRecv() don't work
+  /// then; poll this instead.  Valid after init_pool().
+  internal::SharedReceiver *shared_receiver() {
+    return pool.connection_manager()->shared_receiver();
+  }
+
+  /// Like Recv, but returns right away if nothing has arrived from `from`
+  template <class T> std::optional<T> TryRecv(const Peer &from) {
+    auto conn_or = pool.connection_manager()->GetConnection(from.id);
+    if (conn_or.status.t != sss::Ok)
+      return {};
+    return conn_or.val.value()->channel()->template TryReceive<T>();
+  }
+
   /// [el] Register a thread means allocating resources to that specific thread that allows them to synchronize with each other
   void RegisterThread(){
     pool.RegisterThread();
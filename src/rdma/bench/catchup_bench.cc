@@ -0,0 +1,209 @@
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/event_loop.h"
+#include "../rabia/local_cluster.h"
+#include "../rabia/sim_network.h"
+#include "../rabia/timer_wheel.h"
+#include "../rabia/weak_mvc.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::I64_ARG_OPT("--latency_us", "One-way link latency", 50),
+    sss::I64_ARG_OPT("--window", "How many slots each replica runs at once",
+                     8),
+    sss::I64_ARG_OPT("--outstanding",
+                     "How many objects each live replica keeps in flight", 16),
+    sss::I64_ARG_OPT("--batch", "How many commands per object", 16),
+    sss::I64_ARG_OPT("--down_slots",
+                     "How many slots the cluster decides while the last "
+                     "replica is down",
+                     3000),
+    sss::I64_ARG_OPT("--catchup_batch", "The most slots one catch-up request "
+                     "asks for",
+                     4096),
+    sss::I64_ARG_OPT("--catchup_chunk",
+                     "The most catch-up replies a replica sends a peer per "
+                     "poll",
+                     64),
+    sss::I64_ARG_OPT("--tick_ns",
+                     "Simulated CPU time of an event-loop tick that did work",
+                     1000),
+    sss::I64_ARG_OPT("--max_ms", "Give up on catching up after this much "
+                     "simulated time",
+                     2000),
+};
+
+/// Take the last replica of a Weak-MVC cluster on a SimNetwork down while the
+/// rest decide --down_slots slots, then restart it with nothing, and measure
+/// how long it takes to catch up to where the cluster was when it restarted.
+/// The live replicas keep their load running all along.
+///
+/// With --catchup_batch 1, each request fetches one slot, which is what
+/// fetching missed proposals one at a time would do; the default fetches the
+/// whole gap in one request and streams it back in --catchup_chunk pieces.
+/// Runs as sim_bench does, so the simulated times are repeatable.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") < 3 || args.iget("--window") <= 0 ||
+      args.iget("--outstanding") <= 0 || args.iget("--batch") <= 0 ||
+      args.iget("--down_slots") <= 0 || args.iget("--catchup_batch") <= 0 ||
+      args.iget("--catchup_chunk") <= 0 || args.iget("--max_ms") <= 0) {
+    ROME_ERROR("There must be at least 3 replicas, and every count must be "
+               "positive");
+    exit(1);
+  }
+
+  using namespace std::chrono;
+  using Mvc = rabia::WeakMvc<rabia::SimNetwork::Endpoint>;
+  const uint32_t n = args.iget("--replicas");
+  const uint32_t down = n - 1;
+  rabia::SimNetworkOptions net_opts;
+  net_opts.nodes = n;
+  net_opts.link.latency = microseconds(args.iget("--latency_us"));
+  rabia::SimNetwork net(net_opts);
+
+  struct Replica {
+    rabia::SimNetwork::Endpoint ep;
+    std::unique_ptr<Mvc> mvc;
+    rabia::TimerWheel timers; // On the simulated clock
+    rabia::EventLoop loop;
+    uint32_t next_proseq = 1;
+    uint32_t in_flight = 0;
+    std::vector<uint64_t> log; // ProposalKey of every decided slot
+
+    explicit Replica(rabia::SimNetwork::Endpoint e) : ep(e) {}
+  };
+  std::vector<std::unique_ptr<Replica>> replicas;
+  for (uint32_t i = 0; i < n; ++i)
+    replicas.push_back(std::make_unique<Replica>(net.endpoint(i)));
+
+  auto start = [&](uint32_t i) {
+    Replica &r = *replicas[i];
+    const Mvc::Options mvc_opts{
+        .window = uint32_t(args.iget("--window")),
+        .catchup_batch = uint32_t(args.iget("--catchup_batch")),
+        .catchup_chunk = uint32_t(args.iget("--catchup_chunk")),
+        .timers = &r.timers};
+    r.mvc = std::make_unique<Mvc>(
+        &r.ep,
+        [&, i](uint32_t, const message::ConsensusObj &obj) {
+          Replica &r = *replicas[i];
+          r.log.push_back(obj.isnull() ? 0 : rabia::ProposalKey(obj));
+          if (!obj.isnull() && obj.proid() == i)
+            --r.in_flight;
+        },
+        mvc_opts);
+  };
+
+  const uint32_t batch = args.iget("--batch");
+  for (uint32_t i = 0; i < n; ++i) {
+    start(i);
+    Replica &r = *replicas[i];
+    r.loop.AddPoller([&net, &r]() { return r.timers.Advance(net.now()); });
+    r.loop.AddPoller([&r]() { return r.mvc->Poll(); });
+    if (i == down)
+      continue; // It only catches up
+    r.loop.AddPoller([&, i]() {
+      Replica &r = *replicas[i];
+      int work = 0;
+      while (r.in_flight < args.iget("--outstanding")) {
+        message::ConsensusObj obj;
+        obj.set_proid(i);
+        obj.set_proseq(r.next_proseq);
+        for (uint32_t c = 0; c < batch; ++c) {
+          obj.add_cliids(c);
+          obj.add_cliseqs(r.next_proseq);
+          obj.add_commands(rabia::MakeWriteCommand(c, r.next_proseq));
+        }
+        ++r.next_proseq;
+        r.mvc->Submit(obj);
+        ++r.in_flight;
+        ++work;
+      }
+      return work;
+    });
+  }
+
+  // Run the first `live` replicas until `done()`, or until --max_ms.  What is
+  // sent to the others is lost, as it would be with a crashed replica.
+  const uint64_t tick = args.iget("--tick_ns");
+  const uint64_t max_ns =
+      duration_cast<nanoseconds>(milliseconds(args.iget("--max_ms"))).count();
+  auto run = [&](uint32_t live, auto done) {
+    const uint64_t give_up = net.now() + max_ns;
+    while (!done() && net.now() < give_up) {
+      int work = 0;
+      for (uint32_t i = 0; i < live; ++i)
+        work += replicas[i]->loop.RunOnce();
+      for (uint32_t i = live; i < n; ++i)
+        for (uint32_t peer = 0; peer < n; ++peer)
+          while (peer != i && replicas[i]->ep.TryReceive(peer).has_value()) {
+          }
+      if (work > 0) {
+        net.Advance(tick);
+        continue;
+      }
+      auto next = net.NextArrival();
+      if (!next.has_value())
+        return false;
+      net.AdvanceTo(next.value());
+    }
+    return done();
+  };
+
+  const uint32_t down_slots = args.iget("--down_slots");
+  if (!run(down,
+           [&]() { return replicas[0]->mvc->next_slot() >= down_slots; })) {
+    ROME_ERROR("The live replicas didn't decide {} slots", down_slots);
+    exit(1);
+  }
+
+  // Restart the last replica with no state
+  Replica &late = *replicas[down];
+  start(down);
+  const uint32_t target = replicas[0]->mvc->next_slot();
+  const uint64_t restart = net.now();
+  const uint64_t sent = net.num_sent();
+  auto wall = steady_clock::now();
+  bool ok = run(n, [&]() { return late.mvc->next_slot() >= target; });
+  duration<double, std::milli> wall_ms = steady_clock::now() - wall;
+  double sim_ms = (net.now() - restart) / 1e6;
+
+  // The restarted replica must have decided what the others did
+  for (size_t s = 0; s < late.log.size() && s < replicas[0]->log.size(); ++s)
+    ROME_ASSERT(late.log[s] == replicas[0]->log[s],
+                "The restarted replica disagrees about slot {}", s);
+  if (!ok) {
+    ROME_ERROR("Caught up {} of {} slots in {:.1f} ms ({} requests)",
+               late.mvc->next_slot(), target, sim_ms,
+               late.mvc->num_catchup_requests());
+    exit(1);
+  }
+  ROME_INFO("Caught up {} slots in {:.2f} ms simulated ({:.1f} ms wall), "
+            "{:.0f} slots/s",
+            target, sim_ms, wall_ms.count(), target / (sim_ms / 1e3));
+  ROME_INFO("requests={}, replayed={}, messages={}, cluster_moved_on={}",
+            late.mvc->num_catchup_requests(), late.mvc->num_caught_up(),
+            net.num_sent() - sent, replicas[0]->mvc->next_slot() - target);
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdlib>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/coin.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--slots", "How many slots to flip coins for", 10000000),
+    sss::I64_ARG_OPT("--phases", "How many phases to flip in each slot", 3),
+    sss::I64_ARG_OPT("--block_slots", "Slots per precomputed block", 32768),
+    sss::I64_ARG_OPT("--blocks", "Blocks held at once", 4),
+};
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// Keeps the compiler from dropping work whose result is otherwise unused
+volatile uint64_t sink;
+
+} // namespace
+
+/// Time a coin flip three ways, walking forward through --slots slots and
+/// flipping phases 1 to --phases of each, like a replica with a contended
+/// slot in every slot would: CommonCoin() directly, a CoinTable filled by its
+/// background thread, and a CoinTable filled on first use.  Check that all
+/// three give the same coins, and report ns per flip, the tables' misses, and
+/// how fast a block fills.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--slots") <= 0 || args.iget("--phases") <= 0 ||
+      args.iget("--block_slots") <= 0 || args.iget("--blocks") <= 0) {
+    ROME_ERROR("Every count must be positive");
+    exit(1);
+  }
+
+  const uint32_t slots = args.iget("--slots");
+  const uint32_t phases = args.iget("--phases");
+  const uint64_t flips = uint64_t(slots) * phases;
+  rabia::CoinTableOptions opts{
+      .block_slots = uint32_t(args.iget("--block_slots")),
+      .blocks = uint32_t(args.iget("--blocks"))};
+
+  // Each pass folds its coins into a fingerprint, so they can be compared
+  auto start = clock_type::now();
+  uint64_t direct = 0;
+  for (uint32_t s = 0; s < slots; ++s)
+    for (uint32_t p = 1; p <= phases; ++p)
+      direct = direct * 3 + rabia::CommonCoin(opts.seed, s, p);
+  std::chrono::duration<double, std::nano> t = clock_type::now() - start;
+  sink = direct;
+  ROME_INFO("CommonCoin: {:.2f} ns/flip", t.count() / flips);
+
+  for (bool background : {true, false}) {
+    opts.background = background;
+    rabia::CoinTable table(opts);
+    start = clock_type::now();
+    uint64_t looked_up = 0;
+    for (uint32_t s = 0; s < slots; ++s)
+      for (uint32_t p = 1; p <= phases; ++p)
+        looked_up = looked_up * 3 + table.Flip(s, p);
+    t = clock_type::now() - start;
+    ROME_ASSERT(looked_up == direct, "The table's coins differ from "
+                                     "CommonCoin's");
+    ROME_INFO("CoinTable ({}): {:.2f} ns/flip, {} misses of {} flips, {} "
+              "blocks filled",
+              background ? "background" : "on first use", t.count() / flips,
+              table.num_misses(), flips, table.num_fills());
+  }
+
+  // The hot path alone: every flip finds its block already filled
+  {
+    opts.background = false;
+    rabia::CoinTable table(opts);
+    start = clock_type::now();
+    uint64_t x = 0, hits = 0;
+    while (hits < flips)
+      for (uint32_t s = 0; s < opts.block_slots; ++s, ++hits)
+        x = x * 3 + table.Flip(s, 1);
+    t = clock_type::now() - start;
+    sink = x;
+    ROME_INFO("CoinTable (hits only): {:.2f} ns/flip", t.count() / hits);
+  }
+
+  // The cost of filling a block
+  const uint32_t words = 1 << 20;
+  start = clock_type::now();
+  uint64_t x = 0;
+  for (uint32_t w = 0; w < words; ++w)
+    x ^= rabia::CommonCoinWord(opts.seed, 8 * w);
+  t = clock_type::now() - start;
+  sink = x;
+  ROME_INFO("CommonCoinWord: {:.2f} ns/slot ({:.2f} ns/coin)",
+            t.count() / words / 8, t.count() / words / 64);
+  return 0;
+}
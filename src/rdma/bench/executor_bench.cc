@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/kv_executor.h"
+#include "../rabia/local_cluster.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--slots", "How many decided slots to apply", 20000),
+    sss::I64_ARG_OPT("--commands", "How many commands per slot", 32),
+    sss::I64_ARG_OPT("--keys", "How many distinct keys the commands use",
+                     100000),
+    sss::I64_ARG_OPT("--read_pct", "The percent of commands that are reads",
+                     50),
+    sss::I64_ARG_OPT("--max_workers", "The most worker threads to try", 8),
+};
+
+/// Apply the same --slots decided objects with a KvExecutor of 0 (inline), 1,
+/// 2, 4, ... --max_workers workers, and report applied commands/sec for each.
+/// Every run must produce the same results, command for command, as the
+/// inline run; a fingerprint of them is checked to make sure.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--slots") <= 0 || args.iget("--commands") <= 0 ||
+      args.iget("--keys") <= 0 || args.iget("--max_workers") < 0 ||
+      args.iget("--read_pct") < 0 || args.iget("--read_pct") > 100) {
+    ROME_ERROR("--slots, --commands and --keys must be positive, and "
+               "--read_pct a percentage");
+    exit(1);
+  }
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<uint64_t> key(0, args.iget("--keys") - 1);
+  std::uniform_int_distribution<int64_t> pct(0, 99);
+  std::vector<message::ConsensusObj> slots(args.iget("--slots"));
+  for (uint32_t s = 0; s < slots.size(); ++s) {
+    slots[s].set_svrseq(s);
+    for (int64_t c = 0; c < args.iget("--commands"); ++c) {
+      slots[s].add_cliids(0);
+      slots[s].add_cliseqs(uint32_t(c));
+      if (pct(rng) < args.iget("--read_pct"))
+        slots[s].add_commands(rabia::MakeReadCommand(key(rng)));
+      else
+        slots[s].add_commands(rabia::MakeWriteCommand(key(rng), rng()));
+    }
+  }
+
+  std::optional<uint64_t> expected;
+  ROME_INFO("workers,cmds_per_sec");
+  for (int64_t w = 0; w <= args.iget("--max_workers"); w = w ? w * 2 : 1) {
+    uint64_t fingerprint = 0;
+    rabia::KvExecutor exec(
+        [&](uint32_t, const std::vector<rabia::KvResult> &results) {
+          for (auto &r : results)
+            fingerprint = fingerprint * 31 + (r.found ? r.value + 1 : 0);
+        },
+        {.workers = uint32_t(w)});
+    auto start = std::chrono::steady_clock::now();
+    for (auto &obj : slots) {
+      exec.Submit(obj.svrseq(), obj);
+      exec.Poll();
+    }
+    while (exec.num_slots() < slots.size())
+      exec.Poll();
+    std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+    ROME_INFO("{},{:.0f}", w, exec.num_applied() / t.count());
+    if (!expected.has_value())
+      expected = fingerprint;
+    ROME_ASSERT(fingerprint == expected.value(),
+                "{} workers computed different results", w);
+  }
+  return 0;
+}
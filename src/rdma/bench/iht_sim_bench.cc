@@ -0,0 +1,108 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <iht/rpc.h>
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/sim_network.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--nodes", "How many nodes to partition the keys over",
+                     2),
+    sss::I64_ARG_OPT("--ops", "How many keys each node inserts, reads and "
+                              "removes",
+                     2000),
+    sss::I64_ARG_OPT("--latency_us", "One-way link latency", 5),
+    sss::I64_ARG_OPT("--jitter_us", "Extra latency, drawn uniformly", 0),
+};
+
+using Conn = rabia::SimNetwork::Connection;
+
+/// Run TwoSidedIHT on a realtime SimNetwork, one node per thread.  Every node
+/// at once inserts, reads, removes and reads again its own keys, which are
+/// spread over the whole key range, so most operations go to a peer while
+/// the peer's client is doing the same to it.  Requests travel on channel 0
+/// (`receiver_map`) and responses on channel 1 (`sender_map`), so no server
+/// thread can take a response meant for its own node's client.  Any
+/// operation whose result isn't what a single map would return is counted
+/// as a mismatch.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--nodes") < 2 || args.iget("--ops") <= 0) {
+    ROME_ERROR("Need at least 2 nodes and 1 op");
+    exit(1);
+  }
+
+  using namespace std::chrono;
+  const int n = args.iget("--nodes");
+  const int ops = args.iget("--ops");
+  const int key_ub = n * ops - 1;
+  rabia::SimNetworkOptions net_opts;
+  net_opts.nodes = n;
+  net_opts.channels = 2;
+  net_opts.realtime = true;
+  net_opts.link.latency = microseconds(args.iget("--latency_us"));
+  net_opts.link.jitter = microseconds(args.iget("--jitter_us"));
+  rabia::SimNetwork net(net_opts);
+
+  std::vector<std::unique_ptr<Conn>> conns;
+  std::vector<std::unique_ptr<TwoSidedIHT<Conn>>> nodes;
+  for (int i = 0; i < n; ++i) {
+    std::unordered_map<int, Conn *> senders, receivers;
+    for (int p = 0; p < n; ++p) {
+      if (p == i)
+        continue;
+      receivers[p] = conns.emplace_back(net.connection(i, p, 0)).get();
+      senders[p] = conns.emplace_back(net.connection(i, p, 1)).get();
+    }
+    nodes.push_back(std::make_unique<TwoSidedIHT<Conn>>(i, n, 0, key_ub,
+                                                        senders, receivers));
+  }
+
+  std::atomic<uint64_t> mismatches = 0;
+  std::vector<std::thread> clients;
+  auto start = steady_clock::now();
+  for (int i = 0; i < n; ++i) {
+    clients.emplace_back([&, i]() {
+      TwoSidedIHT<Conn> &iht = *nodes[i];
+      uint64_t bad = 0;
+      for (int j = 0; j < ops; ++j) {
+        const int key = j * n + i;
+        bad += iht.insert(key, key).has_value();
+        bad += iht.get(key) != std::optional<int>(key);
+        bad += iht.remove(key) != std::optional<int>(key);
+        bad += iht.get(key).has_value();
+      }
+      mismatches += bad;
+    });
+  }
+  for (auto &c : clients)
+    c.join();
+  duration<double> secs = steady_clock::now() - start;
+  nodes.clear();
+
+  const uint64_t total = uint64_t(4) * n * ops;
+  ROME_INFO("{} ops in {:.2f}s ({:.0f} ops/s), {} messages, mismatches={}",
+            total, secs.count(), total / secs.count(), net.num_sent(),
+            mismatches.load());
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/durable_log.h"
+#include "../rabia/local_cluster.h"
+
+auto ARGS = {
+    sss::STR_ARG_OPT("--dir", "Where to put the log (it is wiped first)",
+                     "/tmp/rabia_log_bench"),
+    sss::I64_ARG_OPT("--entries", "How many entries to append per run",
+                     100000),
+    sss::I64_ARG_OPT("--commands", "How many commands per entry", 16),
+    sss::I64_ARG_OPT("--max_group", "The largest group commit to try", 1024),
+    sss::I64_ARG_OPT("--segment_mb", "The size of each log segment", 64),
+};
+
+/// Append --entries decided objects to a DurableLog for each group-commit
+/// size 1, 4, 16, ... --max_group (entries per sync), and report appended
+/// entries/sec and syncs.  Then reopen the last log and time its recovery
+/// scan.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--entries") <= 0 || args.iget("--commands") < 0 ||
+      args.iget("--max_group") <= 0 || args.iget("--segment_mb") <= 0) {
+    ROME_ERROR("--entries, --max_group and --segment_mb must be positive");
+    exit(1);
+  }
+
+  message::ConsensusObj obj;
+  obj.set_proid(1);
+  for (int64_t i = 0; i < args.iget("--commands"); ++i) {
+    obj.add_cliids(uint32_t(i));
+    obj.add_cliseqs(uint32_t(i));
+    obj.add_commands(rabia::MakeWriteCommand(i, i));
+  }
+
+  rabia::DurableLogOptions opts;
+  opts.dir = args.sget("--dir");
+  opts.segment_bytes = size_t(args.iget("--segment_mb")) << 20;
+  // Only the entry count triggers a sync here
+  opts.group_interval = std::chrono::hours(1);
+
+  ROME_INFO("group,entries_per_sec,syncs,us_per_sync");
+  for (int64_t g = 1; g <= args.iget("--max_group"); g *= 4) {
+    std::filesystem::remove_all(opts.dir);
+    opts.group_entries = g;
+    rabia::DurableLog log(opts);
+    OK_OR_FAIL(log.Open());
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < args.iget("--entries"); ++i) {
+      obj.set_svrseq(uint32_t(i));
+      obj.set_proseq(uint32_t(i));
+      OK_OR_FAIL(log.Append(obj));
+      log.Poll();
+    }
+    OK_OR_FAIL(log.Sync());
+    std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+    ROME_INFO("{},{:.0f},{},{:.1f}", g, args.iget("--entries") / t.count(),
+              log.num_syncs(), t.count() * 1e6 / log.num_syncs());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  rabia::DurableLog log(opts);
+  OK_OR_FAIL(log.Open());
+  uint64_t entries = 0, commands = 0;
+  log.ForEach([&](const rabia::LogEntryHeader &, const rabia::wire::View &v) {
+    ++entries;
+    commands += v.num_commands();
+  });
+  std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+  ROME_INFO("recovered {} entries ({} commands) in {:.1f} ms", entries,
+            commands, t.count() * 1e3);
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <rdma/rdma.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/rdma_mailbox.h"
+#include "../rabia/weak_mvc.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::STR_ARG_OPT("--addr",
+                     "The IP of the RDMA device (e.g. an rdma_rxe netdev)",
+                     "127.0.0.1"),
+    sss::I64_ARG_OPT("--port", "The first replica's port; the rest follow",
+                     18100),
+    sss::I64_ARG_OPT("--depth", "Slots per mailbox ring", 256),
+    sss::I64_ARG_OPT("--rounds", "How many broadcast rounds to run", 100000),
+    sss::BOOL_ARG_OPT("--two_sided",
+                      "Send everything over the two-sided channel instead"),
+    sss::I64_ARG_OPT("--signal_every",
+                     "With --two_sided, don't wait for sends to complete, "
+                     "and signal one in this many (0 waits for each)",
+                     0),
+};
+
+using rome::rdma::Peer;
+using rome::rdma::rdma_capability;
+
+/// Run `--replicas` replicas as threads of this process, each with its own
+/// rdma_capability on `--addr`, and time all-to-all State broadcasts: in round
+/// r every replica sends a State for slot r to every peer, then waits for the
+/// peers' States for slot r.  This is the message pattern of one Weak-MVC
+/// round, without the rest of the protocol.
+///
+/// To run it without an RDMA NIC, set up Soft-RoCE on any netdev, e.g.
+///
+///   sudo rdma link add rxe0 type rxe netdev eth0
+///   ./mailbox_bench --addr <eth0's IP>
+///
+/// and compare with `--two_sided`, and `--two_sided --signal_every 16`.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 1 || args.iget("--depth") < 2 ||
+      args.iget("--rounds") <= 0 || args.iget("--signal_every") < 0) {
+    ROME_ERROR("Need at least 2 replicas, a depth of 2, and 1 round");
+    exit(1);
+  }
+
+  const uint32_t n = args.iget("--replicas");
+  const uint32_t rounds = args.iget("--rounds");
+  std::vector<Peer> peers;
+  for (uint32_t i = 0; i < n; ++i)
+    peers.emplace_back(i, args.sget("--addr"), args.iget("--port") + i);
+  rabia::MailboxOptions opts{.depth = uint32_t(args.iget("--depth")),
+                             .use_mailbox = !args.bget("--two_sided"),
+                             .catchup_reads = false,
+                             .catchup = {}};
+  rome::rdma::internal::MessengerOptions channel_opts;
+  if (args.iget("--signal_every") > 0) {
+    channel_opts.async_sends = true;
+    channel_opts.signal_every = args.iget("--signal_every");
+  }
+
+  std::vector<std::unique_ptr<rome::metrics::Summary<double>>> latency;
+  for (uint32_t i = 0; i < n; ++i)
+    latency.push_back(std::make_unique<rome::metrics::Summary<double>>(
+        "round_latency", "us", 10000));
+  std::vector<double> rate(n);
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n; ++i) {
+    threads.emplace_back([&, i]() {
+      std::vector<Peer> others;
+      for (auto &p : peers)
+        if (p.id != i)
+          others.push_back(p);
+      auto pool = std::make_shared<rdma_capability>(peers[i], channel_opts);
+      pool->init_pool(1 << 24, others);
+      pool->RegisterThread();
+      rabia::RdmaMailboxTransport net(pool, i, peers, opts);
+      OK_OR_FAIL(net.Init());
+
+      // A peer can be at most one round ahead, since it needs this replica's
+      // State to finish the round this replica is in.
+      uint32_t got[2] = {0, 0};
+      message::Msg state;
+      state.set_type(message::State);
+      state.set_phase(1);
+      state.set_value(rabia::kOne);
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t r = 0; r < rounds; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        state.mutable_obj()->set_svrseq(r);
+        for (uint32_t p = 0; p < n; ++p)
+          if (p != i)
+            OK_OR_FAIL(net.Send(p, state));
+        while (got[r % 2] < n - 1) {
+          for (uint32_t p = 0; p < n; ++p) {
+            if (p == i)
+              continue;
+            auto m = net.TryReceive(p);
+            if (m.has_value())
+              ++got[m->obj().svrseq() % 2];
+          }
+        }
+        got[r % 2] = 0;
+        std::chrono::duration<double, std::micro> lat =
+            std::chrono::steady_clock::now() - t0;
+        *latency[i] << lat.count();
+      }
+      std::chrono::duration<double> t =
+          std::chrono::steady_clock::now() - start;
+      rate[i] = rounds / t.count();
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  for (uint32_t i = 0; i < n; ++i) {
+    ROME_INFO("replica {}: {:.0f} rounds/s", i, rate[i]);
+    ROME_INFO("replica {}: {}", i, latency[i]->ToString());
+  }
+  return 0;
+}
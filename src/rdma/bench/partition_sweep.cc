@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdlib>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/local_cluster.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::I64_ARG_OPT("--max_partitions", "The most partitions to try", 8),
+    sss::I64_ARG_OPT("--outstanding",
+                     "How many closed-loop clients each replica serves", 16),
+    sss::I64_ARG_OPT("--pipeline", "How many commands each client keeps in "
+                     "flight", 4),
+    sss::I64_ARG_OPT("--batch", "The most commands per object", 8),
+    sss::I64_ARG_OPT("--window", "How many slots each instance runs at once",
+                     8),
+    sss::BOOL_ARG_OPT("--pin", "Pin each instance's thread to its own core"),
+    sss::I64_ARG_OPT("--runtime_ms", "How long to run each point for", 1000),
+};
+
+/// Sweep the partitions per replica over powers of two, from 1 to
+/// --max_partitions, with the same client load, and report committed
+/// commands/sec and the speedup over one partition.  Each partition is an
+/// independent Weak-MVC instance on its own thread, so with a core per
+/// instance (--replicas x partitions cores, see --pin) throughput should grow
+/// close to linearly until the clients, which all run on partition 0's thread,
+/// become the bottleneck.
+///
+/// Committed commands are summed over every replica's clients.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 0 || args.iget("--max_partitions") <= 0 ||
+      args.iget("--outstanding") <= 0 || args.iget("--pipeline") <= 0 ||
+      args.iget("--batch") <= 0 || args.iget("--window") <= 0) {
+    ROME_ERROR("Every count must be positive");
+    exit(1);
+  }
+
+  ROME_INFO("partitions,committed_per_sec,speedup,decisions_per_sec,p50_us,"
+            "p99_us");
+  double base = 0;
+  for (int64_t p = 1; p <= args.iget("--max_partitions"); p *= 2) {
+    rabia::LocalCluster::Options opts;
+    opts.replicas = args.iget("--replicas");
+    opts.partitions = p;
+    opts.pin = args.bget("--pin");
+    opts.outstanding = args.iget("--outstanding");
+    opts.pipeline = args.iget("--pipeline");
+    opts.batch = args.iget("--batch");
+    opts.window = args.iget("--window");
+    opts.runtime = std::chrono::milliseconds(args.iget("--runtime_ms"));
+
+    auto results = rabia::LocalCluster(opts).Run();
+    double committed = 0, decided = 0;
+    for (auto &r : results) {
+      committed += r->committed / r->runtime_s;
+      if (r->id == 0)
+        decided += r->decisions_per_sec();
+    }
+    if (p == 1)
+      base = committed;
+    auto &r = *results[0];
+    ROME_INFO("{},{:.0f},{:.2f},{:.0f},{:.1f},{:.1f}", p, committed,
+              committed / base, decided, r.client_latency_us.Get50thPercentile(),
+              r.client_latency_us.Get99thPercentile());
+  }
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/local_cluster.h"
+#include "../rabia/pending_queue.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--entries", "How many objects stay queued", 100000),
+    sss::I64_ARG_OPT("--ops", "How many pops and removals to time", 2000000),
+    sss::I64_ARG_OPT("--remove_pct",
+                     "Percent of ops that remove an object decided elsewhere",
+                     80),
+    sss::I64_ARG_OPT("--scan_ops", "Ops for the scanning heap, which is slow",
+                     200),
+    sss::I64_ARG_OPT("--commands", "How many commands per object", 4),
+};
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+constexpr uint32_t kProxies = 5;
+
+/// Object `seq` comes from proxy seq % kProxies, with a timestamp a little out
+/// of step with `seq`, so the queue isn't simply FIFO
+uint64_t Ts(uint64_t seq) { return seq + (seq * 0x9e3779b97f4a7c15ull >> 54); }
+
+message::ConsensusObj Obj(uint32_t seq, uint32_t commands) {
+  message::ConsensusObj obj;
+  obj.set_proid(seq % kProxies);
+  obj.set_proseq(seq);
+  for (uint32_t c = 0; c < commands; ++c) {
+    obj.add_cliids(c);
+    obj.add_cliseqs(seq);
+    obj.add_commands(rabia::MakeWriteCommand(c, seq));
+  }
+  return obj;
+}
+
+/// The std::map that WeakMvc used to queue objects in
+class MapQueue {
+  std::map<std::tuple<uint64_t, uint32_t, uint32_t>, message::ConsensusObj> m_;
+
+public:
+  void Push(uint64_t ts, message::ConsensusObj obj) {
+    auto k = std::make_tuple(ts, obj.proid(), obj.proseq());
+    m_.emplace(k, std::move(obj));
+  }
+  message::ConsensusObj Pop() {
+    auto obj = std::move(m_.begin()->second);
+    m_.erase(m_.begin());
+    return obj;
+  }
+  bool Remove(uint64_t seq) {
+    return m_.erase(std::make_tuple(Ts(seq), uint32_t(seq % kProxies),
+                                    uint32_t(seq))) > 0;
+  }
+};
+
+/// A binary heap that has to scan for an object to remove it
+class ScanQueue {
+  struct Entry {
+    uint64_t ts;
+    uint32_t proid, proseq;
+    message::ConsensusObj obj;
+    bool operator<(const Entry &o) const {
+      return std::tie(o.ts, o.proid, o.proseq) < std::tie(ts, proid, proseq);
+    }
+  };
+  std::vector<Entry> h_;
+
+public:
+  void Push(uint64_t ts, message::ConsensusObj obj) {
+    h_.push_back({ts, obj.proid(), obj.proseq(), std::move(obj)});
+    std::push_heap(h_.begin(), h_.end());
+  }
+  message::ConsensusObj Pop() {
+    std::pop_heap(h_.begin(), h_.end());
+    auto obj = std::move(h_.back().obj);
+    h_.pop_back();
+    return obj;
+  }
+  bool Remove(uint64_t seq) {
+    auto it = std::find_if(h_.begin(), h_.end(), [&](const Entry &e) {
+      return e.proseq == seq && e.proid == seq % kProxies;
+    });
+    if (it == h_.end())
+      return false;
+    *it = std::move(h_.back());
+    h_.pop_back();
+    std::make_heap(h_.begin(), h_.end());
+    return true;
+  }
+};
+
+/// Adapts PendingQueue to the others' Remove(seq)
+class HeapQueue {
+  rabia::PendingQueue q_;
+
+public:
+  void Push(uint64_t ts, message::ConsensusObj obj) {
+    q_.Push(ts, std::move(obj));
+  }
+  message::ConsensusObj Pop() { return q_.Pop(); }
+  bool Remove(uint64_t seq) {
+    return q_.Remove((uint64_t(seq % kProxies) << 32) | uint32_t(seq));
+  }
+};
+
+/// Fill `q` with `entries` objects, then run `ops` ops on it: each one either
+/// removes a random recent object, as if it was decided through a peer's
+/// proposal, or pops the head.  Each object that leaves is replaced by a new
+/// one, so the queue stays full.  Every queue gets the same ops.
+///
+/// @return ns per op, and a checksum of the popped objects
+template <class Q>
+std::pair<double, uint64_t> Run(Q &q, uint32_t entries, uint64_t ops,
+                                uint32_t remove_pct, uint32_t commands) {
+  uint32_t next = 0;
+  for (; next < entries; ++next)
+    q.Push(Ts(next), Obj(next, commands));
+  std::mt19937_64 rng(7);
+  uint64_t sum = 0;
+  auto start = clock_type::now();
+  for (uint64_t i = 0; i < ops; ++i) {
+    if (rng() % 100 < remove_pct) {
+      if (!q.Remove(next - 1 - rng() % entries))
+        continue;
+    } else {
+      sum = sum * 31 + q.Pop().proseq();
+    }
+    q.Push(Ts(next), Obj(next, commands));
+    ++next;
+  }
+  std::chrono::duration<double, std::nano> t = clock_type::now() - start;
+  return {t.count() / ops, sum};
+}
+
+} // namespace
+
+/// Compare PendingQueue with the std::map that WeakMvc queued objects in
+/// before it, and with a binary heap that removes by scanning, under a steady
+/// --entries objects and a mix of pops and removals of objects decided
+/// elsewhere.  The ns per op includes building each new object, which is the
+/// same for all three.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--entries") <= 0 || args.iget("--ops") <= 0 ||
+      args.iget("--scan_ops") < 0 || args.iget("--commands") < 0 ||
+      args.iget("--remove_pct") < 0 || args.iget("--remove_pct") > 100) {
+    ROME_ERROR("Counts must be positive, and --remove_pct a percentage");
+    exit(1);
+  }
+  const uint32_t entries = args.iget("--entries");
+  const uint64_t ops = args.iget("--ops");
+  const uint32_t remove_pct = args.iget("--remove_pct");
+  const uint32_t commands = args.iget("--commands");
+
+  HeapQueue heap;
+  auto [heap_ns, heap_sum] = Run(heap, entries, ops, remove_pct, commands);
+  ROME_INFO("PendingQueue: {:.1f} ns/op", heap_ns);
+  MapQueue map;
+  auto [map_ns, map_sum] = Run(map, entries, ops, remove_pct, commands);
+  ROME_INFO("std::map: {:.1f} ns/op", map_ns);
+  ROME_ASSERT(heap_sum == map_sum, "The queues popped different objects");
+
+  if (args.iget("--scan_ops") > 0) {
+    ScanQueue scan;
+    auto [scan_ns, scan_sum] =
+        Run(scan, entries, args.iget("--scan_ops"), remove_pct, commands);
+    ROME_INFO("binary heap with scanning removal: {:.1f} ns/op", scan_ns);
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <rdma/peer.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/shm_transport.h"
+#include "../rabia/tcp_transport.h"
+#include "../rabia/weak_mvc.h"
+
+auto ARGS = {
+    sss::STR_ARG_OPT("--addr",
+                     "Both nodes' address; a local one picks shared memory",
+                     "127.0.0.1"),
+    sss::I64_ARG_OPT("--port", "The first node's port; the second follows",
+                     18300),
+    sss::I64_ARG_OPT("--rounds", "How many round trips to time", 200000),
+    sss::BOOL_ARG_OPT("--wait",
+                      "Sleep on the doorbell futex between messages instead "
+                      "of spinning"),
+    sss::BOOL_ARG_OPT("--tcp",
+                      "Don't use shared memory: go through the TcpTransport"),
+};
+
+using rome::rdma::Peer;
+using Transport = rabia::ShmTransport<rabia::TcpTransport>;
+
+namespace {
+
+/// The next message from `from`, spinning or sleeping on the doorbell
+message::Msg Next(Transport &net, uint32_t from, bool wait) {
+  while (true) {
+    auto m = net.TryReceive(from);
+    if (m.has_value())
+      return m.value();
+    if (wait && net.local(from))
+      net.Wait(std::chrono::microseconds(1000));
+    else
+      std::this_thread::yield();
+  }
+}
+
+} // namespace
+
+/// Ping-pong a State between two nodes, threads of this process, through a
+/// ShmTransport: node 0 sends round r and waits for node 1 to send it back.
+/// Reports the one-way latency (half the round trip).  With `--tcp` the
+/// messages go through the wrapped TcpTransport instead, for comparison.
+///
+/// NB: With fewer than two free cores, the two threads take turns on one and
+///     the spinning numbers measure the scheduler rather than the rings.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--rounds") <= 0) {
+    ROME_ERROR("Need at least 1 round");
+    exit(1);
+  }
+
+  const uint32_t rounds = args.iget("--rounds");
+  const bool wait = args.bget("--wait");
+  std::vector<Peer> peers;
+  for (uint32_t i = 0; i < 2; ++i)
+    peers.emplace_back(i, args.sget("--addr"), args.iget("--port") + i);
+
+  rome::metrics::Summary<double> latency("one_way_latency", "ns", 10000);
+  bool shm = false, huge = false;
+  std::atomic<uint32_t> done(0);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < 2; ++i) {
+    threads.emplace_back([&, i]() {
+      rabia::TcpTransport tcp(i, peers);
+      OK_OR_FAIL(tcp.Init());
+      Transport net(&tcp, peers, {.enable = !args.bget("--tcp")});
+      OK_OR_FAIL(net.Init());
+      message::Msg state;
+      state.set_type(message::State);
+      state.set_phase(1);
+      state.set_value(rabia::kOne);
+      for (uint32_t r = 0; r < rounds; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        state.mutable_obj()->set_svrseq(r);
+        if (i == 0) {
+          OK_OR_FAIL(net.Send(1, state));
+          auto m = Next(net, 1, wait);
+          ROME_ASSERT(m.obj().svrseq() == r, "Round {} got {}", r,
+                      m.obj().svrseq());
+          std::chrono::duration<double, std::nano> rtt =
+              std::chrono::steady_clock::now() - t0;
+          latency << rtt.count() / 2;
+        } else {
+          OK_OR_FAIL(net.Send(0, Next(net, 0, wait)));
+        }
+      }
+      if (i == 0) {
+        shm = net.local(1);
+        huge = net.hugepages();
+      }
+      // Keep the sockets open until both are done
+      done.fetch_add(1);
+      while (done.load() < 2)
+        std::this_thread::yield();
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  ROME_INFO("{}, {}",
+            !shm ? "TCP" : huge ? "shared memory (hugepages)"
+                                : "shared memory (4 KiB pages)",
+            wait ? "futex wakeup" : "spinning");
+  ROME_INFO("{}", latency.ToString());
+  return 0;
+}
@@ -0,0 +1,245 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/coalescer.h"
+#include "../rabia/coin.h"
+#include "../rabia/event_loop.h"
+#include "../rabia/local_cluster.h"
+#include "../rabia/sim_network.h"
+#include "../rabia/weak_mvc.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 5),
+    sss::I64_ARG_OPT("--seed", "Seeds the network's random draws", 1),
+    sss::I64_ARG_OPT("--latency_us", "One-way link latency", 50),
+    sss::I64_ARG_OPT("--jitter_us", "Extra latency, drawn uniformly", 10),
+    sss::I64_ARG_OPT("--loss_pct", "Percent of messages lost (and resent)",
+                     0),
+    sss::I64_ARG_OPT("--retransmit_us", "When a lost message is resent", 200),
+    sss::I64_ARG_OPT("--reorder_pct", "Percent of messages held back", 0),
+    sss::I64_ARG_OPT("--reorder_us", "How long they are held back", 20),
+    sss::I64_ARG_OPT("--window", "How many slots each replica runs at once",
+                     4),
+    sss::I64_ARG_OPT("--outstanding",
+                     "How many objects each replica keeps in flight", 8),
+    sss::I64_ARG_OPT("--batch", "How many commands per object", 16),
+    sss::I64_ARG_OPT("--tick_ns",
+                     "Simulated CPU time of an event-loop tick that did work",
+                     1000),
+    sss::I64_ARG_OPT("--runtime_ms", "How much simulated time to run", 1000),
+    sss::BOOL_ARG_OPT("--coin_table",
+                      "Look coin flips up in a precomputed CoinTable"),
+    sss::BOOL_ARG_OPT("--coalesce",
+                      "Pack each tick's messages to a peer into one Batch"),
+};
+
+/// An FNV-1a digest of a decided object: its ProposalKey, then each command's
+/// length and bytes.  So the fingerprint, and the check that replicas agree,
+/// cover the commands and not just which object was decided.  NULL is 0.
+uint64_t Digest(const message::ConsensusObj &obj) {
+  if (obj.isnull())
+    return 0;
+  uint64_t h = 14695981039346656037ull;
+  auto mix = [&h](const void *p, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+      h = (h ^ static_cast<const uint8_t *>(p)[i]) * 1099511628211ull;
+  };
+  const uint64_t key = rabia::ProposalKey(obj);
+  mix(&key, sizeof(key));
+  for (const std::string &cmd : obj.commands()) {
+    const uint64_t len = cmd.size();
+    mix(&len, sizeof(len));
+    mix(cmd.data(), cmd.size());
+  }
+  return h;
+}
+
+/// Run a Weak-MVC cluster on a SimNetwork, from one thread, in simulated time.
+/// Every replica keeps --outstanding objects of --batch commands in flight,
+/// and submits a new one whenever one of its own is decided.
+///
+/// Each round runs one EventLoop tick per replica, in id order.  If any of
+/// them did work, the clock moves --tick_ns (a crude model of CPU time);
+/// otherwise it jumps to the next message arrival.  Nothing depends on the
+/// wall clock, so a run is a function of its flags alone: the log
+/// fingerprint it prints is the same on every machine, and can be tracked
+/// for regressions along with the throughput, latency and conflict figures.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 0 || args.iget("--window") <= 0 ||
+      args.iget("--outstanding") <= 0 || args.iget("--batch") <= 0 ||
+      args.iget("--runtime_ms") <= 0) {
+    ROME_ERROR("--replicas, --window, --outstanding, --batch and --runtime_ms "
+               "must be positive");
+    exit(1);
+  }
+
+  using namespace std::chrono;
+  const uint32_t n = args.iget("--replicas");
+  rabia::SimNetworkOptions net_opts;
+  net_opts.nodes = n;
+  net_opts.seed = args.iget("--seed");
+  net_opts.link.latency = microseconds(args.iget("--latency_us"));
+  net_opts.link.jitter = microseconds(args.iget("--jitter_us"));
+  net_opts.link.loss = args.iget("--loss_pct") / 100.0;
+  net_opts.link.retransmit = microseconds(args.iget("--retransmit_us"));
+  net_opts.link.reorder = args.iget("--reorder_pct") / 100.0;
+  net_opts.link.reorder_delay = microseconds(args.iget("--reorder_us"));
+  rabia::SimNetwork net(net_opts);
+
+  using Link = rabia::Coalescer<rabia::SimNetwork::Endpoint>;
+  using Mvc = rabia::WeakMvc<Link>;
+  const Link::Options link_opts{
+      .max_bytes = args.bget("--coalesce") ? Link::Options().max_bytes : 0};
+  struct Replica {
+    rabia::SimNetwork::Endpoint ep;
+    Link link; // Passes messages straight through without --coalesce
+    std::unique_ptr<Mvc> mvc;
+    rabia::EventLoop loop;
+    uint32_t next_proseq = 1;
+    uint32_t in_flight = 0;
+    std::unordered_map<uint32_t, uint64_t> submitted; // ProSeq -> time
+    std::vector<uint64_t> log; // Digest() of every decided slot
+    uint64_t committed = 0;    // Commands in this replica's decided objects
+
+    Replica(rabia::SimNetwork::Endpoint e, Link::Options opts)
+        : ep(e), link(&ep, opts) {}
+  };
+  // One table for every replica; filled on first use, since this thread is
+  // the only one that flips
+  std::unique_ptr<rabia::CoinTable> table;
+  if (args.bget("--coin_table"))
+    table = std::make_unique<rabia::CoinTable>(
+        rabia::CoinTableOptions{.background = false});
+  rome::metrics::Summary<double> latency_us("commit_latency", "us", 10000);
+  std::vector<std::unique_ptr<Replica>> replicas;
+  for (uint32_t i = 0; i < n; ++i)
+    replicas.push_back(std::make_unique<Replica>(net.endpoint(i), link_opts));
+
+  const uint32_t batch = args.iget("--batch");
+  for (uint32_t i = 0; i < n; ++i) {
+    Replica &r = *replicas[i];
+    r.mvc = std::make_unique<Mvc>(
+        &r.link,
+        [&, i](uint32_t, const message::ConsensusObj &obj) {
+          Replica &r = *replicas[i];
+          r.log.push_back(Digest(obj));
+          if (obj.isnull() || obj.proid() != i)
+            return;
+          auto it = r.submitted.find(obj.proseq());
+          latency_us << (net.now() - it->second) / 1e3;
+          r.submitted.erase(it);
+          r.committed += obj.commands_size();
+          --r.in_flight;
+        },
+        Mvc::Options{.window = uint32_t(args.iget("--window")),
+                     .coins = table.get()});
+    r.loop.AddPoller([&r]() { return r.mvc->Poll(); });
+    r.loop.AddPoller([&, i]() {
+      Replica &r = *replicas[i];
+      int work = 0;
+      while (r.in_flight < args.iget("--outstanding")) {
+        message::ConsensusObj obj;
+        obj.set_proid(i);
+        obj.set_proseq(r.next_proseq);
+        for (uint32_t c = 0; c < batch; ++c) {
+          obj.add_cliids(c);
+          obj.add_cliseqs(r.next_proseq);
+          obj.add_commands(rabia::MakeWriteCommand(c, r.next_proseq));
+        }
+        r.submitted[r.next_proseq++] = net.now();
+        r.mvc->Submit(obj);
+        ++r.in_flight;
+        ++work;
+      }
+      return work;
+    });
+    r.loop.AddPoller([&r]() { return r.link.Flush(); });
+  }
+
+  const uint64_t end = duration_cast<nanoseconds>(
+                           milliseconds(args.iget("--runtime_ms")))
+                           .count();
+  const uint64_t tick = args.iget("--tick_ns");
+  auto wall = steady_clock::now();
+  while (net.now() < end) {
+    int work = 0;
+    for (auto &r : replicas)
+      work += r->loop.RunOnce();
+    if (work > 0) {
+      net.Advance(tick);
+      continue;
+    }
+    auto next = net.NextArrival();
+    if (!next.has_value()) {
+      ROME_WARN("Nothing left to do at {} ns", net.now());
+      break;
+    }
+    net.AdvanceTo(next.value());
+  }
+  duration<double> wall_s = steady_clock::now() - wall;
+
+  // Every replica must have decided the same prefix
+  size_t common = replicas[0]->log.size();
+  for (auto &r : replicas)
+    common = std::min(common, r->log.size());
+  for (auto &r : replicas)
+    for (size_t s = 0; s < common; ++s)
+      ROME_ASSERT(r->log[s] == replicas[0]->log[s],
+                  "Replicas disagree about slot {}", s);
+  uint64_t fingerprint = 0;
+  for (size_t s = 0; s < common; ++s)
+    fingerprint = fingerprint * 1099511628211ull + replicas[0]->log[s];
+
+  double sim_s = net.now() / 1e9;
+  uint64_t committed = 0, decided = 0, null = 0, phases = 0, coins = 0;
+  uint64_t batches = 0, packed = 0;
+  for (auto &r : replicas) {
+    batches += r->link.num_batches();
+    packed += r->link.num_packed();
+    committed += r->committed;
+    decided += r->mvc->num_decided();
+    null += r->mvc->num_null();
+    phases += r->mvc->num_extra_phases();
+    coins += r->mvc->num_coin_flips();
+  }
+  ROME_INFO("Simulated {:.3f}s in {:.2f}s of wall time", sim_s, wall_s.count());
+  ROME_INFO("slots={} ({:.0f}/s), cmds={:.0f}/s", common, common / sim_s,
+            committed / sim_s);
+  ROME_INFO("null_rate={:.4f}, extra_phases_per_slot={:.4f}, "
+            "coin_flips_per_slot={:.4f}",
+            double(null) / decided, double(phases) / decided,
+            double(coins) / decided);
+  ROME_INFO("messages={}, lost={}, reordered={}, malformed={}",
+            net.num_sent(), net.num_lost(), net.num_reordered(),
+            net.num_malformed());
+  if (batches > 0)
+    ROME_INFO("batches={}, messages_per_batch={:.2f}", batches,
+              double(packed) / batches);
+  ROME_INFO("{}", latency_us.ToString());
+  ROME_INFO("fingerprint={:016x}", fingerprint);
+  return 0;
+}
@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/durable_log.h"
+#include "../rabia/kv_executor.h"
+#include "../rabia/local_cluster.h"
+#include "../rabia/snapshot_store.h"
+
+auto ARGS = {
+    sss::STR_ARG_OPT("--dir", "Where to put the log and snapshots (wiped)",
+                     "/tmp/rabia_snapshot_bench"),
+    sss::I64_ARG_OPT("--slots", "How many decided slots to apply", 200000),
+    sss::I64_ARG_OPT("--commands", "How many writes per slot", 16),
+    sss::I64_ARG_OPT("--keys", "How many distinct keys the writes use",
+                     100000),
+    sss::I64_ARG_OPT("--workers", "KvExecutor worker threads", 2),
+    sss::I64_ARG_OPT("--snapshot_every",
+                     "Slots between snapshots (0 turns them off)", 20000),
+    sss::I64_ARG_OPT("--max_deltas", "Deltas before a full snapshot", 4),
+    sss::I64_ARG_OPT("--segment_mb", "The size of each log segment", 8),
+};
+
+/// Log and apply --slots decided slots of random writes, taking a snapshot
+/// every --snapshot_every slots and truncating the log behind it.  Report the
+/// apply rate and per-slot Submit() latency (to show that snapshots don't
+/// stall apply), and what is left on disk.  Then restart from the disk: load
+/// the snapshots, replay the rest of the log, check the state against the
+/// original, and report how long that took.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--slots") <= 0 || args.iget("--commands") <= 0 ||
+      args.iget("--keys") <= 0 || args.iget("--workers") < 0 ||
+      args.iget("--snapshot_every") < 0 || args.iget("--max_deltas") <= 0 ||
+      args.iget("--segment_mb") <= 0) {
+    ROME_ERROR("Every count must be positive");
+    exit(1);
+  }
+
+  const std::string dir = args.sget("--dir");
+  std::filesystem::remove_all(dir);
+  rabia::DurableLogOptions log_opts;
+  log_opts.dir = dir + "/log";
+  log_opts.segment_bytes = size_t(args.iget("--segment_mb")) << 20;
+  rabia::SnapshotStoreOptions snap_opts{
+      .dir = dir + "/snap", .max_deltas = uint32_t(args.iget("--max_deltas"))};
+  rabia::KvExecutorOptions exec_opts{.workers =
+                                         uint32_t(args.iget("--workers"))};
+  const uint32_t slots = args.iget("--slots");
+  const uint32_t every = args.iget("--snapshot_every");
+
+  rabia::DurableLog log(log_opts);
+  OK_OR_FAIL(log.Open());
+  rabia::SnapshotStore store(snap_opts);
+  OK_OR_FAIL(store.Open());
+  rabia::KvExecutor exec([](uint32_t, const std::vector<rabia::KvResult> &) {},
+                         exec_opts);
+  exec.AttachSnapshots(&store, [&](uint32_t slot, sss::Status st) {
+    OK_OR_FAIL(st);
+    [[maybe_unused]] size_t dropped = log.TruncatePrefix(slot);
+    ROME_DEBUG("Snapshot at slot {}; dropped {} log segments", slot, dropped);
+  });
+
+  rome::metrics::Summary<double> submit_us("submit_latency", "us", 10000);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<uint64_t> key(0, args.iget("--keys") - 1);
+  message::ConsensusObj obj;
+  obj.set_proid(1);
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t s = 0; s < slots; ++s) {
+    obj.clear_cliids();
+    obj.clear_cliseqs();
+    obj.clear_commands();
+    obj.set_svrseq(s);
+    obj.set_proseq(s);
+    for (int64_t c = 0; c < args.iget("--commands"); ++c) {
+      obj.add_cliids(0);
+      obj.add_cliseqs(uint32_t(c));
+      obj.add_commands(rabia::MakeWriteCommand(key(rng), rng()));
+    }
+    OK_OR_FAIL(log.Append(obj));
+    log.Poll();
+    auto t0 = std::chrono::steady_clock::now();
+    exec.Submit(s, obj);
+    std::chrono::duration<double, std::micro> lat =
+        std::chrono::steady_clock::now() - t0;
+    submit_us << lat.count();
+    exec.Poll();
+    if (every != 0 && s % every == every - 1)
+      exec.BeginSnapshot();
+  }
+  OK_OR_FAIL(log.Sync());
+  while (exec.num_slots() < slots || exec.snapshotting())
+    exec.Poll();
+  std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+
+  ROME_INFO("Applied {} slots in {:.2f}s ({:.0f} cmds/s), {} snapshots, {} "
+            "compactions",
+            slots, t.count(), exec.num_applied() / t.count(),
+            exec.num_snapshots(), store.num_compactions());
+  ROME_INFO("{}", submit_us.ToString());
+  ROME_INFO("On disk: {} log segments ({} MB) from slot {}, {:.1f} MB of "
+            "snapshots",
+            log.num_segments(), log.num_segments() * args.iget("--segment_mb"),
+            log.first_slot().value_or(0), store.bytes() / 1048576.0);
+
+  // Restart from what's on disk
+  start = std::chrono::steady_clock::now();
+  rabia::DurableLog log2(log_opts);
+  OK_OR_FAIL(log2.Open());
+  rabia::SnapshotStore store2(snap_opts);
+  OK_OR_FAIL(store2.Open());
+  rabia::KvExecutor exec2(
+      [](uint32_t, const std::vector<rabia::KvResult> &) {}, exec_opts);
+  auto restored = exec2.Restore(store2);
+  OK_OR_FAIL(restored.status);
+  std::optional<uint32_t> snap = restored.val.value();
+  uint32_t replayed = 0;
+  log2.ForEach([&](const rabia::LogEntryHeader &h, const rabia::wire::View &v) {
+    if (snap.has_value() && h.svrseq <= snap.value())
+      return;
+    exec2.Submit(h.svrseq, v);
+    exec2.Poll();
+    ++replayed;
+  });
+  while (exec2.num_slots() < replayed)
+    exec2.Poll();
+  t = std::chrono::steady_clock::now() - start;
+  ROME_INFO("Restarted in {:.1f} ms: snapshot at slot {}, then {} slots from "
+            "the log",
+            t.count() * 1e3, snap.has_value() ? int64_t(snap.value()) : -1,
+            replayed);
+
+  uint64_t wrong = 0;
+  for (int64_t k = 0; k < args.iget("--keys"); ++k)
+    if (exec.Get(k) != exec2.Get(k))
+      ++wrong;
+  ROME_ASSERT(wrong == 0, "{} keys differ after the restart", wrong);
+  return 0;
+}
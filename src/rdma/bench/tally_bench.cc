@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/tally.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas send States and Votes",
+                     5),
+    sss::I64_ARG_OPT("--window", "How many slots are in flight at once", 4096),
+    sss::I64_ARG_OPT("--slots", "How many slots to tally", 2000000),
+    sss::I64_ARG_OPT("--dup_pct", "Percent of messages sent twice", 10),
+    sss::I64_ARG_OPT("--extra_pct", "Percent of slots that need a second phase",
+                     20),
+};
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// The per-slot maps of per-phase tallies that WeakMvc used before
+class MapTallies {
+  struct Tally {
+    std::vector<int8_t> from;
+    uint32_t count[3] = {0, 0, 0};
+    uint32_t total = 0;
+
+    explicit Tally(uint32_t n) : from(n, -1) {}
+
+    void Add(uint32_t sender, uint32_t value) {
+      if (value > rabia::kQuestion || from[sender] != -1)
+        return;
+      from[sender] = int8_t(value);
+      ++count[value];
+      ++total;
+    }
+  };
+  struct Slot {
+    std::map<uint32_t, Tally> tallies[2];
+  };
+
+  const uint32_t n_;
+  std::map<uint32_t, Slot> slots_;
+
+public:
+  MapTallies(uint32_t n, uint32_t) : n_(n) {}
+
+  void Add(uint32_t slot, uint32_t phase, rabia::TallyKind kind,
+           uint32_t sender, uint32_t value) {
+    slots_[slot].tallies[kind].try_emplace(phase, n_).first->second.Add(
+        sender, value);
+  }
+  rabia::TallyCounts Counts(uint32_t slot, uint32_t phase,
+                            rabia::TallyKind kind) {
+    rabia::TallyCounts c;
+    auto &m = slots_[slot].tallies[kind];
+    auto t = m.find(phase);
+    if (t != m.end()) {
+      std::copy(t->second.count, t->second.count + 3, c.count);
+      c.total = t->second.total;
+    }
+    return c;
+  }
+  void Release(uint32_t slot) { slots_.erase(slot); }
+};
+
+/// One message to tally
+struct Msg {
+  uint32_t slot, phase;
+  rabia::TallyKind kind;
+  uint32_t sender, value;
+};
+
+/// The messages for `slots` slots, `window` slots interleaved at a time, as a
+/// replica with that many slots in flight would receive them
+std::vector<Msg> MakeTrace(uint32_t n, uint32_t window, uint32_t slots,
+                           uint32_t dup_pct, uint32_t extra_pct) {
+  std::mt19937_64 rng(11);
+  std::vector<Msg> trace;
+  for (uint32_t first = 0; first < slots; first += window) {
+    std::vector<Msg> batch;
+    for (uint32_t s = first; s < std::min(first + window, slots); ++s) {
+      const uint32_t phases = rng() % 100 < extra_pct ? 2 : 1;
+      for (uint32_t p = 1; p <= phases; ++p)
+        for (auto kind : {rabia::kStateTally, rabia::kVoteTally})
+          for (uint32_t r = 0; r < n; ++r) {
+            Msg m{s, p, kind, r, uint32_t(rng() % 3)};
+            batch.push_back(m);
+            if (rng() % 100 < dup_pct)
+              batch.push_back(m);
+          }
+    }
+    std::shuffle(batch.begin(), batch.end(), rng);
+    trace.insert(trace.end(), batch.begin(), batch.end());
+  }
+  return trace;
+}
+
+/// Tally `trace` as WeakMvc does: add each message, check the slot's counts
+/// for that phase, and release each window of slots once it is done
+///
+/// @return ns per message, and a checksum of the counts seen
+template <class T>
+std::pair<double, uint64_t> Run(T &t, const std::vector<Msg> &trace,
+                                uint32_t window) {
+  uint64_t sum = 0;
+  uint32_t released = 0;
+  auto start = clock_type::now();
+  for (const auto &m : trace) {
+    while (m.slot >= released + window)
+      t.Release(released++);
+    t.Add(m.slot, m.phase, m.kind, m.sender, m.value);
+    auto c = t.Counts(m.slot, m.phase, m.kind);
+    sum = sum * 31 + c.total * 9 + c.count[rabia::kOne] * 3 +
+          c.count[rabia::kZero];
+  }
+  std::chrono::duration<double, std::nano> d = clock_type::now() - start;
+  return {d.count() / trace.size(), sum};
+}
+
+} // namespace
+
+/// Compare TallyTable with the per-slot maps of tallies that WeakMvc used
+/// before it, over the State and Vote messages of --slots slots with --window
+/// of them in flight at once
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 0 ||
+      args.iget("--replicas") > rabia::TallyTable::kMaxReplicas ||
+      args.iget("--window") <= 0 || args.iget("--slots") <= 0 ||
+      args.iget("--dup_pct") < 0 || args.iget("--extra_pct") < 0) {
+    ROME_ERROR("Counts must be positive, with at most {} replicas",
+               rabia::TallyTable::kMaxReplicas);
+    exit(1);
+  }
+  const uint32_t n = args.iget("--replicas");
+  const uint32_t window = args.iget("--window");
+  auto trace = MakeTrace(n, window, args.iget("--slots"), args.iget("--dup_pct"),
+                         args.iget("--extra_pct"));
+
+  MapTallies maps(n, window);
+  auto [map_ns, map_sum] = Run(maps, trace, window);
+  ROME_INFO("std::map tallies: {:.1f} ns/msg", map_ns);
+  rabia::TallyTable table(n, 2 * window);
+  auto [table_ns, table_sum] = Run(table, trace, window);
+  ROME_INFO("TallyTable: {:.1f} ns/msg ({} tallies spilled)", table_ns,
+            table.num_spilled());
+  ROME_ASSERT(map_sum == table_sum, "The tallies counted differently");
+  return 0;
+}
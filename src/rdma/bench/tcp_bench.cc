@@ -0,0 +1,209 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <rdma/peer.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/local_cluster.h"
+#include "../rabia/tcp_transport.h"
+#include "../rabia/weak_mvc.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::STR_ARG_OPT("--addr", "The IP to listen and connect on",
+                     "127.0.0.1"),
+    sss::I64_ARG_OPT("--port", "The first replica's port; the rest follow",
+                     18100),
+    sss::I64_ARG_OPT("--reactors", "I/O threads per replica", 1),
+    sss::BOOL_ARG_OPT("--busy_poll",
+                      "Read the sockets from the replica's thread when "
+                      "nothing is queued"),
+    sss::I64_ARG_OPT("--rounds", "How many broadcast rounds to run", 100000),
+    sss::BOOL_ARG_OPT("--mvc",
+                      "Run Weak-MVC over the transport instead of broadcast "
+                      "rounds"),
+    sss::I64_ARG_OPT("--window", "With --mvc, slots each replica runs at once",
+                     16),
+    sss::I64_ARG_OPT("--outstanding",
+                     "With --mvc, objects each replica keeps in flight", 32),
+    sss::I64_ARG_OPT("--batch", "With --mvc, commands per object", 16),
+    sss::I64_ARG_OPT("--runtime_ms", "With --mvc, how long to run", 2000),
+};
+
+using rome::rdma::Peer;
+
+namespace {
+
+/// Time all-to-all State broadcasts, as mailbox_bench does over RDMA: in
+/// round r every replica sends a State for slot r to every peer, then waits
+/// for the peers' States for slot r
+void Rounds(rabia::TcpTransport &net, uint32_t rounds,
+            rome::metrics::Summary<double> *latency, double *rate) {
+  const uint32_t n = net.size(), i = net.self();
+  // A peer can be at most one round ahead, since it needs this replica's
+  // State to finish the round this replica is in.
+  uint32_t got[2] = {0, 0};
+  message::Msg state;
+  state.set_type(message::State);
+  state.set_phase(1);
+  state.set_value(rabia::kOne);
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    state.mutable_obj()->set_svrseq(r);
+    for (uint32_t p = 0; p < n; ++p)
+      if (p != i)
+        OK_OR_FAIL(net.Send(p, state));
+    while (got[r % 2] < n - 1) {
+      bool any = false;
+      for (uint32_t p = 0; p < n; ++p) {
+        if (p == i)
+          continue;
+        auto m = net.TryReceive(p);
+        if (m.has_value()) {
+          ++got[m->obj().svrseq() % 2];
+          any = true;
+        }
+      }
+      // Let the reactors (and, on a small machine, the peers) run
+      if (!any)
+        std::this_thread::yield();
+    }
+    got[r % 2] = 0;
+    std::chrono::duration<double, std::micro> lat =
+        std::chrono::steady_clock::now() - t0;
+    *latency << lat.count();
+  }
+  std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+  *rate = rounds / t.count();
+}
+
+/// Run a WeakMvc replica on `net` until `end`, keeping `outstanding` objects
+/// of its own in flight, and report its decisions/sec
+void Mvc(rabia::TcpTransport &net, sss::ArgMap &args,
+         std::chrono::steady_clock::time_point end,
+         rome::metrics::Summary<double> *latency, double *rate) {
+  using clock_type = std::chrono::steady_clock;
+  const uint32_t i = net.self();
+  const uint32_t outstanding = args.iget("--outstanding");
+  const uint32_t batch = args.iget("--batch");
+  uint32_t in_flight = 0, next_proseq = 0;
+  std::unordered_map<uint32_t, clock_type::time_point> submitted;
+  rabia::WeakMvc<rabia::TcpTransport> mvc(
+      &net,
+      [&](uint32_t, const message::ConsensusObj &obj) {
+        if (obj.isnull() || obj.proid() != i)
+          return;
+        auto it = submitted.find(obj.proseq());
+        std::chrono::duration<double, std::micro> lat =
+            clock_type::now() - it->second;
+        *latency << lat.count();
+        submitted.erase(it);
+        --in_flight;
+      },
+      {.window = uint32_t(args.iget("--window"))});
+  auto start = clock_type::now();
+  while (clock_type::now() < end) {
+    while (in_flight < outstanding) {
+      message::ConsensusObj obj;
+      obj.set_proid(i);
+      obj.set_proseq(next_proseq);
+      for (uint32_t c = 0; c < batch; ++c) {
+        obj.add_cliids(c);
+        obj.add_cliseqs(next_proseq);
+        obj.add_commands(rabia::MakeWriteCommand(c, next_proseq));
+      }
+      submitted[next_proseq++] = clock_type::now();
+      mvc.Submit(obj);
+      ++in_flight;
+    }
+    if (mvc.Poll() == 0)
+      std::this_thread::yield();
+  }
+  std::chrono::duration<double> t = clock_type::now() - start;
+  *rate = mvc.num_decided() / t.count();
+}
+
+} // namespace
+
+/// Run `--replicas` replicas as threads of this process, connected all-to-all
+/// by a TcpTransport on `--addr`, and time either all-to-all State broadcasts
+/// (compare with mailbox_bench, which does the same over RDMA) or, with
+/// `--mvc`, Weak-MVC itself.  Each replica reports how many of its messages
+/// went out per write syscall.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 1 || args.iget("--reactors") <= 0 ||
+      args.iget("--rounds") <= 0 || args.iget("--window") <= 0 ||
+      args.iget("--outstanding") <= 0) {
+    ROME_ERROR("Need at least 2 replicas, and counts must be positive");
+    exit(1);
+  }
+
+  const uint32_t n = args.iget("--replicas");
+  std::vector<Peer> peers;
+  for (uint32_t i = 0; i < n; ++i)
+    peers.emplace_back(i, args.sget("--addr"), args.iget("--port") + i);
+  rabia::TcpTransportOptions opts{
+      .reactors = uint32_t(args.iget("--reactors")),
+      .busy_poll = args.bget("--busy_poll")};
+
+  std::vector<std::unique_ptr<rome::metrics::Summary<double>>> latency;
+  for (uint32_t i = 0; i < n; ++i)
+    latency.push_back(std::make_unique<rome::metrics::Summary<double>>(
+        args.bget("--mvc") ? "commit_latency" : "round_latency", "us",
+        10000));
+  std::vector<double> rate(n);
+  std::vector<double> per_write(n);
+  // No replica closes its sockets until every one has stopped sending
+  std::atomic<uint32_t> done(0);
+  const auto end = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(args.iget("--runtime_ms"));
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n; ++i) {
+    threads.emplace_back([&, i]() {
+      rabia::TcpTransport net(i, peers, opts);
+      OK_OR_FAIL(net.Init());
+      if (args.bget("--mvc"))
+        Mvc(net, args, end, latency[i].get(), &rate[i]);
+      else
+        Rounds(net, args.iget("--rounds"), latency[i].get(), &rate[i]);
+      per_write[i] = double(net.num_sent()) / std::max<uint64_t>(
+                                                  1, net.num_writes());
+      done.fetch_add(1);
+      while (done.load() < n)
+        std::this_thread::yield();
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  for (uint32_t i = 0; i < n; ++i) {
+    ROME_INFO("replica {}: {:.0f} {}/s, {:.2f} messages per write", i, rate[i],
+              args.bget("--mvc") ? "decisions" : "rounds", per_write[i]);
+    ROME_INFO("replica {}: {}", i, latency[i]->ToString());
+  }
+  return 0;
+}
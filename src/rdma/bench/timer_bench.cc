@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/timer_wheel.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--timers", "How many timers to schedule", 2000000),
+    sss::I64_ARG_OPT("--per_tick", "Timers scheduled per tick", 4),
+    sss::I64_ARG_OPT("--timeout_ticks", "How long each timer is set for", 200),
+    sss::I64_ARG_OPT("--cancel_pct",
+                     "Percent of timers cancelled before they fire (their "
+                     "reply arrived)",
+                     95),
+    sss::I64_ARG_OPT("--tick_ns", "The wheel's tick", 1000),
+};
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// One step of the trace both timer sets run
+struct Op {
+  enum Kind : uint32_t { kSchedule, kCancel, kAdvance } kind;
+  uint32_t timer;
+  uint64_t ns; // The deadline, or the time to advance to
+};
+
+/// Timers scheduled `per_tick` at a time, each set `timeout` ticks out, with
+/// `cancel_pct` percent cancelled at a random point before their deadline,
+/// and the clock advanced once per tick, the way a replica's retransmit and
+/// client-retry timers behave
+std::vector<Op> MakeTrace(uint32_t timers, uint32_t per_tick, uint32_t timeout,
+                          uint32_t cancel_pct, uint64_t tick_ns) {
+  std::mt19937_64 rng(5);
+  // Cancels, bucketed by the tick they happen in
+  std::vector<std::vector<uint32_t>> cancels(timers / per_tick + timeout + 2);
+  std::vector<Op> trace;
+  uint32_t next = 0;
+  for (uint64_t t = 0; t < cancels.size(); ++t) {
+    for (uint32_t i = 0; i < per_tick && next < timers; ++i, ++next) {
+      trace.push_back({Op::kSchedule, next, (t + timeout) * tick_ns});
+      if (rng() % 100 < cancel_pct)
+        cancels[t + rng() % timeout].push_back(next);
+    }
+    for (uint32_t id : cancels[t])
+      trace.push_back({Op::kCancel, id, 0});
+    trace.push_back({Op::kAdvance, 0, t * tick_ns});
+  }
+  return trace;
+}
+
+/// A binary heap of deadlines, with cancelled timers skipped when they reach
+/// the top, which is the usual way to cancel out of a std::priority_queue
+class HeapTimers {
+  using Entry = std::pair<uint64_t, uint32_t>; // Deadline, timer
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap_;
+  std::vector<bool> cancelled_;
+
+public:
+  explicit HeapTimers(uint32_t timers) : cancelled_(timers) {}
+
+  void Schedule(uint32_t id, uint64_t deadline_ns) {
+    heap_.push({deadline_ns, id});
+  }
+  void Cancel(uint32_t id) { cancelled_[id] = true; }
+
+  template <class Fn> void Advance(uint64_t now_ns, Fn &&fired) {
+    while (!heap_.empty() && heap_.top().first <= now_ns) {
+      uint32_t id = heap_.top().second;
+      heap_.pop();
+      if (!cancelled_[id])
+        fired(id);
+    }
+  }
+};
+
+struct Fired {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+};
+
+void OnFire(void *ctx, uint64_t id) {
+  auto *f = static_cast<Fired *>(ctx);
+  ++f->count;
+  f->sum += id;
+}
+
+} // namespace
+
+/// Compare TimerWheel with a std::priority_queue on the same trace of
+/// short-lived timers, most of which are cancelled before they fire, and
+/// report the ns per operation (schedule, cancel, or a tick of the clock)
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--timers") <= 0 || args.iget("--per_tick") <= 0 ||
+      args.iget("--timeout_ticks") <= 0 || args.iget("--cancel_pct") < 0 ||
+      args.iget("--tick_ns") <= 0) {
+    ROME_ERROR("Counts must be positive");
+    exit(1);
+  }
+  const uint32_t timers = args.iget("--timers");
+  const uint64_t tick_ns = args.iget("--tick_ns");
+  auto trace = MakeTrace(timers, args.iget("--per_tick"),
+                         args.iget("--timeout_ticks"), args.iget("--cancel_pct"),
+                         tick_ns);
+
+  Fired heap_fired;
+  HeapTimers heap(timers);
+  auto start = clock_type::now();
+  for (const auto &op : trace) {
+    switch (op.kind) {
+    case Op::kSchedule:
+      heap.Schedule(op.timer, op.ns);
+      break;
+    case Op::kCancel:
+      heap.Cancel(op.timer);
+      break;
+    case Op::kAdvance:
+      heap.Advance(op.ns, [&](uint32_t id) { OnFire(&heap_fired, id); });
+      break;
+    }
+  }
+  std::chrono::duration<double, std::nano> heap_ns = clock_type::now() - start;
+
+  Fired wheel_fired;
+  rabia::TimerWheel wheel({.tick = std::chrono::nanoseconds(tick_ns)});
+  std::vector<rabia::TimerId> ids(timers);
+  start = clock_type::now();
+  for (const auto &op : trace) {
+    switch (op.kind) {
+    case Op::kSchedule:
+      ids[op.timer] = wheel.Schedule(op.ns, &OnFire, &wheel_fired, op.timer);
+      break;
+    case Op::kCancel:
+      wheel.Cancel(ids[op.timer]);
+      break;
+    case Op::kAdvance:
+      wheel.Advance(op.ns);
+      break;
+    }
+  }
+  std::chrono::duration<double, std::nano> wheel_ns = clock_type::now() - start;
+
+  ROME_INFO("{} ops, {} timers fired", trace.size(), wheel_fired.count);
+  ROME_INFO("std::priority_queue: {:.1f} ns/op",
+            heap_ns.count() / trace.size());
+  ROME_INFO("TimerWheel: {:.1f} ns/op", wheel_ns.count() / trace.size());
+  ROME_ASSERT(heap_fired.count == wheel_fired.count &&
+                  heap_fired.sum == wheel_fired.sum,
+              "The timer sets fired different timers");
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <cstdlib>
+#include <string>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/trace.h"
+#include "../rabia/trace_report.h"
+
+auto ARGS = {
+    sss::STR_ARG("--trace_file", "A trace written with --trace_file"),
+    sss::STR_ARG_OPT("--chrome",
+                     "Also write the spans here as Chrome trace-event JSON",
+                     ""),
+    sss::I64_ARG_OPT("--max_slots",
+                     "The most slots per thread to put in the JSON", 2000),
+};
+
+/// Read a per-slot phase trace (see rabia/trace.h, and --trace_file in
+/// weak_mvc_bench) and print how long slots spent in each phase: waiting for
+/// proposals, in the State and Vote rounds of the first phase, in any later
+/// (coin) phases, waiting to be released in order, and being applied.  With
+/// --chrome, also write the spans of each slot for chrome://tracing or
+/// ui.perfetto.dev.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--max_slots") < 0) {
+    ROME_ERROR("--max_slots can't be negative");
+    exit(1);
+  }
+
+  auto threads = rabia::trace::ReadFile(args.sget("--trace_file"));
+  OK_OR_FAIL(threads.status);
+  uint64_t events = 0;
+  for (const auto &t : threads.val.value())
+    events += t.events.size();
+  ROME_INFO("{} events from {} threads", events, threads.val->size());
+
+  rabia::trace::TraceReport report(threads.val.value());
+  ROME_INFO("Per-phase latency:\n{}", report.Histograms());
+  if (!args.sget("--chrome").empty()) {
+    OK_OR_FAIL(report.WriteChromeTrace(args.sget("--chrome"),
+                                       args.iget("--max_slots")));
+    ROME_INFO("Wrote {}", args.sget("--chrome"));
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/local_cluster.h"
+#include "../rabia/trace.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::I64_ARG_OPT("--outstanding",
+                     "How many closed-loop clients each replica serves", 1),
+    sss::I64_ARG_OPT("--pipeline", "How many commands each client keeps in "
+                     "flight", 1),
+    sss::I64_ARG_OPT("--drop_every",
+                     "Lose one in this many client messages (0: none)", 0),
+    sss::I64_ARG_OPT("--client_timeout_us",
+                     "How long a client waits before resending", 10000),
+    sss::I64_ARG_OPT("--batch", "The most commands per object", 1),
+    sss::I64_ARG_OPT("--batch_delay_us",
+                     "The longest a command waits for its batch to fill", 100),
+    sss::I64_ARG_OPT("--window", "How many slots each replica runs at once",
+                     1),
+    sss::I64_ARG_OPT("--partitions",
+                     "How many instances each replica runs, one per key "
+                     "partition",
+                     1),
+    sss::BOOL_ARG_OPT("--pin", "Pin each instance's thread to its own core"),
+    sss::I64_ARG_OPT("--cross_pct",
+                     "Percent of commands with a key in a second partition", 0),
+    sss::BOOL_ARG_OPT("--order_cross", "Order cross-partition commands in "
+                      "partition 0, rather than rejecting them"),
+    sss::BOOL_ARG_OPT("--coalesce", "Send each replica's messages to a peer "
+                      "once per event-loop tick, packed into one Batch"),
+    sss::I64_ARG_OPT("--runtime_ms", "How long to run for", 1000),
+    sss::STR_ARG_OPT("--trace_file",
+                     "Write per-slot phase timestamps here, for trace_dump "
+                     "(needs a build with -DSLOT_TRACE=ON)",
+                     ""),
+};
+
+/// Run a Weak-MVC cluster in this process and report, per replica, the decided
+/// slots per second, the commit latency of its clients' commands (at the proxy,
+/// and end to end at the client), the sizes of the batches its proxy built,
+/// and how many client retries there were.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 0 || args.iget("--outstanding") <= 0 ||
+      args.iget("--pipeline") <= 0 || args.iget("--batch") <= 0 ||
+      args.iget("--window") <= 0 || args.iget("--drop_every") < 0 ||
+      args.iget("--partitions") <= 0 || args.iget("--cross_pct") < 0) {
+    ROME_ERROR("--replicas, --outstanding, --pipeline, --batch, --window and "
+               "--partitions must be positive");
+    exit(1);
+  }
+
+  rabia::LocalCluster::Options opts;
+  opts.replicas = args.iget("--replicas");
+  opts.outstanding = args.iget("--outstanding");
+  opts.pipeline = args.iget("--pipeline");
+  opts.drop_every = args.iget("--drop_every");
+  opts.client_timeout =
+      std::chrono::microseconds(args.iget("--client_timeout_us"));
+  opts.batch = args.iget("--batch");
+  opts.window = args.iget("--window");
+  opts.batch_delay = std::chrono::microseconds(args.iget("--batch_delay_us"));
+  opts.partitions = args.iget("--partitions");
+  opts.pin = args.bget("--pin");
+  opts.cross_pct = args.iget("--cross_pct");
+  opts.reject_cross = !args.bget("--order_cross");
+  opts.coalesce = args.bget("--coalesce");
+  opts.runtime = std::chrono::milliseconds(args.iget("--runtime_ms"));
+
+  auto results = rabia::LocalCluster(opts).Run();
+  for (auto &r : results) {
+    std::string name = std::to_string(r->id);
+    if (opts.partitions > 1)
+      name += "/" + std::to_string(r->partition);
+    ROME_INFO("replica {}: decided={} ({:.0f}/s), null={}, committed={} "
+              "({:.0f}/s), retries={}, rejected={}, duplicates={}",
+              name, r->decided, r->decisions_per_sec(), r->null, r->committed,
+              r->committed / r->runtime_s, r->retries, r->rejected,
+              r->duplicates);
+    ROME_INFO("replica {}: {}", name, r->latency_us.ToString());
+    if (r->partition == 0)
+      ROME_INFO("replica {}: {}", name, r->client_latency_us.ToString());
+    ROME_INFO("replica {}: {}", name, r->batch_size.ToString());
+  }
+
+  if (!args.sget("--trace_file").empty()) {
+    if (!RABIA_TRACE)
+      ROME_WARN("Tracing is compiled out (RABIA_TRACE=0); the trace is empty");
+    OK_OR_FAIL(rabia::trace::WriteFile(args.sget("--trace_file")));
+  }
+  return 0;
+}
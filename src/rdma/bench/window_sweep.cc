@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdlib>
+
+#include <logging/logging.h>
+#include <vendor/sss/cli.h>
+
+#include "../rabia/local_cluster.h"
+
+auto ARGS = {
+    sss::I64_ARG_OPT("--replicas", "How many replicas to run (2f+1)", 3),
+    sss::I64_ARG_OPT("--batch", "The most commands per object", 1),
+    sss::I64_ARG_OPT("--max_window", "The largest window to try", 128),
+    sss::I64_ARG_OPT("--runtime_ms", "How long to run each window for", 1000),
+};
+
+/// Sweep the Weak-MVC window over powers of two, from 1 to --max_window, and
+/// report decisions/sec and commit latency for each.  Every replica keeps one
+/// object in flight per slot in the window, so the pipeline stays full.
+///
+/// Throughput and latency are taken from replica 0; the replicas are symmetric,
+/// so the others see much the same.
+int main(int argc, char **argv) {
+  ROME_INIT_LOG();
+
+  sss::ArgMap args;
+  auto res = args.import_args(ARGS);
+  if (res) {
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  res = args.parse_args(argc, argv);
+  if (res) {
+    args.usage();
+    ROME_ERROR(res.value());
+    exit(1);
+  }
+  if (args.iget("--replicas") <= 0 || args.iget("--batch") <= 0 ||
+      args.iget("--max_window") <= 0) {
+    ROME_ERROR("--replicas, --batch and --max_window must be positive");
+    exit(1);
+  }
+
+  ROME_INFO("window,decisions_per_sec,null,p50_us,p99_us");
+  for (int64_t w = 1; w <= args.iget("--max_window"); w *= 2) {
+    rabia::LocalCluster::Options opts;
+    opts.replicas = args.iget("--replicas");
+    opts.batch = args.iget("--batch");
+    opts.window = w;
+    opts.outstanding = w;
+    opts.runtime = std::chrono::milliseconds(args.iget("--runtime_ms"));
+
+    auto results = rabia::LocalCluster(opts).Run();
+    auto &r = *results[0];
+    ROME_INFO("{},{:.0f},{},{:.1f},{:.1f}", w, r.decisions_per_sec(), r.null,
+              r.latency_us.Get50thPercentile(), r.latency_us.Get99thPercentile());
+  }
+  return 0;
+}
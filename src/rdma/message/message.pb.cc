@@ -14,143 +14,150 @@
 #include <google/protobuf/wire_format.h>
 // @@protoc_insertion_point(includes)
 #include <google/protobuf/port_def.inc>
-extern PROTOBUF_INTERNAL_EXPORT_message_2eproto ::PROTOBUF_NAMESPACE_ID::internal::SCCInfo<0> scc_info_ConsensusObj_message_2eproto;
-namespace message {
-class CommandDefaultTypeInternal {
- public:
-  ::PROTOBUF_NAMESPACE_ID::internal::ExplicitlyConstructed<Command> _instance;
-} _Command_default_instance_;
-class ConsensusObjDefaultTypeInternal {
- public:
-  ::PROTOBUF_NAMESPACE_ID::internal::ExplicitlyConstructed<ConsensusObj> _instance;
-} _ConsensusObj_default_instance_;
-class MsgDefaultTypeInternal {
- public:
-  ::PROTOBUF_NAMESPACE_ID::internal::ExplicitlyConstructed<Msg> _instance;
-} _Msg_default_instance_;
-}  // namespace message
-static void InitDefaultsscc_info_Command_message_2eproto() {
-  GOOGLE_PROTOBUF_VERIFY_VERSION;
-
-  {
-    void* ptr = &::message::_Command_default_instance_;
-    new (ptr) ::message::Command();
-    ::PROTOBUF_NAMESPACE_ID::internal::OnShutdownDestroyMessage(ptr);
-  }
-  ::message::Command::InitAsDefaultInstance();
-}
-
-::PROTOBUF_NAMESPACE_ID::internal::SCCInfo<0> scc_info_Command_message_2eproto =
-    {{ATOMIC_VAR_INIT(::PROTOBUF_NAMESPACE_ID::internal::SCCInfoBase::kUninitialized), 0, 0, InitDefaultsscc_info_Command_message_2eproto}, {}};
-
-static void InitDefaultsscc_info_ConsensusObj_message_2eproto() {
-  GOOGLE_PROTOBUF_VERIFY_VERSION;
-
-  {
-    void* ptr = &::message::_ConsensusObj_default_instance_;
-    new (ptr) ::message::ConsensusObj();
-    ::PROTOBUF_NAMESPACE_ID::internal::OnShutdownDestroyMessage(ptr);
-  }
-  ::message::ConsensusObj::InitAsDefaultInstance();
-}
 
-::PROTOBUF_NAMESPACE_ID::internal::SCCInfo<0> scc_info_ConsensusObj_message_2eproto =
-    {{ATOMIC_VAR_INIT(::PROTOBUF_NAMESPACE_ID::internal::SCCInfoBase::kUninitialized), 0, 0, InitDefaultsscc_info_ConsensusObj_message_2eproto}, {}};
+PROTOBUF_PRAGMA_INIT_SEG
 
-static void InitDefaultsscc_info_Msg_message_2eproto() {
-  GOOGLE_PROTOBUF_VERIFY_VERSION;
+namespace _pb = ::PROTOBUF_NAMESPACE_ID;
+namespace _pbi = _pb::internal;
 
-  {
-    void* ptr = &::message::_Msg_default_instance_;
-    new (ptr) ::message::Msg();
-    ::PROTOBUF_NAMESPACE_ID::internal::OnShutdownDestroyMessage(ptr);
-  }
-  ::message::Msg::InitAsDefaultInstance();
-}
-
-::PROTOBUF_NAMESPACE_ID::internal::SCCInfo<1> scc_info_Msg_message_2eproto =
-    {{ATOMIC_VAR_INIT(::PROTOBUF_NAMESPACE_ID::internal::SCCInfoBase::kUninitialized), 1, 0, InitDefaultsscc_info_Msg_message_2eproto}, {
-      &scc_info_ConsensusObj_message_2eproto.base,}};
-
-static ::PROTOBUF_NAMESPACE_ID::Metadata file_level_metadata_message_2eproto[3];
-static const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* file_level_enum_descriptors_message_2eproto[1];
-static constexpr ::PROTOBUF_NAMESPACE_ID::ServiceDescriptor const** file_level_service_descriptors_message_2eproto = nullptr;
+namespace message {
+PROTOBUF_CONSTEXPR Command::Command(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.commands_)*/{}
+  , /*decltype(_impl_.cliid_)*/0u
+  , /*decltype(_impl_.cliseq_)*/0u
+  , /*decltype(_impl_.svrseq_)*/0u
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct CommandDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR CommandDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~CommandDefaultTypeInternal() {}
+  union {
+    Command _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 CommandDefaultTypeInternal _Command_default_instance_;
+PROTOBUF_CONSTEXPR ConsensusObj::ConsensusObj(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.cliids_)*/{}
+  , /*decltype(_impl_._cliids_cached_byte_size_)*/{0}
+  , /*decltype(_impl_.cliseqs_)*/{}
+  , /*decltype(_impl_._cliseqs_cached_byte_size_)*/{0}
+  , /*decltype(_impl_.commands_)*/{}
+  , /*decltype(_impl_.proid_)*/0u
+  , /*decltype(_impl_.proseq_)*/0u
+  , /*decltype(_impl_.svrseq_)*/0u
+  , /*decltype(_impl_.isnull_)*/false
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct ConsensusObjDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR ConsensusObjDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~ConsensusObjDefaultTypeInternal() {}
+  union {
+    ConsensusObj _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 ConsensusObjDefaultTypeInternal _ConsensusObj_default_instance_;
+PROTOBUF_CONSTEXPR Msg::Msg(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.frames_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.obj_)*/nullptr
+  , /*decltype(_impl_.type_)*/0
+  , /*decltype(_impl_.phase_)*/0u
+  , /*decltype(_impl_.value_)*/0u
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct MsgDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR MsgDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~MsgDefaultTypeInternal() {}
+  union {
+    Msg _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 MsgDefaultTypeInternal _Msg_default_instance_;
+}  // namespace message
+static ::_pb::Metadata file_level_metadata_message_2eproto[3];
+static const ::_pb::EnumDescriptor* file_level_enum_descriptors_message_2eproto[1];
+static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_message_2eproto = nullptr;
 
-const ::PROTOBUF_NAMESPACE_ID::uint32 TableStruct_message_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+const uint32_t TableStruct_message_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::message::Command, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
-  PROTOBUF_FIELD_OFFSET(::message::Command, cliid_),
-  PROTOBUF_FIELD_OFFSET(::message::Command, cliseq_),
-  PROTOBUF_FIELD_OFFSET(::message::Command, svrseq_),
-  PROTOBUF_FIELD_OFFSET(::message::Command, commands_),
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::message::Command, _impl_.cliid_),
+  PROTOBUF_FIELD_OFFSET(::message::Command, _impl_.cliseq_),
+  PROTOBUF_FIELD_OFFSET(::message::Command, _impl_.svrseq_),
+  PROTOBUF_FIELD_OFFSET(::message::Command, _impl_.commands_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, proid_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, proseq_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, svrseq_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, isnull_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, cliids_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, cliseqs_),
-  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, commands_),
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.proid_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.proseq_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.svrseq_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.isnull_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.cliids_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.cliseqs_),
+  PROTOBUF_FIELD_OFFSET(::message::ConsensusObj, _impl_.commands_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::message::Msg, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
-  PROTOBUF_FIELD_OFFSET(::message::Msg, type_),
-  PROTOBUF_FIELD_OFFSET(::message::Msg, phase_),
-  PROTOBUF_FIELD_OFFSET(::message::Msg, value_),
-  PROTOBUF_FIELD_OFFSET(::message::Msg, obj_),
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::message::Msg, _impl_.type_),
+  PROTOBUF_FIELD_OFFSET(::message::Msg, _impl_.phase_),
+  PROTOBUF_FIELD_OFFSET(::message::Msg, _impl_.value_),
+  PROTOBUF_FIELD_OFFSET(::message::Msg, _impl_.obj_),
+  PROTOBUF_FIELD_OFFSET(::message::Msg, _impl_.frames_),
 };
-static const ::PROTOBUF_NAMESPACE_ID::internal::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
-  { 0, -1, sizeof(::message::Command)},
-  { 9, -1, sizeof(::message::ConsensusObj)},
-  { 21, -1, sizeof(::message::Msg)},
+static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  { 0, -1, -1, sizeof(::message::Command)},
+  { 10, -1, -1, sizeof(::message::ConsensusObj)},
+  { 23, -1, -1, sizeof(::message::Msg)},
 };
 
-static ::PROTOBUF_NAMESPACE_ID::Message const * const file_default_instances[] = {
-  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::message::_Command_default_instance_),
-  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::message::_ConsensusObj_default_instance_),
-  reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Message*>(&::message::_Msg_default_instance_),
+static const ::_pb::Message* const file_default_instances[] = {
+  &::message::_Command_default_instance_._instance,
+  &::message::_ConsensusObj_default_instance_._instance,
+  &::message::_Msg_default_instance_._instance,
 };
 
 const char descriptor_table_protodef_message_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
   "\n\rmessage.proto\022\007message\"J\n\007Command\022\r\n\005C"
   "liId\030\001 \001(\r\022\016\n\006CliSeq\030\002 \001(\r\022\016\n\006SvrSeq\030\003 \001"
-  "(\r\022\020\n\010Commands\030\004 \003(\t\"\200\001\n\014ConsensusObj\022\r\n"
+  "(\r\022\020\n\010Commands\030\004 \003(\014\"\200\001\n\014ConsensusObj\022\r\n"
   "\005ProId\030\001 \001(\r\022\016\n\006ProSeq\030\002 \001(\r\022\016\n\006SvrSeq\030\003"
   " \001(\r\022\016\n\006IsNull\030\004 \001(\010\022\016\n\006CliIds\030\005 \003(\r\022\017\n\007"
-  "CliSeqs\030\006 \003(\r\022\020\n\010Commands\030\007 \003(\t\"g\n\003Msg\022\036"
+  "CliSeqs\030\006 \003(\r\022\020\n\010Commands\030\007 \003(\014\"w\n\003Msg\022\036"
   "\n\004Type\030\001 \001(\0162\020.message.MsgType\022\r\n\005Phase\030"
   "\002 \001(\r\022\r\n\005Value\030\003 \001(\r\022\"\n\003Obj\030\004 \001(\0132\025.mess"
-  "age.ConsensusObj*u\n\007MsgType\022\021\n\rClientReq"
-  "uest\020\000\022\014\n\010Proposal\020\001\022\t\n\005State\020\002\022\010\n\004Vote\020"
-  "\003\022\023\n\017ProposalRequest\020\004\022\021\n\rProposalReply\020"
-  "\005\022\014\n\010Decision\020\006b\006proto3"
+  "age.ConsensusObj\022\016\n\006Frames\030\005 \001(\014*\200\001\n\007Msg"
+  "Type\022\021\n\rClientRequest\020\000\022\014\n\010Proposal\020\001\022\t\n"
+  "\005State\020\002\022\010\n\004Vote\020\003\022\023\n\017ProposalRequest\020\004\022"
+  "\021\n\rProposalReply\020\005\022\014\n\010Decision\020\006\022\t\n\005Batc"
+  "h\020\007B\014Z\n../messageb\006proto3"
   ;
-static const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable*const descriptor_table_message_2eproto_deps[1] = {
-};
-static ::PROTOBUF_NAMESPACE_ID::internal::SCCInfoBase*const descriptor_table_message_2eproto_sccs[3] = {
-  &scc_info_Command_message_2eproto.base,
-  &scc_info_ConsensusObj_message_2eproto.base,
-  &scc_info_Msg_message_2eproto.base,
-};
-static ::PROTOBUF_NAMESPACE_ID::internal::once_flag descriptor_table_message_2eproto_once;
-const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_message_2eproto = {
-  false, false, descriptor_table_protodef_message_2eproto, "message.proto", 463,
-  &descriptor_table_message_2eproto_once, descriptor_table_message_2eproto_sccs, descriptor_table_message_2eproto_deps, 3, 0,
-  schemas, file_default_instances, TableStruct_message_2eproto::offsets,
-  file_level_metadata_message_2eproto, 3, file_level_enum_descriptors_message_2eproto, file_level_service_descriptors_message_2eproto,
+static ::_pbi::once_flag descriptor_table_message_2eproto_once;
+const ::_pbi::DescriptorTable descriptor_table_message_2eproto = {
+    false, false, 505, descriptor_table_protodef_message_2eproto,
+    "message.proto",
+    &descriptor_table_message_2eproto_once, nullptr, 0, 3,
+    schemas, file_default_instances, TableStruct_message_2eproto::offsets,
+    file_level_metadata_message_2eproto, file_level_enum_descriptors_message_2eproto,
+    file_level_service_descriptors_message_2eproto,
 };
+PROTOBUF_ATTRIBUTE_WEAK const ::_pbi::DescriptorTable* descriptor_table_message_2eproto_getter() {
+  return &descriptor_table_message_2eproto;
+}
 
 // Force running AddDescriptors() at dynamic initialization time.
-static bool dynamic_init_dummy_message_2eproto = (static_cast<void>(::PROTOBUF_NAMESPACE_ID::internal::AddDescriptors(&descriptor_table_message_2eproto)), true);
+PROTOBUF_ATTRIBUTE_INIT_PRIORITY2 static ::_pbi::AddDescriptorsRunner dynamic_init_dummy_message_2eproto(&descriptor_table_message_2eproto);
 namespace message {
 const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* MsgType_descriptor() {
   ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_message_2eproto);
@@ -165,6 +172,7 @@ bool MsgType_IsValid(int value) {
     case 4:
     case 5:
     case 6:
+    case 7:
       return true;
     default:
       return false;
@@ -174,175 +182,176 @@ bool MsgType_IsValid(int value) {
 
 // ===================================================================
 
-void Command::InitAsDefaultInstance() {
-}
 class Command::_Internal {
  public:
 };
 
-Command::Command(::PROTOBUF_NAMESPACE_ID::Arena* arena)
-  : ::PROTOBUF_NAMESPACE_ID::Message(arena),
-  commands_(arena) {
-  SharedCtor();
-  RegisterArenaDtor(arena);
+Command::Command(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:message.Command)
 }
 Command::Command(const Command& from)
-  : ::PROTOBUF_NAMESPACE_ID::Message(),
-      commands_(from.commands_) {
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  Command* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.commands_){from._impl_.commands_}
+    , decltype(_impl_.cliid_){}
+    , decltype(_impl_.cliseq_){}
+    , decltype(_impl_.svrseq_){}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  ::memcpy(&cliid_, &from.cliid_,
-    static_cast<size_t>(reinterpret_cast<char*>(&svrseq_) -
-    reinterpret_cast<char*>(&cliid_)) + sizeof(svrseq_));
+  ::memcpy(&_impl_.cliid_, &from._impl_.cliid_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.svrseq_) -
+    reinterpret_cast<char*>(&_impl_.cliid_)) + sizeof(_impl_.svrseq_));
   // @@protoc_insertion_point(copy_constructor:message.Command)
 }
 
-void Command::SharedCtor() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&scc_info_Command_message_2eproto.base);
-  ::memset(&cliid_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&svrseq_) -
-      reinterpret_cast<char*>(&cliid_)) + sizeof(svrseq_));
+inline void Command::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.commands_){arena}
+    , decltype(_impl_.cliid_){0u}
+    , decltype(_impl_.cliseq_){0u}
+    , decltype(_impl_.svrseq_){0u}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
 }
 
 Command::~Command() {
   // @@protoc_insertion_point(destructor:message.Command)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
   SharedDtor();
-  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-void Command::SharedDtor() {
-  GOOGLE_DCHECK(GetArena() == nullptr);
+inline void Command::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.commands_.~RepeatedPtrField();
 }
 
-void Command::ArenaDtor(void* object) {
-  Command* _this = reinterpret_cast< Command* >(object);
-  (void)_this;
-}
-void Command::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
-}
 void Command::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
-}
-const Command& Command::default_instance() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&::scc_info_Command_message_2eproto.base);
-  return *internal_default_instance();
+  _impl_._cached_size_.Set(size);
 }
 
-
 void Command::Clear() {
 // @@protoc_insertion_point(message_clear_start:message.Command)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  commands_.Clear();
-  ::memset(&cliid_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&svrseq_) -
-      reinterpret_cast<char*>(&cliid_)) + sizeof(svrseq_));
+  _impl_.commands_.Clear();
+  ::memset(&_impl_.cliid_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&_impl_.svrseq_) -
+      reinterpret_cast<char*>(&_impl_.cliid_)) + sizeof(_impl_.svrseq_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-const char* Command::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+const char* Command::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
 #define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
-  ::PROTOBUF_NAMESPACE_ID::Arena* arena = GetArena(); (void)arena;
   while (!ctx->Done(&ptr)) {
-    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
-    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
-    CHK_(ptr);
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
     switch (tag >> 3) {
       // uint32 CliId = 1;
       case 1:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 8)) {
-          cliid_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          _impl_.cliid_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 CliSeq = 2;
       case 2:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 16)) {
-          cliseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          _impl_.cliseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 SvrSeq = 3;
       case 3:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 24)) {
-          svrseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _impl_.svrseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
-      // repeated string Commands = 4;
+      // repeated bytes Commands = 4;
       case 4:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 34)) {
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 34)) {
           ptr -= 1;
           do {
             ptr += 1;
             auto str = _internal_add_commands();
-            ptr = ::PROTOBUF_NAMESPACE_ID::internal::InlineGreedyStringParser(str, ptr, ctx);
-            CHK_(::PROTOBUF_NAMESPACE_ID::internal::VerifyUTF8(str, "message.Command.Commands"));
+            ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
             CHK_(ptr);
             if (!ctx->DataAvailable(ptr)) break;
           } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<34>(ptr));
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
-      default: {
-      handle_unusual:
-        if ((tag & 7) == 4 || tag == 0) {
-          ctx->SetLastTag(tag);
-          goto success;
-        }
-        ptr = UnknownFieldParse(tag,
-            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
-            ptr, ctx);
-        CHK_(ptr != nullptr);
-        continue;
-      }
+      default:
+        goto handle_unusual;
     }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
   }  // while
-success:
+message_done:
   return ptr;
 failure:
   ptr = nullptr;
-  goto success;
+  goto message_done;
 #undef CHK_
 }
 
-::PROTOBUF_NAMESPACE_ID::uint8* Command::_InternalSerialize(
-    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+uint8_t* Command::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
   // @@protoc_insertion_point(serialize_to_array_start:message.Command)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
   // uint32 CliId = 1;
-  if (this->cliid() != 0) {
+  if (this->_internal_cliid() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(1, this->_internal_cliid(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(1, this->_internal_cliid(), target);
   }
 
   // uint32 CliSeq = 2;
-  if (this->cliseq() != 0) {
+  if (this->_internal_cliseq() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(2, this->_internal_cliseq(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(2, this->_internal_cliseq(), target);
   }
 
   // uint32 SvrSeq = 3;
-  if (this->svrseq() != 0) {
+  if (this->_internal_svrseq() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(3, this->_internal_svrseq(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(3, this->_internal_svrseq(), target);
   }
 
-  // repeated string Commands = 4;
+  // repeated bytes Commands = 4;
   for (int i = 0, n = this->_internal_commands_size(); i < n; i++) {
     const auto& s = this->_internal_commands(i);
-    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
-      s.data(), static_cast<int>(s.length()),
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
-      "message.Command.Commands");
-    target = stream->WriteString(4, s, target);
+    target = stream->WriteBytes(4, s, target);
   }
 
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
   }
   // @@protoc_insertion_point(serialize_to_array_end:message.Command)
@@ -353,87 +362,62 @@ size_t Command::ByteSizeLong() const {
 // @@protoc_insertion_point(message_byte_size_start:message.Command)
   size_t total_size = 0;
 
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  // repeated string Commands = 4;
+  // repeated bytes Commands = 4;
   total_size += 1 *
-      ::PROTOBUF_NAMESPACE_ID::internal::FromIntSize(commands_.size());
-  for (int i = 0, n = commands_.size(); i < n; i++) {
-    total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
-      commands_.Get(i));
+      ::PROTOBUF_NAMESPACE_ID::internal::FromIntSize(_impl_.commands_.size());
+  for (int i = 0, n = _impl_.commands_.size(); i < n; i++) {
+    total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::BytesSize(
+      _impl_.commands_.Get(i));
   }
 
   // uint32 CliId = 1;
-  if (this->cliid() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_cliid());
+  if (this->_internal_cliid() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_cliid());
   }
 
   // uint32 CliSeq = 2;
-  if (this->cliseq() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_cliseq());
+  if (this->_internal_cliseq() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_cliseq());
   }
 
   // uint32 SvrSeq = 3;
-  if (this->svrseq() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_svrseq());
+  if (this->_internal_svrseq() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_svrseq());
   }
 
-  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
-        _internal_metadata_, total_size, &_cached_size_);
-  }
-  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
-  SetCachedSize(cached_size);
-  return total_size;
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
-void Command::MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_merge_from_start:message.Command)
-  GOOGLE_DCHECK_NE(&from, this);
-  const Command* source =
-      ::PROTOBUF_NAMESPACE_ID::DynamicCastToGenerated<Command>(
-          &from);
-  if (source == nullptr) {
-  // @@protoc_insertion_point(generalized_merge_from_cast_fail:message.Command)
-    ::PROTOBUF_NAMESPACE_ID::internal::ReflectionOps::Merge(from, this);
-  } else {
-  // @@protoc_insertion_point(generalized_merge_from_cast_success:message.Command)
-    MergeFrom(*source);
-  }
-}
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData Command::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    Command::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Command::GetClassData() const { return &_class_data_; }
 
-void Command::MergeFrom(const Command& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:message.Command)
-  GOOGLE_DCHECK_NE(&from, this);
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+
+void Command::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<Command*>(&to_msg);
+  auto& from = static_cast<const Command&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:message.Command)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
-  commands_.MergeFrom(from.commands_);
-  if (from.cliid() != 0) {
-    _internal_set_cliid(from._internal_cliid());
+  _this->_impl_.commands_.MergeFrom(from._impl_.commands_);
+  if (from._internal_cliid() != 0) {
+    _this->_internal_set_cliid(from._internal_cliid());
   }
-  if (from.cliseq() != 0) {
-    _internal_set_cliseq(from._internal_cliseq());
+  if (from._internal_cliseq() != 0) {
+    _this->_internal_set_cliseq(from._internal_cliseq());
   }
-  if (from.svrseq() != 0) {
-    _internal_set_svrseq(from._internal_svrseq());
+  if (from._internal_svrseq() != 0) {
+    _this->_internal_set_svrseq(from._internal_svrseq());
   }
-}
-
-void Command::CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_copy_from_start:message.Command)
-  if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void Command::CopyFrom(const Command& from) {
@@ -449,222 +433,239 @@ bool Command::IsInitialized() const {
 
 void Command::InternalSwap(Command* other) {
   using std::swap;
-  _internal_metadata_.Swap<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(&other->_internal_metadata_);
-  commands_.InternalSwap(&other->commands_);
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.commands_.InternalSwap(&other->_impl_.commands_);
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(Command, svrseq_)
-      + sizeof(Command::svrseq_)
-      - PROTOBUF_FIELD_OFFSET(Command, cliid_)>(
-          reinterpret_cast<char*>(&cliid_),
-          reinterpret_cast<char*>(&other->cliid_));
+      PROTOBUF_FIELD_OFFSET(Command, _impl_.svrseq_)
+      + sizeof(Command::_impl_.svrseq_)
+      - PROTOBUF_FIELD_OFFSET(Command, _impl_.cliid_)>(
+          reinterpret_cast<char*>(&_impl_.cliid_),
+          reinterpret_cast<char*>(&other->_impl_.cliid_));
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata Command::GetMetadata() const {
-  return GetMetadataStatic();
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_message_2eproto_getter, &descriptor_table_message_2eproto_once,
+      file_level_metadata_message_2eproto[0]);
 }
 
-
 // ===================================================================
 
-void ConsensusObj::InitAsDefaultInstance() {
-}
 class ConsensusObj::_Internal {
  public:
 };
 
-ConsensusObj::ConsensusObj(::PROTOBUF_NAMESPACE_ID::Arena* arena)
-  : ::PROTOBUF_NAMESPACE_ID::Message(arena),
-  cliids_(arena),
-  cliseqs_(arena),
-  commands_(arena) {
-  SharedCtor();
-  RegisterArenaDtor(arena);
+ConsensusObj::ConsensusObj(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:message.ConsensusObj)
 }
 ConsensusObj::ConsensusObj(const ConsensusObj& from)
-  : ::PROTOBUF_NAMESPACE_ID::Message(),
-      cliids_(from.cliids_),
-      cliseqs_(from.cliseqs_),
-      commands_(from.commands_) {
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  ConsensusObj* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.cliids_){from._impl_.cliids_}
+    , /*decltype(_impl_._cliids_cached_byte_size_)*/{0}
+    , decltype(_impl_.cliseqs_){from._impl_.cliseqs_}
+    , /*decltype(_impl_._cliseqs_cached_byte_size_)*/{0}
+    , decltype(_impl_.commands_){from._impl_.commands_}
+    , decltype(_impl_.proid_){}
+    , decltype(_impl_.proseq_){}
+    , decltype(_impl_.svrseq_){}
+    , decltype(_impl_.isnull_){}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  ::memcpy(&proid_, &from.proid_,
-    static_cast<size_t>(reinterpret_cast<char*>(&isnull_) -
-    reinterpret_cast<char*>(&proid_)) + sizeof(isnull_));
+  ::memcpy(&_impl_.proid_, &from._impl_.proid_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.isnull_) -
+    reinterpret_cast<char*>(&_impl_.proid_)) + sizeof(_impl_.isnull_));
   // @@protoc_insertion_point(copy_constructor:message.ConsensusObj)
 }
 
-void ConsensusObj::SharedCtor() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&scc_info_ConsensusObj_message_2eproto.base);
-  ::memset(&proid_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&isnull_) -
-      reinterpret_cast<char*>(&proid_)) + sizeof(isnull_));
+inline void ConsensusObj::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.cliids_){arena}
+    , /*decltype(_impl_._cliids_cached_byte_size_)*/{0}
+    , decltype(_impl_.cliseqs_){arena}
+    , /*decltype(_impl_._cliseqs_cached_byte_size_)*/{0}
+    , decltype(_impl_.commands_){arena}
+    , decltype(_impl_.proid_){0u}
+    , decltype(_impl_.proseq_){0u}
+    , decltype(_impl_.svrseq_){0u}
+    , decltype(_impl_.isnull_){false}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
 }
 
 ConsensusObj::~ConsensusObj() {
   // @@protoc_insertion_point(destructor:message.ConsensusObj)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
   SharedDtor();
-  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-void ConsensusObj::SharedDtor() {
-  GOOGLE_DCHECK(GetArena() == nullptr);
+inline void ConsensusObj::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.cliids_.~RepeatedField();
+  _impl_.cliseqs_.~RepeatedField();
+  _impl_.commands_.~RepeatedPtrField();
 }
 
-void ConsensusObj::ArenaDtor(void* object) {
-  ConsensusObj* _this = reinterpret_cast< ConsensusObj* >(object);
-  (void)_this;
-}
-void ConsensusObj::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
-}
 void ConsensusObj::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
-}
-const ConsensusObj& ConsensusObj::default_instance() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&::scc_info_ConsensusObj_message_2eproto.base);
-  return *internal_default_instance();
+  _impl_._cached_size_.Set(size);
 }
 
-
 void ConsensusObj::Clear() {
 // @@protoc_insertion_point(message_clear_start:message.ConsensusObj)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  cliids_.Clear();
-  cliseqs_.Clear();
-  commands_.Clear();
-  ::memset(&proid_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&isnull_) -
-      reinterpret_cast<char*>(&proid_)) + sizeof(isnull_));
+  _impl_.cliids_.Clear();
+  _impl_.cliseqs_.Clear();
+  _impl_.commands_.Clear();
+  ::memset(&_impl_.proid_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&_impl_.isnull_) -
+      reinterpret_cast<char*>(&_impl_.proid_)) + sizeof(_impl_.isnull_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-const char* ConsensusObj::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+const char* ConsensusObj::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
 #define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
-  ::PROTOBUF_NAMESPACE_ID::Arena* arena = GetArena(); (void)arena;
   while (!ctx->Done(&ptr)) {
-    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
-    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
-    CHK_(ptr);
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
     switch (tag >> 3) {
       // uint32 ProId = 1;
       case 1:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 8)) {
-          proid_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          _impl_.proid_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 ProSeq = 2;
       case 2:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 16)) {
-          proseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          _impl_.proseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 SvrSeq = 3;
       case 3:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 24)) {
-          svrseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _impl_.svrseq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // bool IsNull = 4;
       case 4:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 32)) {
-          isnull_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 32)) {
+          _impl_.isnull_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // repeated uint32 CliIds = 5;
       case 5:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 42)) {
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 42)) {
           ptr = ::PROTOBUF_NAMESPACE_ID::internal::PackedUInt32Parser(_internal_mutable_cliids(), ptr, ctx);
           CHK_(ptr);
-        } else if (static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 40) {
+        } else if (static_cast<uint8_t>(tag) == 40) {
           _internal_add_cliids(::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr));
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // repeated uint32 CliSeqs = 6;
       case 6:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 50)) {
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 50)) {
           ptr = ::PROTOBUF_NAMESPACE_ID::internal::PackedUInt32Parser(_internal_mutable_cliseqs(), ptr, ctx);
           CHK_(ptr);
-        } else if (static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 48) {
+        } else if (static_cast<uint8_t>(tag) == 48) {
           _internal_add_cliseqs(::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr));
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
-      // repeated string Commands = 7;
+      // repeated bytes Commands = 7;
       case 7:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 58)) {
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 58)) {
           ptr -= 1;
           do {
             ptr += 1;
             auto str = _internal_add_commands();
-            ptr = ::PROTOBUF_NAMESPACE_ID::internal::InlineGreedyStringParser(str, ptr, ctx);
-            CHK_(::PROTOBUF_NAMESPACE_ID::internal::VerifyUTF8(str, "message.ConsensusObj.Commands"));
+            ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
             CHK_(ptr);
             if (!ctx->DataAvailable(ptr)) break;
           } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<58>(ptr));
-        } else goto handle_unusual;
-        continue;
-      default: {
-      handle_unusual:
-        if ((tag & 7) == 4 || tag == 0) {
-          ctx->SetLastTag(tag);
-          goto success;
-        }
-        ptr = UnknownFieldParse(tag,
-            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
-            ptr, ctx);
-        CHK_(ptr != nullptr);
+        } else
+          goto handle_unusual;
         continue;
-      }
+      default:
+        goto handle_unusual;
     }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
   }  // while
-success:
+message_done:
   return ptr;
 failure:
   ptr = nullptr;
-  goto success;
+  goto message_done;
 #undef CHK_
 }
 
-::PROTOBUF_NAMESPACE_ID::uint8* ConsensusObj::_InternalSerialize(
-    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+uint8_t* ConsensusObj::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
   // @@protoc_insertion_point(serialize_to_array_start:message.ConsensusObj)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
   // uint32 ProId = 1;
-  if (this->proid() != 0) {
+  if (this->_internal_proid() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(1, this->_internal_proid(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(1, this->_internal_proid(), target);
   }
 
   // uint32 ProSeq = 2;
-  if (this->proseq() != 0) {
+  if (this->_internal_proseq() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(2, this->_internal_proseq(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(2, this->_internal_proseq(), target);
   }
 
   // uint32 SvrSeq = 3;
-  if (this->svrseq() != 0) {
+  if (this->_internal_svrseq() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(3, this->_internal_svrseq(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(3, this->_internal_svrseq(), target);
   }
 
   // bool IsNull = 4;
-  if (this->isnull() != 0) {
+  if (this->_internal_isnull() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteBoolToArray(4, this->_internal_isnull(), target);
+    target = ::_pbi::WireFormatLite::WriteBoolToArray(4, this->_internal_isnull(), target);
   }
 
   // repeated uint32 CliIds = 5;
   {
-    int byte_size = _cliids_cached_byte_size_.load(std::memory_order_relaxed);
+    int byte_size = _impl_._cliids_cached_byte_size_.load(std::memory_order_relaxed);
     if (byte_size > 0) {
       target = stream->WriteUInt32Packed(
           5, _internal_cliids(), byte_size, target);
@@ -673,25 +674,21 @@ failure:
 
   // repeated uint32 CliSeqs = 6;
   {
-    int byte_size = _cliseqs_cached_byte_size_.load(std::memory_order_relaxed);
+    int byte_size = _impl_._cliseqs_cached_byte_size_.load(std::memory_order_relaxed);
     if (byte_size > 0) {
       target = stream->WriteUInt32Packed(
           6, _internal_cliseqs(), byte_size, target);
     }
   }
 
-  // repeated string Commands = 7;
+  // repeated bytes Commands = 7;
   for (int i = 0, n = this->_internal_commands_size(); i < n; i++) {
     const auto& s = this->_internal_commands(i);
-    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
-      s.data(), static_cast<int>(s.length()),
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
-      "message.ConsensusObj.Commands");
-    target = stream->WriteString(7, s, target);
+    target = stream->WriteBytes(7, s, target);
   }
 
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
   }
   // @@protoc_insertion_point(serialize_to_array_end:message.ConsensusObj)
@@ -702,127 +699,100 @@ size_t ConsensusObj::ByteSizeLong() const {
 // @@protoc_insertion_point(message_byte_size_start:message.ConsensusObj)
   size_t total_size = 0;
 
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
   // repeated uint32 CliIds = 5;
   {
-    size_t data_size = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
-      UInt32Size(this->cliids_);
+    size_t data_size = ::_pbi::WireFormatLite::
+      UInt32Size(this->_impl_.cliids_);
     if (data_size > 0) {
       total_size += 1 +
-        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int32Size(
-            static_cast<::PROTOBUF_NAMESPACE_ID::int32>(data_size));
+        ::_pbi::WireFormatLite::Int32Size(static_cast<int32_t>(data_size));
     }
-    int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(data_size);
-    _cliids_cached_byte_size_.store(cached_size,
+    int cached_size = ::_pbi::ToCachedSize(data_size);
+    _impl_._cliids_cached_byte_size_.store(cached_size,
                                     std::memory_order_relaxed);
     total_size += data_size;
   }
 
   // repeated uint32 CliSeqs = 6;
   {
-    size_t data_size = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
-      UInt32Size(this->cliseqs_);
+    size_t data_size = ::_pbi::WireFormatLite::
+      UInt32Size(this->_impl_.cliseqs_);
     if (data_size > 0) {
       total_size += 1 +
-        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int32Size(
-            static_cast<::PROTOBUF_NAMESPACE_ID::int32>(data_size));
+        ::_pbi::WireFormatLite::Int32Size(static_cast<int32_t>(data_size));
     }
-    int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(data_size);
-    _cliseqs_cached_byte_size_.store(cached_size,
+    int cached_size = ::_pbi::ToCachedSize(data_size);
+    _impl_._cliseqs_cached_byte_size_.store(cached_size,
                                     std::memory_order_relaxed);
     total_size += data_size;
   }
 
-  // repeated string Commands = 7;
+  // repeated bytes Commands = 7;
   total_size += 1 *
-      ::PROTOBUF_NAMESPACE_ID::internal::FromIntSize(commands_.size());
-  for (int i = 0, n = commands_.size(); i < n; i++) {
-    total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
-      commands_.Get(i));
+      ::PROTOBUF_NAMESPACE_ID::internal::FromIntSize(_impl_.commands_.size());
+  for (int i = 0, n = _impl_.commands_.size(); i < n; i++) {
+    total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::BytesSize(
+      _impl_.commands_.Get(i));
   }
 
   // uint32 ProId = 1;
-  if (this->proid() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_proid());
+  if (this->_internal_proid() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_proid());
   }
 
   // uint32 ProSeq = 2;
-  if (this->proseq() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_proseq());
+  if (this->_internal_proseq() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_proseq());
   }
 
   // uint32 SvrSeq = 3;
-  if (this->svrseq() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_svrseq());
+  if (this->_internal_svrseq() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_svrseq());
   }
 
   // bool IsNull = 4;
-  if (this->isnull() != 0) {
+  if (this->_internal_isnull() != 0) {
     total_size += 1 + 1;
   }
 
-  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
-        _internal_metadata_, total_size, &_cached_size_);
-  }
-  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
-  SetCachedSize(cached_size);
-  return total_size;
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
-void ConsensusObj::MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_merge_from_start:message.ConsensusObj)
-  GOOGLE_DCHECK_NE(&from, this);
-  const ConsensusObj* source =
-      ::PROTOBUF_NAMESPACE_ID::DynamicCastToGenerated<ConsensusObj>(
-          &from);
-  if (source == nullptr) {
-  // @@protoc_insertion_point(generalized_merge_from_cast_fail:message.ConsensusObj)
-    ::PROTOBUF_NAMESPACE_ID::internal::ReflectionOps::Merge(from, this);
-  } else {
-  // @@protoc_insertion_point(generalized_merge_from_cast_success:message.ConsensusObj)
-    MergeFrom(*source);
-  }
-}
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData ConsensusObj::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    ConsensusObj::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*ConsensusObj::GetClassData() const { return &_class_data_; }
 
-void ConsensusObj::MergeFrom(const ConsensusObj& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:message.ConsensusObj)
-  GOOGLE_DCHECK_NE(&from, this);
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+
+void ConsensusObj::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<ConsensusObj*>(&to_msg);
+  auto& from = static_cast<const ConsensusObj&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:message.ConsensusObj)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
-  cliids_.MergeFrom(from.cliids_);
-  cliseqs_.MergeFrom(from.cliseqs_);
-  commands_.MergeFrom(from.commands_);
-  if (from.proid() != 0) {
-    _internal_set_proid(from._internal_proid());
+  _this->_impl_.cliids_.MergeFrom(from._impl_.cliids_);
+  _this->_impl_.cliseqs_.MergeFrom(from._impl_.cliseqs_);
+  _this->_impl_.commands_.MergeFrom(from._impl_.commands_);
+  if (from._internal_proid() != 0) {
+    _this->_internal_set_proid(from._internal_proid());
   }
-  if (from.proseq() != 0) {
-    _internal_set_proseq(from._internal_proseq());
+  if (from._internal_proseq() != 0) {
+    _this->_internal_set_proseq(from._internal_proseq());
   }
-  if (from.svrseq() != 0) {
-    _internal_set_svrseq(from._internal_svrseq());
+  if (from._internal_svrseq() != 0) {
+    _this->_internal_set_svrseq(from._internal_svrseq());
   }
-  if (from.isnull() != 0) {
-    _internal_set_isnull(from._internal_isnull());
+  if (from._internal_isnull() != 0) {
+    _this->_internal_set_isnull(from._internal_isnull());
   }
-}
-
-void ConsensusObj::CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_copy_from_start:message.ConsensusObj)
-  if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void ConsensusObj::CopyFrom(const ConsensusObj& from) {
@@ -838,29 +808,26 @@ bool ConsensusObj::IsInitialized() const {
 
 void ConsensusObj::InternalSwap(ConsensusObj* other) {
   using std::swap;
-  _internal_metadata_.Swap<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(&other->_internal_metadata_);
-  cliids_.InternalSwap(&other->cliids_);
-  cliseqs_.InternalSwap(&other->cliseqs_);
-  commands_.InternalSwap(&other->commands_);
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.cliids_.InternalSwap(&other->_impl_.cliids_);
+  _impl_.cliseqs_.InternalSwap(&other->_impl_.cliseqs_);
+  _impl_.commands_.InternalSwap(&other->_impl_.commands_);
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(ConsensusObj, isnull_)
-      + sizeof(ConsensusObj::isnull_)
-      - PROTOBUF_FIELD_OFFSET(ConsensusObj, proid_)>(
-          reinterpret_cast<char*>(&proid_),
-          reinterpret_cast<char*>(&other->proid_));
+      PROTOBUF_FIELD_OFFSET(ConsensusObj, _impl_.isnull_)
+      + sizeof(ConsensusObj::_impl_.isnull_)
+      - PROTOBUF_FIELD_OFFSET(ConsensusObj, _impl_.proid_)>(
+          reinterpret_cast<char*>(&_impl_.proid_),
+          reinterpret_cast<char*>(&other->_impl_.proid_));
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata ConsensusObj::GetMetadata() const {
-  return GetMetadataStatic();
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_message_2eproto_getter, &descriptor_table_message_2eproto_once,
+      file_level_metadata_message_2eproto[1]);
 }
 
-
 // ===================================================================
 
-void Msg::InitAsDefaultInstance() {
-  ::message::_Msg_default_instance_._instance.get_mutable()->obj_ = const_cast< ::message::ConsensusObj*>(
-      ::message::ConsensusObj::internal_default_instance());
-}
 class Msg::_Internal {
  public:
   static const ::message::ConsensusObj& obj(const Msg* msg);
@@ -868,171 +835,208 @@ class Msg::_Internal {
 
 const ::message::ConsensusObj&
 Msg::_Internal::obj(const Msg* msg) {
-  return *msg->obj_;
+  return *msg->_impl_.obj_;
 }
-Msg::Msg(::PROTOBUF_NAMESPACE_ID::Arena* arena)
-  : ::PROTOBUF_NAMESPACE_ID::Message(arena) {
-  SharedCtor();
-  RegisterArenaDtor(arena);
+Msg::Msg(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:message.Msg)
 }
 Msg::Msg(const Msg& from)
   : ::PROTOBUF_NAMESPACE_ID::Message() {
+  Msg* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.frames_){}
+    , decltype(_impl_.obj_){nullptr}
+    , decltype(_impl_.type_){}
+    , decltype(_impl_.phase_){}
+    , decltype(_impl_.value_){}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _impl_.frames_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.frames_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (!from._internal_frames().empty()) {
+    _this->_impl_.frames_.Set(from._internal_frames(), 
+      _this->GetArenaForAllocation());
+  }
   if (from._internal_has_obj()) {
-    obj_ = new ::message::ConsensusObj(*from.obj_);
-  } else {
-    obj_ = nullptr;
+    _this->_impl_.obj_ = new ::message::ConsensusObj(*from._impl_.obj_);
   }
-  ::memcpy(&type_, &from.type_,
-    static_cast<size_t>(reinterpret_cast<char*>(&value_) -
-    reinterpret_cast<char*>(&type_)) + sizeof(value_));
+  ::memcpy(&_impl_.type_, &from._impl_.type_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.value_) -
+    reinterpret_cast<char*>(&_impl_.type_)) + sizeof(_impl_.value_));
   // @@protoc_insertion_point(copy_constructor:message.Msg)
 }
 
-void Msg::SharedCtor() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&scc_info_Msg_message_2eproto.base);
-  ::memset(&obj_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&value_) -
-      reinterpret_cast<char*>(&obj_)) + sizeof(value_));
+inline void Msg::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.frames_){}
+    , decltype(_impl_.obj_){nullptr}
+    , decltype(_impl_.type_){0}
+    , decltype(_impl_.phase_){0u}
+    , decltype(_impl_.value_){0u}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+  _impl_.frames_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.frames_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
 }
 
 Msg::~Msg() {
   // @@protoc_insertion_point(destructor:message.Msg)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
   SharedDtor();
-  _internal_metadata_.Delete<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-void Msg::SharedDtor() {
-  GOOGLE_DCHECK(GetArena() == nullptr);
-  if (this != internal_default_instance()) delete obj_;
+inline void Msg::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.frames_.Destroy();
+  if (this != internal_default_instance()) delete _impl_.obj_;
 }
 
-void Msg::ArenaDtor(void* object) {
-  Msg* _this = reinterpret_cast< Msg* >(object);
-  (void)_this;
-}
-void Msg::RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena*) {
-}
 void Msg::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
+  _impl_._cached_size_.Set(size);
 }
-const Msg& Msg::default_instance() {
-  ::PROTOBUF_NAMESPACE_ID::internal::InitSCC(&::scc_info_Msg_message_2eproto.base);
-  return *internal_default_instance();
-}
-
 
 void Msg::Clear() {
 // @@protoc_insertion_point(message_clear_start:message.Msg)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  if (GetArena() == nullptr && obj_ != nullptr) {
-    delete obj_;
+  _impl_.frames_.ClearToEmpty();
+  if (GetArenaForAllocation() == nullptr && _impl_.obj_ != nullptr) {
+    delete _impl_.obj_;
   }
-  obj_ = nullptr;
-  ::memset(&type_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&value_) -
-      reinterpret_cast<char*>(&type_)) + sizeof(value_));
+  _impl_.obj_ = nullptr;
+  ::memset(&_impl_.type_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&_impl_.value_) -
+      reinterpret_cast<char*>(&_impl_.type_)) + sizeof(_impl_.value_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
-const char* Msg::_InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) {
+const char* Msg::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
 #define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
-  ::PROTOBUF_NAMESPACE_ID::Arena* arena = GetArena(); (void)arena;
   while (!ctx->Done(&ptr)) {
-    ::PROTOBUF_NAMESPACE_ID::uint32 tag;
-    ptr = ::PROTOBUF_NAMESPACE_ID::internal::ReadTag(ptr, &tag);
-    CHK_(ptr);
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
     switch (tag >> 3) {
       // .message.MsgType Type = 1;
       case 1:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 8)) {
-          ::PROTOBUF_NAMESPACE_ID::uint64 val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          uint64_t val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
           CHK_(ptr);
           _internal_set_type(static_cast<::message::MsgType>(val));
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 Phase = 2;
       case 2:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 16)) {
-          phase_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          _impl_.phase_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // uint32 Value = 3;
       case 3:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 24)) {
-          value_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _impl_.value_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
       // .message.ConsensusObj Obj = 4;
       case 4:
-        if (PROTOBUF_PREDICT_TRUE(static_cast<::PROTOBUF_NAMESPACE_ID::uint8>(tag) == 34)) {
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 34)) {
           ptr = ctx->ParseMessage(_internal_mutable_obj(), ptr);
           CHK_(ptr);
-        } else goto handle_unusual;
+        } else
+          goto handle_unusual;
         continue;
-      default: {
-      handle_unusual:
-        if ((tag & 7) == 4 || tag == 0) {
-          ctx->SetLastTag(tag);
-          goto success;
-        }
-        ptr = UnknownFieldParse(tag,
-            _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
-            ptr, ctx);
-        CHK_(ptr != nullptr);
+      // bytes Frames = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 42)) {
+          auto str = _internal_mutable_frames();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
         continue;
-      }
+      default:
+        goto handle_unusual;
     }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
   }  // while
-success:
+message_done:
   return ptr;
 failure:
   ptr = nullptr;
-  goto success;
+  goto message_done;
 #undef CHK_
 }
 
-::PROTOBUF_NAMESPACE_ID::uint8* Msg::_InternalSerialize(
-    ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+uint8_t* Msg::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
   // @@protoc_insertion_point(serialize_to_array_start:message.Msg)
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
   // .message.MsgType Type = 1;
-  if (this->type() != 0) {
+  if (this->_internal_type() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteEnumToArray(
+    target = ::_pbi::WireFormatLite::WriteEnumToArray(
       1, this->_internal_type(), target);
   }
 
   // uint32 Phase = 2;
-  if (this->phase() != 0) {
+  if (this->_internal_phase() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(2, this->_internal_phase(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(2, this->_internal_phase(), target);
   }
 
   // uint32 Value = 3;
-  if (this->value() != 0) {
+  if (this->_internal_value() != 0) {
     target = stream->EnsureSpace(target);
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(3, this->_internal_value(), target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(3, this->_internal_value(), target);
   }
 
   // .message.ConsensusObj Obj = 4;
-  if (this->has_obj()) {
-    target = stream->EnsureSpace(target);
+  if (this->_internal_has_obj()) {
     target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
-      InternalWriteMessage(
-        4, _Internal::obj(this), target, stream);
+      InternalWriteMessage(4, _Internal::obj(this),
+        _Internal::obj(this).GetCachedSize(), target, stream);
+  }
+
+  // bytes Frames = 5;
+  if (!this->_internal_frames().empty()) {
+    target = stream->WriteBytesMaybeAliased(
+        5, this->_internal_frames(), target);
   }
 
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::InternalSerializeUnknownFieldsToArray(
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
   }
   // @@protoc_insertion_point(serialize_to_array_end:message.Msg)
@@ -1043,87 +1047,75 @@ size_t Msg::ByteSizeLong() const {
 // @@protoc_insertion_point(message_byte_size_start:message.Msg)
   size_t total_size = 0;
 
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+  uint32_t cached_has_bits = 0;
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
+  // bytes Frames = 5;
+  if (!this->_internal_frames().empty()) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::BytesSize(
+        this->_internal_frames());
+  }
+
   // .message.ConsensusObj Obj = 4;
-  if (this->has_obj()) {
+  if (this->_internal_has_obj()) {
     total_size += 1 +
       ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
-        *obj_);
+        *_impl_.obj_);
   }
 
   // .message.MsgType Type = 1;
-  if (this->type() != 0) {
+  if (this->_internal_type() != 0) {
     total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::EnumSize(this->_internal_type());
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_type());
   }
 
   // uint32 Phase = 2;
-  if (this->phase() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_phase());
+  if (this->_internal_phase() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_phase());
   }
 
   // uint32 Value = 3;
-  if (this->value() != 0) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32Size(
-        this->_internal_value());
+  if (this->_internal_value() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_value());
   }
 
-  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
-    return ::PROTOBUF_NAMESPACE_ID::internal::ComputeUnknownFieldsSize(
-        _internal_metadata_, total_size, &_cached_size_);
-  }
-  int cached_size = ::PROTOBUF_NAMESPACE_ID::internal::ToCachedSize(total_size);
-  SetCachedSize(cached_size);
-  return total_size;
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
-void Msg::MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_merge_from_start:message.Msg)
-  GOOGLE_DCHECK_NE(&from, this);
-  const Msg* source =
-      ::PROTOBUF_NAMESPACE_ID::DynamicCastToGenerated<Msg>(
-          &from);
-  if (source == nullptr) {
-  // @@protoc_insertion_point(generalized_merge_from_cast_fail:message.Msg)
-    ::PROTOBUF_NAMESPACE_ID::internal::ReflectionOps::Merge(from, this);
-  } else {
-  // @@protoc_insertion_point(generalized_merge_from_cast_success:message.Msg)
-    MergeFrom(*source);
-  }
-}
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData Msg::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    Msg::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Msg::GetClassData() const { return &_class_data_; }
 
-void Msg::MergeFrom(const Msg& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:message.Msg)
-  GOOGLE_DCHECK_NE(&from, this);
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  ::PROTOBUF_NAMESPACE_ID::uint32 cached_has_bits = 0;
+
+void Msg::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<Msg*>(&to_msg);
+  auto& from = static_cast<const Msg&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:message.Msg)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
-  if (from.has_obj()) {
-    _internal_mutable_obj()->::message::ConsensusObj::MergeFrom(from._internal_obj());
+  if (!from._internal_frames().empty()) {
+    _this->_internal_set_frames(from._internal_frames());
+  }
+  if (from._internal_has_obj()) {
+    _this->_internal_mutable_obj()->::message::ConsensusObj::MergeFrom(
+        from._internal_obj());
   }
-  if (from.type() != 0) {
-    _internal_set_type(from._internal_type());
+  if (from._internal_type() != 0) {
+    _this->_internal_set_type(from._internal_type());
   }
-  if (from.phase() != 0) {
-    _internal_set_phase(from._internal_phase());
+  if (from._internal_phase() != 0) {
+    _this->_internal_set_phase(from._internal_phase());
   }
-  if (from.value() != 0) {
-    _internal_set_value(from._internal_value());
+  if (from._internal_value() != 0) {
+    _this->_internal_set_value(from._internal_value());
   }
-}
-
-void Msg::CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-// @@protoc_insertion_point(generalized_copy_from_start:message.Msg)
-  if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void Msg::CopyFrom(const Msg& from) {
@@ -1139,30 +1131,40 @@ bool Msg::IsInitialized() const {
 
 void Msg::InternalSwap(Msg* other) {
   using std::swap;
-  _internal_metadata_.Swap<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(&other->_internal_metadata_);
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.frames_, lhs_arena,
+      &other->_impl_.frames_, rhs_arena
+  );
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(Msg, value_)
-      + sizeof(Msg::value_)
-      - PROTOBUF_FIELD_OFFSET(Msg, obj_)>(
-          reinterpret_cast<char*>(&obj_),
-          reinterpret_cast<char*>(&other->obj_));
+      PROTOBUF_FIELD_OFFSET(Msg, _impl_.value_)
+      + sizeof(Msg::_impl_.value_)
+      - PROTOBUF_FIELD_OFFSET(Msg, _impl_.obj_)>(
+          reinterpret_cast<char*>(&_impl_.obj_),
+          reinterpret_cast<char*>(&other->_impl_.obj_));
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata Msg::GetMetadata() const {
-  return GetMetadataStatic();
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_message_2eproto_getter, &descriptor_table_message_2eproto_once,
+      file_level_metadata_message_2eproto[2]);
 }
 
-
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace message
 PROTOBUF_NAMESPACE_OPEN
-template<> PROTOBUF_NOINLINE ::message::Command* Arena::CreateMaybeMessage< ::message::Command >(Arena* arena) {
+template<> PROTOBUF_NOINLINE ::message::Command*
+Arena::CreateMaybeMessage< ::message::Command >(Arena* arena) {
   return Arena::CreateMessageInternal< ::message::Command >(arena);
 }
-template<> PROTOBUF_NOINLINE ::message::ConsensusObj* Arena::CreateMaybeMessage< ::message::ConsensusObj >(Arena* arena) {
+template<> PROTOBUF_NOINLINE ::message::ConsensusObj*
+Arena::CreateMaybeMessage< ::message::ConsensusObj >(Arena* arena) {
   return Arena::CreateMessageInternal< ::message::ConsensusObj >(arena);
 }
-template<> PROTOBUF_NOINLINE ::message::Msg* Arena::CreateMaybeMessage< ::message::Msg >(Arena* arena) {
+template<> PROTOBUF_NOINLINE ::message::Msg*
+Arena::CreateMaybeMessage< ::message::Msg >(Arena* arena) {
   return Arena::CreateMessageInternal< ::message::Msg >(arena);
 }
 PROTOBUF_NAMESPACE_CLOSE
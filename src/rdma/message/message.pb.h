@@ -8,12 +8,12 @@
 #include <string>
 
 #include <google/protobuf/port_def.inc>
-#if PROTOBUF_VERSION < 3012000
+#if PROTOBUF_VERSION < 3021000
 #error This file was generated by a newer version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please update
 #error your headers.
 #endif
-#if 3012004 < PROTOBUF_MIN_PROTOC_VERSION
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
 #error This file was generated by an older version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please
 #error regenerate this file with a newer version of protoc.
@@ -23,9 +23,7 @@
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/arena.h>
 #include <google/protobuf/arenastring.h>
-#include <google/protobuf/generated_message_table_driven.h>
 #include <google/protobuf/generated_message_util.h>
-#include <google/protobuf/inlined_string_field.h>
 #include <google/protobuf/metadata_lite.h>
 #include <google/protobuf/generated_message_reflection.h>
 #include <google/protobuf/message.h>
@@ -44,26 +42,18 @@ PROTOBUF_NAMESPACE_CLOSE
 
 // Internal implementation detail -- do not use these members.
 struct TableStruct_message_2eproto {
-  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTableField entries[]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::AuxillaryParseTableField aux[]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::ParseTable schema[3]
-    PROTOBUF_SECTION_VARIABLE(protodesc_cold);
-  static const ::PROTOBUF_NAMESPACE_ID::internal::FieldMetadata field_metadata[];
-  static const ::PROTOBUF_NAMESPACE_ID::internal::SerializationTable serialization_table[];
-  static const ::PROTOBUF_NAMESPACE_ID::uint32 offsets[];
+  static const uint32_t offsets[];
 };
 extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_message_2eproto;
 namespace message {
 class Command;
-class CommandDefaultTypeInternal;
+struct CommandDefaultTypeInternal;
 extern CommandDefaultTypeInternal _Command_default_instance_;
 class ConsensusObj;
-class ConsensusObjDefaultTypeInternal;
+struct ConsensusObjDefaultTypeInternal;
 extern ConsensusObjDefaultTypeInternal _ConsensusObj_default_instance_;
 class Msg;
-class MsgDefaultTypeInternal;
+struct MsgDefaultTypeInternal;
 extern MsgDefaultTypeInternal _Msg_default_instance_;
 }  // namespace message
 PROTOBUF_NAMESPACE_OPEN
@@ -81,12 +71,13 @@ enum MsgType : int {
   ProposalRequest = 4,
   ProposalReply = 5,
   Decision = 6,
-  MsgType_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<::PROTOBUF_NAMESPACE_ID::int32>::min(),
-  MsgType_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<::PROTOBUF_NAMESPACE_ID::int32>::max()
+  Batch = 7,
+  MsgType_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  MsgType_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
 };
 bool MsgType_IsValid(int value);
 constexpr MsgType MsgType_MIN = ClientRequest;
-constexpr MsgType MsgType_MAX = Decision;
+constexpr MsgType MsgType_MAX = Batch;
 constexpr int MsgType_ARRAYSIZE = MsgType_MAX + 1;
 
 const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* MsgType_descriptor();
@@ -99,17 +90,18 @@ inline const std::string& MsgType_Name(T enum_t_value) {
     MsgType_descriptor(), enum_t_value);
 }
 inline bool MsgType_Parse(
-    const std::string& name, MsgType* value) {
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, MsgType* value) {
   return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<MsgType>(
     MsgType_descriptor(), name, value);
 }
 // ===================================================================
 
-class Command PROTOBUF_FINAL :
+class Command final :
     public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:message.Command) */ {
  public:
-  inline Command() : Command(nullptr) {};
-  virtual ~Command();
+  inline Command() : Command(nullptr) {}
+  ~Command() override;
+  explicit PROTOBUF_CONSTEXPR Command(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
 
   Command(const Command& from);
   Command(Command&& from) noexcept
@@ -122,8 +114,13 @@ class Command PROTOBUF_FINAL :
     return *this;
   }
   inline Command& operator=(Command&& from) noexcept {
-    if (GetArena() == from.GetArena()) {
-      if (this != &from) InternalSwap(&from);
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
     } else {
       CopyFrom(from);
     }
@@ -134,14 +131,14 @@ class Command PROTOBUF_FINAL :
     return GetDescriptor();
   }
   static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
-    return GetMetadataStatic().descriptor;
+    return default_instance().GetMetadata().descriptor;
   }
   static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
-    return GetMetadataStatic().reflection;
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Command& default_instance() {
+    return *internal_default_instance();
   }
-  static const Command& default_instance();
-
-  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
   static inline const Command* internal_default_instance() {
     return reinterpret_cast<const Command*>(
                &_Command_default_instance_);
@@ -154,7 +151,12 @@ class Command PROTOBUF_FINAL :
   }
   inline void Swap(Command* other) {
     if (other == this) return;
-    if (GetArena() == other->GetArena()) {
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
       InternalSwap(other);
     } else {
       ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
@@ -162,56 +164,53 @@ class Command PROTOBUF_FINAL :
   }
   void UnsafeArenaSwap(Command* other) {
     if (other == this) return;
-    GOOGLE_DCHECK(GetArena() == other->GetArena());
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
     InternalSwap(other);
   }
 
   // implements Message ----------------------------------------------
 
-  inline Command* New() const final {
-    return CreateMaybeMessage<Command>(nullptr);
-  }
-
-  Command* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+  Command* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
     return CreateMaybeMessage<Command>(arena);
   }
-  void CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
-  void MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const Command& from);
-  void MergeFrom(const Command& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const Command& from) {
+    Command::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
 
   size_t ByteSizeLong() const final;
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
-  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
-      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  inline void SharedCtor();
-  inline void SharedDtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(Command* other);
+
+  private:
   friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
   static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
     return "message.Command";
   }
   protected:
-  explicit Command(::PROTOBUF_NAMESPACE_ID::Arena* arena);
-  private:
-  static void ArenaDtor(void* object);
-  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  explicit Command(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
   public:
 
-  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
-  private:
-  static ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadataStatic() {
-    ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&::descriptor_table_message_2eproto);
-    return ::descriptor_table_message_2eproto.file_level_metadata[kIndexInFileMessages];
-  }
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
 
-  public:
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
 
   // nested types ----------------------------------------------------
 
@@ -223,7 +222,7 @@ class Command PROTOBUF_FINAL :
     kCliSeqFieldNumber = 2,
     kSvrSeqFieldNumber = 3,
   };
-  // repeated string Commands = 4;
+  // repeated bytes Commands = 4;
   int commands_size() const;
   private:
   int _internal_commands_size() const;
@@ -234,12 +233,12 @@ class Command PROTOBUF_FINAL :
   void set_commands(int index, const std::string& value);
   void set_commands(int index, std::string&& value);
   void set_commands(int index, const char* value);
-  void set_commands(int index, const char* value, size_t size);
+  void set_commands(int index, const void* value, size_t size);
   std::string* add_commands();
   void add_commands(const std::string& value);
   void add_commands(std::string&& value);
   void add_commands(const char* value);
-  void add_commands(const char* value, size_t size);
+  void add_commands(const void* value, size_t size);
   const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>& commands() const;
   ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>* mutable_commands();
   private:
@@ -249,29 +248,29 @@ class Command PROTOBUF_FINAL :
 
   // uint32 CliId = 1;
   void clear_cliid();
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliid() const;
-  void set_cliid(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t cliid() const;
+  void set_cliid(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_cliid() const;
-  void _internal_set_cliid(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_cliid() const;
+  void _internal_set_cliid(uint32_t value);
   public:
 
   // uint32 CliSeq = 2;
   void clear_cliseq();
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliseq() const;
-  void set_cliseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t cliseq() const;
+  void set_cliseq(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_cliseq() const;
-  void _internal_set_cliseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_cliseq() const;
+  void _internal_set_cliseq(uint32_t value);
   public:
 
   // uint32 SvrSeq = 3;
   void clear_svrseq();
-  ::PROTOBUF_NAMESPACE_ID::uint32 svrseq() const;
-  void set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t svrseq() const;
+  void set_svrseq(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_svrseq() const;
-  void _internal_set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_svrseq() const;
+  void _internal_set_svrseq(uint32_t value);
   public:
 
   // @@protoc_insertion_point(class_scope:message.Command)
@@ -281,20 +280,24 @@ class Command PROTOBUF_FINAL :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string> commands_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliid_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliseq_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 svrseq_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string> commands_;
+    uint32_t cliid_;
+    uint32_t cliseq_;
+    uint32_t svrseq_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_message_2eproto;
 };
 // -------------------------------------------------------------------
 
-class ConsensusObj PROTOBUF_FINAL :
+class ConsensusObj final :
     public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:message.ConsensusObj) */ {
  public:
-  inline ConsensusObj() : ConsensusObj(nullptr) {};
-  virtual ~ConsensusObj();
+  inline ConsensusObj() : ConsensusObj(nullptr) {}
+  ~ConsensusObj() override;
+  explicit PROTOBUF_CONSTEXPR ConsensusObj(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
 
   ConsensusObj(const ConsensusObj& from);
   ConsensusObj(ConsensusObj&& from) noexcept
@@ -307,8 +310,13 @@ class ConsensusObj PROTOBUF_FINAL :
     return *this;
   }
   inline ConsensusObj& operator=(ConsensusObj&& from) noexcept {
-    if (GetArena() == from.GetArena()) {
-      if (this != &from) InternalSwap(&from);
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
     } else {
       CopyFrom(from);
     }
@@ -319,14 +327,14 @@ class ConsensusObj PROTOBUF_FINAL :
     return GetDescriptor();
   }
   static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
-    return GetMetadataStatic().descriptor;
+    return default_instance().GetMetadata().descriptor;
   }
   static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
-    return GetMetadataStatic().reflection;
+    return default_instance().GetMetadata().reflection;
+  }
+  static const ConsensusObj& default_instance() {
+    return *internal_default_instance();
   }
-  static const ConsensusObj& default_instance();
-
-  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
   static inline const ConsensusObj* internal_default_instance() {
     return reinterpret_cast<const ConsensusObj*>(
                &_ConsensusObj_default_instance_);
@@ -339,7 +347,12 @@ class ConsensusObj PROTOBUF_FINAL :
   }
   inline void Swap(ConsensusObj* other) {
     if (other == this) return;
-    if (GetArena() == other->GetArena()) {
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
       InternalSwap(other);
     } else {
       ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
@@ -347,56 +360,53 @@ class ConsensusObj PROTOBUF_FINAL :
   }
   void UnsafeArenaSwap(ConsensusObj* other) {
     if (other == this) return;
-    GOOGLE_DCHECK(GetArena() == other->GetArena());
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
     InternalSwap(other);
   }
 
   // implements Message ----------------------------------------------
 
-  inline ConsensusObj* New() const final {
-    return CreateMaybeMessage<ConsensusObj>(nullptr);
-  }
-
-  ConsensusObj* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+  ConsensusObj* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
     return CreateMaybeMessage<ConsensusObj>(arena);
   }
-  void CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
-  void MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const ConsensusObj& from);
-  void MergeFrom(const ConsensusObj& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const ConsensusObj& from) {
+    ConsensusObj::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
 
   size_t ByteSizeLong() const final;
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
-  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
-      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  inline void SharedCtor();
-  inline void SharedDtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(ConsensusObj* other);
+
+  private:
   friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
   static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
     return "message.ConsensusObj";
   }
   protected:
-  explicit ConsensusObj(::PROTOBUF_NAMESPACE_ID::Arena* arena);
-  private:
-  static void ArenaDtor(void* object);
-  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  explicit ConsensusObj(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
   public:
 
-  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
-  private:
-  static ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadataStatic() {
-    ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&::descriptor_table_message_2eproto);
-    return ::descriptor_table_message_2eproto.file_level_metadata[kIndexInFileMessages];
-  }
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
 
-  public:
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
 
   // nested types ----------------------------------------------------
 
@@ -418,19 +428,19 @@ class ConsensusObj PROTOBUF_FINAL :
   public:
   void clear_cliids();
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_cliids(int index) const;
-  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+  uint32_t _internal_cliids(int index) const;
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
       _internal_cliids() const;
-  void _internal_add_cliids(::PROTOBUF_NAMESPACE_ID::uint32 value);
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+  void _internal_add_cliids(uint32_t value);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
       _internal_mutable_cliids();
   public:
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliids(int index) const;
-  void set_cliids(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value);
-  void add_cliids(::PROTOBUF_NAMESPACE_ID::uint32 value);
-  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+  uint32_t cliids(int index) const;
+  void set_cliids(int index, uint32_t value);
+  void add_cliids(uint32_t value);
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
       cliids() const;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
       mutable_cliids();
 
   // repeated uint32 CliSeqs = 6;
@@ -440,22 +450,22 @@ class ConsensusObj PROTOBUF_FINAL :
   public:
   void clear_cliseqs();
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_cliseqs(int index) const;
-  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+  uint32_t _internal_cliseqs(int index) const;
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
       _internal_cliseqs() const;
-  void _internal_add_cliseqs(::PROTOBUF_NAMESPACE_ID::uint32 value);
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+  void _internal_add_cliseqs(uint32_t value);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
       _internal_mutable_cliseqs();
   public:
-  ::PROTOBUF_NAMESPACE_ID::uint32 cliseqs(int index) const;
-  void set_cliseqs(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value);
-  void add_cliseqs(::PROTOBUF_NAMESPACE_ID::uint32 value);
-  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+  uint32_t cliseqs(int index) const;
+  void set_cliseqs(int index, uint32_t value);
+  void add_cliseqs(uint32_t value);
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
       cliseqs() const;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+  ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
       mutable_cliseqs();
 
-  // repeated string Commands = 7;
+  // repeated bytes Commands = 7;
   int commands_size() const;
   private:
   int _internal_commands_size() const;
@@ -466,12 +476,12 @@ class ConsensusObj PROTOBUF_FINAL :
   void set_commands(int index, const std::string& value);
   void set_commands(int index, std::string&& value);
   void set_commands(int index, const char* value);
-  void set_commands(int index, const char* value, size_t size);
+  void set_commands(int index, const void* value, size_t size);
   std::string* add_commands();
   void add_commands(const std::string& value);
   void add_commands(std::string&& value);
   void add_commands(const char* value);
-  void add_commands(const char* value, size_t size);
+  void add_commands(const void* value, size_t size);
   const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>& commands() const;
   ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>* mutable_commands();
   private:
@@ -481,29 +491,29 @@ class ConsensusObj PROTOBUF_FINAL :
 
   // uint32 ProId = 1;
   void clear_proid();
-  ::PROTOBUF_NAMESPACE_ID::uint32 proid() const;
-  void set_proid(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t proid() const;
+  void set_proid(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_proid() const;
-  void _internal_set_proid(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_proid() const;
+  void _internal_set_proid(uint32_t value);
   public:
 
   // uint32 ProSeq = 2;
   void clear_proseq();
-  ::PROTOBUF_NAMESPACE_ID::uint32 proseq() const;
-  void set_proseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t proseq() const;
+  void set_proseq(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_proseq() const;
-  void _internal_set_proseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_proseq() const;
+  void _internal_set_proseq(uint32_t value);
   public:
 
   // uint32 SvrSeq = 3;
   void clear_svrseq();
-  ::PROTOBUF_NAMESPACE_ID::uint32 svrseq() const;
-  void set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t svrseq() const;
+  void set_svrseq(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_svrseq() const;
-  void _internal_set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_svrseq() const;
+  void _internal_set_svrseq(uint32_t value);
   public:
 
   // bool IsNull = 4;
@@ -522,25 +532,29 @@ class ConsensusObj PROTOBUF_FINAL :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 > cliids_;
-  mutable std::atomic<int> _cliids_cached_byte_size_;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 > cliseqs_;
-  mutable std::atomic<int> _cliseqs_cached_byte_size_;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string> commands_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 proid_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 proseq_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 svrseq_;
-  bool isnull_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t > cliids_;
+    mutable std::atomic<int> _cliids_cached_byte_size_;
+    ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t > cliseqs_;
+    mutable std::atomic<int> _cliseqs_cached_byte_size_;
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string> commands_;
+    uint32_t proid_;
+    uint32_t proseq_;
+    uint32_t svrseq_;
+    bool isnull_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_message_2eproto;
 };
 // -------------------------------------------------------------------
 
-class Msg PROTOBUF_FINAL :
+class Msg final :
     public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:message.Msg) */ {
  public:
-  inline Msg() : Msg(nullptr) {};
-  virtual ~Msg();
+  inline Msg() : Msg(nullptr) {}
+  ~Msg() override;
+  explicit PROTOBUF_CONSTEXPR Msg(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
 
   Msg(const Msg& from);
   Msg(Msg&& from) noexcept
@@ -553,8 +567,13 @@ class Msg PROTOBUF_FINAL :
     return *this;
   }
   inline Msg& operator=(Msg&& from) noexcept {
-    if (GetArena() == from.GetArena()) {
-      if (this != &from) InternalSwap(&from);
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
     } else {
       CopyFrom(from);
     }
@@ -565,14 +584,14 @@ class Msg PROTOBUF_FINAL :
     return GetDescriptor();
   }
   static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
-    return GetMetadataStatic().descriptor;
+    return default_instance().GetMetadata().descriptor;
   }
   static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
-    return GetMetadataStatic().reflection;
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Msg& default_instance() {
+    return *internal_default_instance();
   }
-  static const Msg& default_instance();
-
-  static void InitAsDefaultInstance();  // FOR INTERNAL USE ONLY
   static inline const Msg* internal_default_instance() {
     return reinterpret_cast<const Msg*>(
                &_Msg_default_instance_);
@@ -585,7 +604,12 @@ class Msg PROTOBUF_FINAL :
   }
   inline void Swap(Msg* other) {
     if (other == this) return;
-    if (GetArena() == other->GetArena()) {
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
       InternalSwap(other);
     } else {
       ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
@@ -593,67 +617,79 @@ class Msg PROTOBUF_FINAL :
   }
   void UnsafeArenaSwap(Msg* other) {
     if (other == this) return;
-    GOOGLE_DCHECK(GetArena() == other->GetArena());
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
     InternalSwap(other);
   }
 
   // implements Message ----------------------------------------------
 
-  inline Msg* New() const final {
-    return CreateMaybeMessage<Msg>(nullptr);
-  }
-
-  Msg* New(::PROTOBUF_NAMESPACE_ID::Arena* arena) const final {
+  Msg* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
     return CreateMaybeMessage<Msg>(arena);
   }
-  void CopyFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
-  void MergeFrom(const ::PROTOBUF_NAMESPACE_ID::Message& from) final;
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const Msg& from);
-  void MergeFrom(const Msg& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const Msg& from) {
+    Msg::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
 
   size_t ByteSizeLong() const final;
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
-  ::PROTOBUF_NAMESPACE_ID::uint8* _InternalSerialize(
-      ::PROTOBUF_NAMESPACE_ID::uint8* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  inline void SharedCtor();
-  inline void SharedDtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(Msg* other);
+
+  private:
   friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
   static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
     return "message.Msg";
   }
   protected:
-  explicit Msg(::PROTOBUF_NAMESPACE_ID::Arena* arena);
-  private:
-  static void ArenaDtor(void* object);
-  inline void RegisterArenaDtor(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  explicit Msg(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
   public:
 
-  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
-  private:
-  static ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadataStatic() {
-    ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&::descriptor_table_message_2eproto);
-    return ::descriptor_table_message_2eproto.file_level_metadata[kIndexInFileMessages];
-  }
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
 
-  public:
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
 
   // nested types ----------------------------------------------------
 
   // accessors -------------------------------------------------------
 
   enum : int {
+    kFramesFieldNumber = 5,
     kObjFieldNumber = 4,
     kTypeFieldNumber = 1,
     kPhaseFieldNumber = 2,
     kValueFieldNumber = 3,
   };
+  // bytes Frames = 5;
+  void clear_frames();
+  const std::string& frames() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_frames(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_frames();
+  PROTOBUF_NODISCARD std::string* release_frames();
+  void set_allocated_frames(std::string* frames);
+  private:
+  const std::string& _internal_frames() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_frames(const std::string& value);
+  std::string* _internal_mutable_frames();
+  public:
+
   // .message.ConsensusObj Obj = 4;
   bool has_obj() const;
   private:
@@ -661,7 +697,7 @@ class Msg PROTOBUF_FINAL :
   public:
   void clear_obj();
   const ::message::ConsensusObj& obj() const;
-  ::message::ConsensusObj* release_obj();
+  PROTOBUF_NODISCARD ::message::ConsensusObj* release_obj();
   ::message::ConsensusObj* mutable_obj();
   void set_allocated_obj(::message::ConsensusObj* obj);
   private:
@@ -683,20 +719,20 @@ class Msg PROTOBUF_FINAL :
 
   // uint32 Phase = 2;
   void clear_phase();
-  ::PROTOBUF_NAMESPACE_ID::uint32 phase() const;
-  void set_phase(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t phase() const;
+  void set_phase(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_phase() const;
-  void _internal_set_phase(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_phase() const;
+  void _internal_set_phase(uint32_t value);
   public:
 
   // uint32 Value = 3;
   void clear_value();
-  ::PROTOBUF_NAMESPACE_ID::uint32 value() const;
-  void set_value(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t value() const;
+  void set_value(uint32_t value);
   private:
-  ::PROTOBUF_NAMESPACE_ID::uint32 _internal_value() const;
-  void _internal_set_value(::PROTOBUF_NAMESPACE_ID::uint32 value);
+  uint32_t _internal_value() const;
+  void _internal_set_value(uint32_t value);
   public:
 
   // @@protoc_insertion_point(class_scope:message.Msg)
@@ -706,11 +742,15 @@ class Msg PROTOBUF_FINAL :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::message::ConsensusObj* obj_;
-  int type_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 phase_;
-  ::PROTOBUF_NAMESPACE_ID::uint32 value_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr frames_;
+    ::message::ConsensusObj* obj_;
+    int type_;
+    uint32_t phase_;
+    uint32_t value_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_message_2eproto;
 };
 // ===================================================================
@@ -726,80 +766,81 @@ class Msg PROTOBUF_FINAL :
 
 // uint32 CliId = 1;
 inline void Command::clear_cliid() {
-  cliid_ = 0u;
+  _impl_.cliid_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::_internal_cliid() const {
-  return cliid_;
+inline uint32_t Command::_internal_cliid() const {
+  return _impl_.cliid_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::cliid() const {
+inline uint32_t Command::cliid() const {
   // @@protoc_insertion_point(field_get:message.Command.CliId)
   return _internal_cliid();
 }
-inline void Command::_internal_set_cliid(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::_internal_set_cliid(uint32_t value) {
   
-  cliid_ = value;
+  _impl_.cliid_ = value;
 }
-inline void Command::set_cliid(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::set_cliid(uint32_t value) {
   _internal_set_cliid(value);
   // @@protoc_insertion_point(field_set:message.Command.CliId)
 }
 
 // uint32 CliSeq = 2;
 inline void Command::clear_cliseq() {
-  cliseq_ = 0u;
+  _impl_.cliseq_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::_internal_cliseq() const {
-  return cliseq_;
+inline uint32_t Command::_internal_cliseq() const {
+  return _impl_.cliseq_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::cliseq() const {
+inline uint32_t Command::cliseq() const {
   // @@protoc_insertion_point(field_get:message.Command.CliSeq)
   return _internal_cliseq();
 }
-inline void Command::_internal_set_cliseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::_internal_set_cliseq(uint32_t value) {
   
-  cliseq_ = value;
+  _impl_.cliseq_ = value;
 }
-inline void Command::set_cliseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::set_cliseq(uint32_t value) {
   _internal_set_cliseq(value);
   // @@protoc_insertion_point(field_set:message.Command.CliSeq)
 }
 
 // uint32 SvrSeq = 3;
 inline void Command::clear_svrseq() {
-  svrseq_ = 0u;
+  _impl_.svrseq_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::_internal_svrseq() const {
-  return svrseq_;
+inline uint32_t Command::_internal_svrseq() const {
+  return _impl_.svrseq_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Command::svrseq() const {
+inline uint32_t Command::svrseq() const {
   // @@protoc_insertion_point(field_get:message.Command.SvrSeq)
   return _internal_svrseq();
 }
-inline void Command::_internal_set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::_internal_set_svrseq(uint32_t value) {
   
-  svrseq_ = value;
+  _impl_.svrseq_ = value;
 }
-inline void Command::set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Command::set_svrseq(uint32_t value) {
   _internal_set_svrseq(value);
   // @@protoc_insertion_point(field_set:message.Command.SvrSeq)
 }
 
-// repeated string Commands = 4;
+// repeated bytes Commands = 4;
 inline int Command::_internal_commands_size() const {
-  return commands_.size();
+  return _impl_.commands_.size();
 }
 inline int Command::commands_size() const {
   return _internal_commands_size();
 }
 inline void Command::clear_commands() {
-  commands_.Clear();
+  _impl_.commands_.Clear();
 }
 inline std::string* Command::add_commands() {
+  std::string* _s = _internal_add_commands();
   // @@protoc_insertion_point(field_add_mutable:message.Command.Commands)
-  return _internal_add_commands();
+  return _s;
 }
 inline const std::string& Command::_internal_commands(int index) const {
-  return commands_.Get(index);
+  return _impl_.commands_.Get(index);
 }
 inline const std::string& Command::commands(int index) const {
   // @@protoc_insertion_point(field_get:message.Command.Commands)
@@ -807,55 +848,55 @@ inline const std::string& Command::commands(int index) const {
 }
 inline std::string* Command::mutable_commands(int index) {
   // @@protoc_insertion_point(field_mutable:message.Command.Commands)
-  return commands_.Mutable(index);
+  return _impl_.commands_.Mutable(index);
 }
 inline void Command::set_commands(int index, const std::string& value) {
+  _impl_.commands_.Mutable(index)->assign(value);
   // @@protoc_insertion_point(field_set:message.Command.Commands)
-  commands_.Mutable(index)->assign(value);
 }
 inline void Command::set_commands(int index, std::string&& value) {
+  _impl_.commands_.Mutable(index)->assign(std::move(value));
   // @@protoc_insertion_point(field_set:message.Command.Commands)
-  commands_.Mutable(index)->assign(std::move(value));
 }
 inline void Command::set_commands(int index, const char* value) {
   GOOGLE_DCHECK(value != nullptr);
-  commands_.Mutable(index)->assign(value);
+  _impl_.commands_.Mutable(index)->assign(value);
   // @@protoc_insertion_point(field_set_char:message.Command.Commands)
 }
-inline void Command::set_commands(int index, const char* value, size_t size) {
-  commands_.Mutable(index)->assign(
+inline void Command::set_commands(int index, const void* value, size_t size) {
+  _impl_.commands_.Mutable(index)->assign(
     reinterpret_cast<const char*>(value), size);
   // @@protoc_insertion_point(field_set_pointer:message.Command.Commands)
 }
 inline std::string* Command::_internal_add_commands() {
-  return commands_.Add();
+  return _impl_.commands_.Add();
 }
 inline void Command::add_commands(const std::string& value) {
-  commands_.Add()->assign(value);
+  _impl_.commands_.Add()->assign(value);
   // @@protoc_insertion_point(field_add:message.Command.Commands)
 }
 inline void Command::add_commands(std::string&& value) {
-  commands_.Add(std::move(value));
+  _impl_.commands_.Add(std::move(value));
   // @@protoc_insertion_point(field_add:message.Command.Commands)
 }
 inline void Command::add_commands(const char* value) {
   GOOGLE_DCHECK(value != nullptr);
-  commands_.Add()->assign(value);
+  _impl_.commands_.Add()->assign(value);
   // @@protoc_insertion_point(field_add_char:message.Command.Commands)
 }
-inline void Command::add_commands(const char* value, size_t size) {
-  commands_.Add()->assign(reinterpret_cast<const char*>(value), size);
+inline void Command::add_commands(const void* value, size_t size) {
+  _impl_.commands_.Add()->assign(reinterpret_cast<const char*>(value), size);
   // @@protoc_insertion_point(field_add_pointer:message.Command.Commands)
 }
 inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>&
 Command::commands() const {
   // @@protoc_insertion_point(field_list:message.Command.Commands)
-  return commands_;
+  return _impl_.commands_;
 }
 inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>*
 Command::mutable_commands() {
   // @@protoc_insertion_point(field_mutable_list:message.Command.Commands)
-  return &commands_;
+  return &_impl_.commands_;
 }
 
 // -------------------------------------------------------------------
@@ -864,70 +905,70 @@ Command::mutable_commands() {
 
 // uint32 ProId = 1;
 inline void ConsensusObj::clear_proid() {
-  proid_ = 0u;
+  _impl_.proid_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::_internal_proid() const {
-  return proid_;
+inline uint32_t ConsensusObj::_internal_proid() const {
+  return _impl_.proid_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::proid() const {
+inline uint32_t ConsensusObj::proid() const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.ProId)
   return _internal_proid();
 }
-inline void ConsensusObj::_internal_set_proid(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::_internal_set_proid(uint32_t value) {
   
-  proid_ = value;
+  _impl_.proid_ = value;
 }
-inline void ConsensusObj::set_proid(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::set_proid(uint32_t value) {
   _internal_set_proid(value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.ProId)
 }
 
 // uint32 ProSeq = 2;
 inline void ConsensusObj::clear_proseq() {
-  proseq_ = 0u;
+  _impl_.proseq_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::_internal_proseq() const {
-  return proseq_;
+inline uint32_t ConsensusObj::_internal_proseq() const {
+  return _impl_.proseq_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::proseq() const {
+inline uint32_t ConsensusObj::proseq() const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.ProSeq)
   return _internal_proseq();
 }
-inline void ConsensusObj::_internal_set_proseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::_internal_set_proseq(uint32_t value) {
   
-  proseq_ = value;
+  _impl_.proseq_ = value;
 }
-inline void ConsensusObj::set_proseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::set_proseq(uint32_t value) {
   _internal_set_proseq(value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.ProSeq)
 }
 
 // uint32 SvrSeq = 3;
 inline void ConsensusObj::clear_svrseq() {
-  svrseq_ = 0u;
+  _impl_.svrseq_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::_internal_svrseq() const {
-  return svrseq_;
+inline uint32_t ConsensusObj::_internal_svrseq() const {
+  return _impl_.svrseq_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::svrseq() const {
+inline uint32_t ConsensusObj::svrseq() const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.SvrSeq)
   return _internal_svrseq();
 }
-inline void ConsensusObj::_internal_set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::_internal_set_svrseq(uint32_t value) {
   
-  svrseq_ = value;
+  _impl_.svrseq_ = value;
 }
-inline void ConsensusObj::set_svrseq(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::set_svrseq(uint32_t value) {
   _internal_set_svrseq(value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.SvrSeq)
 }
 
 // bool IsNull = 4;
 inline void ConsensusObj::clear_isnull() {
-  isnull_ = false;
+  _impl_.isnull_ = false;
 }
 inline bool ConsensusObj::_internal_isnull() const {
-  return isnull_;
+  return _impl_.isnull_;
 }
 inline bool ConsensusObj::isnull() const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.IsNull)
@@ -935,7 +976,7 @@ inline bool ConsensusObj::isnull() const {
 }
 inline void ConsensusObj::_internal_set_isnull(bool value) {
   
-  isnull_ = value;
+  _impl_.isnull_ = value;
 }
 inline void ConsensusObj::set_isnull(bool value) {
   _internal_set_isnull(value);
@@ -944,46 +985,46 @@ inline void ConsensusObj::set_isnull(bool value) {
 
 // repeated uint32 CliIds = 5;
 inline int ConsensusObj::_internal_cliids_size() const {
-  return cliids_.size();
+  return _impl_.cliids_.size();
 }
 inline int ConsensusObj::cliids_size() const {
   return _internal_cliids_size();
 }
 inline void ConsensusObj::clear_cliids() {
-  cliids_.Clear();
+  _impl_.cliids_.Clear();
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::_internal_cliids(int index) const {
-  return cliids_.Get(index);
+inline uint32_t ConsensusObj::_internal_cliids(int index) const {
+  return _impl_.cliids_.Get(index);
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::cliids(int index) const {
+inline uint32_t ConsensusObj::cliids(int index) const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.CliIds)
   return _internal_cliids(index);
 }
-inline void ConsensusObj::set_cliids(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value) {
-  cliids_.Set(index, value);
+inline void ConsensusObj::set_cliids(int index, uint32_t value) {
+  _impl_.cliids_.Set(index, value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.CliIds)
 }
-inline void ConsensusObj::_internal_add_cliids(::PROTOBUF_NAMESPACE_ID::uint32 value) {
-  cliids_.Add(value);
+inline void ConsensusObj::_internal_add_cliids(uint32_t value) {
+  _impl_.cliids_.Add(value);
 }
-inline void ConsensusObj::add_cliids(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::add_cliids(uint32_t value) {
   _internal_add_cliids(value);
   // @@protoc_insertion_point(field_add:message.ConsensusObj.CliIds)
 }
-inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
 ConsensusObj::_internal_cliids() const {
-  return cliids_;
+  return _impl_.cliids_;
 }
-inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
 ConsensusObj::cliids() const {
   // @@protoc_insertion_point(field_list:message.ConsensusObj.CliIds)
   return _internal_cliids();
 }
-inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
 ConsensusObj::_internal_mutable_cliids() {
-  return &cliids_;
+  return &_impl_.cliids_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
 ConsensusObj::mutable_cliids() {
   // @@protoc_insertion_point(field_mutable_list:message.ConsensusObj.CliIds)
   return _internal_mutable_cliids();
@@ -991,67 +1032,68 @@ ConsensusObj::mutable_cliids() {
 
 // repeated uint32 CliSeqs = 6;
 inline int ConsensusObj::_internal_cliseqs_size() const {
-  return cliseqs_.size();
+  return _impl_.cliseqs_.size();
 }
 inline int ConsensusObj::cliseqs_size() const {
   return _internal_cliseqs_size();
 }
 inline void ConsensusObj::clear_cliseqs() {
-  cliseqs_.Clear();
+  _impl_.cliseqs_.Clear();
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::_internal_cliseqs(int index) const {
-  return cliseqs_.Get(index);
+inline uint32_t ConsensusObj::_internal_cliseqs(int index) const {
+  return _impl_.cliseqs_.Get(index);
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 ConsensusObj::cliseqs(int index) const {
+inline uint32_t ConsensusObj::cliseqs(int index) const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.CliSeqs)
   return _internal_cliseqs(index);
 }
-inline void ConsensusObj::set_cliseqs(int index, ::PROTOBUF_NAMESPACE_ID::uint32 value) {
-  cliseqs_.Set(index, value);
+inline void ConsensusObj::set_cliseqs(int index, uint32_t value) {
+  _impl_.cliseqs_.Set(index, value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.CliSeqs)
 }
-inline void ConsensusObj::_internal_add_cliseqs(::PROTOBUF_NAMESPACE_ID::uint32 value) {
-  cliseqs_.Add(value);
+inline void ConsensusObj::_internal_add_cliseqs(uint32_t value) {
+  _impl_.cliseqs_.Add(value);
 }
-inline void ConsensusObj::add_cliseqs(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void ConsensusObj::add_cliseqs(uint32_t value) {
   _internal_add_cliseqs(value);
   // @@protoc_insertion_point(field_add:message.ConsensusObj.CliSeqs)
 }
-inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
 ConsensusObj::_internal_cliseqs() const {
-  return cliseqs_;
+  return _impl_.cliseqs_;
 }
-inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >&
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >&
 ConsensusObj::cliseqs() const {
   // @@protoc_insertion_point(field_list:message.ConsensusObj.CliSeqs)
   return _internal_cliseqs();
 }
-inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
 ConsensusObj::_internal_mutable_cliseqs() {
-  return &cliseqs_;
+  return &_impl_.cliseqs_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< ::PROTOBUF_NAMESPACE_ID::uint32 >*
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedField< uint32_t >*
 ConsensusObj::mutable_cliseqs() {
   // @@protoc_insertion_point(field_mutable_list:message.ConsensusObj.CliSeqs)
   return _internal_mutable_cliseqs();
 }
 
-// repeated string Commands = 7;
+// repeated bytes Commands = 7;
 inline int ConsensusObj::_internal_commands_size() const {
-  return commands_.size();
+  return _impl_.commands_.size();
 }
 inline int ConsensusObj::commands_size() const {
   return _internal_commands_size();
 }
 inline void ConsensusObj::clear_commands() {
-  commands_.Clear();
+  _impl_.commands_.Clear();
 }
 inline std::string* ConsensusObj::add_commands() {
+  std::string* _s = _internal_add_commands();
   // @@protoc_insertion_point(field_add_mutable:message.ConsensusObj.Commands)
-  return _internal_add_commands();
+  return _s;
 }
 inline const std::string& ConsensusObj::_internal_commands(int index) const {
-  return commands_.Get(index);
+  return _impl_.commands_.Get(index);
 }
 inline const std::string& ConsensusObj::commands(int index) const {
   // @@protoc_insertion_point(field_get:message.ConsensusObj.Commands)
@@ -1059,55 +1101,55 @@ inline const std::string& ConsensusObj::commands(int index) const {
 }
 inline std::string* ConsensusObj::mutable_commands(int index) {
   // @@protoc_insertion_point(field_mutable:message.ConsensusObj.Commands)
-  return commands_.Mutable(index);
+  return _impl_.commands_.Mutable(index);
 }
 inline void ConsensusObj::set_commands(int index, const std::string& value) {
+  _impl_.commands_.Mutable(index)->assign(value);
   // @@protoc_insertion_point(field_set:message.ConsensusObj.Commands)
-  commands_.Mutable(index)->assign(value);
 }
 inline void ConsensusObj::set_commands(int index, std::string&& value) {
+  _impl_.commands_.Mutable(index)->assign(std::move(value));
   // @@protoc_insertion_point(field_set:message.ConsensusObj.Commands)
-  commands_.Mutable(index)->assign(std::move(value));
 }
 inline void ConsensusObj::set_commands(int index, const char* value) {
   GOOGLE_DCHECK(value != nullptr);
-  commands_.Mutable(index)->assign(value);
+  _impl_.commands_.Mutable(index)->assign(value);
   // @@protoc_insertion_point(field_set_char:message.ConsensusObj.Commands)
 }
-inline void ConsensusObj::set_commands(int index, const char* value, size_t size) {
-  commands_.Mutable(index)->assign(
+inline void ConsensusObj::set_commands(int index, const void* value, size_t size) {
+  _impl_.commands_.Mutable(index)->assign(
     reinterpret_cast<const char*>(value), size);
   // @@protoc_insertion_point(field_set_pointer:message.ConsensusObj.Commands)
 }
 inline std::string* ConsensusObj::_internal_add_commands() {
-  return commands_.Add();
+  return _impl_.commands_.Add();
 }
 inline void ConsensusObj::add_commands(const std::string& value) {
-  commands_.Add()->assign(value);
+  _impl_.commands_.Add()->assign(value);
   // @@protoc_insertion_point(field_add:message.ConsensusObj.Commands)
 }
 inline void ConsensusObj::add_commands(std::string&& value) {
-  commands_.Add(std::move(value));
+  _impl_.commands_.Add(std::move(value));
   // @@protoc_insertion_point(field_add:message.ConsensusObj.Commands)
 }
 inline void ConsensusObj::add_commands(const char* value) {
   GOOGLE_DCHECK(value != nullptr);
-  commands_.Add()->assign(value);
+  _impl_.commands_.Add()->assign(value);
   // @@protoc_insertion_point(field_add_char:message.ConsensusObj.Commands)
 }
-inline void ConsensusObj::add_commands(const char* value, size_t size) {
-  commands_.Add()->assign(reinterpret_cast<const char*>(value), size);
+inline void ConsensusObj::add_commands(const void* value, size_t size) {
+  _impl_.commands_.Add()->assign(reinterpret_cast<const char*>(value), size);
   // @@protoc_insertion_point(field_add_pointer:message.ConsensusObj.Commands)
 }
 inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>&
 ConsensusObj::commands() const {
   // @@protoc_insertion_point(field_list:message.ConsensusObj.Commands)
-  return commands_;
+  return _impl_.commands_;
 }
 inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField<std::string>*
 ConsensusObj::mutable_commands() {
   // @@protoc_insertion_point(field_mutable_list:message.ConsensusObj.Commands)
-  return &commands_;
+  return &_impl_.commands_;
 }
 
 // -------------------------------------------------------------------
@@ -1116,10 +1158,10 @@ ConsensusObj::mutable_commands() {
 
 // .message.MsgType Type = 1;
 inline void Msg::clear_type() {
-  type_ = 0;
+  _impl_.type_ = 0;
 }
 inline ::message::MsgType Msg::_internal_type() const {
-  return static_cast< ::message::MsgType >(type_);
+  return static_cast< ::message::MsgType >(_impl_.type_);
 }
 inline ::message::MsgType Msg::type() const {
   // @@protoc_insertion_point(field_get:message.Msg.Type)
@@ -1127,7 +1169,7 @@ inline ::message::MsgType Msg::type() const {
 }
 inline void Msg::_internal_set_type(::message::MsgType value) {
   
-  type_ = value;
+  _impl_.type_ = value;
 }
 inline void Msg::set_type(::message::MsgType value) {
   _internal_set_type(value);
@@ -1136,61 +1178,61 @@ inline void Msg::set_type(::message::MsgType value) {
 
 // uint32 Phase = 2;
 inline void Msg::clear_phase() {
-  phase_ = 0u;
+  _impl_.phase_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Msg::_internal_phase() const {
-  return phase_;
+inline uint32_t Msg::_internal_phase() const {
+  return _impl_.phase_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Msg::phase() const {
+inline uint32_t Msg::phase() const {
   // @@protoc_insertion_point(field_get:message.Msg.Phase)
   return _internal_phase();
 }
-inline void Msg::_internal_set_phase(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Msg::_internal_set_phase(uint32_t value) {
   
-  phase_ = value;
+  _impl_.phase_ = value;
 }
-inline void Msg::set_phase(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Msg::set_phase(uint32_t value) {
   _internal_set_phase(value);
   // @@protoc_insertion_point(field_set:message.Msg.Phase)
 }
 
 // uint32 Value = 3;
 inline void Msg::clear_value() {
-  value_ = 0u;
+  _impl_.value_ = 0u;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Msg::_internal_value() const {
-  return value_;
+inline uint32_t Msg::_internal_value() const {
+  return _impl_.value_;
 }
-inline ::PROTOBUF_NAMESPACE_ID::uint32 Msg::value() const {
+inline uint32_t Msg::value() const {
   // @@protoc_insertion_point(field_get:message.Msg.Value)
   return _internal_value();
 }
-inline void Msg::_internal_set_value(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Msg::_internal_set_value(uint32_t value) {
   
-  value_ = value;
+  _impl_.value_ = value;
 }
-inline void Msg::set_value(::PROTOBUF_NAMESPACE_ID::uint32 value) {
+inline void Msg::set_value(uint32_t value) {
   _internal_set_value(value);
   // @@protoc_insertion_point(field_set:message.Msg.Value)
 }
 
 // .message.ConsensusObj Obj = 4;
 inline bool Msg::_internal_has_obj() const {
-  return this != internal_default_instance() && obj_ != nullptr;
+  return this != internal_default_instance() && _impl_.obj_ != nullptr;
 }
 inline bool Msg::has_obj() const {
   return _internal_has_obj();
 }
 inline void Msg::clear_obj() {
-  if (GetArena() == nullptr && obj_ != nullptr) {
-    delete obj_;
+  if (GetArenaForAllocation() == nullptr && _impl_.obj_ != nullptr) {
+    delete _impl_.obj_;
   }
-  obj_ = nullptr;
+  _impl_.obj_ = nullptr;
 }
 inline const ::message::ConsensusObj& Msg::_internal_obj() const {
-  const ::message::ConsensusObj* p = obj_;
-  return p != nullptr ? *p : *reinterpret_cast<const ::message::ConsensusObj*>(
-      &::message::_ConsensusObj_default_instance_);
+  const ::message::ConsensusObj* p = _impl_.obj_;
+  return p != nullptr ? *p : reinterpret_cast<const ::message::ConsensusObj&>(
+      ::message::_ConsensusObj_default_instance_);
 }
 inline const ::message::ConsensusObj& Msg::obj() const {
   // @@protoc_insertion_point(field_get:message.Msg.Obj)
@@ -1198,10 +1240,10 @@ inline const ::message::ConsensusObj& Msg::obj() const {
 }
 inline void Msg::unsafe_arena_set_allocated_obj(
     ::message::ConsensusObj* obj) {
-  if (GetArena() == nullptr) {
-    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(obj_);
+  if (GetArenaForAllocation() == nullptr) {
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.obj_);
   }
-  obj_ = obj;
+  _impl_.obj_ = obj;
   if (obj) {
     
   } else {
@@ -1210,39 +1252,48 @@ inline void Msg::unsafe_arena_set_allocated_obj(
   // @@protoc_insertion_point(field_unsafe_arena_set_allocated:message.Msg.Obj)
 }
 inline ::message::ConsensusObj* Msg::release_obj() {
-  auto temp = unsafe_arena_release_obj();
-  if (GetArena() != nullptr) {
+  
+  ::message::ConsensusObj* temp = _impl_.obj_;
+  _impl_.obj_ = nullptr;
+#ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
+  auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
+  temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
+  if (GetArenaForAllocation() == nullptr) { delete old; }
+#else  // PROTOBUF_FORCE_COPY_IN_RELEASE
+  if (GetArenaForAllocation() != nullptr) {
     temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
   }
+#endif  // !PROTOBUF_FORCE_COPY_IN_RELEASE
   return temp;
 }
 inline ::message::ConsensusObj* Msg::unsafe_arena_release_obj() {
   // @@protoc_insertion_point(field_release:message.Msg.Obj)
   
-  ::message::ConsensusObj* temp = obj_;
-  obj_ = nullptr;
+  ::message::ConsensusObj* temp = _impl_.obj_;
+  _impl_.obj_ = nullptr;
   return temp;
 }
 inline ::message::ConsensusObj* Msg::_internal_mutable_obj() {
   
-  if (obj_ == nullptr) {
-    auto* p = CreateMaybeMessage<::message::ConsensusObj>(GetArena());
-    obj_ = p;
+  if (_impl_.obj_ == nullptr) {
+    auto* p = CreateMaybeMessage<::message::ConsensusObj>(GetArenaForAllocation());
+    _impl_.obj_ = p;
   }
-  return obj_;
+  return _impl_.obj_;
 }
 inline ::message::ConsensusObj* Msg::mutable_obj() {
+  ::message::ConsensusObj* _msg = _internal_mutable_obj();
   // @@protoc_insertion_point(field_mutable:message.Msg.Obj)
-  return _internal_mutable_obj();
+  return _msg;
 }
 inline void Msg::set_allocated_obj(::message::ConsensusObj* obj) {
-  ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArena();
+  ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
   if (message_arena == nullptr) {
-    delete obj_;
+    delete _impl_.obj_;
   }
   if (obj) {
     ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
-      ::PROTOBUF_NAMESPACE_ID::Arena::GetArena(obj);
+        ::PROTOBUF_NAMESPACE_ID::Arena::InternalGetOwningArena(obj);
     if (message_arena != submessage_arena) {
       obj = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
           message_arena, obj, submessage_arena);
@@ -1251,10 +1302,60 @@ inline void Msg::set_allocated_obj(::message::ConsensusObj* obj) {
   } else {
     
   }
-  obj_ = obj;
+  _impl_.obj_ = obj;
   // @@protoc_insertion_point(field_set_allocated:message.Msg.Obj)
 }
 
+// bytes Frames = 5;
+inline void Msg::clear_frames() {
+  _impl_.frames_.ClearToEmpty();
+}
+inline const std::string& Msg::frames() const {
+  // @@protoc_insertion_point(field_get:message.Msg.Frames)
+  return _internal_frames();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void Msg::set_frames(ArgT0&& arg0, ArgT... args) {
+ 
+ _impl_.frames_.SetBytes(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:message.Msg.Frames)
+}
+inline std::string* Msg::mutable_frames() {
+  std::string* _s = _internal_mutable_frames();
+  // @@protoc_insertion_point(field_mutable:message.Msg.Frames)
+  return _s;
+}
+inline const std::string& Msg::_internal_frames() const {
+  return _impl_.frames_.Get();
+}
+inline void Msg::_internal_set_frames(const std::string& value) {
+  
+  _impl_.frames_.Set(value, GetArenaForAllocation());
+}
+inline std::string* Msg::_internal_mutable_frames() {
+  
+  return _impl_.frames_.Mutable(GetArenaForAllocation());
+}
+inline std::string* Msg::release_frames() {
+  // @@protoc_insertion_point(field_release:message.Msg.Frames)
+  return _impl_.frames_.Release();
+}
+inline void Msg::set_allocated_frames(std::string* frames) {
+  if (frames != nullptr) {
+    
+  } else {
+    
+  }
+  _impl_.frames_.SetAllocated(frames, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.frames_.IsDefault()) {
+    _impl_.frames_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:message.Msg.Frames)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+
+#include "wire.h"
+
+namespace rabia {
+
+struct CatchupLogOptions {
+  uint32_t slots = 4096;     // Decided slots kept (a power of 2)
+  uint32_t cell_bytes = 512; // Per slot, header and trailer included (ditto)
+};
+
+/// CatchupLog keeps a replica's most recently decided slots, so that it can
+/// send them to a peer that missed them (see WeakMvc's catch-up).
+///
+/// Slot s lives in cell s % `slots` of one flat array, encoded with the wire
+/// format as the ProposalReply that carries it.  So the array can be put in
+/// registered memory, and a peer can fetch a run of resident decisions with a
+/// single one-sided READ and decode them in place (see Parse()), without this
+/// replica's CPU.  A decision too big for a cell is kept on the side instead,
+/// for the two-sided path only.
+///
+/// A cell starts with a header holding its slot's tag (slot + 1; 0 while the
+/// cell is being written) and ends with a copy of the tag.  The writer clears
+/// both tags, writes the frame, then sets the trailer and the header tag.  A
+/// READ that raced with a rewrite either saw the old header but a trailer
+/// cleared before any of the new frame, or saw a cleared header, so its tags
+/// mismatch and it is discarded.
+///
+/// NB: Like the mailbox rings (see MailboxSlot), this relies on the NIC
+///     placing a READ's bytes in address order, which verbs don't promise but
+///     every NIC we run on does.
+class CatchupLog {
+public:
+  using Options = CatchupLogOptions;
+
+  struct CellHeader {
+    uint32_t tag;    // slot + 1, or 0
+    uint32_t length; // Of the frame that follows
+  };
+  static_assert(sizeof(CellHeader) == 8);
+
+private:
+  const Options opts_;
+  std::unique_ptr<uint8_t[]> owned_;
+  uint8_t *cells_; //! NOT OWNED, unless it is owned_
+  uint32_t end_;   // One past the newest slot appended
+
+  /// Decisions that don't fit in a cell, by slot
+  std::map<uint32_t, message::Msg> large_;
+
+  uint8_t *cell(uint32_t slot) const {
+    return cells_ + size_t(slot & (opts_.slots - 1)) * opts_.cell_bytes;
+  }
+
+  std::atomic_ref<uint32_t> header_tag(uint32_t slot) const {
+    return std::atomic_ref<uint32_t>(
+        reinterpret_cast<CellHeader *>(cell(slot))->tag);
+  }
+
+  std::atomic_ref<uint32_t> trailer_tag(uint32_t slot) const {
+    return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t *>(
+        cell(slot) + opts_.cell_bytes - sizeof(uint32_t)));
+  }
+
+public:
+  /// The bytes of cell array a log with `opts` needs
+  static size_t Bytes(const Options &opts) {
+    return size_t(opts.slots) * opts.cell_bytes;
+  }
+
+  /// The largest frame a cell holds
+  static uint32_t Capacity(const Options &opts) {
+    return opts.cell_bytes - sizeof(CellHeader) - sizeof(uint32_t);
+  }
+
+  /// @param opts   The number and size of cells
+  /// @param cells  Bytes(opts) bytes of 8-aligned memory for the cells (e.g.
+  ///               registered for RDMA), or nullptr to allocate them (not
+  ///               owned)
+  explicit CatchupLog(Options opts, uint8_t *cells = nullptr)
+      : opts_(opts), cells_(cells), end_(0) {
+    ROME_ASSERT(std::has_single_bit(opts_.slots) &&
+                    std::has_single_bit(opts_.cell_bytes) &&
+                    opts_.cell_bytes > sizeof(CellHeader) + sizeof(uint32_t),
+                "Catch-up log slots and cell size must be powers of two");
+    if (cells_ == nullptr) {
+      owned_ = std::make_unique<uint8_t[]>(Bytes(opts_));
+      cells_ = owned_.get();
+    }
+    std::memset(cells_, 0, Bytes(opts_));
+  }
+
+  CatchupLog(const CatchupLog &) = delete;
+  CatchupLog(CatchupLog &&) = delete;
+
+  // Getters.
+  const Options &options() const { return opts_; }
+  const uint8_t *cells() const { return cells_; }
+  uint32_t end() const { return end_; }
+  /// The oldest slot still kept
+  uint32_t begin() const {
+    return end_ > opts_.slots ? end_ - opts_.slots : 0;
+  }
+
+  /// The byte offset of `slot`'s cell in the array
+  size_t Offset(uint32_t slot) const {
+    return size_t(slot & (opts_.slots - 1)) * opts_.cell_bytes;
+  }
+
+  /// Record that `slot` decided `obj`.  Slots are appended in order; any
+  /// skipped (e.g. by a replica that started after them) are just not kept.
+  void Append(uint32_t slot, uint32_t decision,
+              const message::ConsensusObj &obj) {
+    ROME_ASSERT_DEBUG(slot >= end_, "Slots must be appended in order");
+    end_ = slot + 1;
+    if (!large_.empty())
+      large_.erase(large_.begin(), large_.lower_bound(begin()));
+
+    uint8_t *c = cell(slot);
+    header_tag(slot).store(0, std::memory_order_relaxed);
+    trailer_tag(slot).store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    auto len = wire::EncodeObj(message::ProposalReply, 0, decision, obj,
+                               c + sizeof(CellHeader), Capacity(opts_));
+    if (len.status.t != sss::Ok) {
+      // Too big for a cell (or malformed, which Get() will pass on as is)
+      message::Msg &msg = large_[slot];
+      msg.set_type(message::ProposalReply);
+      msg.set_value(decision);
+      *msg.mutable_obj() = obj;
+      msg.mutable_obj()->set_svrseq(slot);
+      return;
+    }
+    reinterpret_cast<CellHeader *>(c)->length = len.val.value();
+    trailer_tag(slot).store(end_, std::memory_order_release);
+    header_tag(slot).store(end_, std::memory_order_release);
+  }
+
+  /// The ProposalReply for `slot`, if it is still kept
+  std::optional<message::Msg> Get(uint32_t slot) const {
+    if (slot >= end_ || slot < begin())
+      return std::nullopt;
+    if (auto it = large_.find(slot); it != large_.end())
+      return it->second;
+    return Parse(cell(slot), opts_.cell_bytes, slot);
+  }
+
+  /// Decode the ProposalReply for `slot` from a copy of its cell, e.g. one
+  /// fetched by RDMA READ
+  ///
+  /// @return Nothing if the cell holds another slot, is empty, or was caught
+  ///         mid-write
+  static std::optional<message::Msg> Parse(const uint8_t *cell,
+                                           uint32_t cell_bytes, uint32_t slot) {
+    CellHeader h;
+    uint32_t trailer;
+    std::memcpy(&h, cell, sizeof(h));
+    std::memcpy(&trailer, cell + cell_bytes - sizeof(uint32_t),
+                sizeof(trailer));
+    if (h.tag != slot + 1 || trailer != slot + 1 ||
+        h.length > cell_bytes - sizeof(CellHeader) - sizeof(uint32_t))
+      return std::nullopt;
+    auto view = wire::View::Parse(cell + sizeof(CellHeader), h.length);
+    if (view.status.t != sss::Ok || view.val->svrseq() != slot)
+      return std::nullopt;
+    message::Msg msg;
+    view.val->ToMsg(&msg);
+    return msg;
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <metrics/summary.h>
+#include <vendor/sss/status.h>
+
+#include "timer_wheel.h"
+
+namespace rabia {
+
+/// The SvrSeq of a proxy's reply to a request it won't order, e.g. a Command
+/// whose keys span partitions (see PartitionRouter)
+static constexpr uint32_t kRejectedSvrSeq = ~0u;
+
+struct ClientOptions {
+  uint32_t cliid = 0;
+  uint32_t max_outstanding = 64; // CliSeqs in flight at once
+  std::chrono::microseconds timeout{10000}; // Before a request is resent
+  uint32_t max_attempts = 0; // Sends before giving up; 0 never gives up
+};
+
+/// Client submits Commands to one proxy and pipelines them: up to
+/// `max_outstanding` CliSeqs can be waiting for a reply at once, and each
+/// request completes, through a callback or a future, when the proxy replies
+/// with the SvrSeq of the slot that decided it.
+///
+/// A request that gets no reply within `timeout` is resent with the same
+/// CliSeq.  Each send arms a timer in a TimerWheel, on the TSC clock, and a
+/// reply cancels it, so Poll() only looks at the requests that timed out, not
+/// at every one in flight.  The proxy's ClientTable recognizes the CliSeq, so a resend of a
+/// request that is already in consensus is dropped, and a resend of one that
+/// was decided just gets its reply again: retries never run a command twice.
+///
+/// CliSeqs in flight never span more than `max_outstanding`: a new CliSeq
+/// isn't sent until it is less than `max_outstanding` past the oldest
+/// unfinished one.  That is what lets the proxy forget CliSeqs that are
+/// further behind (see ClientTable).
+///
+/// Requests submitted while the pipeline is full wait in a local queue, so
+/// Submit() never blocks.  Nothing happens, though, unless Poll() is called,
+/// e.g. from an EventLoop.  Callbacks run inside Poll() or Submit(), on that
+/// thread.
+///
+/// @tparam Link Sends Commands to the proxy and receives its replies:
+///              `sss::Status Send(const message::Command &)` and
+///              `std::optional<message::Command> TryReceive()`, which never
+///              blocks (see LocalClientHub::ClientEnd)
+template <class Link> class Client {
+public:
+  using Options = ClientOptions;
+  using clock = std::chrono::steady_clock;
+
+  /// Called once per request.  `status` is Ok and `svrseq` is the deciding
+  /// slot, InvalidArgument if the proxy rejected the request, or Unavailable
+  /// after `max_attempts` sends without a reply (the request may still be
+  /// decided later).
+  using DoneFn = std::function<void(sss::Status status, uint32_t svrseq)>;
+
+private:
+  struct Request {
+    message::Command cmd;
+    DoneFn done;
+    clock::time_point submitted;
+    TimerId timer = kNoTimer; // Armed by each send
+    uint32_t attempts = 0;
+  };
+
+  Link *link_; //! NOT OWNED
+  const Options opts_;
+  uint32_t next_seq_ = 1;
+
+  std::deque<Request> waiting_;          // Not sent yet, in CliSeq order
+  std::map<uint32_t, Request> in_flight_; // By CliSeq
+
+  TimerWheel timers_;
+  std::vector<uint32_t> expired_; // CliSeqs whose timers fired this Poll()
+
+  rome::metrics::Summary<double> *latency_us_; //! NOT OWNED, may be null
+  uint64_t num_completed_ = 0;
+  uint64_t num_retries_ = 0;
+  uint64_t num_rejected_ = 0;
+
+public:
+  /// @param link       The connection to the proxy (not owned)
+  /// @param opts       This client's id, pipeline depth, and retry policy
+  /// @param latency_us If not null, gets the latency of each completed
+  ///                   request, from Submit() to its reply (not owned)
+  Client(Link *link, Options opts,
+         rome::metrics::Summary<double> *latency_us = nullptr)
+      : link_(link), opts_(opts),
+        timers_({.capacity = opts.max_outstanding}),
+        latency_us_(latency_us) {
+    ROME_ASSERT(opts_.max_outstanding > 0,
+                "A client needs room for one request in flight");
+  }
+
+  Client(const Client &) = delete;
+  Client(Client &&) = delete;
+
+  // Getters.
+  uint32_t cliid() const { return opts_.cliid; }
+  size_t outstanding() const { return waiting_.size() + in_flight_.size(); }
+  uint64_t num_completed() const { return num_completed_; }
+  uint64_t num_retries() const { return num_retries_; }
+  uint64_t num_rejected() const { return num_rejected_; }
+
+  /// Submit one request carrying `commands` (each kCommandBytes long)
+  ///
+  /// @return The request's CliSeq
+  uint32_t Submit(const std::vector<std::string> &commands, DoneFn done) {
+    Request r;
+    r.cmd.set_cliid(opts_.cliid);
+    r.cmd.set_cliseq(next_seq_++);
+    for (const auto &c : commands)
+      r.cmd.add_commands(c);
+    r.done = std::move(done);
+    r.submitted = clock::now();
+    waiting_.push_back(std::move(r));
+    SendWaiting();
+    return next_seq_ - 1;
+  }
+
+  /// Submit a request with one command
+  uint32_t Submit(const std::string &command, DoneFn done) {
+    return Submit(std::vector<std::string>{command}, std::move(done));
+  }
+
+  /// Like Submit(), but complete a future instead of calling back.  The
+  /// future holds the SvrSeq, or the error status.
+  std::future<sss::StatusVal<uint32_t>>
+  SubmitAsync(const std::vector<std::string> &commands) {
+    auto p = std::make_shared<std::promise<sss::StatusVal<uint32_t>>>();
+    auto f = p->get_future();
+    Submit(commands, [p](sss::Status status, uint32_t svrseq) {
+      if (status.t == sss::Ok)
+        p->set_value({status, svrseq});
+      else
+        p->set_value({status, {}});
+    });
+    return f;
+  }
+
+  /// Complete the requests the proxy has replied to, resend the ones that
+  /// timed out, and send waiting requests that now fit in the pipeline
+  ///
+  /// @return How many replies and resends there were
+  int Poll() {
+    int work = 0;
+    while (auto reply = link_->TryReceive()) {
+      ++work;
+      // Replies to requests that already completed are duplicates of a
+      // resend, and are dropped
+      auto it = in_flight_.find(reply->cliseq());
+      if (it == in_flight_.end())
+        continue;
+      Request r = std::move(it->second);
+      in_flight_.erase(it);
+      timers_.Cancel(r.timer);
+      if (reply->svrseq() == kRejectedSvrSeq) {
+        ++num_rejected_;
+        sss::Status err = {sss::InvalidArgument, "The proxy rejected CliSeq "};
+        r.done(err << r.cmd.cliseq(), 0);
+        continue;
+      }
+      if (latency_us_ != nullptr) {
+        std::chrono::duration<double, std::micro> lat =
+            clock::now() - r.submitted;
+        *latency_us_ << lat.count();
+      }
+      ++num_completed_;
+      r.done(sss::Status::Ok(), reply->svrseq());
+    }
+
+    timers_.Advance(TscNanos());
+    std::vector<Request> failed;
+    for (uint32_t seq : expired_) {
+      auto it = in_flight_.find(seq);
+      if (it == in_flight_.end())
+        continue;
+      Request &r = it->second;
+      ++work;
+      if (opts_.max_attempts != 0 && r.attempts >= opts_.max_attempts) {
+        failed.push_back(std::move(r));
+        in_flight_.erase(it);
+        continue;
+      }
+      ++num_retries_;
+      Send(r);
+    }
+    expired_.clear();
+    // Callbacks may Submit(), so call them once the map is settled
+    for (auto &r : failed) {
+      sss::Status err = {sss::Unavailable, "No reply for CliSeq "};
+      r.done(err << r.cmd.cliseq() << " after " << r.attempts << " sends", 0);
+    }
+
+    SendWaiting();
+    return work;
+  }
+
+private:
+  /// Send waiting requests while they fit in the pipeline
+  void SendWaiting() {
+    while (!waiting_.empty()) {
+      uint32_t seq = waiting_.front().cmd.cliseq();
+      if (!in_flight_.empty() &&
+          seq - in_flight_.begin()->first >= opts_.max_outstanding)
+        return;
+      auto [it, _] = in_flight_.emplace(seq, std::move(waiting_.front()));
+      waiting_.pop_front();
+      Send(it->second);
+    }
+  }
+
+  static void OnTimeout(void *ctx, uint64_t cliseq) {
+    static_cast<Client *>(ctx)->expired_.push_back(uint32_t(cliseq));
+  }
+
+  void Send(Request &r) {
+    r.timer = timers_.Schedule(
+        TscNanos() + std::chrono::nanoseconds(opts_.timeout).count(),
+        &OnTimeout, this, r.cmd.cliseq());
+    ++r.attempts;
+    auto st = link_->Send(r.cmd);
+    // A failed send is retried like a lost one, after the timeout
+    if (st.t != sss::Ok)
+      ROME_DEBUG("Client {} couldn't send CliSeq {}: {}", opts_.cliid,
+                 r.cmd.cliseq(), st.message.value_or(""));
+  }
+};
+
+} // namespace rabia
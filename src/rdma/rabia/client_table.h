@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+#include <message.pb.h>
+
+namespace rabia {
+
+struct ClientTableOptions {
+  uint32_t proxy_id = 0;
+  uint32_t window = 64; // At least every client's max_outstanding
+};
+
+/// ClientTable is the proxy's record of its clients' requests, by (CliId,
+/// CliSeq), so that a Client's retries never put a command into consensus
+/// twice.  Every Command from a client goes through Admit(), and only the ones
+/// it calls kNew go on to the ProxyBatcher.  When one of this proxy's objects
+/// is decided, Decided() marks its requests done and sends each client its
+/// reply.
+///
+/// A client keeps its CliSeqs in flight within `window` of each other (see
+/// Client), so once a client has sent CliSeq s, it will never resend anything
+/// at or below s - window.  The table forgets those entries, which keeps it at
+/// `window` entries per client.
+class ClientTable {
+public:
+  using Options = ClientTableOptions;
+
+  /// What to do with a Command from a client
+  enum Admission {
+    kNew,     // First time seen: batch it
+    kPending, // Already in consensus: drop it
+    kDecided, // Already decided: send the reply again
+    kStale,   // Too old to know about: drop it
+  };
+
+  /// Called with the reply for each decided request
+  using ReplyFn = std::function<void(uint32_t cliid,
+                                     const message::Command &reply)>;
+
+private:
+  struct Client {
+    uint32_t max_seq = 0;
+    /// SvrSeq of the deciding slot, or kUndecided
+    std::map<uint32_t, uint32_t> seqs;
+  };
+  static constexpr uint32_t kUndecided = ~0u;
+
+  const Options opts_;
+  std::unordered_map<uint32_t, Client> clients_;
+
+public:
+  explicit ClientTable(Options opts) : opts_(opts) {}
+
+  ClientTable(const ClientTable &) = delete;
+  ClientTable(ClientTable &&) = delete;
+
+  /// Classify `cmd`, and remember it if it is new
+  ///
+  /// @param svrseq Set to the deciding slot if the result is kDecided
+  Admission Admit(const message::Command &cmd, uint32_t *svrseq) {
+    Client &c = clients_[cmd.cliid()];
+    uint32_t seq = cmd.cliseq();
+    if (c.max_seq >= opts_.window && seq <= c.max_seq - opts_.window)
+      return kStale;
+    auto it = c.seqs.find(seq);
+    if (it != c.seqs.end()) {
+      if (it->second == kUndecided)
+        return kPending;
+      *svrseq = it->second;
+      return kDecided;
+    }
+    c.seqs.emplace(seq, kUndecided);
+    if (seq > c.max_seq) {
+      c.max_seq = seq;
+      if (seq >= opts_.window)
+        c.seqs.erase(c.seqs.begin(), c.seqs.upper_bound(seq - opts_.window));
+    }
+    return kNew;
+  }
+
+  /// Record that `obj` was decided in `slot`, and call `reply` for each of its
+  /// requests.  Objects from other proxies, and NULL slots, are ignored.
+  void Decided(uint32_t slot, const message::ConsensusObj &obj,
+               const ReplyFn &reply) {
+    if (obj.isnull() || obj.proid() != opts_.proxy_id)
+      return;
+    message::Command r;
+    r.set_svrseq(slot);
+    for (int i = 0; i < obj.cliids_size(); ++i) {
+      auto c = clients_.find(obj.cliids(i));
+      if (c == clients_.end())
+        continue;
+      auto it = c->second.seqs.find(obj.cliseqs(i));
+      // Forgotten: the client has moved on from it
+      if (it == c->second.seqs.end())
+        continue;
+      it->second = slot;
+      r.set_cliid(obj.cliids(i));
+      r.set_cliseq(obj.cliseqs(i));
+      reply(obj.cliids(i), r);
+    }
+  }
+
+  /// A reply for a request that Admit() called kDecided
+  static message::Command Reply(const message::Command &cmd, uint32_t svrseq) {
+    message::Command r;
+    r.set_cliid(cmd.cliid());
+    r.set_cliseq(cmd.cliseq());
+    r.set_svrseq(svrseq);
+    return r;
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+#include "wire.h"
+
+namespace rabia {
+
+struct CoalescerOptions {
+  /// The most bytes of frames packed in one Batch, or 0 to pass every
+  /// message straight through.  The default keeps a Batch under the 256
+  /// bytes that a Rome TwoSidedRdmaMessenger receives at once.
+  uint32_t max_bytes = 240;
+};
+
+/// Coalescer is a Transport (see LocalNetwork) that wraps another one and
+/// packs the messages sent to each peer during one event-loop tick into a
+/// single Batch message, so that a window of slots in flight costs one send
+/// (one work request, one completion) per peer per tick rather than one per
+/// State or Vote.
+///
+/// Send() encodes `msg` with the wire format onto the peer's pending frame.
+/// Flush(), registered as the last poller of the replica's EventLoop, sends
+/// each peer's pending frame as a Batch whose `Frames` are the encodings back
+/// to back.  A frame also goes out when the next message wouldn't fit in
+/// `max_bytes`.  A message too big for any frame, or that the wire format
+/// can't encode, flushes the peer's frame and is then sent as is, so each
+/// link stays FIFO.
+///
+/// TryReceive() takes a Batch from the wrapped transport apart into its
+/// messages and hands them back one at a time, in order, so WeakMvc handles
+/// each against its own slot as if it had arrived alone.  Messages that
+/// aren't Batches pass through.
+///
+/// NB: Every replica must wrap its transport in a Coalescer (with any
+///     `max_bytes`), since WeakMvc itself doesn't take Batches apart.
+///
+/// NB: A message waits in its frame until Flush(), so a replica that sends
+///     without polling its loop must call Flush() itself.
+template <class Transport> class Coalescer {
+public:
+  using Options = CoalescerOptions;
+
+private:
+  /// What is pending for, or unpacked from, one peer
+  struct Link {
+    std::string out;             // Frames not sent yet
+    uint32_t out_msgs = 0;       // How many messages are in `out`
+    std::deque<message::Msg> in; // Taken from a Batch, not yet received
+  };
+
+  Transport *inner_; //! NOT OWNED
+  const Options opts_;
+  std::vector<Link> links_;
+
+  uint64_t num_batches_ = 0; // Batches sent
+  uint64_t num_packed_ = 0;  // Messages sent in them
+  uint64_t num_dropped_ = 0; // Batches received that were cut short
+
+  /// Send `to`'s pending frame, if it has one
+  sss::Status FlushLink(uint32_t to) {
+    Link &l = links_[to];
+    if (l.out_msgs == 0)
+      return sss::Status::Ok();
+    message::Msg batch;
+    batch.set_type(message::Batch);
+    batch.set_value(l.out_msgs);
+    batch.set_frames(l.out);
+    ++num_batches_;
+    num_packed_ += l.out_msgs;
+    l.out.clear();
+    l.out_msgs = 0;
+    return inner_->Send(to, batch);
+  }
+
+  /// Queue the messages in `batch` from `from` for TryReceive().  A Batch
+  /// that is corrupt partway through keeps the messages before the bad frame
+  /// and drops the rest, since frames can't be found past one that doesn't
+  /// parse.
+  void Unpack(uint32_t from, const message::Msg &batch) {
+    Link &l = links_[from];
+    const auto &frames = batch.frames();
+    const auto *buf = reinterpret_cast<const uint8_t *>(frames.data());
+    size_t off = 0;
+    for (uint32_t i = 0; i < batch.value(); ++i) {
+      auto view = wire::View::Parse(buf + off, frames.size() - off);
+      if (view.status.t != sss::Ok) {
+        ROME_WARN("Dropping {} of {} messages in a batch from {}: {}",
+                  batch.value() - i, batch.value(), from,
+                  view.status.message.value_or(""));
+        ++num_dropped_;
+        return;
+      }
+      view.val->ToMsg(&l.in.emplace_back());
+      off += view.val->size();
+    }
+    if (off != frames.size())
+      ROME_WARN("Ignoring {} stray bytes in a batch from {}",
+                frames.size() - off, from);
+  }
+
+public:
+  /// @param inner  The transport to send and receive Batches on (not owned)
+  /// @param opts   How big a Batch may get
+  explicit Coalescer(Transport *inner, Options opts = Options())
+      : inner_(inner), opts_(opts), links_(inner->size()) {}
+
+  Coalescer(const Coalescer &) = delete;
+  Coalescer(Coalescer &&) = delete;
+
+  uint32_t self() const { return inner_->self(); }
+  uint32_t size() const { return inner_->size(); }
+
+  // Getters.
+  Transport *inner() { return inner_; }
+  uint64_t num_batches() const { return num_batches_; }
+  uint64_t num_packed() const { return num_packed_; }
+  uint64_t num_dropped() const { return num_dropped_; }
+
+  sss::Status Send(uint32_t to, const message::Msg &msg) {
+    if (opts_.max_bytes == 0 || to >= links_.size())
+      return inner_->Send(to, msg);
+    Link &l = links_[to];
+    const size_t size = wire::EncodedSize(msg);
+    if (size > opts_.max_bytes) {
+      auto s = FlushLink(to);
+      RETURN_STATUS_ON_ERROR(s);
+      return inner_->Send(to, msg);
+    }
+    if (l.out.size() + size > opts_.max_bytes) {
+      auto s = FlushLink(to);
+      RETURN_STATUS_ON_ERROR(s);
+    }
+    const size_t at = l.out.size();
+    l.out.resize(at + size);
+    auto len =
+        wire::Encode(msg, reinterpret_cast<uint8_t *>(l.out.data() + at), size);
+    if (len.status.t != sss::Ok) {
+      l.out.resize(at);
+      auto s = FlushLink(to);
+      RETURN_STATUS_ON_ERROR(s);
+      return inner_->Send(to, msg);
+    }
+    ++l.out_msgs;
+    return sss::Status::Ok();
+  }
+
+  std::optional<message::Msg> TryReceive(uint32_t from) {
+    if (from >= links_.size())
+      return inner_->TryReceive(from);
+    Link &l = links_[from];
+    while (l.in.empty()) {
+      auto msg = inner_->TryReceive(from);
+      if (!msg.has_value() || msg->type() != message::Batch)
+        return msg;
+      Unpack(from, msg.value());
+    }
+    message::Msg msg = std::move(l.in.front());
+    l.in.pop_front();
+    return msg;
+  }
+
+  /// READ a peer's catch-up log, if the wrapped transport can (see
+  /// RdmaMailboxTransport::ReadCatchup())
+  void ReadCatchup(uint32_t from, uint32_t first, uint32_t count,
+                   std::vector<message::Msg> *out)
+    requires requires(Transport &t) { t.ReadCatchup(from, first, count, out); }
+  {
+    inner_->ReadCatchup(from, first, count, out);
+  }
+
+  /// Send every peer's pending frame.  A peer whose link is closed just
+  /// misses its Batch, as it would have missed the messages (see WeakMvc).
+  ///
+  /// @return How many Batches were sent
+  int Flush() {
+    int sent = 0;
+    for (uint32_t to = 0; to < links_.size(); ++to) {
+      if (links_[to].out_msgs == 0)
+        continue;
+      auto s = FlushLink(to);
+      if (s.t != sss::Ok) {
+        ROME_DEBUG("Batch to {} failed: {}", to, s.message.value_or(""));
+        continue;
+      }
+      ++sent;
+    }
+    return sent;
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <logging/logging.h>
+
+namespace rabia {
+
+/// The seed that all replicas use for the common coin, unless told otherwise
+static constexpr uint64_t kDefaultCoinSeed = 0x5ab1a5ab1a5ab1a5ull;
+
+/// Flip the common coin for `phase` of `slot`.  Every replica computes the same
+/// bit from the same seed, which is all that Weak-MVC needs from the coin.
+///
+/// This is splitmix64's finalizer over (seed, slot, phase).
+inline uint32_t CommonCoin(uint64_t seed, uint32_t slot, uint32_t phase) {
+  uint64_t z = seed + ((uint64_t(slot) << 32) | phase) * 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z = z ^ (z >> 31);
+  return uint32_t(z & 1);
+}
+
+/// The coins for phases [0, 8) of slots [first, first + 8), with phase p of
+/// slot first + i at bit 8 * i + p.  Each bit is CommonCoin(seed, slot, p).
+///
+/// The 64 coins are independent lanes with no branches, so the compiler
+/// vectorizes the loop (4 or 8 lanes at a time, depending on -march).
+inline uint64_t CommonCoinWord(uint64_t seed, uint32_t first) {
+  // ((slot << 32) | p) * k == (slot << 32) * k + p * k, since p < 2^32
+  const uint64_t base = seed + (uint64_t(first) << 32) * 0x9e3779b97f4a7c15ull;
+  uint64_t word = 0;
+  for (uint64_t l = 0; l < 64; ++l) {
+    uint64_t z = base + (l >> 3) * (0x9e3779b97f4a7c15ull << 32) +
+                 (l & 7) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z = z ^ (z >> 31);
+    word |= (z & 1) << l;
+  }
+  return word;
+}
+
+struct CoinTableOptions {
+  uint64_t seed = kDefaultCoinSeed; // Must match on every replica
+  uint32_t block_slots = 32768; // Slots per block, 1 byte each (a power of 2)
+  uint32_t blocks = 4; // Blocks held: the current one and those ahead (ditto)
+  bool background = true; // Fill ahead on a thread, or on first use if not
+  std::chrono::microseconds idle{200}; // The filler's nap when all is filled
+};
+
+/// CoinTable precomputes the common coin, so that a flip is an array lookup
+/// rather than a hash.  Its coins are exactly CommonCoin(seed, slot, phase), so
+/// replicas with and without a table agree.
+///
+/// The table holds `blocks` blocks of `block_slots` consecutive slots, with the
+/// coins for phases 0 to 7 of each slot in a byte (see CommonCoinWord()); a
+/// contended slot rarely needs more than a couple of phases.  The block for
+/// slot s lives at position (s / block_slots) % blocks; both are powers of two,
+/// so finding it is a shift and a mask.  Flip()
+/// remembers the highest slot it was asked about, and a background thread
+/// keeps that slot's block and the `blocks - 1` after it filled, so a replica
+/// moving forward through its slots always finds them ready.
+///
+/// A flip never waits or locks: a block is published with a sequence tag
+/// (a seqlock), and a lookup that finds the wrong block there, finds it being
+/// refilled, or asks for phase 8 or later, just calls CommonCoin().  Those
+/// misses are counted, and should be rare.
+///
+/// Flip() is safe to call from many threads, so one table can serve every
+/// replica in a process (e.g. a LocalCluster).  Without `background`, a miss
+/// fills the block on the caller's thread instead, which is only safe with a
+/// single caller (e.g. bench/sim_bench.cc).
+class CoinTable {
+public:
+  using Options = CoinTableOptions;
+
+  /// The coins for phases past this come from CommonCoin()
+  static constexpr uint32_t kPhases = 8;
+
+private:
+  static constexpr uint64_t kEmpty = ~0ull;
+  static constexpr uint64_t kFilling = ~0ull - 1;
+
+  struct Block {
+    /// The index of the block held (slot / block_slots), kEmpty or kFilling
+    std::atomic<uint64_t> tag{kEmpty};
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+  };
+
+  const Options opts_;
+  const uint32_t block_shift_; // log2(block_slots)
+  std::vector<Block> blocks_;
+  std::atomic<uint32_t> hint_{0}; // The highest slot asked about
+  std::atomic<bool> running_{false};
+  std::thread filler_;
+
+  std::atomic<uint64_t> num_misses_{0};
+  std::atomic<uint64_t> num_fills_{0};
+
+public:
+  explicit CoinTable(Options opts)
+      : opts_(opts), block_shift_(std::countr_zero(opts.block_slots)),
+        blocks_(opts.blocks) {
+    ROME_ASSERT(std::has_single_bit(opts_.block_slots) &&
+                    opts_.block_slots >= 8 && std::has_single_bit(opts_.blocks),
+                "Coin table blocks must be a power of two of at least 8 slots, "
+                "and there must be a power of two of them");
+    for (auto &b : blocks_)
+      b.words =
+          std::make_unique<std::atomic<uint64_t>[]>(opts_.block_slots / 8);
+    // Start out with the first blocks, so the first slots don't miss
+    for (uint64_t b = 0; b < opts_.blocks; ++b)
+      Fill(b);
+    if (opts_.background) {
+      running_ = true;
+      filler_ = std::thread([this]() { FillAhead(); });
+    }
+  }
+
+  ~CoinTable() {
+    running_ = false;
+    if (filler_.joinable())
+      filler_.join();
+  }
+
+  CoinTable(const CoinTable &) = delete;
+  CoinTable(CoinTable &&) = delete;
+
+  // Getters.
+  uint64_t seed() const { return opts_.seed; }
+  uint64_t num_misses() const { return num_misses_.load(); }
+  uint64_t num_fills() const { return num_fills_.load(); }
+
+  /// Flip the common coin for `phase` of `slot`
+  uint32_t Flip(uint32_t slot, uint32_t phase) {
+    if (phase < kPhases) {
+      if (slot > hint_.load(std::memory_order_relaxed))
+        hint_.store(slot, std::memory_order_relaxed);
+      const uint64_t b = slot >> block_shift_;
+      Block &blk = blocks_[b & (opts_.blocks - 1)];
+      if (blk.tag.load(std::memory_order_acquire) != b && !opts_.background)
+        Fill(b);
+      if (blk.tag.load(std::memory_order_acquire) == b) {
+        const uint32_t i = slot & (opts_.block_slots - 1);
+        uint64_t w = blk.words[i / 8].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (blk.tag.load(std::memory_order_relaxed) == b)
+          return uint32_t((w >> (8 * (i % 8) + phase)) & 1);
+      }
+    }
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    return CommonCoin(opts_.seed, slot, phase);
+  }
+
+private:
+  /// Compute block `b` into its position, retagging it around the writes so
+  /// that concurrent Flip()s see either the old block or the new one, or miss
+  void Fill(uint64_t b) {
+    Block &blk = blocks_[b & (opts_.blocks - 1)];
+    blk.tag.store(kFilling, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const uint64_t first = b << block_shift_;
+    for (uint32_t i = 0; i < opts_.block_slots / 8; ++i)
+      blk.words[i].store(CommonCoinWord(opts_.seed, uint32_t(first + 8 * i)),
+                         std::memory_order_relaxed);
+    blk.tag.store(b, std::memory_order_release);
+    num_fills_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// The filler thread: keep the hinted slot's block, and the ones after it,
+  /// in the table
+  void FillAhead() {
+    while (running_.load(std::memory_order_relaxed)) {
+      const uint64_t first = hint_.load(std::memory_order_relaxed) >> block_shift_;
+      bool filled = false;
+      for (uint64_t b = first; b < first + opts_.blocks; ++b) {
+        if (blocks_[b & (opts_.blocks - 1)].tag.load(
+                std::memory_order_relaxed) == b)
+          continue;
+        Fill(b);
+        filled = true;
+      }
+      if (!filled)
+        std::this_thread::sleep_for(opts_.idle);
+    }
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,474 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+#include "wire.h"
+
+namespace rabia {
+
+/// CRC-32C (Castagnoli), as used by iSCSI and ext4.  Uses the SSE4.2 crc32
+/// instruction when the build allows it, and a byte-wise table otherwise.
+inline uint32_t Crc32c(const uint8_t *data, size_t len, uint32_t crc = 0) {
+  crc = ~crc;
+#if defined(__SSE4_2__)
+  for (; len >= 8; data += 8, len -= 8) {
+    uint64_t v;
+    std::memcpy(&v, data, sizeof(v));
+    crc = uint32_t(__builtin_ia32_crc32di(crc, v));
+  }
+  for (; len > 0; ++data, --len)
+    crc = __builtin_ia32_crc32qi(crc, *data);
+#else
+  static const auto table = []() {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k)
+        c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  for (; len > 0; ++data, --len)
+    crc = table[(crc ^ *data) & 0xff] ^ (crc >> 8);
+#endif
+  return ~crc;
+}
+
+/// The fixed header in front of every entry in a log segment.  The payload
+/// that follows is the decided object in the wire format (a Decision
+/// ObjFrame), so a recovered entry can be read in place through a
+/// wire::View.
+struct LogEntryHeader {
+  uint32_t magic;  // kLogMagic; zero where nothing was ever written
+  uint32_t svrseq; // The slot
+  uint32_t proid;
+  uint32_t proseq;
+  uint32_t length; // Of the payload, in bytes
+  uint32_t crc;    // Crc32c of the payload, then of the first 20 bytes above
+};
+static_assert(sizeof(LogEntryHeader) == 24);
+
+static constexpr uint32_t kLogMagic = 0x52424c47; // "RBLG"
+
+/// Entries start on 8-byte boundaries
+static constexpr size_t kLogAlign = 8;
+
+struct DurableLogOptions {
+  std::string dir;                      // Created if missing
+  size_t segment_bytes = 64ull << 20;   // Pre-allocated size of each segment
+  uint32_t group_entries = 64;          // Sync after this many entries...
+  std::chrono::microseconds group_interval{1000}; // ...or this long
+};
+
+/// DurableLog persists decided slots in an append-only log of memory-mapped,
+/// pre-allocated segment files (`<dir>/<first slot>.seg`).
+///
+/// Append() only copies the entry into the mapping; nothing is durable until
+/// Sync() msyncs the pages written since the last Sync().  Poll() does that
+/// once `group_entries` entries are waiting, or once the oldest of them has
+/// waited `group_interval`, so many decisions share one flush (group commit).
+/// Because segments are allocated up front, appending never changes file
+/// metadata, and msync of the data pages is all a sync costs.
+///
+/// Open() recovers whatever an earlier run left behind.  It maps every
+/// segment and walks its entries in place, stopping at the first one whose
+/// magic, length, CRC or slot number is wrong: that is where the last run's
+/// durable prefix ends.  Anything after it in that segment is zeroed, and
+/// later segments are removed, since a torn group commit can leave later pages
+/// on disk without earlier ones.  ForEach() then visits the recovered entries
+/// without copying them out of the mapping.
+///
+/// TruncatePrefix() drops whole segments once a snapshot covers them, so the
+/// log only holds the slots since (about) the last snapshot.  The log then
+/// starts at the first remaining segment's slot rather than slot 0.
+///
+/// NB: Entries must be appended in slot order, with no gaps.  That is the
+///     order in which WeakMvc's DecideFn delivers them.
+class DurableLog {
+public:
+  using Options = DurableLogOptions;
+  using clock = std::chrono::steady_clock;
+
+private:
+  struct Segment {
+    std::string path;
+    uint32_t first_slot; // The slot of its first entry
+    int fd = -1;
+    uint8_t *base = nullptr;
+    size_t size = 0;
+    size_t used = 0; // Bytes of entries
+  };
+
+  const Options opts_;
+  std::vector<Segment> segments_; // In slot order; the last one is appended to
+
+  std::optional<uint32_t> last_slot_;    // The newest entry's slot
+  std::optional<uint32_t> durable_slot_; // The newest synced entry's slot
+  size_t synced_ = 0;          // Bytes of the tail segment known durable
+  uint32_t unsynced_ = 0;      // Entries appended since the last Sync()
+  clock::time_point oldest_;   // When the first of them was appended
+  uint64_t num_syncs_ = 0;
+
+public:
+  explicit DurableLog(Options opts) : opts_(std::move(opts)) {}
+
+  DurableLog(const DurableLog &) = delete;
+  DurableLog(DurableLog &&) = delete;
+
+  ~DurableLog() {
+    for (auto &s : segments_)
+      Close(s);
+  }
+
+  // Getters.
+  std::optional<uint32_t> last_slot() const { return last_slot_; }
+  std::optional<uint32_t> durable_slot() const { return durable_slot_; }
+  uint64_t num_syncs() const { return num_syncs_; }
+  size_t num_segments() const { return segments_.size(); }
+
+  /// The slot of the oldest entry still in the log, if there is one
+  std::optional<uint32_t> first_slot() const {
+    if (segments_.empty() || segments_.front().used == 0)
+      return std::nullopt;
+    return segments_.front().first_slot;
+  }
+
+  /// Open the log, recovering any segments already in `dir`
+  sss::Status Open() {
+    std::error_code ec;
+    std::filesystem::create_directories(opts_.dir, ec);
+    if (ec) {
+      sss::Status err = {sss::InternalError, "Can't create "};
+      return err << opts_.dir << ": " << ec.message();
+    }
+
+    std::vector<std::pair<uint32_t, std::string>> found;
+    for (auto &e : std::filesystem::directory_iterator(opts_.dir)) {
+      if (e.path().extension() != ".seg")
+        continue;
+      found.emplace_back(std::stoul(e.path().stem().string()),
+                         e.path().string());
+    }
+    std::sort(found.begin(), found.end());
+
+    bool torn = false;
+    bool removed = false;
+    for (auto &[first, path] : found) {
+      if (torn) {
+        ROME_WARN("Removing {}, which follows a torn entry", path);
+        std::filesystem::remove(path);
+        removed = true;
+        continue;
+      }
+      if (last_slot_.has_value() && first != last_slot_.value() + 1) {
+        ROME_WARN("Removing {}, which doesn't continue slot {}", path,
+                  last_slot_.value());
+        std::filesystem::remove(path);
+        removed = true;
+        torn = true;
+        continue;
+      }
+      Segment s{path, first};
+      auto st = Map(s, false);
+      RETURN_STATUS_ON_ERROR(st);
+      torn = !Scan(s);
+      segments_.push_back(s);
+    }
+    if (removed) {
+      auto st = SyncDir();
+      RETURN_STATUS_ON_ERROR(st);
+    }
+    durable_slot_ = last_slot_;
+    if (!segments_.empty())
+      synced_ = segments_.back().used;
+    return sss::Status::Ok();
+  }
+
+  /// Visit every entry in the log, oldest first, in place
+  ///
+  /// @param fn Called as fn(const LogEntryHeader &, const wire::View &); both
+  ///           point into the mapping, and are valid until the log changes
+  template <class Fn> void ForEach(Fn &&fn) const {
+    for (const auto &s : segments_) {
+      for (size_t off = 0; off < s.used;) {
+        const auto *h = reinterpret_cast<const LogEntryHeader *>(s.base + off);
+        auto view = wire::View::Parse(s.base + off + sizeof(*h), h->length);
+        fn(*h, view.val.value());
+        off += EntryBytes(h->length);
+      }
+    }
+  }
+
+  /// Append the decided object for slot `obj.svrseq()`.  It isn't durable
+  /// until the next Sync().
+  sss::Status Append(const message::ConsensusObj &obj) {
+    uint32_t slot = obj.svrseq();
+    if (last_slot_.has_value() && slot != last_slot_.value() + 1) {
+      sss::Status err = {sss::InvalidArgument, "Out-of-order append of slot "};
+      return err << slot << " after " << last_slot_.value();
+    }
+    size_t payload = wire::EncodedSize(obj);
+    size_t bytes = EntryBytes(payload);
+    if (bytes > opts_.segment_bytes) {
+      sss::Status err = {sss::InvalidArgument, "Entry too big for a segment: "};
+      return err << bytes;
+    }
+    if (segments_.empty() ||
+        segments_.back().used + bytes > segments_.back().size) {
+      auto st = NewSegment(slot);
+      RETURN_STATUS_ON_ERROR(st);
+    }
+
+    Segment &s = segments_.back();
+    uint8_t *p = s.base + s.used;
+    auto len = wire::EncodeObj(message::Decision, 0, obj.isnull() ? 0 : 1, obj,
+                               p + sizeof(LogEntryHeader), payload);
+    if (len.status.t != sss::Ok)
+      return len.status;
+    LogEntryHeader h{kLogMagic, slot, obj.proid(), obj.proseq(),
+                     uint32_t(payload), 0};
+    h.crc = EntryCrc(h, p + sizeof(h));
+    std::memcpy(p, &h, sizeof(h));
+    s.used += bytes;
+
+    if (unsynced_++ == 0)
+      oldest_ = clock::now();
+    last_slot_ = slot;
+    return sss::Status::Ok();
+  }
+
+  /// Make every appended entry durable
+  sss::Status Sync() {
+    if (unsynced_ == 0)
+      return sss::Status::Ok();
+    // Earlier segments were synced in full when they filled (NewSegment)
+    Segment &s = segments_.back();
+    auto st = SyncRange(s, synced_, s.used);
+    RETURN_STATUS_ON_ERROR(st);
+    synced_ = s.used;
+    unsynced_ = 0;
+    durable_slot_ = last_slot_;
+    ++num_syncs_;
+    return sss::Status::Ok();
+  }
+
+  /// Sync if enough entries are waiting, or the oldest has waited long
+  /// enough.  Meant to be registered with an EventLoop.
+  ///
+  /// @return 1 if it synced, otherwise 0
+  int Poll() {
+    if (unsynced_ == 0)
+      return 0;
+    if (unsynced_ < opts_.group_entries &&
+        clock::now() - oldest_ < opts_.group_interval)
+      return 0;
+    auto st = Sync();
+    ROME_ASSERT(st.t == sss::Ok, "Log sync failed: {}",
+                st.message.value_or(""));
+    return 1;
+  }
+
+  /// Remove every segment whose entries all come at or before `slot`, e.g.
+  /// because a durable snapshot covers them.  The segment being appended to
+  /// is never removed, so up to one segment's worth of covered entries stays.
+  ///
+  /// @return How many segments were removed
+  size_t TruncatePrefix(uint32_t slot) {
+    size_t drop = 0;
+    // Segment i ends just before segment i + 1 begins
+    while (drop + 1 < segments_.size() &&
+           segments_[drop + 1].first_slot <= slot + 1)
+      ++drop;
+    for (size_t i = 0; i < drop; ++i) {
+      Close(segments_[i]);
+      std::error_code ec;
+      std::filesystem::remove(segments_[i].path, ec);
+      if (ec)
+        ROME_WARN("Can't remove {}: {}", segments_[i].path, ec.message());
+    }
+    segments_.erase(segments_.begin(), segments_.begin() + drop);
+    if (drop > 0) {
+      // Only a recovery that finds the removed segments again would notice
+      // this failing, and it just removes them once more
+      auto st = SyncDir();
+      if (st.t != sss::Ok)
+        ROME_WARN("Can't sync {}: {}", opts_.dir, st.message.value_or(""));
+    }
+    return drop;
+  }
+
+private:
+  static size_t EntryBytes(size_t payload) {
+    return (sizeof(LogEntryHeader) + payload + kLogAlign - 1) &
+           ~(kLogAlign - 1);
+  }
+
+  static uint32_t EntryCrc(const LogEntryHeader &h, const uint8_t *payload) {
+    uint32_t crc = Crc32c(payload, h.length);
+    return Crc32c(reinterpret_cast<const uint8_t *>(&h),
+                  offsetof(LogEntryHeader, crc), crc);
+  }
+
+  /// Walk `s` from its start, setting `used` and `last_slot_` to cover every
+  /// good entry, and zero whatever follows
+  ///
+  /// @return False if the walk ended at a bad entry rather than clean space
+  bool Scan(Segment &s) {
+    size_t off = 0;
+    std::optional<uint32_t> expect;
+    if (last_slot_.has_value())
+      expect = last_slot_.value() + 1;
+    else
+      expect = s.first_slot;
+    bool clean = true;
+    while (off + sizeof(LogEntryHeader) <= s.size) {
+      LogEntryHeader h;
+      std::memcpy(&h, s.base + off, sizeof(h));
+      if (h.magic == 0 && h.length == 0)
+        break; // Never written
+      size_t bytes = EntryBytes(h.length);
+      if (h.magic != kLogMagic || off + bytes > s.size ||
+          h.svrseq != expect.value() ||
+          h.crc != EntryCrc(h, s.base + off + sizeof(h)) ||
+          wire::View::Parse(s.base + off + sizeof(h), h.length).status.t !=
+              sss::Ok) {
+        ROME_WARN("Log {} ends in a torn entry at offset {}", s.path, off);
+        clean = false;
+        break;
+      }
+      last_slot_ = h.svrseq;
+      expect = h.svrseq + 1;
+      off += bytes;
+    }
+    s.used = off;
+    if (!clean) {
+      std::memset(s.base + off, 0, s.size - off);
+      auto st = SyncRange(s, off, s.size);
+      ROME_ASSERT(st.t == sss::Ok, "Can't clear the torn tail of {}: {}",
+                  s.path, st.message.value_or(""));
+    }
+    return clean;
+  }
+
+  /// Start a segment whose first entry is `slot`, syncing the one it replaces
+  sss::Status NewSegment(uint32_t slot) {
+    if (!segments_.empty()) {
+      Segment &old = segments_.back();
+      auto st = SyncRange(old, synced_, old.used);
+      RETURN_STATUS_ON_ERROR(st);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%010u.seg", slot);
+    Segment s{(std::filesystem::path(opts_.dir) / name).string(), slot};
+    auto st = Map(s, true);
+    RETURN_STATUS_ON_ERROR(st);
+    // The segment's directory entry must be durable too, or a crash could
+    // lose the file along with the entries synced into it
+    st = SyncDir();
+    if (st.t != sss::Ok) {
+      Close(s);
+      std::filesystem::remove(s.path);
+      return st;
+    }
+    segments_.push_back(s);
+    synced_ = 0;
+    return sss::Status::Ok();
+  }
+
+  /// Open and map `s`, creating and pre-allocating it if `create`.  On
+  /// failure `s` is left closed, and a file it created is removed.
+  sss::Status Map(Segment &s, bool create) {
+    s.fd = open(s.path.c_str(), O_RDWR | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (s.fd < 0)
+      return Errno("open", s.path);
+    auto fail = [&](const char *what) {
+      sss::Status err = Errno(what, s.path);
+      Close(s);
+      if (create)
+        unlink(s.path.c_str());
+      return err;
+    };
+    if (create) {
+      int err = posix_fallocate(s.fd, 0, opts_.segment_bytes);
+      if (err != 0) {
+        errno = err;
+        return fail("posix_fallocate");
+      }
+      // Make the new file's size durable once, up front, so that syncing
+      // entries never has to touch metadata.  (NewSegment() syncs the
+      // directory, for its existence.)
+      if (fsync(s.fd) != 0)
+        return fail("fsync");
+      s.size = opts_.segment_bytes;
+    } else {
+      off_t size = lseek(s.fd, 0, SEEK_END);
+      if (size < 0)
+        return fail("lseek");
+      s.size = size;
+    }
+    void *p = mmap(nullptr, s.size, PROT_READ | PROT_WRITE, MAP_SHARED, s.fd, 0);
+    if (p == MAP_FAILED)
+      return fail("mmap");
+    s.base = static_cast<uint8_t *>(p);
+    return sss::Status::Ok();
+  }
+
+  /// fsync the log's directory, so that segments created or removed in it
+  /// stay that way across a crash
+  sss::Status SyncDir() const {
+    int fd = open(opts_.dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+      return Errno("open", opts_.dir);
+    if (fsync(fd) != 0) {
+      sss::Status err = Errno("fsync", opts_.dir);
+      close(fd);
+      return err;
+    }
+    close(fd);
+    return sss::Status::Ok();
+  }
+
+  /// msync the pages of `s` that hold bytes [from, to)
+  static sss::Status SyncRange(Segment &s, size_t from, size_t to) {
+    if (from >= to)
+      return sss::Status::Ok();
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    size_t start = from & ~(page - 1);
+    if (msync(s.base + start, to - start, MS_SYNC) != 0)
+      return Errno("msync", s.path);
+    return sss::Status::Ok();
+  }
+
+  static void Close(Segment &s) {
+    if (s.base != nullptr)
+      munmap(s.base, s.size);
+    if (s.fd >= 0)
+      close(s.fd);
+    s.base = nullptr;
+    s.fd = -1;
+  }
+
+  static sss::Status Errno(const char *what, const std::string &path) {
+    sss::Status err = {sss::InternalError, what};
+    return err << "(" << path << "): " << std::strerror(errno);
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace rabia {
+
+/// A single-threaded event loop.  Everything a replica does (draining its
+/// transport, proposing, feeding client load) is registered as a "poller" that
+/// is called once per tick.  A poller never blocks; it does whatever work is
+/// ready and returns how much it did, so that a tick which did nothing can be
+/// told apart from a busy one.
+///
+/// NB: This replaces the blocking `Deliver()` pattern from node1/node2, where a
+///     thread spins on one connection and can't make progress on anything else.
+class EventLoop {
+  std::vector<std::function<int()>> pollers_;
+  std::atomic<bool> running_{false};
+
+public:
+  EventLoop() = default;
+  EventLoop(const EventLoop &) = delete;
+  EventLoop(EventLoop &&) = delete;
+
+  /// Register `poller` to be run once per tick, after all earlier pollers
+  void AddPoller(std::function<int()> poller) {
+    pollers_.push_back(std::move(poller));
+  }
+
+  /// Run every poller once
+  ///
+  /// @return The total amount of work reported by the pollers
+  int RunOnce() {
+    int work = 0;
+    for (auto &p : pollers_)
+      work += p();
+    return work;
+  }
+
+  /// Run ticks until some thread calls Stop().  A tick that found no work
+  /// yields, so that replicas sharing a core don't spin out each other's
+  /// scheduler quantum.
+  void Run() {
+    running_ = true;
+    while (running_.load(std::memory_order_relaxed)) {
+      if (RunOnce() == 0)
+        std::this_thread::yield();
+    }
+  }
+
+  /// Ask Run() to return after its current tick.  Safe to call from any thread.
+  void Stop() { running_ = false; }
+
+  bool running() const { return running_; }
+};
+
+} // namespace rabia
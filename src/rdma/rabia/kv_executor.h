@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <iht/iht_local.h>
+#include <logging/logging.h>
+#include <message.pb.h>
+
+#include "snapshot_store.h"
+#include "trace.h"
+#include "wire.h"
+
+namespace rabia {
+
+/// The outcome of one command.  A read returns the key's value, if it has
+/// one; a write returns the value it replaced, if any.
+struct KvResult {
+  bool found = false;
+  uint64_t value = 0;
+};
+
+/// How KvExecutor spreads commands over threads
+struct KvExecutorOptions {
+  uint32_t workers = 4;       // 0 applies every command on the caller's thread
+  uint32_t queue_depth = 4096; // Commands queued per worker, at most
+  uint32_t trace_node = 0;     // The replica, in trace events (see trace.h)
+};
+
+/// KvExecutor applies decided slots to an in-memory key-value store (an
+/// `iht_carumap`), using the command layout from message.proto: a 1-byte op
+/// ('0' write, '1' read), an 8-byte key, and an 8-byte value.
+///
+/// Each key belongs to one worker thread, chosen by hashing the key.  Submit()
+/// walks a slot's commands in order and appends each one to its key's worker
+/// queue, so commands on different keys run in parallel, while the commands
+/// on any one key run one at a time, in (slot, index) order, on one thread.
+/// That is the order a single-threaded apply loop would use, so every replica
+/// computes the same results no matter how many workers it has.
+///
+/// Slots finish out of order, but Poll() hands them to the DoneFn strictly in
+/// the order they were submitted, once every command in the slot has run.
+///
+/// NB: Submit() and Poll() must be called from one thread (the replica's
+///     EventLoop).  If a worker's queue is full, Submit() waits for it to
+///     drain, which is the only time it blocks.
+///
+/// NB: The workers share one map.  Since no two of them touch the same key,
+///     the map's per-bucket locks only ever contend on bucket collisions.
+///
+/// Snapshots
+/// ---------
+/// With a SnapshotStore attached, each worker remembers which of its keys
+/// were written since the last snapshot.  BeginSnapshot() queues a marker
+/// behind the last submitted slot on every worker.  When a worker reaches its
+/// marker, it freezes its set of changed keys and starts a fresh one, and
+/// carries on applying.  A background thread then copies the frozen keys'
+/// values out of the map and adds them to the store as a delta.
+///
+/// The copy is copy-on-write at the granularity of a key: before a worker
+/// overwrites a frozen key that the background thread hasn't copied yet, it
+/// copies the old value itself.  So the snapshot sees every key exactly as of
+/// the marker's slot, and applying never waits for the snapshot (only, at
+/// worst, for one map read of a key that both want at once).  Once the delta
+/// is durable, Poll() reports the slot to the SnapshotFn, and the log before
+/// it (see DurableLog::TruncatePrefix) is no longer needed.
+class KvExecutor {
+public:
+  using Options = KvExecutorOptions;
+  using Map = iht_carumap<uint64_t, uint64_t, 8, 64>;
+
+  /// Called once per submitted slot, in submission order, with one result per
+  /// command
+  using DoneFn = std::function<void(uint32_t slot,
+                                    const std::vector<KvResult> &results)>;
+
+  /// Called from Poll() when a snapshot finishes.  If `status` is Ok, every
+  /// slot up to and including `slot` is in the SnapshotStore.
+  using SnapshotFn = std::function<void(uint32_t slot, sss::Status status)>;
+
+private:
+  /// One submitted slot.  `cmds` is a copy of its commands, back to back, so
+  /// that the caller's object can go away as soon as Submit() returns.
+  struct Batch {
+    uint32_t slot;
+    std::string cmds;
+    std::vector<KvResult> results;
+    std::atomic<uint32_t> remaining;
+  };
+
+  /// One command, as queued for a worker.  An Op with no batch is a snapshot
+  /// marker.
+  struct Op {
+    Batch *batch;
+    uint32_t index;
+  };
+
+  /// A key frozen for the snapshot in progress, and (once `state` is kCopied)
+  /// its value as of the snapshot's slot
+  struct FrozenKey {
+    uint64_t key;
+    uint64_t value = 0;
+    std::atomic<uint8_t> state{kUncopied};
+  };
+  static constexpr uint8_t kUncopied = 0, kCopying = 1, kCopied = 2;
+
+  /// One worker's frozen keys.  `index` is built before the Frozen is
+  /// published and never changes after, so both threads can read it.
+  struct Frozen {
+    std::unique_ptr<FrozenKey[]> keys;
+    size_t size = 0;
+    std::unordered_map<uint64_t, size_t> index;
+  };
+
+  /// A bounded single-producer, single-consumer queue of Ops.  Submit() is
+  /// the producer and the worker is the consumer.
+  struct alignas(64) Queue {
+    std::vector<Op> ring;
+    alignas(64) std::atomic<uint64_t> head{0}; // Next Op to take
+    alignas(64) std::atomic<uint64_t> tail{0}; // Next free entry
+
+    explicit Queue(uint32_t depth) : ring(depth) {}
+
+    bool TryPush(const Op &op) {
+      uint64_t t = tail.load(std::memory_order_relaxed);
+      if (t - head.load(std::memory_order_acquire) == ring.size())
+        return false;
+      ring[t % ring.size()] = op;
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    std::optional<Op> TryPop() {
+      uint64_t h = head.load(std::memory_order_relaxed);
+      if (h == tail.load(std::memory_order_acquire))
+        return std::nullopt;
+      Op op = ring[h % ring.size()];
+      head.store(h + 1, std::memory_order_release);
+      return op;
+    }
+  };
+
+  /// Everything one worker owns.  With no workers, the caller's thread uses
+  /// the one Partition, and its queue is unused.
+  struct Partition {
+    Queue q;
+    std::unordered_set<uint64_t> dirty; // Keys written since the last marker
+    std::unique_ptr<Frozen> frozen;     // Set at the marker; only the worker
+                                        // replaces it
+
+    explicit Partition(uint32_t depth) : q(depth) {}
+  };
+
+  const Options opts_;
+  DoneFn on_done_;
+  Map map_;
+
+  std::deque<std::unique_ptr<Batch>> batches_; // Submitted, not yet delivered
+  std::vector<std::unique_ptr<Partition>> parts_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> running_{true};
+
+  SnapshotStore *store_ = nullptr; //! NOT OWNED
+  SnapshotFn on_snapshot_;
+  std::optional<uint32_t> last_submitted_;
+  std::thread snapshotter_;
+  uint32_t snap_slot_ = 0;
+  sss::Status snap_status_;
+  std::atomic<bool> snapping_{false};  // Between BeginSnapshot() and Poll()
+  std::atomic<uint32_t> frozen_{0};    // Workers past the current marker
+  std::atomic<bool> snap_done_{false}; // Set by the snapshot thread
+  uint64_t num_snapshots_ = 0;
+
+  uint64_t num_applied_ = 0; // Commands in delivered slots
+  uint32_t num_slots_ = 0;   // Delivered slots
+
+public:
+  /// Construct the executor and start its workers
+  ///
+  /// @param on_done  Called with each slot's results, from Poll()
+  /// @param opts     The number of workers and the depth of their queues
+  explicit KvExecutor(DoneFn on_done, Options opts = Options())
+      : opts_(opts), on_done_(std::move(on_done)) {
+    ROME_ASSERT(opts_.workers == 0 || opts_.queue_depth > 0,
+                "Worker queues need at least one entry");
+    for (uint32_t w = 0; w < std::max(opts_.workers, 1u); ++w)
+      parts_.push_back(std::make_unique<Partition>(
+          opts_.workers == 0 ? 1 : opts_.queue_depth));
+    for (uint32_t w = 0; w < opts_.workers; ++w)
+      workers_.emplace_back([this, w]() { Work(*parts_[w]); });
+  }
+
+  KvExecutor(const KvExecutor &) = delete;
+  KvExecutor(KvExecutor &&) = delete;
+
+  /// Stop the workers.  Slots that were submitted but not delivered are
+  /// dropped.
+  ~KvExecutor() {
+    running_ = false;
+    for (auto &t : workers_)
+      t.join();
+    if (snapshotter_.joinable())
+      snapshotter_.join();
+  }
+
+  /// Keep snapshots in `store`, reporting each finished one to `on_snapshot`.
+  /// Call this before the first Submit(), and after Restore() if the store
+  /// already has a chain.
+  void AttachSnapshots(SnapshotStore *store, SnapshotFn on_snapshot) {
+    ROME_ASSERT(batches_.empty() && !last_submitted_.has_value(),
+                "Attach snapshots before submitting anything");
+    store_ = store;
+    on_snapshot_ = std::move(on_snapshot);
+  }
+
+  /// Load the state in `store` into the map.  Call this before the first
+  /// Submit().
+  ///
+  /// @return The last slot the state includes, if the store had any
+  sss::StatusVal<std::optional<uint32_t>> Restore(const SnapshotStore &store) {
+    ROME_ASSERT(batches_.empty() && !last_submitted_.has_value(),
+                "Restore before submitting anything");
+    auto st = store.Load([&](uint64_t k, uint64_t v) { Put(k, v); });
+    if (st.t != sss::Ok)
+      return {st, {}};
+    return {sss::Status::Ok(), store.last_slot()};
+  }
+
+  /// Start a snapshot of the state after the last submitted slot.  The
+  /// SnapshotFn is called from Poll() when it finishes.
+  ///
+  /// @return False if there's no store, nothing new was submitted since the
+  ///         last snapshot, or a snapshot is still running
+  bool BeginSnapshot() {
+    if (store_ == nullptr || snapping_ || !last_submitted_.has_value())
+      return false;
+    auto last = store_->last_slot();
+    if (last.has_value() && last.value() >= last_submitted_.value())
+      return false;
+    if (snapshotter_.joinable())
+      snapshotter_.join();
+    snap_slot_ = last_submitted_.value();
+    snapping_ = true;
+    frozen_ = 0;
+    snap_done_ = false;
+    if (opts_.workers == 0) {
+      Freeze(*parts_[0]);
+    } else {
+      for (auto &p : parts_)
+        while (!p->q.TryPush({nullptr, 0}))
+          std::this_thread::yield();
+    }
+    snapshotter_ = std::thread([this]() { TakeSnapshot(); });
+    return true;
+  }
+
+  /// Queue the commands of `obj`, which was decided in slot `slot`.  A NULL
+  /// object still gets a (empty) delivery, so every slot is reported.
+  void Submit(uint32_t slot, const message::ConsensusObj &obj) {
+    last_submitted_ = slot;
+    auto b = std::make_unique<Batch>();
+    b->slot = slot;
+    if (!obj.isnull()) {
+      b->cmds.reserve(size_t(wire::kCommandBytes) * obj.commands_size());
+      for (const auto &c : obj.commands()) {
+        ROME_ASSERT(c.size() == wire::kCommandBytes,
+                    "Command is not 17 bytes");
+        b->cmds.append(c);
+      }
+    }
+    Dispatch(std::move(b));
+  }
+
+  /// Like Submit(), straight from a received wire frame
+  void Submit(uint32_t slot, const wire::View &view) {
+    last_submitted_ = slot;
+    auto b = std::make_unique<Batch>();
+    b->slot = slot;
+    if (!view.binary() && !view.isnull() && view.num_commands() > 0) {
+      // The commands are contiguous in the frame
+      auto first = view.command(0);
+      b->cmds.assign(first.data(),
+                     size_t(wire::kCommandBytes) * view.num_commands());
+    }
+    Dispatch(std::move(b));
+  }
+
+  /// Deliver every finished slot at the front of the queue to the DoneFn,
+  /// and report a finished snapshot to the SnapshotFn
+  ///
+  /// @return How many slots and snapshots were delivered
+  int Poll() {
+    int work = 0;
+    if (snapping_ && snap_done_.load(std::memory_order_acquire)) {
+      snapshotter_.join();
+      snapping_ = false;
+      ++num_snapshots_;
+      ++work;
+      if (on_snapshot_)
+        on_snapshot_(snap_slot_, snap_status_);
+    }
+    while (!batches_.empty() &&
+           batches_.front()->remaining.load(std::memory_order_acquire) == 0) {
+      auto &b = *batches_.front();
+      RABIA_TRACE_EVENT(opts_.trace_node, b.slot, 0, kExecute);
+      on_done_(b.slot, b.results);
+      num_applied_ += b.results.size();
+      ++num_slots_;
+      batches_.pop_front();
+      ++work;
+    }
+    return work;
+  }
+
+  /// Read `key` directly.  Only meaningful once every slot that writes it has
+  /// been delivered.
+  std::optional<uint64_t> Get(uint64_t key) {
+    uint64_t val;
+    if (map_.get(key, val))
+      return val;
+    return std::nullopt;
+  }
+
+  uint32_t workers() const { return opts_.workers; }
+  size_t in_flight() const { return batches_.size(); }
+  uint64_t num_applied() const { return num_applied_; }
+  uint32_t num_slots() const { return num_slots_; }
+  uint64_t num_snapshots() const { return num_snapshots_; }
+  bool snapshotting() const { return snapping_; }
+
+private:
+  /// The worker that owns `key`.  The key's bytes are client data, so mix
+  /// them before taking the modulus.
+  uint32_t WorkerOf(uint64_t key) const {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return uint32_t(key % opts_.workers);
+  }
+
+  static uint64_t KeyOf(const char *cmd) {
+    uint64_t key;
+    std::memcpy(&key, cmd + 1, sizeof(key));
+    return key;
+  }
+
+  /// Queue every command of `b` on its key's worker, or apply them here if
+  /// there are no workers
+  void Dispatch(std::unique_ptr<Batch> b) {
+    uint32_t n = b->cmds.size() / wire::kCommandBytes;
+    b->results.resize(n);
+    b->remaining.store(n, std::memory_order_relaxed);
+    Batch *raw = b.get();
+    // The batch must be in `batches_` before any worker can finish it
+    batches_.push_back(std::move(b));
+    for (uint32_t i = 0; i < n; ++i) {
+      if (opts_.workers == 0) {
+        Apply(*parts_[0], {raw, i});
+        continue;
+      }
+      auto &q = parts_[WorkerOf(KeyOf(raw->cmds.data() +
+                                      size_t(wire::kCommandBytes) * i))]
+                    ->q;
+      while (!q.TryPush({raw, i}))
+        std::this_thread::yield();
+    }
+  }
+
+  /// Set `key` to `val`.  iht_carumap has no update, so replacing a value is
+  /// remove + insert.  Only the key's owner calls this, so nobody sees the
+  /// key missing in between.
+  ///
+  /// @return The value it replaced, if any
+  std::optional<uint64_t> Put(uint64_t key, uint64_t val) {
+    auto old = map_.insert(key, val);
+    if (old.has_value()) {
+      uint64_t ignored;
+      map_.remove(key, ignored);
+      map_.insert(key, val);
+    }
+    return old;
+  }
+
+  /// Copy `fk`'s value out of the map, unless the other thread already has.
+  /// Whoever loses the race waits for the winner, which takes one map read.
+  void Copy(FrozenKey &fk) {
+    uint8_t expect = kUncopied;
+    if (fk.state.compare_exchange_strong(expect, kCopying,
+                                         std::memory_order_acq_rel)) {
+      uint64_t v = 0;
+      map_.get(fk.key, v);
+      fk.value = v;
+      fk.state.store(kCopied, std::memory_order_release);
+      return;
+    }
+    while (fk.state.load(std::memory_order_acquire) != kCopied)
+      std::this_thread::yield();
+  }
+
+  /// Freeze `p`'s changed keys for the snapshot in progress.  Called by the
+  /// partition's worker when it reaches the marker.
+  void Freeze(Partition &p) {
+    auto f = std::make_unique<Frozen>();
+    f->size = p.dirty.size();
+    f->keys = std::make_unique<FrozenKey[]>(f->size);
+    f->index.reserve(f->size);
+    size_t i = 0;
+    for (uint64_t k : p.dirty) {
+      f->keys[i].key = k;
+      f->index.emplace(k, i++);
+    }
+    p.dirty.clear();
+    p.frozen = std::move(f);
+    frozen_.fetch_add(1, std::memory_order_release);
+  }
+
+  /// The snapshot thread: wait for every worker to freeze its keys, copy the
+  /// ones nobody has copied yet, and write them to the store
+  void TakeSnapshot() {
+    while (frozen_.load(std::memory_order_acquire) < parts_.size())
+      std::this_thread::yield();
+    std::vector<KvPair> pairs;
+    for (auto &p : parts_) {
+      Frozen &f = *p->frozen;
+      for (size_t i = 0; i < f.size; ++i) {
+        Copy(f.keys[i]);
+        pairs.push_back({f.keys[i].key, f.keys[i].value});
+      }
+    }
+    // Sorted by key, so that every replica writes the same bytes
+    std::sort(pairs.begin(), pairs.end(),
+              [](const KvPair &a, const KvPair &b) { return a.key < b.key; });
+    snap_status_ = store_->AddDelta(snap_slot_, pairs);
+    if (snap_status_.t == sss::Ok)
+      snap_status_ = store_->Compact();
+    snap_done_.store(true, std::memory_order_release);
+  }
+
+  /// Run one command against the map, and record its result
+  void Apply(Partition &p, const Op &op) {
+    const char *cmd =
+        op.batch->cmds.data() + size_t(wire::kCommandBytes) * op.index;
+    uint64_t key = KeyOf(cmd);
+    KvResult &res = op.batch->results[op.index];
+    if (cmd[0] == '0') {
+      uint64_t val;
+      std::memcpy(&val, cmd + 9, sizeof(val));
+      if (store_ != nullptr) {
+        // Copy-on-write: the snapshot in progress needs the value from
+        // before this write
+        if (p.frozen != nullptr && snapping_.load(std::memory_order_relaxed)) {
+          auto it = p.frozen->index.find(key);
+          if (it != p.frozen->index.end())
+            Copy(p.frozen->keys[it->second]);
+        }
+        p.dirty.insert(key);
+      }
+      auto old = Put(key, val);
+      if (old.has_value())
+        res = {true, old.value()};
+    } else {
+      res.found = map_.get(key, res.value);
+    }
+    op.batch->remaining.fetch_sub(1, std::memory_order_release);
+  }
+
+  /// A worker's loop: apply whatever is queued, and yield when there's
+  /// nothing, so that idle workers don't starve the replica's own thread.
+  void Work(Partition &p) {
+    while (running_.load(std::memory_order_relaxed)) {
+      auto op = p.q.TryPop();
+      if (!op.has_value()) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (op->batch == nullptr)
+        Freeze(p);
+      else
+        Apply(p, op.value());
+    }
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <metrics/summary.h>
+
+#include "client.h"
+#include "client_table.h"
+#include "coalescer.h"
+#include "event_loop.h"
+#include "local_transport.h"
+#include "partition.h"
+#include "proxy_batcher.h"
+#include "timer_wheel.h"
+#include "weak_mvc.h"
+
+namespace rabia {
+
+/// Build a 17-byte write command: a '0' op byte, then the key and value as raw
+/// 8-byte strings (see the Command comment in message.proto)
+inline std::string MakeWriteCommand(uint64_t key, uint64_t val) {
+  std::string cmd(17, '\0');
+  cmd[0] = '0';
+  std::memcpy(cmd.data() + 1, &key, sizeof(key));
+  std::memcpy(cmd.data() + 9, &val, sizeof(val));
+  return cmd;
+}
+
+/// Build a 17-byte read command for `key`.  The value bytes are unused.
+inline std::string MakeReadCommand(uint64_t key) {
+  std::string cmd(17, '\0');
+  cmd[0] = '1';
+  std::memcpy(cmd.data() + 1, &key, sizeof(key));
+  return cmd;
+}
+
+/// LocalCluster runs `replicas` WeakMvc replicas in one process, each on its
+/// own thread with its own EventLoop, connected by a LocalNetwork.  In front of
+/// each replica is a ProxyBatcher fed by `outstanding` Clients over a
+/// LocalClientHub: each client keeps `pipeline` single-command Commands in
+/// flight, and submits the next one as soon as one completes.  A ClientTable
+/// between the hub and the batcher turns client retries into replies.  With
+/// `coalesce`, each replica's messages to a peer go out once per tick, packed
+/// by a Coalescer.
+///
+/// With `partitions` > 1, each replica runs that many independent instances,
+/// one per key partition, each with its own thread, LocalNetwork, batcher and
+/// table (and, with `pin`, its own core).  The clients and a PartitionRouter
+/// run on partition 0's thread: the router hands each Command to the instance
+/// that owns its keys, through a queue.  `cross_pct` of the Commands carry a
+/// second key from another partition, which the router rejects or sends to
+/// partition 0 (see PartitionRouterOptions).
+///
+/// This is the harness for measuring decisions/sec and commit latency on one
+/// machine.  Commit latency is measured per Command at the replica its client
+/// sent it to, from when the batcher got it to when it is decided, and also
+/// end to end, from Submit() at the client until the client has its reply.
+class LocalCluster {
+public:
+  struct Options {
+    uint32_t replicas = 3;
+    uint32_t outstanding = 1; // Clients per replica
+    uint32_t pipeline = 1;    // Commands each client keeps in flight
+    uint32_t drop_every = 0;  // Lose 1 in this many client messages (0: none)
+    std::chrono::microseconds client_timeout{10000}; // Before a resend
+    uint32_t batch = 1;       // The most Commands per object
+    std::chrono::microseconds batch_delay{100}; // Longest a Command is held
+    uint32_t window = 1;      // Slots each replica keeps in flight
+    uint32_t partitions = 1;  // Instances per replica, one per key partition
+    bool pin = false;         // Pin each instance's thread to its own core
+    uint32_t cross_pct = 0;   // Percent of Commands that span two partitions
+    bool reject_cross = true; // Reject those, or order them in partition 0
+    bool coalesce = false;    // Pack each tick's messages to a peer together
+    std::chrono::milliseconds runtime{1000};
+  };
+
+  /// What one instance (one partition of one replica) saw during a run.  The
+  /// client-side counts are all in partition 0's Result, where the clients run.
+  struct Result {
+    uint32_t id;
+    uint32_t partition = 0;
+    uint64_t decided = 0;   // Slots decided, including NULL slots
+    uint64_t null = 0;      // Slots decided NULL
+    uint64_t committed = 0; // Of this replica's clients' Commands
+    uint64_t retries = 0;   // Resends by this replica's clients
+    uint64_t rejected = 0;  // Commands the router rejected
+    uint64_t duplicates = 0; // (CliId, CliSeq)s decided more than once
+    double runtime_s = 0;
+    rome::metrics::Summary<double> latency_us{"commit_latency", "us", 10000};
+    rome::metrics::Summary<double> client_latency_us{"client_latency", "us",
+                                                     10000};
+    rome::metrics::Summary<uint32_t> batch_size{"batch_size", "cmds", 10000};
+
+    double decisions_per_sec() const { return decided / runtime_s; }
+  };
+
+private:
+  /// Commands routed to one instance from partition 0's thread
+  struct Inbox {
+    std::mutex mu;
+    std::deque<message::Command> cmds;
+  };
+
+  Options opts_;
+
+  /// Pin the calling thread to `core`, if there is such a core
+  static void PinToCore(uint32_t core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+      ROME_WARN("Couldn't pin a thread to core {}", core);
+  }
+
+public:
+  explicit LocalCluster(Options opts) : opts_(opts) {
+    ROME_ASSERT(opts_.partitions > 0, "There must be at least one partition");
+  }
+
+  /// Run the cluster for the configured time
+  ///
+  /// @return One Result per instance, by replica id and then partition
+  std::vector<std::unique_ptr<Result>> Run() {
+    using clock = std::chrono::steady_clock;
+    const uint32_t parts = opts_.partitions;
+    const uint32_t instances = opts_.replicas * parts;
+    std::vector<std::unique_ptr<LocalNetwork>> nets;
+    for (uint32_t p = 0; p < parts; ++p)
+      nets.push_back(std::make_unique<LocalNetwork>(opts_.replicas));
+    std::vector<std::unique_ptr<LocalClientHub>> hubs;
+    for (uint32_t i = 0; i < opts_.replicas; ++i)
+      hubs.push_back(std::make_unique<LocalClientHub>(opts_.outstanding,
+                                                      opts_.drop_every));
+    std::vector<std::unique_ptr<Result>> results;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    std::vector<std::unique_ptr<Inbox>> inboxes;
+    for (uint32_t k = 0; k < instances; ++k) {
+      results.push_back(std::make_unique<Result>());
+      results.back()->id = k / parts;
+      results.back()->partition = k % parts;
+      loops.push_back(std::make_unique<EventLoop>());
+      inboxes.push_back(std::make_unique<Inbox>());
+    }
+
+    std::atomic<uint32_t> ready(0);
+    std::vector<std::thread> threads;
+    for (uint32_t inst = 0; inst < instances; ++inst) {
+      threads.emplace_back([&, inst]() {
+        const uint32_t i = inst / parts, p = inst % parts;
+        if (opts_.pin)
+          PinToCore(inst);
+        Result &res = *results[inst];
+        EventLoop &loop = *loops[inst];
+        auto raw_ep = nets[p]->endpoint(i);
+        Coalescer<LocalNetwork::Endpoint> ep(
+            &raw_ep, {.max_bytes = opts_.coalesce ? CoalescerOptions().max_bytes
+                                                  : 0});
+        LocalClientHub &hub = *hubs[i];
+        auto proxy_end = hub.proxy();
+        ClientTable table({.proxy_id = i, .window = opts_.pipeline});
+        std::vector<LocalClientHub::ClientEnd> ends;
+        std::vector<std::unique_ptr<Client<LocalClientHub::ClientEnd>>>
+            clients;
+        // Partition 0 runs this replica's clients
+        for (uint32_t c = 0; p == 0 && c < opts_.outstanding; ++c)
+          ends.push_back(hub.client(c));
+        for (uint32_t c = 0; p == 0 && c < opts_.outstanding; ++c)
+          clients.push_back(
+              std::make_unique<Client<LocalClientHub::ClientEnd>>(
+                  &ends[c],
+                  ClientOptions{.cliid = c,
+                                .max_outstanding = opts_.pipeline,
+                                .timeout = opts_.client_timeout},
+                  &res.client_latency_us));
+        PartitionRouter router({.partitions = parts,
+                                .reject_cross = opts_.reject_cross});
+        // Every (CliId, CliSeq) this instance got decided, to check that
+        // retries don't commit anything twice
+        std::vector<std::unordered_set<uint32_t>> decided(opts_.outstanding);
+
+        TimerWheel timers;
+        using Mvc = WeakMvc<Coalescer<LocalNetwork::Endpoint>>;
+        Mvc *engine = nullptr;
+        ProxyBatcher proxy({.proxy_id = i,
+                            .max_batch = opts_.batch,
+                            .max_in_flight = opts_.window,
+                            .max_delay = opts_.batch_delay},
+                           [&](const message::ConsensusObj &obj) {
+                             engine->Submit(obj);
+                           },
+                           &res.batch_size, &res.latency_us);
+        Mvc mvc(
+            &ep,
+            [&](uint32_t slot, const message::ConsensusObj &obj) {
+              if (obj.isnull() || obj.proid() != i)
+                return;
+              for (int k = 0; k < obj.cliids_size(); ++k)
+                if (!decided[obj.cliids(k)].insert(obj.cliseqs(k)).second)
+                  ++res.duplicates;
+              proxy.Decided(obj);
+              table.Decided(slot, obj,
+                            [&](uint32_t cliid, const message::Command &r) {
+                              proxy_end.Send(cliid, r);
+                            });
+            },
+            {.window = opts_.window, .timers = &timers});
+        engine = &mvc;
+
+        // A Command for this instance
+        auto admit = [&](const message::Command &cmd) {
+          uint32_t svrseq;
+          switch (table.Admit(cmd, &svrseq)) {
+          case ClientTable::kNew:
+            proxy.Add(cmd);
+            break;
+          case ClientTable::kDecided:
+            proxy_end.Send(cmd.cliid(), ClientTable::Reply(cmd, svrseq));
+            break;
+          default:
+            break;
+          }
+        };
+
+        // Keys for the clients' Commands: unique per replica, so they spread
+        // over the partitions
+        uint64_t next_key = uint64_t(i) << 40;
+        std::mt19937 rng(i);
+
+        loop.AddPoller([&]() { return timers.Advance(TscNanos()); });
+        loop.AddPoller([&]() { return mvc.Poll(); });
+        loop.AddPoller([&]() { return proxy.Poll(); });
+        if (p != 0) {
+          // The Commands partition 0 routed here
+          loop.AddPoller([&]() {
+            std::deque<message::Command> cmds;
+            {
+              Inbox &in = *inboxes[inst];
+              std::lock_guard<std::mutex> g(in.mu);
+              cmds.swap(in.cmds);
+            }
+            for (const auto &cmd : cmds)
+              admit(cmd);
+            return int(cmds.size());
+          });
+        } else {
+          // The proxy's side of the hub, routing each Command to its instance
+          loop.AddPoller([&]() {
+            int work = 0;
+            while (auto cmd = proxy_end.TryReceive()) {
+              ++work;
+              auto to = router.Route(cmd.value());
+              if (to.status.t != sss::Ok) {
+                proxy_end.Send(cmd->cliid(),
+                               ClientTable::Reply(cmd.value(), kRejectedSvrSeq));
+              } else if (to.val.value() == 0) {
+                admit(cmd.value());
+              } else {
+                Inbox &in = *inboxes[i * parts + to.val.value()];
+                std::lock_guard<std::mutex> g(in.mu);
+                in.cmds.push_back(std::move(cmd.value()));
+              }
+            }
+            return work;
+          });
+          // The clients, each keeping its pipeline full
+          loop.AddPoller([&]() {
+            int work = 0;
+            for (auto &c : clients) {
+              work += c->Poll();
+              while (c->outstanding() < opts_.pipeline) {
+                ++work;
+                uint64_t key = next_key++;
+                std::vector<std::string> cmds{
+                    MakeWriteCommand(key, c->num_completed())};
+                if (rng() % 100 < opts_.cross_pct) {
+                  uint64_t other = next_key++;
+                  while (parts > 1 && PartitionOf(other, parts) ==
+                                          PartitionOf(key, parts))
+                    other = next_key++;
+                  cmds.push_back(MakeWriteCommand(other, c->num_completed()));
+                }
+                c->Submit(cmds, [&](sss::Status st, uint32_t) {
+                  if (st.t == sss::Ok)
+                    ++res.committed;
+                });
+              }
+            }
+            return work;
+          });
+        }
+
+        // Last, so it sends everything the tick queued
+        loop.AddPoller([&]() { return ep.Flush(); });
+
+        ++ready;
+        auto start = clock::now();
+        loop.Run();
+        res.runtime_s =
+            std::chrono::duration<double>(clock::now() - start).count();
+        res.decided = mvc.num_decided();
+        res.null = mvc.num_null();
+        res.rejected = router.num_rejected();
+        for (auto &c : clients)
+          res.retries += c->num_retries();
+      });
+    }
+
+    while (ready < instances)
+      std::this_thread::yield();
+    // Run() sets the running flag, so give every loop a moment to start
+    // before sleeping through the measurement window.
+    for (auto &l : loops)
+      while (!l->running())
+        std::this_thread::yield();
+    std::this_thread::sleep_for(opts_.runtime);
+    for (auto &l : loops)
+      l->Stop();
+    for (auto &t : threads)
+      t.join();
+    return results;
+  }
+};
+
+} // namespace rabia
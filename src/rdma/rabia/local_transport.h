@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <message.pb.h>
+#include <vendor/sss/status.h>
+
+namespace rabia {
+
+/// An in-process network that connects `n` replicas with a FIFO mailbox for
+/// every (sender, receiver) pair.  It gives a multi-replica run on one machine
+/// the same reliable, per-link ordered delivery that an RC queue pair gives
+/// across machines, so the consensus engine can be benchmarked without RDMA.
+///
+/// Each replica gets an `Endpoint`, which is the Transport that `WeakMvc` is
+/// instantiated with.  A Transport must provide:
+///   - `uint32_t self() const` and `uint32_t size() const`
+///   - `sss::Status Send(uint32_t to, const message::Msg &msg)`
+///   - `std::optional<message::Msg> TryReceive(uint32_t from)`, which never
+///     blocks
+class LocalNetwork {
+  /// One direction of one link
+  struct Mailbox {
+    std::mutex mu;
+    std::deque<message::Msg> msgs;
+  };
+
+  const uint32_t n_;
+
+  /// Mailbox for messages from `i` to `j` is at `boxes_[i * n_ + j]`
+  std::vector<std::unique_ptr<Mailbox>> boxes_;
+
+  Mailbox &box(uint32_t from, uint32_t to) { return *boxes_[from * n_ + to]; }
+
+public:
+  class Endpoint {
+    LocalNetwork *net_; //! NOT OWNED
+    uint32_t self_;
+
+  public:
+    Endpoint(LocalNetwork *net, uint32_t self) : net_(net), self_(self) {}
+
+    uint32_t self() const { return self_; }
+    uint32_t size() const { return net_->n_; }
+
+    sss::Status Send(uint32_t to, const message::Msg &msg) {
+      if (to >= net_->n_) {
+        sss::Status err = {sss::InvalidArgument, "No such replica: "};
+        return err << to;
+      }
+      auto &b = net_->box(self_, to);
+      std::lock_guard<std::mutex> g(b.mu);
+      b.msgs.push_back(msg);
+      return sss::Status::Ok();
+    }
+
+    std::optional<message::Msg> TryReceive(uint32_t from) {
+      auto &b = net_->box(from, self_);
+      std::lock_guard<std::mutex> g(b.mu);
+      if (b.msgs.empty())
+        return std::nullopt;
+      message::Msg msg = std::move(b.msgs.front());
+      b.msgs.pop_front();
+      return msg;
+    }
+  };
+
+  explicit LocalNetwork(uint32_t n) : n_(n) {
+    for (uint32_t i = 0; i < n * n; ++i)
+      boxes_.push_back(std::make_unique<Mailbox>());
+  }
+
+  LocalNetwork(const LocalNetwork &) = delete;
+  LocalNetwork(LocalNetwork &&) = delete;
+
+  uint32_t size() const { return n_; }
+
+  Endpoint endpoint(uint32_t id) { return Endpoint(this, id); }
+};
+
+/// An in-process link between one proxy and `n` clients, with a FIFO mailbox
+/// per direction: clients send Commands to the proxy, and the proxy replies to
+/// each client with a Command carrying the decided SvrSeq.
+///
+/// To exercise client retries, it can drop one message in every `drop_every`
+/// (0 never drops), in either direction.
+///
+/// A client's end (see Client for what it needs) is a `ClientEnd`; the proxy's
+/// is a `ProxyEnd`.
+class LocalClientHub {
+  struct Mailbox {
+    std::mutex mu;
+    std::deque<message::Command> cmds;
+  };
+
+  const uint32_t n_;
+  const uint32_t drop_every_;
+  std::atomic<uint64_t> sent_{0};
+  Mailbox requests_;                             // To the proxy
+  std::vector<std::unique_ptr<Mailbox>> replies_; // To each client, by CliId
+
+  /// Should the next message be lost?
+  bool Drop() {
+    return drop_every_ != 0 && ++sent_ % drop_every_ == 0;
+  }
+
+  static void Push(Mailbox &b, const message::Command &cmd) {
+    std::lock_guard<std::mutex> g(b.mu);
+    b.cmds.push_back(cmd);
+  }
+
+  static std::optional<message::Command> Pop(Mailbox &b) {
+    std::lock_guard<std::mutex> g(b.mu);
+    if (b.cmds.empty())
+      return std::nullopt;
+    message::Command cmd = std::move(b.cmds.front());
+    b.cmds.pop_front();
+    return cmd;
+  }
+
+public:
+  class ClientEnd {
+    LocalClientHub *hub_; //! NOT OWNED
+    uint32_t cliid_;
+
+  public:
+    ClientEnd(LocalClientHub *hub, uint32_t cliid)
+        : hub_(hub), cliid_(cliid) {}
+
+    sss::Status Send(const message::Command &cmd) {
+      if (!hub_->Drop())
+        Push(hub_->requests_, cmd);
+      return sss::Status::Ok();
+    }
+
+    std::optional<message::Command> TryReceive() {
+      return Pop(*hub_->replies_[cliid_]);
+    }
+  };
+
+  class ProxyEnd {
+    LocalClientHub *hub_; //! NOT OWNED
+
+  public:
+    explicit ProxyEnd(LocalClientHub *hub) : hub_(hub) {}
+
+    sss::Status Send(uint32_t cliid, const message::Command &reply) {
+      if (cliid >= hub_->n_) {
+        sss::Status err = {sss::InvalidArgument, "No such client: "};
+        return err << cliid;
+      }
+      if (!hub_->Drop())
+        Push(*hub_->replies_[cliid], reply);
+      return sss::Status::Ok();
+    }
+
+    std::optional<message::Command> TryReceive() {
+      return Pop(hub_->requests_);
+    }
+  };
+
+  explicit LocalClientHub(uint32_t n, uint32_t drop_every = 0)
+      : n_(n), drop_every_(drop_every) {
+    for (uint32_t i = 0; i < n; ++i)
+      replies_.push_back(std::make_unique<Mailbox>());
+  }
+
+  LocalClientHub(const LocalClientHub &) = delete;
+  LocalClientHub(LocalClientHub &&) = delete;
+
+  ClientEnd client(uint32_t cliid) { return ClientEnd(this, cliid); }
+  ProxyEnd proxy() { return ProxyEnd(this); }
+};
+
+} // namespace rabia
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <logging/logging.h>
+#include <message.pb.h>
+#include <vendor/sss/status.h>
+
+#include "wire.h"
+
+namespace rabia {
+
+/// The key of a command: the 8 bytes after its op byte
+inline uint64_t CommandKey(const std::string &cmd) {
+  uint64_t key;
+  std::memcpy(&key, cmd.data() + 1, sizeof(key));
+  return key;
+}
+
+/// The partition that owns `key`, of `partitions`.  The key's bytes are client
+/// data, so they are mixed (with splitmix64's finalizer) before the modulus.
+/// The mix differs from KvExecutor's, so that the keys of one partition still
+/// spread over all of its executor's workers.
+inline uint32_t PartitionOf(uint64_t key, uint32_t partitions) {
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+  key ^= key >> 31;
+  return uint32_t(key % partitions);
+}
+
+struct PartitionRouterOptions {
+  uint32_t partitions = 1;
+  /// Where a Command whose keys span partitions goes; if `reject_cross` is set,
+  /// it is rejected instead
+  uint32_t designated = 0;
+  bool reject_cross = true;
+};
+
+/// PartitionRouter places each client Command in the Rabia instance that owns
+/// its keys.  A replica runs one instance per partition, each with its own
+/// event loop, core, and connections, so instances never share a slot
+/// sequence: each orders only the Commands for its own keys, and they scale
+/// independently.
+///
+/// A Command whose keys fall in more than one partition has no single owner.
+/// By default it is rejected.  Otherwise it goes to the `designated` instance,
+/// which orders it with every other cross-partition Command and with that
+/// partition's own Commands, but not with the other partitions' Commands: it
+/// is only serializable for keys that single-partition Commands don't write.
+class PartitionRouter {
+public:
+  using Options = PartitionRouterOptions;
+
+private:
+  const Options opts_;
+
+  uint64_t num_routed_ = 0;
+  uint64_t num_cross_ = 0;
+  uint64_t num_rejected_ = 0;
+
+public:
+  explicit PartitionRouter(Options opts) : opts_(opts) {
+    ROME_ASSERT(opts_.partitions > 0, "There must be at least one partition");
+    ROME_ASSERT(opts_.designated < opts_.partitions,
+                "Designated partition {} out of range for {} partitions",
+                opts_.designated, opts_.partitions);
+  }
+
+  // Getters.
+  uint32_t partitions() const { return opts_.partitions; }
+  uint64_t num_routed() const { return num_routed_; }
+  uint64_t num_cross() const { return num_cross_; }
+  uint64_t num_rejected() const { return num_rejected_; }
+
+  /// The partition whose instance should order `cmd`
+  ///
+  /// @return InvalidArgument if `cmd` has no commands, a malformed one, or
+  ///         (with `reject_cross`) keys in more than one partition
+  sss::StatusVal<uint32_t> Route(const message::Command &cmd) {
+    if (cmd.commands_size() == 0) {
+      ++num_rejected_;
+      return {{sss::InvalidArgument, "Empty Command"}, {}};
+    }
+    uint32_t part = 0;
+    for (int i = 0; i < cmd.commands_size(); ++i) {
+      const auto &c = cmd.commands(i);
+      if (c.size() != wire::kCommandBytes) {
+        ++num_rejected_;
+        sss::Status err = {sss::InvalidArgument, "Malformed command of "};
+        return {err << c.size() << " bytes", {}};
+      }
+      uint32_t p = opts_.partitions == 1
+                       ? 0
+                       : PartitionOf(CommandKey(c), opts_.partitions);
+      if (i == 0) {
+        part = p;
+      } else if (p != part) {
+        ++num_cross_;
+        if (opts_.reject_cross) {
+          ++num_rejected_;
+          sss::Status err = {sss::InvalidArgument, "CliSeq "};
+          return {err << cmd.cliseq() << " spans partitions " << part
+                      << " and " << p,
+                  {}};
+        }
+        ++num_routed_;
+        return {sss::Status::Ok(), opts_.designated};
+      }
+    }
+    ++num_routed_;
+    return {sss::Status::Ok(), part};
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+
+namespace rabia {
+
+/// Identify a proposal by its proxy and that proxy's sequence number.  All NULL
+/// proposals share one key, so that a majority of idle replicas can agree on an
+/// empty slot.
+inline uint64_t ProposalKey(const message::ConsensusObj &obj) {
+  if (obj.isnull())
+    return ~0ull;
+  return (uint64_t(obj.proid()) << 32) | obj.proseq();
+}
+
+/// PendingQueue holds the objects a replica could propose, ordered by
+/// (timestamp, ProId, ProSeq), with the earliest at the top.  Replicas that
+/// queued the same objects under the same timestamps agree on the order, so
+/// they tend to propose the same object in the same slot.
+///
+/// The order lives in a 4-ary heap of 16-byte keys.  The four children of a
+/// node sit side by side in one 64-byte cache line, so sifting down touches
+/// one line per level, over half as many levels as a binary heap.  The objects
+/// themselves sit in a separate pool and never move; a sift moves keys, and
+/// the pool entry of each heap position in a compact array beside them.
+///
+/// An index from ProposalKey to the pool finds any queued object in O(1).  It
+/// is a flat, linear-probing table, so a lookup is usually one cache miss and
+/// nothing is allocated per object.  It also turns away a second copy of a
+/// queued object.
+///
+/// Taking an object out by key (one decided through another replica's
+/// proposal) is O(1) too: it leaves the index and its pool entry is marked
+/// dead, but its key stays in the heap until it reaches the top, where it is
+/// discarded.  The top is always live.  Once dead keys outnumber live ones,
+/// the heap is rebuilt without them, so they cost O(1) amortized and the heap
+/// is never much more than twice the queue.
+///
+/// Pointers returned by Top() and Find() are good until the next Push().
+class PendingQueue {
+public:
+  static constexpr uint32_t kArity = 4;
+
+  /// What the heap orders by
+  struct Key {
+    uint64_t ts;
+    uint32_t proid;
+    uint32_t proseq;
+
+    bool operator<(const Key &o) const {
+      if (ts != o.ts)
+        return ts < o.ts;
+      if (proid != o.proid)
+        return proid < o.proid;
+      return proseq < o.proseq;
+    }
+  };
+  static_assert(sizeof(Key) * kArity == 64, "A node's children fill a line");
+
+private:
+  /// Heap position i is in line (i + kPad) / kArity, so the children of every
+  /// node (kArity * i + 1 to kArity * i + kArity) start a line
+  static constexpr uint32_t kPad = kArity - 1;
+
+  struct alignas(64) Line {
+    Key keys[kArity];
+  };
+
+  static constexpr uint32_t kNone = ~0u;
+
+  /// ProposalKey to pool entry.  Open addressing with linear probing, at most
+  /// half full; deletion shifts later entries of the run back, so there are no
+  /// tombstones.
+  class Index {
+    /// The NULL key, which is never queued, marks an empty bucket
+    static constexpr uint64_t kFree = ~0ull;
+
+    struct Bucket {
+      uint64_t key = kFree;
+      uint32_t val = 0;
+    };
+    std::vector<Bucket> b_ = std::vector<Bucket>(16);
+    size_t mask_ = 15;
+    uint32_t shift_ = 60; // 64 - log2(buckets)
+    size_t size_ = 0;
+
+    /// Fibonacci hashing: the top bits of the product mix in every key bit
+    size_t Home(uint64_t key) const {
+      return (key * 0x9e3779b97f4a7c15ull) >> shift_;
+    }
+
+    /// The bucket holding `key`, or the empty one where it would go
+    size_t Probe(uint64_t key) const {
+      size_t i = Home(key);
+      while (b_[i].key != key && b_[i].key != kFree)
+        i = (i + 1) & mask_;
+      return i;
+    }
+
+    void Grow() {
+      std::vector<Bucket> old(b_.size() * 2);
+      old.swap(b_);
+      mask_ = b_.size() - 1;
+      --shift_;
+      for (const auto &e : old)
+        if (e.key != kFree)
+          b_[Probe(e.key)] = e;
+    }
+
+  public:
+    bool contains(uint64_t key) const { return b_[Probe(key)].key == key; }
+
+    /// The entry for `key`, or kNone
+    uint32_t Find(uint64_t key) const {
+      const Bucket &e = b_[Probe(key)];
+      return e.key == key ? e.val : kNone;
+    }
+
+    /// Map `key` to `val`, unless `key` is already in
+    ///
+    /// @return Whether it was added
+    bool Insert(uint64_t key, uint32_t val) {
+      if (2 * (size_ + 1) > b_.size())
+        Grow();
+      size_t i = Probe(key);
+      if (b_[i].key == key)
+        return false;
+      b_[i] = {key, val};
+      ++size_;
+      return true;
+    }
+
+    void Erase(uint64_t key) {
+      size_t i = Probe(key);
+      if (b_[i].key != key)
+        return;
+      --size_;
+      // Pull back any later entry of the run that probing from its home would
+      // no longer reach across the hole
+      for (size_t j = (i + 1) & mask_; b_[j].key != kFree; j = (j + 1) & mask_) {
+        size_t home = Home(b_[j].key);
+        if (((j - home) & mask_) >= ((j - i) & mask_)) {
+          b_[i] = b_[j];
+          i = j;
+        }
+      }
+      b_[i].key = kFree;
+    }
+  };
+
+  std::vector<Line> lines_;
+  std::vector<uint32_t> node_at_; // The pool entry at each heap position
+  uint32_t heap_size_ = 0;        // Live and dead keys
+
+  std::vector<message::ConsensusObj> objs_; // The pool
+  std::vector<uint8_t> dead_;  // Taken out, but its key is still in the heap
+  std::vector<uint32_t> free_; // Pool entries with no key in the heap
+  size_t size_ = 0;            // Live objects
+
+  Index index_;
+
+  Key &key(uint32_t pos) {
+    return lines_[(pos + kPad) / kArity].keys[(pos + kPad) % kArity];
+  }
+
+public:
+  PendingQueue() = default;
+
+  PendingQueue(const PendingQueue &) = delete;
+  PendingQueue(PendingQueue &&) = delete;
+
+  // Getters.
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool contains(uint64_t key) const { return index_.contains(key); }
+
+  /// Queue `obj`, ordered by `ts`
+  ///
+  /// @return False, and nothing queued, if an object with the same ProposalKey
+  ///         is already queued
+  bool Push(uint64_t ts, message::ConsensusObj obj) {
+    ROME_ASSERT_DEBUG(!obj.isnull(), "NULL objects are never queued");
+    uint32_t n = free_.empty() ? uint32_t(objs_.size()) : free_.back();
+    if (!index_.Insert(ProposalKey(obj), n))
+      return false;
+    if (free_.empty()) {
+      objs_.emplace_back();
+      dead_.push_back(false);
+    } else {
+      free_.pop_back();
+    }
+    Key k{ts, obj.proid(), obj.proseq()};
+    objs_[n] = std::move(obj);
+    dead_[n] = false;
+    ++size_;
+
+    uint32_t pos = heap_size_++;
+    if ((pos + kPad) / kArity >= lines_.size())
+      lines_.emplace_back();
+    if (pos >= node_at_.size())
+      node_at_.push_back(n);
+    SiftUp(pos, k, n);
+    return true;
+  }
+
+  /// The earliest object, or nullptr if the queue is empty
+  const message::ConsensusObj *Top() const {
+    return size_ == 0 ? nullptr : &objs_[node_at_[0]];
+  }
+
+  /// The queued object with ProposalKey `key`, or nullptr
+  const message::ConsensusObj *Find(uint64_t key) const {
+    uint32_t n = index_.Find(key);
+    return n == kNone ? nullptr : &objs_[n];
+  }
+
+  /// Remove and return the earliest object.  The queue must not be empty.
+  message::ConsensusObj Pop() {
+    ROME_ASSERT_DEBUG(size_ > 0, "Pop() from an empty PendingQueue");
+    // The top is live, so it leaves the heap now rather than being marked
+    const Key &k = key(0);
+    const uint32_t n = node_at_[0];
+    index_.Erase((uint64_t(k.proid) << 32) | k.proseq);
+    message::ConsensusObj obj = std::move(objs_[n]);
+    free_.push_back(n);
+    --size_;
+    uint32_t last = --heap_size_;
+    if (last > 0)
+      SiftDown(0, key(last), node_at_[last]);
+    DropDeadTop();
+    return obj;
+  }
+
+  /// Remove and return the object with ProposalKey `key`, if it is queued
+  std::optional<message::ConsensusObj> Take(uint64_t key) {
+    uint32_t n = index_.Find(key);
+    if (n == kNone)
+      return std::nullopt;
+    index_.Erase(key);
+    message::ConsensusObj obj = std::move(objs_[n]);
+    objs_[n].Clear();
+    dead_[n] = true;
+    --size_;
+    if (heap_size_ > 2 * size_ + 64)
+      Sweep();
+    else
+      DropDeadTop();
+    return obj;
+  }
+
+  /// Remove the object with ProposalKey `key`, if it is queued
+  ///
+  /// @return Whether it was
+  bool Remove(uint64_t key) { return Take(key).has_value(); }
+
+private:
+  /// Discard dead keys from the top of the heap, so the top is live
+  void DropDeadTop() {
+    while (heap_size_ > 0 && dead_[node_at_[0]]) {
+      free_.push_back(node_at_[0]);
+      uint32_t last = --heap_size_;
+      if (last > 0)
+        SiftDown(0, key(last), node_at_[last]);
+    }
+  }
+
+  /// Rebuild the heap from its live keys, bottom up
+  void Sweep() {
+    uint32_t live = 0;
+    for (uint32_t pos = 0; pos < heap_size_; ++pos) {
+      uint32_t n = node_at_[pos];
+      if (dead_[n]) {
+        free_.push_back(n);
+        continue;
+      }
+      key(live) = key(pos);
+      node_at_[live++] = n;
+    }
+    heap_size_ = live;
+    for (uint32_t pos = live / kArity + 1; pos-- > 0;)
+      if (pos < live)
+        SiftDown(pos, key(pos), node_at_[pos]);
+  }
+
+  /// Put (k, n) at `pos`, or above it if it belongs there
+  void SiftUp(uint32_t pos, const Key k, const uint32_t n) {
+    while (pos > 0) {
+      uint32_t parent = (pos - 1) / kArity;
+      if (!(k < key(parent)))
+        break;
+      key(pos) = key(parent);
+      node_at_[pos] = node_at_[parent];
+      pos = parent;
+    }
+    key(pos) = k;
+    node_at_[pos] = n;
+  }
+
+  /// Put (k, n) at `pos`, or below it if it belongs there
+  void SiftDown(uint32_t pos, const Key k, const uint32_t n) {
+    while (true) {
+      uint32_t first = kArity * pos + 1;
+      if (first >= heap_size_)
+        break;
+      uint32_t end = std::min(first + kArity, heap_size_);
+      uint32_t best = first;
+      for (uint32_t c = first + 1; c < end; ++c)
+        if (key(c) < key(best))
+          best = c;
+      if (!(key(best) < k))
+        break;
+      key(pos) = key(best);
+      node_at_[pos] = node_at_[best];
+      pos = best;
+    }
+    key(pos) = k;
+    node_at_[pos] = n;
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <metrics/summary.h>
+
+namespace rabia {
+
+/// ProxyBatcher is the proxy stage in front of a replica.  It gathers client
+/// Commands into ConsensusObjs (see the proxy batch layout in message.proto),
+/// and hands each finished object to a FlushFn, which will usually Submit() it
+/// to the replica's WeakMvc.
+///
+/// The batch is flushed when any of these holds:
+///
+/// - Fewer than `max_in_flight` of this proxy's objects are undecided.  When
+///   the system is idle, a Command is flushed on the next Poll() after it
+///   arrives, so batching adds at most one EventLoop tick of latency.
+/// - The batch holds `max_batch` Commands.
+/// - The oldest Command in the batch has waited `max_delay`.
+///
+/// NB: Only a full batch is flushed from Add().  Everything else waits for
+///     Poll(), so that Commands that arrive together in one tick go out
+///     together.
+///
+/// Under load, the in-flight objects are all still in consensus when Commands
+/// arrive, so Commands pile up until one of them is decided, and the next
+/// batch carries everything that arrived in the meantime.  The batch size thus
+/// follows the arrival rate times the commit latency, between 1 and
+/// `max_batch`, without any tuning.
+///
+/// Batch sizes (in Commands) and per-Command latency, from Add() until the
+/// object carrying it is decided, are recorded in `rome::metrics::Summary`s
+/// that the caller owns, so they outlive the batcher.
+class ProxyBatcher {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// Called with every flushed batch
+  using FlushFn = std::function<void(const message::ConsensusObj &obj)>;
+
+  struct Options {
+    uint32_t proxy_id = 0;
+    uint32_t max_batch = 64;    // Commands per object, at most
+    uint32_t max_in_flight = 1; // Undecided objects before batching kicks in
+    std::chrono::microseconds max_delay{100};
+  };
+
+private:
+  const Options opts_;
+  FlushFn flush_;
+
+  message::ConsensusObj batch_;            // The batch being built
+  std::vector<clock::time_point> arrived_; // When each Command in it arrived
+  uint32_t next_seq_ = 1;                  // ProSeq of the next batch
+
+  /// Arrival times of the Commands in each undecided batch, by ProSeq
+  std::unordered_map<uint32_t, std::vector<clock::time_point>> in_flight_;
+
+  rome::metrics::Summary<uint32_t> *batch_size_; //! NOT OWNED
+  rome::metrics::Summary<double> *latency_us_;   //! NOT OWNED
+
+public:
+  /// @param opts        Batching limits, and the id stamped into each object
+  /// @param flush       Called with each batch, in ProSeq order
+  /// @param batch_size  Gets the size of each batch, in Commands (not owned)
+  /// @param latency_us  Gets the latency of each Command (not owned)
+  ProxyBatcher(Options opts, FlushFn flush,
+               rome::metrics::Summary<uint32_t> *batch_size,
+               rome::metrics::Summary<double> *latency_us)
+      : opts_(opts), flush_(std::move(flush)), batch_size_(batch_size),
+        latency_us_(latency_us) {
+    ROME_ASSERT(opts_.max_batch > 0 && opts_.max_in_flight > 0,
+                "Batch and in-flight limits must be positive");
+  }
+
+  ProxyBatcher(const ProxyBatcher &) = delete;
+  ProxyBatcher(ProxyBatcher &&) = delete;
+
+  // Getters.
+  size_t batched() const { return arrived_.size(); }
+  size_t in_flight() const { return in_flight_.size(); }
+
+  /// Add a client's Command to the current batch, and flush if that fills it
+  void Add(const message::Command &cmd) {
+    batch_.add_cliids(cmd.cliid());
+    batch_.add_cliseqs(cmd.cliseq());
+    for (const auto &c : cmd.commands())
+      batch_.add_commands(c);
+    arrived_.push_back(clock::now());
+    if (arrived_.size() >= opts_.max_batch)
+      Flush();
+  }
+
+  /// Flush the batch if the pipeline has room for it or its deadline passed.
+  /// Meant to be registered with an EventLoop.
+  ///
+  /// @return 1 if a batch was flushed, otherwise 0
+  int Poll() {
+    if (arrived_.empty())
+      return 0;
+    if (in_flight_.size() < opts_.max_in_flight ||
+        clock::now() - arrived_.front() >= opts_.max_delay) {
+      Flush();
+      return 1;
+    }
+    return 0;
+  }
+
+  /// Tell the batcher that a slot was decided.  Objects from other proxies,
+  /// and NULL slots, are ignored.  Once one of this proxy's objects is
+  /// decided, the Commands in it are complete, and the next Poll() has room to
+  /// flush another batch.
+  void Decided(const message::ConsensusObj &obj) {
+    if (obj.isnull() || obj.proid() != opts_.proxy_id)
+      return;
+    auto it = in_flight_.find(obj.proseq());
+    if (it == in_flight_.end())
+      return;
+    auto now = clock::now();
+    for (auto t : it->second) {
+      std::chrono::duration<double, std::micro> lat = now - t;
+      *latency_us_ << lat.count();
+    }
+    in_flight_.erase(it);
+  }
+
+private:
+  /// Stamp the current batch with the next ProSeq and hand it off
+  void Flush() {
+    batch_.set_proid(opts_.proxy_id);
+    batch_.set_proseq(next_seq_);
+    *batch_size_ << uint32_t(arrived_.size());
+    in_flight_.emplace(next_seq_, std::move(arrived_));
+    ++next_seq_;
+    flush_(batch_);
+    batch_.Clear();
+    arrived_.clear();
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <protos/rdma.pb.h>
+#include <rdma/rdma.h>
+#include <vendor/sss/status.h>
+
+#include "catchup_log.h"
+#include "wire.h"
+
+namespace rabia {
+
+/// The bytes of an encoded message that fit in one mailbox slot
+static constexpr uint32_t kMailboxPayload = 52;
+
+/// One entry in a mailbox ring.  A sender fills the whole slot with a single
+/// RDMA WRITE.  `seq` is last, so that once the receiver sees the sequence
+/// number it expects, the payload in front of it has landed too.
+///
+/// NB: Verbs don't promise that the bytes of one WRITE are placed in address
+///     order, but every NIC we run on (and rdma_rxe) does, and FaRM-style
+///     mailboxes rely on the same thing.  A slot is one cache line, so on
+///     those NICs it lands in one PCIe write anyway.
+struct alignas(64) MailboxSlot {
+  uint8_t payload[kMailboxPayload];
+  uint32_t length;
+  uint64_t seq; // 1 + the sender's count of earlier messages to this receiver
+};
+static_assert(sizeof(MailboxSlot) == 64);
+
+/// How RdmaMailboxTransport sizes and uses its rings
+struct MailboxOptions {
+  uint32_t depth = 256;       // Slots per sender ring
+  bool use_mailbox = true;    // If false, send everything two-sided
+  bool catchup_reads = false; // Register a CatchupLog that peers can READ
+  CatchupLogOptions catchup;  // Its size, if so
+};
+
+/// A Transport (see LocalNetwork) that sends small messages with one-sided
+/// RDMA WRITEs into mailboxes in the receiver's memory, so a broadcast costs N
+/// posted WRITEs and no receiver CPU until it polls.
+///
+/// Every replica registers, through its `rdma_capability`, one ring of
+/// `depth` MailboxSlots per sender, plus one ack word per peer.  To send, a
+/// replica encodes the message with the wire format and WRITEs it into its
+/// ring at the receiver.  To receive from a peer, a replica checks the `seq`
+/// of the next slot in that peer's ring, which is a local memory read.  Every
+/// `depth / 2` messages, the receiver WRITEs how many it has consumed into the
+/// sender's ack word for it, and the sender never gets more than `depth`
+/// ahead of that.  A message that finds the ring full waits in a local backlog
+/// until there is room, so Send() never blocks.
+///
+/// Messages whose encoding doesn't fit in kMailboxPayload bytes (Proposals
+/// that carry commands, ClientRequests, a Coalescer's Batches) go over the
+/// capability's two-sided channel instead.  State and Vote messages, and objects without commands,
+/// always fit.  The two paths are not ordered with respect to each other,
+/// which WeakMvc doesn't need.
+///
+/// With `catchup_reads`, every replica also registers a CatchupLog (see
+/// catchup_log()) and swaps its address with its peers, so that a replica
+/// catching up can READ a run of a peer's decided slots straight out of the
+/// peer's memory (see ReadCatchup()).  WeakMvc finds ReadCatchup() and uses
+/// it before asking the peer two-sided, if it is given catchup_log() as its
+/// log.  Every replica must agree on `catchup_reads` and `catchup`.
+///
+/// NB: WRITEs are posted unsignaled, except every kSignalEvery-th one per
+///     peer, which waits for its completion (and so for all before it, as the
+///     QP is RC).  That keeps the send queue from filling up.
+///
+/// NB: The thread that calls Send() and TryReceive() must have called
+///     `RegisterThread()` on the capability.
+class RdmaMailboxTransport {
+  using rdma_capability = rome::rdma::rdma_capability;
+  using Peer = rome::rdma::Peer;
+  template <class T> using remote_ptr = rome::rdma::remote_ptr<T>;
+
+public:
+  using Options = MailboxOptions;
+
+private:
+  /// How often a WRITE to one peer is signaled
+  static constexpr uint32_t kSignalEvery = 32;
+  /// The most catch-up log cells one READ fetches
+  static constexpr uint32_t kReadCells = 64;
+
+  /// What this replica knows about one peer
+  struct PeerState {
+    uint64_t ring = 0;     // Address of this replica's ring at the peer
+    uint64_t ack = 0;      // Address of this replica's ack word at the peer
+    uint64_t log = 0;      // Address of the peer's CatchupLog cells
+    uint64_t sent = 0;     // Messages put in the peer's ring
+    uint64_t received = 0; // Messages taken from the peer's ring here
+    uint64_t reported = 0; // `received`, as last written to the peer
+    uint32_t unsignaled = 0;
+    std::deque<message::Msg> backlog; // Waiting for room in the ring
+  };
+
+  std::shared_ptr<rdma_capability> pool_;
+  const uint32_t self_;
+  std::vector<Peer> peers_; // By id, including this replica
+  const Options opts_;
+  std::vector<PeerState> state_;
+
+  remote_ptr<MailboxSlot> inbox_;   // n rings of `depth` slots, by sender
+  remote_ptr<uint64_t> acks_;       // n ack words, written by each receiver
+  remote_ptr<MailboxSlot> staging_; // A local copy of every outgoing slot
+  remote_ptr<uint64_t> ack_staging_;
+
+  remote_ptr<uint8_t> log_cells_; // The CatchupLog's cells, if peers READ it
+  std::unique_ptr<CatchupLog> log_;
+  remote_ptr<uint8_t> read_staging_; // kReadCells cells READ from a peer
+
+public:
+  /// Construct the transport.  Call Init() before using it.
+  ///
+  /// @param pool   A capability whose pool is already connected to every peer
+  /// @param self   This replica's id
+  /// @param peers  Every replica, including this one, indexed by id
+  /// @param opts   The ring depth, and the catch-up log if any
+  RdmaMailboxTransport(std::shared_ptr<rdma_capability> pool, uint32_t self,
+                       std::vector<Peer> peers, Options opts = Options())
+      : pool_(std::move(pool)), self_(self), peers_(std::move(peers)),
+        opts_(opts), state_(peers_.size()) {
+    ROME_ASSERT(opts_.depth >= 2, "Mailbox rings need at least two slots");
+  }
+
+  RdmaMailboxTransport(const RdmaMailboxTransport &) = delete;
+  RdmaMailboxTransport(RdmaMailboxTransport &&) = delete;
+
+  uint32_t self() const { return self_; }
+  uint32_t size() const { return peers_.size(); }
+  /// The log to give WeakMvc (see Options), or nullptr without
+  /// `catchup_reads`.  Valid after Init().
+  CatchupLog *catchup_log() { return log_.get(); }
+
+  /// Allocate and register the rings, and swap their addresses with every
+  /// peer over the two-sided channel.  Every replica must call this at about
+  /// the same time, before sending anything.
+  sss::Status Init() {
+    const uint32_t n = size();
+    inbox_ = pool_->Allocate<MailboxSlot>(n * opts_.depth);
+    acks_ = pool_->Allocate<uint64_t>(n);
+    staging_ = pool_->Allocate<MailboxSlot>(n * opts_.depth);
+    ack_staging_ = pool_->Allocate<uint64_t>(n);
+    std::memset(inbox_.get(), 0, sizeof(MailboxSlot) * n * opts_.depth);
+    std::memset(acks_.get(), 0, sizeof(uint64_t) * n);
+    if (opts_.catchup_reads) {
+      log_cells_ = pool_->Allocate<uint8_t>(CatchupLog::Bytes(opts_.catchup));
+      log_ = std::make_unique<CatchupLog>(opts_.catchup, log_cells_.get());
+      read_staging_ =
+          pool_->Allocate<uint8_t>(kReadCells * opts_.catchup.cell_bytes);
+    }
+
+    for (uint32_t p = 0; p < n; ++p) {
+      if (p == self_)
+        continue;
+      rome::rdma::RemoteObjectProto ring, ack, log;
+      ring.set_id("rabia_mailbox");
+      ring.set_raddr(inbox_.address() +
+                     sizeof(MailboxSlot) * opts_.depth * p);
+      ack.set_id("rabia_mailbox_ack");
+      ack.set_raddr(acks_.address() + sizeof(uint64_t) * p);
+      auto s = pool_->Send(peers_[p], ring);
+      RETURN_STATUS_ON_ERROR(s);
+      s = pool_->Send(peers_[p], ack);
+      RETURN_STATUS_ON_ERROR(s);
+      if (opts_.catchup_reads) {
+        log.set_id("rabia_catchup_log");
+        log.set_raddr(log_cells_.address());
+        s = pool_->Send(peers_[p], log);
+        RETURN_STATUS_ON_ERROR(s);
+      }
+    }
+    for (uint32_t p = 0; p < n; ++p) {
+      if (p == self_)
+        continue;
+      auto ring = pool_->Recv<rome::rdma::RemoteObjectProto>(peers_[p]);
+      RETURN_STATUSVAL_ON_ERROR(ring);
+      auto ack = pool_->Recv<rome::rdma::RemoteObjectProto>(peers_[p]);
+      RETURN_STATUSVAL_ON_ERROR(ack);
+      state_[p].ring = ring.val->raddr();
+      state_[p].ack = ack.val->raddr();
+      if (opts_.catchup_reads) {
+        auto log = pool_->Recv<rome::rdma::RemoteObjectProto>(peers_[p]);
+        RETURN_STATUSVAL_ON_ERROR(log);
+        state_[p].log = log.val->raddr();
+      }
+    }
+    return sss::Status::Ok();
+  }
+
+  /// READ the ProposalReplies for up to `count` slots from `first` out of
+  /// `from`'s CatchupLog, and append them to `out` in slot order.  Stops at
+  /// the first slot that isn't resident (not decided there yet, overwritten,
+  /// too big for a cell, or caught mid-write), and at the end of the cell
+  /// array, so one call is one READ of at most kReadCells cells.
+  ///
+  /// NB: The READ is waited on, so this blocks for a round trip.
+  void ReadCatchup(uint32_t from, uint32_t first, uint32_t count,
+                   std::vector<message::Msg> *out) {
+    if (!opts_.catchup_reads || from >= size() || from == self_ || count == 0)
+      return;
+    const auto &o = opts_.catchup;
+    const uint32_t idx = first & (o.slots - 1);
+    count = std::min({count, kReadCells, o.slots - idx});
+    auto remote = remote_ptr<uint8_t>(
+        uint16_t(from), state_[from].log + size_t(idx) * o.cell_bytes);
+    pool_->ExtendedRead(remote, count * o.cell_bytes, read_staging_);
+    for (uint32_t i = 0; i < count; ++i) {
+      auto msg = CatchupLog::Parse(read_staging_.get() + i * o.cell_bytes,
+                                   o.cell_bytes, first + i);
+      if (!msg.has_value())
+        return;
+      out->push_back(std::move(msg.value()));
+    }
+  }
+
+  sss::Status Send(uint32_t to, const message::Msg &msg) {
+    if (to >= size() || to == self_) {
+      sss::Status err = {sss::InvalidArgument, "No mailbox for "};
+      return err << to;
+    }
+    if (!opts_.use_mailbox || msg.type() == message::Batch ||
+        wire::EncodedSize(msg) > kMailboxPayload)
+      return pool_->Send(peers_[to], msg);
+    auto &ps = state_[to];
+    Flush(to);
+    if (!ps.backlog.empty() || !TryWrite(to, msg))
+      ps.backlog.push_back(msg);
+    return sss::Status::Ok();
+  }
+
+  std::optional<message::Msg> TryReceive(uint32_t from) {
+    if (from >= size() || from == self_)
+      return std::nullopt;
+    auto &ps = state_[from];
+    Flush(from);
+
+    MailboxSlot *slot = inbox_.get() + opts_.depth * from +
+                        ps.received % opts_.depth;
+    uint64_t seq =
+        std::atomic_ref<uint64_t>(slot->seq).load(std::memory_order_acquire);
+    if (seq != ps.received + 1)
+      return pool_->TryRecv<message::Msg>(peers_[from]);
+
+    auto view = wire::View::Parse(slot->payload, slot->length);
+    ROME_ASSERT(view.status.t == sss::Ok, "Bad mailbox frame from {}: {}",
+                from, view.status.message.value_or(""));
+    message::Msg msg;
+    view.val->ToMsg(&msg);
+    ++ps.received;
+    if (ps.received - ps.reported >= opts_.depth / 2)
+      ReportAck(from);
+    return msg;
+  }
+
+private:
+  /// Move as much of `to`'s backlog into its ring as there is room for
+  void Flush(uint32_t to) {
+    auto &ps = state_[to];
+    while (!ps.backlog.empty() && TryWrite(to, ps.backlog.front()))
+      ps.backlog.pop_front();
+  }
+
+  /// WRITE `msg` into this replica's ring at `to`, if there is room
+  ///
+  /// @return False if the ring is full
+  bool TryWrite(uint32_t to, const message::Msg &msg) {
+    auto &ps = state_[to];
+    uint64_t acked = std::atomic_ref<uint64_t>(acks_.get()[to]).load(
+        std::memory_order_acquire);
+    if (ps.sent - acked >= opts_.depth)
+      return false;
+    MailboxSlot slot;
+    auto len = wire::Encode(msg, slot.payload, sizeof(slot.payload));
+    ROME_ASSERT(len.status.t == sss::Ok, "Encode failed: {}",
+                len.status.message.value_or(""));
+    slot.length = len.val.value();
+    slot.seq = ps.sent + 1;
+    uint32_t idx = ps.sent % opts_.depth;
+    auto remote = remote_ptr<MailboxSlot>(uint16_t(to),
+                                          ps.ring + sizeof(MailboxSlot) * idx);
+    // The staging copy of a slot isn't reused until the receiver acks it, by
+    // which time the WRITE that read it has long finished.
+    auto local = remote_ptr<MailboxSlot>(
+        uint16_t(self_),
+        staging_.address() + sizeof(MailboxSlot) * (opts_.depth * to + idx));
+    pool_->Write<MailboxSlot>(remote, slot, local, NextWriteBehavior(ps));
+    ++ps.sent;
+    return true;
+  }
+
+  /// Tell `from` how many of its messages this replica has consumed.  The
+  /// staging word is reused every time, so this WRITE is always signaled:
+  /// Write() clears the staging word before filling it, and the NIC must not
+  /// read it half done.
+  void ReportAck(uint32_t from) {
+    auto &ps = state_[from];
+    auto remote = remote_ptr<uint64_t>(uint16_t(from), ps.ack);
+    auto local = remote_ptr<uint64_t>(
+        uint16_t(self_), ack_staging_.address() + sizeof(uint64_t) * from);
+    pool_->Write<uint64_t>(remote, ps.received, local,
+                           rdma_capability::RDMAWriteWithAck);
+    ps.unsignaled = 0;
+    ps.reported = ps.received;
+  }
+
+  rdma_capability::RDMAWriteBehavior NextWriteBehavior(PeerState &ps) {
+    if (++ps.unsignaled < kSignalEvery)
+      return rdma_capability::RDMAWriteNoAck;
+    ps.unsignaled = 0;
+    return rdma_capability::RDMAWriteWithAck;
+  }
+};
+
+} // namespace rabia
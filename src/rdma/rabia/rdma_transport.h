@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+#include <message.pb.h>
+#include <rdma/connection_manager.h>
+#include <vendor/sss/status.h>
+
+namespace rabia {
+
+/// A Transport (see LocalNetwork) over the RC connections that a Rome
+/// `ConnectionManager` established with every peer.  Receiving uses the
+/// non-blocking `TryReceive`, never `Deliver`, so a replica's EventLoop can
+/// keep polling every peer.
+///
+/// NB: The map is the one built by `init_cm()` in iht/compete.cc, i.e. keyed
+///     by peer id, and may or may not contain a loopback connection; WeakMvc
+///     never sends to itself over the transport.
+class RdmaTransport {
+  using Connection = rome::rdma::internal::Connection;
+
+  uint32_t self_;
+  uint32_t n_;
+  std::unordered_map<uint32_t, Connection *> conns_; //! NOT OWNED
+
+public:
+  RdmaTransport(uint32_t self, uint32_t n,
+                std::unordered_map<uint32_t, Connection *> conns)
+      : self_(self), n_(n), conns_(std::move(conns)) {}
+
+  uint32_t self() const { return self_; }
+  uint32_t size() const { return n_; }
+
+  sss::Status Send(uint32_t to, const message::Msg &msg) {
+    auto it = conns_.find(to);
+    if (it == conns_.end()) {
+      sss::Status err = {sss::NotFound, "No connection to "};
+      return err << to;
+    }
+    return it->second->channel()->Send(msg);
+  }
+
+  std::optional<message::Msg> TryReceive(uint32_t from) {
+    auto it = conns_.find(from);
+    if (it == conns_.end())
+      return std::nullopt;
+    return it->second->channel()->TryReceive<message::Msg>();
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+namespace rabia {
+
+namespace shm {
+
+inline void FutexWait(std::atomic<uint32_t> *word, uint32_t expected,
+                      std::chrono::microseconds timeout) {
+  timespec ts{time_t(timeout.count() / 1000000),
+              long(timeout.count() % 1000000 * 1000)};
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT,
+            expected, &ts, nullptr, 0);
+}
+
+inline void FutexWakeAll(std::atomic<uint32_t> *word) {
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE,
+            INT32_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace shm
+
+/// The words a consumer sleeps on.  One Doorbell serves every ring the
+/// consumer reads, so it can sleep until any of them has something.
+struct alignas(64) Doorbell {
+  std::atomic<uint32_t> rings{0};  // Bumped by a producer that saw `asleep`
+  std::atomic<uint32_t> asleep{0}; // Set while the consumer may sleep
+};
+
+/// Where a ring's producer and consumer are, in bytes ever written and read,
+/// on separate cache lines
+struct RingHeader {
+  alignas(64) std::atomic<uint64_t> head{0}; // Written by the producer
+  alignas(64) std::atomic<uint64_t> tail{0}; // Written by the consumer
+};
+
+/// ShmRing is a single-producer, single-consumer ring of variable-length
+/// records in memory that both ends map (see ShmRegion).  A record is a
+/// 4-byte length and the payload, padded to 8 bytes; a record that would
+/// run past the end of the buffer is put at the start instead, behind a
+/// wrap marker.  Neither end takes a lock or makes a syscall unless the
+/// consumer has gone to sleep on its Doorbell, in which case TryPush() wakes
+/// it with a futex.
+///
+/// NB: ShmRing is only a view: copies refer to the same ring, and neither
+///     end owns the memory.
+class ShmRing {
+  static constexpr uint32_t kWrap = UINT32_MAX; // The rest of the buffer is
+                                                // unused
+  static constexpr uint64_t kAlign = 8;
+
+  RingHeader *hdr_ = nullptr; //! NOT OWNED
+  uint8_t *data_ = nullptr;   //! NOT OWNED
+  uint64_t capacity_ = 0;     // A power of two
+  Doorbell *bell_ = nullptr;  //! NOT OWNED
+
+  static uint64_t Padded(uint64_t len) {
+    return (sizeof(uint32_t) + len + kAlign - 1) & ~(kAlign - 1);
+  }
+
+public:
+  ShmRing() = default;
+  ShmRing(RingHeader *hdr, uint8_t *data, uint64_t capacity, Doorbell *bell)
+      : hdr_(hdr), data_(data), capacity_(capacity), bell_(bell) {
+    ROME_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                "Ring capacity {} is not a power of two", capacity);
+  }
+
+  bool valid() const { return hdr_ != nullptr; }
+  /// The largest payload TryPush() can ever take
+  uint64_t max_payload() const { return capacity_ / 2 - sizeof(uint32_t); }
+
+  /// Reserve `len` bytes, have `write(uint8_t *)` fill them in place, and
+  /// publish the record
+  ///
+  /// @return false if the ring doesn't have room right now
+  template <class WriteFn> bool TryPush(uint32_t len, WriteFn &&write) {
+    const uint64_t head = hdr_->head.load(std::memory_order_relaxed);
+    const uint64_t tail = hdr_->tail.load(std::memory_order_acquire);
+    const uint64_t at = head & (capacity_ - 1);
+    const uint64_t need = Padded(len);
+    const uint64_t skip = at + need > capacity_ ? capacity_ - at : 0;
+    if (len > max_payload() || head + skip + need - tail > capacity_)
+      return false;
+    if (skip > 0)
+      std::memcpy(data_ + at, &kWrap, sizeof(kWrap));
+    uint8_t *rec = data_ + ((head + skip) & (capacity_ - 1));
+    std::memcpy(rec, &len, sizeof(len));
+    write(rec + sizeof(len));
+    hdr_->head.store(head + skip + need, std::memory_order_release);
+    // Pairs with the fence in ShmRegion::Sleep(): either the consumer sees
+    // the record before it sleeps, or this sees it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (bell_->asleep.load(std::memory_order_relaxed) != 0) {
+      bell_->rings.fetch_add(1, std::memory_order_relaxed);
+      shm::FutexWakeAll(&bell_->rings);
+    }
+    return true;
+  }
+
+  bool TryPush(const void *buf, uint32_t len) {
+    return TryPush(len, [&](uint8_t *dst) { std::memcpy(dst, buf, len); });
+  }
+
+  /// Hand the oldest record to `read(const uint8_t *, uint32_t)`, in place,
+  /// then release its space
+  ///
+  /// @return false if the ring is empty
+  template <class ReadFn> bool TryPop(ReadFn &&read) {
+    uint64_t tail = hdr_->tail.load(std::memory_order_relaxed);
+    const uint64_t head = hdr_->head.load(std::memory_order_acquire);
+    if (tail == head)
+      return false;
+    uint32_t len;
+    std::memcpy(&len, data_ + (tail & (capacity_ - 1)), sizeof(len));
+    if (len == kWrap) {
+      tail += capacity_ - (tail & (capacity_ - 1));
+      std::memcpy(&len, data_ + (tail & (capacity_ - 1)), sizeof(len));
+    }
+    read(data_ + (tail & (capacity_ - 1)) + sizeof(len), len);
+    hdr_->tail.store(tail + Padded(len), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return hdr_->tail.load(std::memory_order_relaxed) ==
+           hdr_->head.load(std::memory_order_acquire);
+  }
+};
+
+struct ShmRegionOptions {
+  uint32_t rings = 1;            // How many producers write to the region
+  uint64_t ring_bytes = 1 << 20; // Per ring; rounded up to a power of two
+  bool hugepages = true;         // Try MFD_HUGETLB first
+};
+
+/// ShmRegion is the memory a consumer reads its rings from: a Doorbell and
+/// `rings` ShmRings, in an anonymous `memfd` (backed by hugepages when the
+/// system has them reserved, so the rings take few TLB entries).  The owner
+/// creates it with Create() and hands fd() to each producer, which maps the
+/// same memory with Map() and writes to ring(its id).
+class ShmRegion {
+public:
+  using Options = ShmRegionOptions;
+
+  static constexpr uint64_t kHugePage = 2 << 20;
+
+private:
+  int fd_ = -1;
+  uint8_t *base_ = nullptr;
+  uint64_t size_ = 0;
+  uint32_t rings_ = 0;
+  uint64_t ring_bytes_ = 0;
+  bool huge_ = false;
+
+  /// The first ring's header follows the Doorbell; each ring's buffer
+  /// follows its header
+  static constexpr uint64_t kHeaderBytes = sizeof(Doorbell);
+  static constexpr uint64_t kRingHeaderBytes = sizeof(RingHeader);
+
+  static uint64_t RingBytes(uint64_t bytes) {
+    uint64_t cap = 64;
+    while (cap < bytes)
+      cap *= 2;
+    return cap;
+  }
+
+  static uint64_t SizeFor(uint32_t rings, uint64_t ring_bytes, bool huge) {
+    const uint64_t size =
+        kHeaderBytes + rings * (kRingHeaderBytes + ring_bytes);
+    const uint64_t page = huge ? kHugePage : 4096;
+    return (size + page - 1) / page * page;
+  }
+
+  sss::Status MapFd() {
+    void *p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (p == MAP_FAILED)
+      return {sss::InternalError,
+              std::string("mmap shared rings: ") + std::strerror(errno)};
+    base_ = static_cast<uint8_t *>(p);
+    return sss::Status::Ok();
+  }
+
+public:
+  ShmRegion() = default;
+  ShmRegion(const ShmRegion &) = delete;
+  ShmRegion(ShmRegion &&) = delete;
+
+  ~ShmRegion() {
+    if (base_ != nullptr)
+      ::munmap(base_, size_);
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  /// Create the region, as the consumer
+  sss::Status Create(Options opts) {
+    rings_ = opts.rings;
+    ring_bytes_ = RingBytes(opts.ring_bytes);
+    if (opts.hugepages) {
+      fd_ = ::memfd_create("rabia-rings", MFD_CLOEXEC | MFD_HUGETLB);
+      size_ = SizeFor(rings_, ring_bytes_, true);
+      if (fd_ >= 0 && ::ftruncate(fd_, size_) == 0 && MapFd().t == sss::Ok) {
+        huge_ = true;
+      } else {
+        ROME_DEBUG("No hugepages for shared rings, using 4 KiB pages");
+        if (fd_ >= 0)
+          ::close(fd_);
+        fd_ = -1;
+      }
+    }
+    if (!huge_) {
+      fd_ = ::memfd_create("rabia-rings", MFD_CLOEXEC);
+      size_ = SizeFor(rings_, ring_bytes_, false);
+      if (fd_ < 0 || ::ftruncate(fd_, size_) != 0)
+        return {sss::InternalError,
+                std::string("memfd for shared rings: ") +
+                    std::strerror(errno)};
+      auto mapped = MapFd();
+      RETURN_STATUS_ON_ERROR(mapped);
+    }
+    new (base_) Doorbell();
+    for (uint32_t i = 0; i < rings_; ++i)
+      new (base_ + kHeaderBytes + i * (kRingHeaderBytes + ring_bytes_))
+          RingHeader();
+    return sss::Status::Ok();
+  }
+
+  /// Map a region that a consumer created, as a producer.  The region takes
+  /// ownership of `fd`.
+  sss::Status Map(int fd, uint32_t rings, uint64_t ring_bytes) {
+    fd_ = fd;
+    rings_ = rings;
+    ring_bytes_ = RingBytes(ring_bytes);
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+      return {sss::InternalError,
+              std::string("fstat shared rings: ") + std::strerror(errno)};
+    size_ = st.st_size;
+    if (size_ < SizeFor(rings_, ring_bytes_, false))
+      return {sss::InvalidArgument, "Shared ring region is too small"};
+    return MapFd();
+  }
+
+  // Getters.
+  int fd() const { return fd_; }
+  bool huge() const { return huge_; }
+  uint64_t size() const { return size_; }
+  Doorbell *doorbell() { return reinterpret_cast<Doorbell *>(base_); }
+
+  /// The ring producer `i` writes to
+  ShmRing ring(uint32_t i) {
+    uint8_t *hdr = base_ + kHeaderBytes + i * (kRingHeaderBytes + ring_bytes_);
+    return ShmRing(reinterpret_cast<RingHeader *>(hdr),
+                   hdr + kRingHeaderBytes, ring_bytes_, doorbell());
+  }
+
+  /// Sleep until a producer pushes to any ring of this region, or for at
+  /// most `timeout`, unless `ready()` says there is work already.  Only the
+  /// consumer may call this.
+  template <class ReadyFn>
+  void Sleep(std::chrono::microseconds timeout, ReadyFn &&ready) {
+    Doorbell *bell = doorbell();
+    const uint32_t seen = bell->rings.load(std::memory_order_relaxed);
+    bell->asleep.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!ready())
+      shm::FutexWait(&bell->rings, seen, timeout);
+    bell->asleep.store(0, std::memory_order_relaxed);
+  }
+};
+
+} // namespace rabia
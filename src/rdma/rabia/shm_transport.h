@@ -0,0 +1,325 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <rdma/peer.h>
+#include <vendor/sss/status.h>
+
+#include "shm_ring.h"
+
+namespace rabia {
+
+/// Is `address` one of this host's own IPv4 addresses (or loopback)?
+inline bool IsLocalAddress(const std::string &address) {
+  addrinfo hints{}, *res = nullptr;
+  hints.ai_family = AF_INET;
+  if (getaddrinfo(address.c_str(), nullptr, &hints, &res) != 0 ||
+      res == nullptr)
+    return false;
+  const in_addr_t want =
+      reinterpret_cast<sockaddr_in *>(res->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(res);
+  if ((ntohl(want) >> 24) == 127)
+    return true;
+  ifaddrs *ifs = nullptr;
+  if (getifaddrs(&ifs) != 0)
+    return false;
+  bool local = false;
+  for (ifaddrs *i = ifs; i != nullptr && !local; i = i->ifa_next)
+    local = i->ifa_addr != nullptr && i->ifa_addr->sa_family == AF_INET &&
+            reinterpret_cast<sockaddr_in *>(i->ifa_addr)->sin_addr.s_addr ==
+                want;
+  freeifaddrs(ifs);
+  return local;
+}
+
+struct ShmTransportOptions {
+  uint64_t ring_bytes = 1 << 20; // Per (sender, receiver) pair
+  bool hugepages = true;         // Back the rings with hugepages if possible
+  bool enable = true;            // false sends everything through Remote
+  std::chrono::milliseconds connect_timeout{10000};
+};
+
+/// ShmTransport is a Transport (see LocalNetwork) that wraps another one,
+/// `Remote` (a TcpTransport, RdmaTransport or RdmaMailboxTransport), and
+/// sends to peers on the same host through shared memory instead.  Which
+/// peers those are is decided from `Peer::address` (see IsLocalAddress()),
+/// so a proxy and a replica that share a host skip the NIC with no change to
+/// the code that uses the transport.
+///
+/// Each node owns an ShmRegion holding one ShmRing per peer, which it reads.
+/// Init() passes the region's memfd to every co-located peer over a Unix
+/// socket (SCM_RIGHTS, in the abstract namespace, named by the node's port)
+/// and maps the regions they pass back, writing to its own ring in each.
+/// Send() serializes straight into the ring.  If the ring is full, the
+/// message waits in a per-peer backlog that the next Send() or TryReceive()
+/// drains first, so Send() never blocks and the link stays FIFO.
+///
+/// Wait() sleeps on the node's doorbell futex until a co-located peer sends
+/// something, for event loops that would rather not spin when idle.
+///
+/// NB: Messages from remote peers don't ring the doorbell.
+template <class Remote> class ShmTransport {
+  using Peer = rome::rdma::Peer;
+
+public:
+  using Options = ShmTransportOptions;
+
+private:
+  /// Where to send to one co-located peer
+  struct Out {
+    std::unique_ptr<ShmRegion> region; // The peer's region, mapped
+    ShmRing ring;                      // This node's ring in it
+    std::deque<std::string> backlog;   // Didn't fit in `ring` yet
+  };
+
+  Remote *remote_; //! NOT OWNED
+  std::vector<Peer> peers_;
+  const Options opts_;
+  std::vector<bool> local_;
+  ShmRegion in_; // This node's region, which the peers write to
+  std::vector<Out> out_;
+  int listen_fd_ = -1;
+
+  uint64_t num_local_ = 0; // Messages sent through shared memory
+
+  static sss::Status Errno(const std::string &what) {
+    return {sss::InternalError, what + ": " + std::strerror(errno)};
+  }
+
+  static sockaddr_un SocketName(uint16_t port) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    // Abstract namespace: a leading NUL, and nothing to clean up
+    std::snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1,
+                  "rabia-shm-%u", port);
+    return addr;
+  }
+
+  static socklen_t SocketLen(const sockaddr_un &addr) {
+    return offsetof(sockaddr_un, sun_path) + 1 +
+           std::strlen(addr.sun_path + 1);
+  }
+
+  /// Pass this node's region to `peer`
+  sss::Status Offer(uint32_t peer) {
+    auto addr = SocketName(peers_[peer].port);
+    auto give_up = std::chrono::steady_clock::now() + opts_.connect_timeout;
+    int fd;
+    while (true) {
+      fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0)
+        return Errno("socket");
+      if (::connect(fd, reinterpret_cast<sockaddr *>(&addr),
+                    SocketLen(addr)) == 0)
+        break;
+      ::close(fd);
+      if (std::chrono::steady_clock::now() > give_up) {
+        sss::Status err = {sss::Unavailable, "Can't reach co-located node "};
+        return err << peer;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    uint32_t self = self_id();
+    iovec iov{&self, sizeof(self)};
+    char ctl[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl;
+    msg.msg_controllen = sizeof(ctl);
+    cmsghdr *c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    const int region = in_.fd();
+    std::memcpy(CMSG_DATA(c), &region, sizeof(region));
+    const bool ok = ::sendmsg(fd, &msg, 0) == sizeof(self);
+    ::close(fd);
+    if (!ok)
+      return Errno("Passing shared rings");
+    return sss::Status::Ok();
+  }
+
+  /// Take a peer's region from the listening socket and map it
+  sss::Status Accept() {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0)
+      return Errno("accept");
+    uint32_t from = 0;
+    iovec iov{&from, sizeof(from)};
+    char ctl[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl;
+    msg.msg_controllen = sizeof(ctl);
+    const ssize_t got = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    ::close(fd);
+    cmsghdr *c = CMSG_FIRSTHDR(&msg);
+    if (got != sizeof(from) || c == nullptr || c->cmsg_type != SCM_RIGHTS)
+      return {sss::InternalError, "No shared rings in the handshake"};
+    int region;
+    std::memcpy(&region, CMSG_DATA(c), sizeof(region));
+    if (from >= peers_.size() || !local_[from] || out_[from].region) {
+      ::close(region);
+      sss::Status err = {sss::InvalidArgument,
+                         "Unexpected shared rings from "};
+      return err << from;
+    }
+    Out &o = out_[from];
+    o.region = std::make_unique<ShmRegion>();
+    auto mapped = o.region->Map(region, peers_.size(), opts_.ring_bytes);
+    RETURN_STATUS_ON_ERROR(mapped);
+    o.ring = o.region->ring(self_id());
+    return sss::Status::Ok();
+  }
+
+  uint32_t self_id() const { return remote_->self(); }
+
+  /// Push what is waiting in `o`'s backlog, oldest first
+  void Drain(Out &o) {
+    while (!o.backlog.empty()) {
+      const std::string &m = o.backlog.front();
+      if (!o.ring.TryPush(m.data(), m.size()))
+        return;
+      o.backlog.pop_front();
+    }
+  }
+
+public:
+  /// @param remote  Carries messages to peers on other hosts (not owned)
+  /// @param peers   Every node, including this one, indexed by id
+  /// @param opts    Ring sizes, and whether to use shared memory at all
+  ShmTransport(Remote *remote, std::vector<Peer> peers,
+               Options opts = Options())
+      : remote_(remote), peers_(std::move(peers)), opts_(opts),
+        local_(peers_.size(), false), out_(peers_.size()) {
+    ROME_ASSERT(peers_.size() == remote_->size(),
+                "{} peers for a transport of {} nodes", peers_.size(),
+                remote_->size());
+    for (uint32_t p = 0; opts_.enable && p < peers_.size(); ++p)
+      local_[p] = p != self_id() && IsLocalAddress(peers_[p].address);
+  }
+
+  ShmTransport(const ShmTransport &) = delete;
+  ShmTransport(ShmTransport &&) = delete;
+
+  ~ShmTransport() {
+    if (listen_fd_ >= 0)
+      ::close(listen_fd_);
+  }
+
+  uint32_t self() const { return self_id(); }
+  uint32_t size() const { return peers_.size(); }
+
+  // Getters.
+  Remote *remote() { return remote_; }
+  /// Does this node reach `peer` through shared memory?
+  bool local(uint32_t peer) const { return local_[peer]; }
+  uint64_t num_local() const { return num_local_; }
+  bool hugepages() const { return in_.huge(); }
+
+  /// Create this node's rings and swap regions with every co-located peer.
+  /// Those peers must call Init() at about the same time.
+  sss::Status Init() {
+    uint32_t n_local = 0;
+    for (uint32_t p = 0; p < peers_.size(); ++p)
+      n_local += local_[p];
+    if (n_local == 0)
+      return sss::Status::Ok();
+    auto created = in_.Create({.rings = uint32_t(peers_.size()),
+                               .ring_bytes = opts_.ring_bytes,
+                               .hugepages = opts_.hugepages});
+    RETURN_STATUS_ON_ERROR(created);
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    auto addr = SocketName(peers_[self_id()].port);
+    if (listen_fd_ < 0 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr),
+               SocketLen(addr)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0)
+      return Errno("Listening for co-located peers");
+    // Connecting lands in the peer's backlog, so every node can offer first
+    // and accept afterwards
+    for (uint32_t p = 0; p < peers_.size(); ++p) {
+      if (!local_[p])
+        continue;
+      auto offered = Offer(p);
+      RETURN_STATUS_ON_ERROR(offered);
+    }
+    for (uint32_t i = 0; i < n_local; ++i) {
+      auto accepted = Accept();
+      RETURN_STATUS_ON_ERROR(accepted);
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    return sss::Status::Ok();
+  }
+
+  sss::Status Send(uint32_t to, const message::Msg &msg) {
+    if (to >= peers_.size() || !local_[to])
+      return remote_->Send(to, msg);
+    Out &o = out_[to];
+    const uint32_t len = msg.ByteSizeLong();
+    if (len > o.ring.max_payload())
+      return {sss::InvalidArgument, "Message is bigger than a shared ring"};
+    ++num_local_;
+    Drain(o);
+    if (o.backlog.empty() &&
+        o.ring.TryPush(len, [&](uint8_t *dst) {
+          msg.SerializeWithCachedSizesToArray(dst);
+        }))
+      return sss::Status::Ok();
+    msg.SerializeToString(&o.backlog.emplace_back());
+    return sss::Status::Ok();
+  }
+
+  std::optional<message::Msg> TryReceive(uint32_t from) {
+    if (from >= peers_.size() || !local_[from])
+      return remote_->TryReceive(from);
+    Drain(out_[from]);
+    std::optional<message::Msg> msg;
+    in_.ring(from).TryPop([&](const uint8_t *buf, uint32_t len) {
+      if (!msg.emplace().ParseFromArray(buf, len)) {
+        ROME_WARN("Dropping a malformed message from node {}", from);
+        msg.reset();
+      }
+    });
+    return msg;
+  }
+
+  /// Sleep until a co-located peer sends something, or for at most
+  /// `timeout`
+  void Wait(std::chrono::microseconds timeout) {
+    if (in_.fd() < 0)
+      return;
+    in_.Sleep(timeout, [this]() {
+      for (uint32_t p = 0; p < peers_.size(); ++p)
+        if (local_[p] && !in_.ring(p).empty())
+          return true;
+      return false;
+    });
+  }
+};
+
+} // namespace rabia
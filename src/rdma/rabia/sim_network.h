@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+namespace rabia {
+
+/// How one direction of a simulated link treats the messages sent on it
+struct LinkModel {
+  std::chrono::nanoseconds latency{5000}; // One-way, before jitter
+  std::chrono::nanoseconds jitter{0};     // Up to this much more, uniformly
+  double loss = 0; // Probability that a message is lost...
+  std::chrono::nanoseconds retransmit{200000}; // ...and resent this much later
+  double reorder = 0; // Probability that a message is held back...
+  std::chrono::nanoseconds reorder_delay{20000}; // ...by this much more
+};
+
+struct SimNetworkOptions {
+  uint32_t nodes = 3;
+  uint32_t channels = 1; // Links per ordered pair of nodes (TwoSidedIHT: 2)
+  uint64_t seed = 1;
+  LinkModel link;        // Every link's model, until SetLink() changes it
+  bool realtime = false; // Tie the clock to the wall clock (see below)
+};
+
+/// SimNetwork is an in-process network with a model of every link, and a
+/// clock of its own, so that a whole cluster can run in one process under
+/// chosen latency, jitter, loss and reordering, and a run can be repeated
+/// exactly.
+///
+/// A sent message is stamped with the time it should arrive: now, plus the
+/// link's latency, plus a uniform draw from its jitter.  Links are FIFO, so
+/// jitter never lets a message pass an earlier one, except that a message
+/// picked for reordering is held back `reorder_delay` longer and does not
+/// hold up the messages behind it.  A receiver sees a message once the clock
+/// reaches its arrival time.
+///
+/// The transports the engine runs on (RC queue pairs, TCP) are reliable, and
+/// WeakMvc counts on that, so by default a lost message is not gone: it
+/// arrives `retransmit` later, and, since the link is FIFO, so does everything
+/// sent behind it (head-of-line blocking).  With `retransmit` set to zero, a
+/// lost message is dropped for good.
+///
+/// The clock is virtual: it only moves when the driver calls Advance() or
+/// AdvanceTo(), and NextArrival() says how far it can jump before anything
+/// else happens.  All the random draws come from one generator seeded with
+/// `seed`, in the order messages are sent.  So a driver that runs every node
+/// from one thread, in a fixed order (see bench/sim_bench.cc), gets the same
+/// run every time, down to the message.
+///
+/// Code that runs a thread per node and blocks on receives (TwoSidedIHT) has
+/// nobody to advance the clock, so with `realtime` the clock is the wall time
+/// since construction instead.  The link models still apply, but thread
+/// scheduling makes such runs unrepeatable.
+///
+/// There are two ways in:
+///
+/// - `endpoint(id)` is a Transport for WeakMvc (see LocalNetwork).
+/// - `connection(self, peer, channel)` looks like a `Connection` from
+///   rdma/connection_manager.h: its `channel()` has templated Send(),
+///   TryReceive() and Deliver() for any protobuf type.
+///
+/// Every ordered pair of nodes has `channels` links, each a FIFO of its own
+/// with the pair's model, like TcpTransport's connections per peer.  The
+/// Endpoint uses channel 0.  TwoSidedIHT needs two: requests on one, so that
+/// a node's server thread never takes the responses its client waits for on
+/// the other (see bench/iht_sim_bench.cc).
+///
+/// Messages are serialized on Send() and parsed on receive, like they would be
+/// on a real wire; one that fails to parse is dropped and counted in
+/// num_malformed().  Every call is thread-safe.
+class SimNetwork {
+public:
+  using Options = SimNetworkOptions;
+
+private:
+  /// A message on its way
+  struct Packet {
+    uint64_t at;  // Arrival time
+    uint64_t seq; // Ties broken by send order, to keep delivery deterministic
+    std::string bytes;
+
+    bool operator>(const Packet &o) const {
+      return at != o.at ? at > o.at : seq > o.seq;
+    }
+  };
+
+  /// One direction of one link
+  struct Link {
+    LinkModel model;
+    std::priority_queue<Packet, std::vector<Packet>, std::greater<Packet>> q;
+    uint64_t last_at = 0; // Arrival time of the last in-order message
+  };
+
+  const Options opts_;
+  mutable std::mutex mu_;
+  std::mt19937_64 rng_;
+  uint64_t now_ = 0; // In virtual nanoseconds
+  uint64_t seq_ = 0;
+  /// From `i` to `j` on channel `c` at `links_[(i * n + j) * channels + c]`
+  std::vector<Link> links_;
+  const std::chrono::steady_clock::time_point epoch_;
+
+  uint64_t num_sent_ = 0;
+  uint64_t num_lost_ = 0;
+  uint64_t num_reordered_ = 0;
+  uint64_t num_malformed_ = 0; // Received but dropped, since they didn't parse
+
+  Link &link(uint32_t from, uint32_t to, uint32_t channel) {
+    return links_[(from * opts_.nodes + to) * opts_.channels + channel];
+  }
+
+  bool valid(uint32_t from, uint32_t to, uint32_t channel) const {
+    return from < opts_.nodes && to < opts_.nodes && channel < opts_.channels;
+  }
+
+  uint64_t NowLocked() const {
+    if (!opts_.realtime)
+      return now_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+public:
+  explicit SimNetwork(Options opts)
+      : opts_(opts), rng_(opts.seed),
+        links_(opts.nodes * opts.nodes * opts.channels),
+        epoch_(std::chrono::steady_clock::now()) {
+    for (auto &l : links_)
+      l.model = opts_.link;
+  }
+
+  SimNetwork(const SimNetwork &) = delete;
+  SimNetwork(SimNetwork &&) = delete;
+
+  uint32_t size() const { return opts_.nodes; }
+
+  /// The current time, in nanoseconds since the start of the run
+  uint64_t now() const {
+    std::lock_guard<std::mutex> g(mu_);
+    return NowLocked();
+  }
+
+  uint64_t num_sent() const { return num_sent_; }
+  uint64_t num_lost() const { return num_lost_; }
+  uint64_t num_reordered() const { return num_reordered_; }
+  uint64_t num_malformed() const { return num_malformed_; }
+
+  /// Give the links from `from` to `to` (every channel) their own model
+  void SetLink(uint32_t from, uint32_t to, const LinkModel &model) {
+    std::lock_guard<std::mutex> g(mu_);
+    for (uint32_t c = 0; c < opts_.channels; ++c)
+      link(from, to, c).model = model;
+  }
+
+  /// Move the virtual clock forward by `ns`
+  void Advance(uint64_t ns) {
+    std::lock_guard<std::mutex> g(mu_);
+    now_ += ns;
+  }
+
+  /// Move the virtual clock forward to `t`, if it is in the future
+  void AdvanceTo(uint64_t t) {
+    std::lock_guard<std::mutex> g(mu_);
+    now_ = std::max(now_, t);
+  }
+
+  /// The earliest time a message in flight will arrive, if any are
+  std::optional<uint64_t> NextArrival() const {
+    std::lock_guard<std::mutex> g(mu_);
+    std::optional<uint64_t> next;
+    for (auto &l : links_)
+      if (!l.q.empty() && (!next.has_value() || l.q.top().at < next.value()))
+        next = l.q.top().at;
+    return next;
+  }
+
+  /// Put `bytes` on the link from `from` to `to` on `channel`
+  sss::Status SendBytes(uint32_t from, uint32_t to, std::string bytes,
+                        uint32_t channel = 0) {
+    if (!valid(from, to, channel)) {
+      sss::Status err = {sss::InvalidArgument, "No such link: "};
+      return err << from << " -> " << to << " on channel " << channel;
+    }
+    std::lock_guard<std::mutex> g(mu_);
+    Link &l = link(from, to, channel);
+    ++num_sent_;
+    // Make the same draws for every message, lost or not, so that changing
+    // one probability doesn't shift every later draw
+    std::uniform_real_distribution<double> coin(0, 1);
+    bool lost = coin(rng_) < l.model.loss;
+    bool reordered = coin(rng_) < l.model.reorder;
+    uint64_t jitter = l.model.jitter.count() > 0
+                          ? rng_() % uint64_t(l.model.jitter.count())
+                          : 0;
+    uint64_t at = NowLocked() + l.model.latency.count() + jitter;
+    if (lost) {
+      ++num_lost_;
+      if (l.model.retransmit.count() == 0)
+        return sss::Status::Ok();
+      at += l.model.retransmit.count();
+    }
+    if (reordered) {
+      ++num_reordered_;
+      at += l.model.reorder_delay.count();
+    } else {
+      at = std::max(at, l.last_at);
+      l.last_at = at;
+    }
+    l.q.push({at, seq_++, std::move(bytes)});
+    return sss::Status::Ok();
+  }
+
+  /// Take the next message that has arrived on the link from `from` to `to`
+  /// on `channel`
+  std::optional<std::string> TryReceiveBytes(uint32_t from, uint32_t to,
+                                             uint32_t channel = 0) {
+    if (!valid(from, to, channel))
+      return std::nullopt;
+    std::lock_guard<std::mutex> g(mu_);
+    Link &l = link(from, to, channel);
+    if (l.q.empty() || l.q.top().at > NowLocked())
+      return std::nullopt;
+    // priority_queue only hands out a const top, so the bytes are copied
+    std::string bytes = l.q.top().bytes;
+    l.q.pop();
+    return bytes;
+  }
+
+  /// Take the next message that has arrived on the link from `from` to `to`
+  /// on `channel`, and parse it.  One that doesn't parse is dropped and
+  /// counted.
+  template <typename ProtoType>
+  std::optional<ProtoType> TryReceiveProto(uint32_t from, uint32_t to,
+                                           uint32_t channel = 0) {
+    auto bytes = TryReceiveBytes(from, to, channel);
+    if (!bytes.has_value())
+      return std::nullopt;
+    ProtoType proto;
+    if (!proto.ParseFromString(bytes.value())) {
+      ROME_WARN("Dropping a malformed message from {} to {}", from, to);
+      std::lock_guard<std::mutex> g(mu_);
+      ++num_malformed_;
+      return std::nullopt;
+    }
+    return proto;
+  }
+
+  /// A Transport for one replica (see LocalNetwork)
+  class Endpoint {
+    SimNetwork *net_; //! NOT OWNED
+    uint32_t self_;
+
+  public:
+    Endpoint(SimNetwork *net, uint32_t self) : net_(net), self_(self) {}
+
+    uint32_t self() const { return self_; }
+    uint32_t size() const { return net_->size(); }
+
+    sss::Status Send(uint32_t to, const message::Msg &msg) {
+      return net_->SendBytes(self_, to, msg.SerializeAsString());
+    }
+
+    std::optional<message::Msg> TryReceive(uint32_t from) {
+      return net_->TryReceiveProto<message::Msg>(from, self_);
+    }
+  };
+
+  /// One end of a link, with the surface of `Connection` (see the class
+  /// comment)
+  class Connection {
+  public:
+    class Channel {
+      SimNetwork *net_; //! NOT OWNED
+      uint32_t self_, peer_, channel_;
+
+    public:
+      Channel(SimNetwork *net, uint32_t self, uint32_t peer, uint32_t channel)
+          : net_(net), self_(self), peer_(peer), channel_(channel) {}
+
+      template <typename ProtoType> sss::Status Send(const ProtoType &proto) {
+        return net_->SendBytes(self_, peer_, proto.SerializeAsString(),
+                               channel_);
+      }
+
+      template <typename ProtoType> std::optional<ProtoType> TryReceive() {
+        return net_->TryReceiveProto<ProtoType>(peer_, self_, channel_);
+      }
+
+      /// Wait for the next message.  Only useful with a realtime clock, or
+      /// with another thread advancing the virtual one.
+      template <typename ProtoType> sss::StatusVal<ProtoType> Deliver() {
+        while (true) {
+          auto p = TryReceive<ProtoType>();
+          if (p.has_value())
+            return {sss::Status::Ok(), std::move(p)};
+          std::this_thread::yield();
+        }
+      }
+    };
+
+  private:
+    Channel channel_;
+
+  public:
+    Connection(SimNetwork *net, uint32_t self, uint32_t peer,
+               uint32_t channel)
+        : channel_(net, self, peer, channel) {}
+
+    Channel *channel() { return &channel_; }
+  };
+
+  Endpoint endpoint(uint32_t id) { return Endpoint(this, id); }
+
+  /// `self`'s end of its link with `peer` on `channel`, or nullptr if there
+  /// is no such link
+  std::unique_ptr<Connection> connection(uint32_t self, uint32_t peer,
+                                         uint32_t channel = 0) {
+    if (!valid(self, peer, channel))
+      return nullptr;
+    return std::make_unique<Connection>(this, self, peer, channel);
+  }
+};
+
+} // namespace rabia
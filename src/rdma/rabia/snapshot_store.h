@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+#include "durable_log.h"
+
+namespace rabia {
+
+/// One key and its value, as stored in a snapshot file
+struct KvPair {
+  uint64_t key;
+  uint64_t value;
+};
+static_assert(sizeof(KvPair) == 16);
+
+/// The header at the start of every snapshot file
+struct SnapshotHeader {
+  uint32_t magic; // kSnapshotMagic
+  uint32_t slot;  // The last slot whose writes are included
+  uint64_t count; // KvPairs that follow
+  uint32_t full;  // 1 if this holds every key, 0 if only changed ones
+  uint32_t crc;   // Crc32c of the pairs, then of the first 20 bytes above
+};
+static_assert(sizeof(SnapshotHeader) == 24);
+
+static constexpr uint32_t kSnapshotMagic = 0x52425350; // "RBSP"
+
+struct SnapshotStoreOptions {
+  std::string dir;         // Created if missing
+  uint32_t max_deltas = 8; // Merge into a new full snapshot after this many
+};
+
+/// SnapshotStore keeps the snapshots of a KvExecutor's state in `dir`, as a
+/// chain: at most one full snapshot (`<slot>.full`), then deltas
+/// (`<slot>.delta`), each holding only the keys written since the previous
+/// file in the chain.  Loading the chain in order rebuilds the state as of the
+/// newest file's slot.
+///
+/// Every file is written under a temporary name, fsynced, and renamed into
+/// place, so a crash leaves either the whole file or none of it.
+///
+/// Compact() bounds the chain: once it holds `max_deltas` deltas, or the
+/// deltas add up to more than the full snapshot, it merges the chain into a
+/// new full snapshot and removes the files it replaces.  The disk holds at
+/// most about one full snapshot plus `max_deltas` deltas, no matter how long
+/// the history is.
+///
+/// NB: The store isn't thread-safe.  KvExecutor only touches it from one
+///     snapshot thread at a time, and the owner only between snapshots.
+class SnapshotStore {
+public:
+  using Options = SnapshotStoreOptions;
+
+private:
+  struct File {
+    std::string path;
+    uint32_t slot;
+    bool full;
+    uint64_t count = 0;
+  };
+
+  const Options opts_;
+  std::vector<File> chain_; // The full snapshot (if any) first, then deltas
+  uint64_t num_compactions_ = 0;
+
+public:
+  explicit SnapshotStore(Options opts) : opts_(std::move(opts)) {}
+
+  SnapshotStore(const SnapshotStore &) = delete;
+  SnapshotStore(SnapshotStore &&) = delete;
+
+  /// Find the chain in `dir`, removing leftovers from an interrupted write or
+  /// compaction
+  sss::Status Open() {
+    std::error_code ec;
+    std::filesystem::create_directories(opts_.dir, ec);
+    if (ec) {
+      sss::Status err = {sss::InternalError, "Can't create "};
+      return err << opts_.dir << ": " << ec.message();
+    }
+
+    std::vector<File> found;
+    for (auto &e : std::filesystem::directory_iterator(opts_.dir)) {
+      auto ext = e.path().extension();
+      if (ext == ".tmp") {
+        std::filesystem::remove(e.path());
+        continue;
+      }
+      if (ext != ".full" && ext != ".delta")
+        continue;
+      found.push_back({e.path().string(),
+                       uint32_t(std::stoul(e.path().stem().string())),
+                       ext == ".full"});
+    }
+    std::sort(found.begin(), found.end(), [](const File &a, const File &b) {
+      return a.slot != b.slot ? a.slot < b.slot : a.full > b.full;
+    });
+
+    // Everything up to and including the newest full snapshot's slot is
+    // covered by it
+    auto full = std::find_if(found.rbegin(), found.rend(),
+                             [](const File &f) { return f.full; });
+    uint32_t covered = full == found.rend() ? 0 : full->slot;
+    chain_.clear();
+    for (auto &f : found) {
+      bool keep = full == found.rend() || (f.full && f.slot == covered) ||
+                  (!f.full && f.slot > covered);
+      if (!keep) {
+        std::filesystem::remove(f.path);
+        continue;
+      }
+      auto h = ReadHeader(f.path);
+      RETURN_STATUSVAL_ON_ERROR(h);
+      f.count = h.val->count;
+      chain_.push_back(f);
+    }
+    return sss::Status::Ok();
+  }
+
+  /// The slot the chain rebuilds the state at, if there is a chain
+  std::optional<uint32_t> last_slot() const {
+    if (chain_.empty())
+      return std::nullopt;
+    return chain_.back().slot;
+  }
+
+  size_t num_deltas() const {
+    return chain_.size() - (!chain_.empty() && chain_.front().full ? 1 : 0);
+  }
+  uint64_t num_compactions() const { return num_compactions_; }
+
+  /// The bytes the chain takes on disk
+  uint64_t bytes() const {
+    uint64_t b = 0;
+    for (auto &f : chain_)
+      b += sizeof(SnapshotHeader) + sizeof(KvPair) * f.count;
+    return b;
+  }
+
+  /// Visit every pair in the chain, oldest file first, so a later value for a
+  /// key overwrites an earlier one
+  ///
+  /// @return An error if a file is unreadable or fails its CRC
+  template <class Fn> sss::Status Load(Fn &&fn) const {
+    for (auto &f : chain_) {
+      std::vector<KvPair> pairs;
+      auto st = ReadFile(f.path, &pairs);
+      RETURN_STATUS_ON_ERROR(st);
+      for (auto &p : pairs)
+        fn(p.key, p.value);
+    }
+    return sss::Status::Ok();
+  }
+
+  /// Durably add a delta holding `pairs`, the keys written in the slots after
+  /// last_slot() up to and including `slot`
+  sss::Status AddDelta(uint32_t slot, const std::vector<KvPair> &pairs) {
+    if (last_slot().has_value() && slot <= last_slot().value()) {
+      sss::Status err = {sss::InvalidArgument, "Snapshot of slot "};
+      return err << slot << " is not after " << last_slot().value();
+    }
+    File f{Path(slot, false), slot, false, pairs.size()};
+    auto st = WriteFile(f, pairs);
+    RETURN_STATUS_ON_ERROR(st);
+    chain_.push_back(f);
+    return sss::Status::Ok();
+  }
+
+  /// Merge the chain into one full snapshot, if it has grown past the bounds
+  /// in the class comment
+  sss::Status Compact() {
+    size_t deltas = num_deltas();
+    if (deltas == 0)
+      return sss::Status::Ok();
+    uint64_t full = chain_.front().full ? chain_.front().count : 0;
+    uint64_t delta = 0;
+    for (auto &f : chain_)
+      delta += f.full ? 0 : f.count;
+    if (deltas < opts_.max_deltas && delta <= full)
+      return sss::Status::Ok();
+
+    std::unordered_map<uint64_t, uint64_t> merged;
+    merged.reserve(full + delta);
+    auto st = Load([&](uint64_t k, uint64_t v) { merged[k] = v; });
+    RETURN_STATUS_ON_ERROR(st);
+    std::vector<KvPair> pairs;
+    pairs.reserve(merged.size());
+    for (auto &[k, v] : merged)
+      pairs.push_back({k, v});
+    // Sorted by key, so that every replica writes the same bytes
+    std::sort(pairs.begin(), pairs.end(),
+              [](const KvPair &a, const KvPair &b) { return a.key < b.key; });
+
+    File f{Path(chain_.back().slot, true), chain_.back().slot, true,
+           pairs.size()};
+    st = WriteFile(f, pairs);
+    RETURN_STATUS_ON_ERROR(st);
+    // The new full snapshot is in place, so a crash from here on just leaves
+    // files that Open() will remove
+    for (auto &old : chain_)
+      std::filesystem::remove(old.path);
+    chain_ = {f};
+    ++num_compactions_;
+    return sss::Status::Ok();
+  }
+
+private:
+  std::string Path(uint32_t slot, bool full) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%010u.%s", slot,
+                  full ? "full" : "delta");
+    return (std::filesystem::path(opts_.dir) / name).string();
+  }
+
+  static uint32_t FileCrc(const SnapshotHeader &h, const KvPair *pairs) {
+    uint32_t crc = Crc32c(reinterpret_cast<const uint8_t *>(pairs),
+                          sizeof(KvPair) * h.count);
+    return Crc32c(reinterpret_cast<const uint8_t *>(&h),
+                  offsetof(SnapshotHeader, crc), crc);
+  }
+
+  /// Write `f` under a temporary name, sync it, and rename it into place
+  sss::Status WriteFile(const File &f, const std::vector<KvPair> &pairs) {
+    std::string tmp = f.path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return Errno("open", tmp);
+    SnapshotHeader h{kSnapshotMagic, f.slot, pairs.size(), f.full ? 1u : 0u,
+                     0};
+    h.crc = FileCrc(h, pairs.data());
+    bool ok = WriteAll(fd, &h, sizeof(h)) &&
+              WriteAll(fd, pairs.data(), sizeof(KvPair) * pairs.size()) &&
+              fsync(fd) == 0;
+    int err = errno;
+    close(fd);
+    if (!ok) {
+      errno = err;
+      return Errno("write", tmp);
+    }
+    if (std::rename(tmp.c_str(), f.path.c_str()) != 0)
+      return Errno("rename", f.path);
+    // Make the rename itself durable
+    int dfd = open(opts_.dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dfd < 0)
+      return Errno("open", opts_.dir);
+    ok = fsync(dfd) == 0;
+    close(dfd);
+    if (!ok)
+      return Errno("fsync", opts_.dir);
+    return sss::Status::Ok();
+  }
+
+  static bool WriteAll(int fd, const void *buf, size_t len) {
+    auto *p = static_cast<const uint8_t *>(buf);
+    while (len > 0) {
+      ssize_t n = write(fd, p, len);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  static bool ReadAll(int fd, void *buf, size_t len) {
+    auto *p = static_cast<uint8_t *>(buf);
+    while (len > 0) {
+      ssize_t n = read(fd, p, len);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  static sss::StatusVal<SnapshotHeader> ReadHeader(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return {Errno("open", path), {}};
+    SnapshotHeader h;
+    bool ok = ReadAll(fd, &h, sizeof(h));
+    close(fd);
+    if (!ok || h.magic != kSnapshotMagic) {
+      sss::Status err = {sss::InternalError, "Bad snapshot header in "};
+      return {err << path, {}};
+    }
+    return {sss::Status::Ok(), h};
+  }
+
+  static sss::Status ReadFile(const std::string &path,
+                              std::vector<KvPair> *pairs) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return Errno("open", path);
+    SnapshotHeader h;
+    bool ok = ReadAll(fd, &h, sizeof(h)) && h.magic == kSnapshotMagic;
+    if (ok) {
+      pairs->resize(h.count);
+      ok = ReadAll(fd, pairs->data(), sizeof(KvPair) * h.count);
+    }
+    close(fd);
+    if (!ok || h.crc != FileCrc(h, pairs->data())) {
+      sss::Status err = {sss::InternalError, "Corrupt snapshot "};
+      return err << path;
+    }
+    return sss::Status::Ok();
+  }
+
+  static sss::Status Errno(const char *what, const std::string &path) {
+    sss::Status err = {sss::InternalError, what};
+    return err << "(" << path << "): " << std::strerror(errno);
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <logging/logging.h>
+
+namespace rabia {
+
+/// The values carried in `Msg.Value` by State and Vote messages.  `kQuestion`
+/// is the "?" vote: the voter saw no majority state in its round.
+enum BinValue : uint32_t { kZero = 0, kOne = 1, kQuestion = 2 };
+
+/// The two rounds of a Weak-MVC phase, each with its own tally
+enum TallyKind : uint32_t { kStateTally = 0, kVoteTally = 1 };
+
+/// How many State or Vote messages of each value one (slot, phase) has
+struct TallyCounts {
+  uint32_t count[3] = {0, 0, 0}; // Indexed by BinValue
+  uint32_t total = 0;
+};
+
+/// TallyTable counts the State and Vote messages of the slots in flight.  Each
+/// (slot, phase, kind) is a bitmap of senders per value, so a duplicate is one
+/// AND and the counts are popcounts; there is nothing to allocate per message
+/// or per slot.
+///
+/// Slot s owns line s % `slots` of a ring of 64-byte lines, which holds its
+/// tallies for the phase it is in and the next one; a peer is rarely further
+/// ahead than that.  Phases count from 1, as in Weak-MVC.  A tally that
+/// doesn't fit in the line (a phase further ahead, or a slot whose line is
+/// still held by an earlier slot) is kept in a short spill list instead, and
+/// moves into the line when it can.  Releasing a slot frees its line for the
+/// slot `slots` later, with no reallocation.
+///
+/// Messages from a phase the slot has left, duplicates and malformed values
+/// are dropped.  The last two are masked out rather than branched on.
+class TallyTable {
+public:
+  /// The most replicas a bitmap holds
+  static constexpr uint32_t kMaxReplicas = 32;
+  /// Phases held in a slot's line, starting with its current one
+  static constexpr uint32_t kPhases = 2;
+
+private:
+  static constexpr uint32_t kNoSlot = ~0u;
+
+  /// The senders of each value, for one round of one phase
+  using Bits = uint32_t[3];
+
+  struct alignas(64) Line {
+    uint32_t slot = kNoSlot;
+    uint32_t base = 1; // The phase of bits[0]
+    Bits bits[kPhases][2];
+  };
+  static_assert(sizeof(Line) == 64, "A slot's tallies fill one cache line");
+
+  /// A phase's tallies that didn't fit in its slot's line
+  struct Spill {
+    uint32_t slot;
+    uint32_t phase;
+    Bits bits[2];
+  };
+
+  const uint32_t n_;
+  const uint32_t mask_;
+  std::vector<Line> lines_;
+  std::vector<Spill> spill_;
+
+  uint64_t num_spilled_ = 0;
+
+  /// Set `sender`'s bit under `value`, unless it is already set under any value
+  /// or `value` is out of range
+  static bool Mark(Bits &b, uint32_t sender, uint32_t value) {
+    const uint32_t seen = b[0] | b[1] | b[2];
+    const uint32_t bit =
+        (1u << sender) & ~seen & -uint32_t(value <= kQuestion);
+    b[std::min<uint32_t>(value, kQuestion)] |= bit;
+    return bit != 0;
+  }
+
+  static TallyCounts Count(const Bits &b) {
+    TallyCounts c;
+    for (uint32_t v = 0; v < 3; ++v)
+      c.count[v] = std::popcount(b[v]);
+    c.total = std::popcount(b[0] | b[1] | b[2]);
+    return c;
+  }
+
+  /// The line `slot` owns, claiming it if it is free, or nullptr if another
+  /// slot holds it
+  Line *Own(uint32_t slot) {
+    Line &l = lines_[slot & mask_];
+    if (l.slot == slot)
+      return &l;
+    if (l.slot != kNoSlot)
+      return nullptr;
+    l.slot = slot;
+    l.base = 1;
+    std::memset(l.bits, 0, sizeof(l.bits));
+    Unspill(l);
+    return &l;
+  }
+
+  /// Move the spilled tallies that now fit into `l`
+  void Unspill(Line &l) {
+    if (spill_.empty())
+      return;
+    std::erase_if(spill_, [&](const Spill &s) {
+      if (s.slot != l.slot)
+        return false;
+      if (s.phase < l.base)
+        return true; // Stale
+      if (s.phase - l.base >= kPhases)
+        return false;
+      std::memcpy(l.bits[s.phase - l.base], s.bits, sizeof(s.bits));
+      return true;
+    });
+  }
+
+  Spill *FindSpill(uint32_t slot, uint32_t phase) {
+    for (auto &s : spill_)
+      if (s.slot == slot && s.phase == phase)
+        return &s;
+    return nullptr;
+  }
+
+public:
+  /// @param replicas  Senders are numbered [0, replicas)
+  /// @param slots     Lines in the ring; rounded up to a power of two.  More
+  ///                  than the slots in flight, so that few spill.
+  TallyTable(uint32_t replicas, uint32_t slots)
+      : n_(replicas), mask_(std::bit_ceil(std::max(slots, 1u)) - 1),
+        lines_(mask_ + 1) {
+    ROME_ASSERT(replicas > 0 && replicas <= kMaxReplicas,
+                "Vote tallies hold 1 to {} replicas, not {}", kMaxReplicas,
+                replicas);
+  }
+
+  TallyTable(const TallyTable &) = delete;
+  TallyTable(TallyTable &&) = delete;
+
+  // Getters.
+  uint32_t slots() const { return mask_ + 1; }
+  uint64_t num_spilled() const { return num_spilled_; }
+
+  /// Count `value` from `sender` in round `kind` of `phase` of `slot`
+  ///
+  /// @return False if it was dropped, as a duplicate, stale or malformed
+  bool Add(uint32_t slot, uint32_t phase, TallyKind kind, uint32_t sender,
+           uint32_t value) {
+    ROME_ASSERT_DEBUG(sender < n_, "Sender {} out of range", sender);
+    Line *l = Own(slot);
+    if (l != nullptr) {
+      if (phase < l->base)
+        return false;
+      if (phase - l->base < kPhases)
+        return Mark(l->bits[phase - l->base][kind], sender, value);
+    }
+    Spill *s = FindSpill(slot, phase);
+    if (s == nullptr) {
+      s = &spill_.emplace_back(Spill{slot, phase, {}});
+      ++num_spilled_;
+    }
+    return Mark(s->bits[kind], sender, value);
+  }
+
+  /// The counts for round `kind` of `phase` of `slot`
+  TallyCounts Counts(uint32_t slot, uint32_t phase, TallyKind kind) {
+    const Line &l = lines_[slot & mask_];
+    if (l.slot == slot && phase - l.base < kPhases)
+      return Count(l.bits[phase - l.base][kind]);
+    if (const Spill *s = FindSpill(slot, phase))
+      return Count(s->bits[kind]);
+    return TallyCounts();
+  }
+
+  /// `slot` has moved on to `phase`; drop its earlier tallies
+  void Advance(uint32_t slot, uint32_t phase) {
+    Line *l = Own(slot);
+    if (l == nullptr) {
+      std::erase_if(spill_, [&](const Spill &s) {
+        return s.slot == slot && s.phase < phase;
+      });
+      return;
+    }
+    if (phase <= l->base)
+      return;
+    const uint32_t shift = std::min(phase - l->base, kPhases);
+    std::memmove(l->bits[0], l->bits[shift],
+                 sizeof(l->bits[0]) * (kPhases - shift));
+    std::memset(l->bits[kPhases - shift], 0, sizeof(l->bits[0]) * shift);
+    l->base = phase;
+    Unspill(*l);
+  }
+
+  /// `slot` is done; free its line and spilled tallies
+  void Release(uint32_t slot) {
+    Line &l = lines_[slot & mask_];
+    if (l.slot == slot)
+      l.slot = kNoSlot;
+    if (!spill_.empty())
+      std::erase_if(spill_, [&](const Spill &s) { return s.slot == slot; });
+  }
+};
+
+} // namespace rabia
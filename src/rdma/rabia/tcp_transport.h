@@ -0,0 +1,596 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+#include <rdma/peer.h>
+#include <vendor/sss/status.h>
+
+namespace rabia {
+
+struct TcpTransportOptions {
+  uint32_t reactors = 1; // Threads doing socket I/O, each with its own epoll
+  uint32_t channels = 1; // Connections per peer (TwoSidedIHT needs 2)
+  uint32_t max_message = 1 << 26; // Larger length prefixes are an error
+  /// With nothing queued, TryReceive() reads the socket itself instead of
+  /// waiting for the reactor.  That saves a handoff between threads per
+  /// message (and, with fewer cores than threads, a scheduler tick) at the
+  /// cost of a read() per empty poll.
+  bool busy_poll = false;
+  std::chrono::milliseconds connect_timeout{10000};
+};
+
+/// A Transport (see LocalNetwork) over TCP, for nodes without RDMA and for
+/// CI, and a baseline that the RDMA transports can be measured against.
+///
+/// Every node opens `channels` connections to every peer, with TCP_NODELAY.
+/// Messages are serialized protobufs behind a 4-byte length prefix.  The
+/// sockets are nonblocking and spread over `reactors` threads, each running
+/// an epoll loop:
+///
+/// - Send() frames the message and, if nothing is queued for the socket,
+///   writes it on the caller's thread.  Whatever the kernel doesn't take is
+///   queued, and the reactor writes the queue when the socket is writable,
+///   with one writev() of up to kMaxIov messages at a time.
+/// - The reactor reads whatever has arrived, cuts it into messages, and
+///   queues them per connection for TryReceive().
+///
+/// Besides the Transport surface for WeakMvc, which uses channel 0,
+/// connection(peer, channel) has the surface of a `Connection` from
+/// rdma/connection_manager.h: its `channel()` has templated Send(),
+/// TryReceive() and Deliver() for any protobuf type, so code written against
+/// RdmaChannel (e.g. TwoSidedIHT, with its senders on one channel and its
+/// receivers on another) runs unchanged over TCP.
+///
+/// NB: Send() and TryReceive() may be called from any thread.  Messages on
+///     one connection are delivered in the order they were sent.
+class TcpTransport {
+  using Peer = rome::rdma::Peer;
+
+public:
+  using Options = TcpTransportOptions;
+
+  /// The most messages one writev() sends
+  static constexpr uint32_t kMaxIov = 64;
+
+private:
+  struct Reactor;
+
+  /// One connection to one peer
+  struct Conn {
+    int fd = -1;
+    uint32_t peer = 0;
+    Reactor *reactor = nullptr;
+    std::atomic<bool> closed{false};
+
+    std::mutex send_mu;
+    std::deque<std::string> out; // Framed messages waiting for the socket
+    size_t out_off = 0;          // Bytes of out.front() already written
+    bool want_write = false;     // Is EPOLLOUT armed?
+
+    std::mutex read_mu; // Held by whoever reads the socket
+    std::string rbuf;   // Bytes read but not yet cut into messages
+
+    std::mutex recv_mu;
+    std::condition_variable arrived;
+    std::deque<std::string> in; // Payloads, waiting for TryReceive()
+  };
+
+  /// One I/O thread and its epoll set
+  struct Reactor {
+    int epfd = -1;
+    int wake = -1; // An eventfd, to stop the loop
+    std::thread thread;
+  };
+
+public:
+  /// One end of a connection, with the surface of `Connection` (see the
+  /// class comment)
+  class Connection {
+  public:
+    class Channel {
+      TcpTransport *net_; //! NOT OWNED
+      Conn *conn_;        //! NOT OWNED
+
+    public:
+      Channel(TcpTransport *net, Conn *conn) : net_(net), conn_(conn) {}
+
+      template <typename ProtoType> sss::Status Send(const ProtoType &proto) {
+        return net_->SendFrame(conn_, proto);
+      }
+
+      template <typename ProtoType> std::optional<ProtoType> TryReceive() {
+        auto bytes = net_->Pop(conn_);
+        if (!bytes.has_value())
+          return std::nullopt;
+        ProtoType proto;
+        if (!proto.ParseFromString(bytes.value())) {
+          ROME_WARN("Dropping a malformed frame from node {}", conn_->peer);
+          return std::nullopt;
+        }
+        return proto;
+      }
+
+      /// Wait for the next message
+      ///
+      /// @return Unavailable if the connection closes first
+      template <typename ProtoType> sss::StatusVal<ProtoType> Deliver() {
+        std::unique_lock<std::mutex> lock(conn_->recv_mu);
+        conn_->arrived.wait(lock, [this]() {
+          return !conn_->in.empty() ||
+                 conn_->closed.load(std::memory_order_acquire);
+        });
+        if (conn_->in.empty())
+          return {{sss::Unavailable, "Connection closed"}, {}};
+        std::string bytes = std::move(conn_->in.front());
+        conn_->in.pop_front();
+        lock.unlock();
+        ProtoType proto;
+        if (!proto.ParseFromString(bytes)) {
+          sss::Status err = {sss::InternalError, "Malformed frame from node "};
+          return {err << conn_->peer, {}};
+        }
+        return {sss::Status::Ok(), std::move(proto)};
+      }
+    };
+
+  private:
+    Channel channel_;
+
+  public:
+    Connection(TcpTransport *net, Conn *conn) : channel_(net, conn) {}
+
+    Channel *channel() { return &channel_; }
+  };
+
+private:
+  const uint32_t self_;
+  std::vector<Peer> peers_; // By id, including this node
+  const Options opts_;
+  std::vector<std::unique_ptr<Conn>> conns_; // [peer * channels + channel]
+  std::vector<std::unique_ptr<Connection>> connections_; // Same order
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+  int listen_fd_ = -1;
+
+  std::atomic<uint64_t> num_sent_{0};   // Messages
+  std::atomic<uint64_t> num_writes_{0}; // send() and writev() calls
+
+  Conn *conn(uint32_t peer, uint32_t channel) {
+    if (peer >= peers_.size() || peer == self_ || channel >= opts_.channels)
+      return nullptr;
+    return conns_[peer * opts_.channels + channel].get();
+  }
+
+  static sss::Status Errno(const std::string &what) {
+    return {sss::InternalError, what + ": " + std::strerror(errno)};
+  }
+
+  /// Read exactly `len` bytes from a blocking socket
+  static bool ReadFully(int fd, void *buf, size_t len) {
+    auto *p = static_cast<uint8_t *>(buf);
+    while (len > 0) {
+      ssize_t r = ::read(fd, p, len);
+      if (r <= 0 && !(r < 0 && errno == EINTR))
+        return false;
+      if (r > 0) {
+        p += r;
+        len -= r;
+      }
+    }
+    return true;
+  }
+
+  static sss::StatusVal<sockaddr_in> Resolve(const Peer &p) {
+    addrinfo hints{}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(p.address.c_str(), nullptr, &hints, &res) != 0 ||
+        res == nullptr)
+      return {{sss::NotFound, "Can't resolve " + p.address}, {}};
+    sockaddr_in addr;
+    std::memcpy(&addr, res->ai_addr, sizeof(addr));
+    freeaddrinfo(res);
+    addr.sin_port = htons(p.port);
+    return {sss::Status::Ok(), addr};
+  }
+
+  /// Connect to `peer`, retrying until it listens or the timeout passes, and
+  /// say which node and channel this is
+  sss::StatusVal<int> Dial(uint32_t peer, uint32_t channel) {
+    auto addr = Resolve(peers_[peer]);
+    if (addr.status.t != sss::Ok)
+      return {addr.status, {}};
+    auto give_up = std::chrono::steady_clock::now() + opts_.connect_timeout;
+    while (true) {
+      int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+      if (fd < 0)
+        return {Errno("socket"), {}};
+      if (::connect(fd, reinterpret_cast<sockaddr *>(&addr.val.value()),
+                    sizeof(sockaddr_in)) == 0) {
+        uint32_t hello[2] = {self_, channel};
+        if (::write(fd, hello, sizeof(hello)) != sizeof(hello)) {
+          ::close(fd);
+          return {Errno("handshake"), {}};
+        }
+        return {sss::Status::Ok(), fd};
+      }
+      ::close(fd);
+      if (std::chrono::steady_clock::now() > give_up) {
+        sss::Status err = {sss::Unavailable, "Can't connect to node "};
+        return {err << peer, {}};
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  /// Make `fd` nonblocking with Nagle off, and hand it to a reactor
+  sss::Status Adopt(uint32_t peer, uint32_t channel, int fd) {
+    int one = 1;
+    if (::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) != 0)
+      return Errno("TCP_NODELAY");
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+      return Errno("O_NONBLOCK");
+    Conn *c = conn(peer, channel);
+    if (c == nullptr || c->fd >= 0) {
+      ::close(fd);
+      sss::Status err = {sss::InvalidArgument, "Bad or repeated handshake "};
+      return err << peer << "/" << channel;
+    }
+    c->fd = fd;
+    c->peer = peer;
+    return sss::Status::Ok();
+  }
+
+  static std::string Frame(const google::protobuf::MessageLite &proto) {
+    const uint32_t len = proto.ByteSizeLong();
+    std::string frame(sizeof(len) + len, '\0');
+    std::memcpy(frame.data(), &len, sizeof(len));
+    proto.SerializeToArray(frame.data() + sizeof(len), len);
+    return frame;
+  }
+
+  sss::Status SendFrame(Conn *c, const google::protobuf::MessageLite &proto) {
+    if (c == nullptr || c->closed.load(std::memory_order_acquire))
+      return {sss::Unavailable, "Connection closed"};
+    std::string frame = Frame(proto);
+    num_sent_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(c->send_mu);
+    if (!c->out.empty()) {
+      // The reactor will get to it, in order
+      c->out.push_back(std::move(frame));
+      return sss::Status::Ok();
+    }
+    num_writes_.fetch_add(1, std::memory_order_relaxed);
+    ssize_t w = ::send(c->fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+    if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      Close(c);
+      return Errno("send");
+    }
+    if (size_t(std::max<ssize_t>(w, 0)) == frame.size())
+      return sss::Status::Ok();
+    c->out.push_back(std::move(frame));
+    c->out_off = std::max<ssize_t>(w, 0);
+    ArmWrite(c, true);
+    return sss::Status::Ok();
+  }
+
+  std::optional<std::string> Pop(Conn *c) {
+    if (c == nullptr)
+      return std::nullopt;
+    std::unique_lock<std::mutex> lock(c->recv_mu);
+    if (c->in.empty() && opts_.busy_poll && !c->closed.load() &&
+        c->read_mu.try_lock()) {
+      lock.unlock();
+      OnReadable(c);
+      c->read_mu.unlock();
+      lock.lock();
+    }
+    if (c->in.empty())
+      return std::nullopt;
+    std::string bytes = std::move(c->in.front());
+    c->in.pop_front();
+    return bytes;
+  }
+
+  /// Turn EPOLLOUT for `c` on or off.  Call with `c->send_mu` held.
+  void ArmWrite(Conn *c, bool on) {
+    if (c->want_write == on)
+      return;
+    c->want_write = on;
+    epoll_event ev{};
+    ev.events = EPOLLIN | (on ? uint32_t(EPOLLOUT) : 0u);
+    ev.data.ptr = c;
+    ::epoll_ctl(c->reactor->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+  }
+
+  void Close(Conn *c) {
+    if (c->closed.exchange(true))
+      return;
+    ROME_WARN("Connection to node {} closed", c->peer);
+    ::epoll_ctl(c->reactor->epfd, EPOLL_CTL_DEL, c->fd, nullptr);
+    ::shutdown(c->fd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(c->recv_mu);
+    c->arrived.notify_all();
+  }
+
+  /// Write as much of `c`'s queue as the socket takes, kMaxIov messages per
+  /// writev()
+  void OnWritable(Conn *c) {
+    std::lock_guard<std::mutex> lock(c->send_mu);
+    while (!c->out.empty()) {
+      iovec iov[kMaxIov];
+      uint32_t n = 0;
+      for (auto it = c->out.begin(); it != c->out.end() && n < kMaxIov;
+           ++it, ++n) {
+        const size_t skip = n == 0 ? c->out_off : 0;
+        iov[n].iov_base = it->data() + skip;
+        iov[n].iov_len = it->size() - skip;
+      }
+      num_writes_.fetch_add(1, std::memory_order_relaxed);
+      ssize_t w = ::writev(c->fd, iov, n);
+      if (w < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+          return;
+        Close(c);
+        return;
+      }
+      size_t left = w;
+      while (left > 0) {
+        const size_t rest = c->out.front().size() - c->out_off;
+        if (left < rest) {
+          c->out_off += left;
+          break;
+        }
+        left -= rest;
+        c->out.pop_front();
+        c->out_off = 0;
+      }
+    }
+    ArmWrite(c, false);
+  }
+
+  /// Read everything that has arrived on `c` and queue the whole messages.
+  /// Call with `c->read_mu` held.
+  void OnReadable(Conn *c) {
+    std::vector<std::string> got;
+    while (true) {
+      const size_t at = c->rbuf.size();
+      c->rbuf.resize(at + 65536);
+      ssize_t r = ::read(c->fd, c->rbuf.data() + at, 65536);
+      c->rbuf.resize(at + std::max<ssize_t>(r, 0));
+      if (r > 0)
+        continue;
+      if (r < 0 && errno == EINTR)
+        continue;
+      if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        Close(c);
+      break;
+    }
+    size_t pos = 0;
+    while (c->rbuf.size() - pos >= sizeof(uint32_t)) {
+      uint32_t len;
+      std::memcpy(&len, c->rbuf.data() + pos, sizeof(len));
+      if (len > opts_.max_message) {
+        ROME_WARN("Message of {} bytes from node {}", len, c->peer);
+        Close(c);
+        return;
+      }
+      if (c->rbuf.size() - pos - sizeof(len) < len)
+        break;
+      got.emplace_back(c->rbuf, pos + sizeof(len), len);
+      pos += sizeof(len) + len;
+    }
+    c->rbuf.erase(0, pos);
+    if (got.empty())
+      return;
+    std::lock_guard<std::mutex> lock(c->recv_mu);
+    for (auto &m : got)
+      c->in.push_back(std::move(m));
+    c->arrived.notify_all();
+  }
+
+  void Run(Reactor *r) {
+    epoll_event events[64];
+    while (true) {
+      int n = ::epoll_wait(r->epfd, events, 64, -1);
+      if (n < 0 && errno != EINTR) {
+        ROME_WARN("epoll_wait: {}", std::strerror(errno));
+        return;
+      }
+      for (int i = 0; i < n; ++i) {
+        if (events[i].data.ptr == nullptr)
+          return; // Stop()
+        auto *c = static_cast<Conn *>(events[i].data.ptr);
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+          std::lock_guard<std::mutex> lock(c->read_mu);
+          OnReadable(c);
+        }
+        if ((events[i].events & EPOLLOUT) && !c->closed.load())
+          OnWritable(c);
+      }
+    }
+  }
+
+public:
+  /// Construct the transport.  Call Init() before using it.
+  ///
+  /// @param self   This node's id
+  /// @param peers  Every node, including this one, indexed by id
+  /// @param opts   Reactor threads and connections per peer
+  TcpTransport(uint32_t self, std::vector<Peer> peers,
+               Options opts = Options())
+      : self_(self), peers_(std::move(peers)), opts_(opts) {
+    ROME_ASSERT(self_ < peers_.size(), "Node {} out of range for {} nodes",
+                self_, peers_.size());
+    ROME_ASSERT(opts_.reactors > 0 && opts_.channels > 0,
+                "Need at least one reactor and one channel");
+    for (uint32_t i = 0; i < peers_.size() * opts_.channels; ++i) {
+      conns_.push_back(std::make_unique<Conn>());
+      connections_.push_back(
+          std::make_unique<Connection>(this, conns_.back().get()));
+    }
+  }
+
+  TcpTransport(const TcpTransport &) = delete;
+  TcpTransport(TcpTransport &&) = delete;
+
+  ~TcpTransport() { Stop(); }
+
+  uint32_t self() const { return self_; }
+  uint32_t size() const { return peers_.size(); }
+
+  // Getters.
+  uint64_t num_sent() const { return num_sent_.load(); }
+  /// send() and writev() calls; below num_sent() when writes were batched
+  uint64_t num_writes() const { return num_writes_.load(); }
+
+  /// Listen on this node's port, connect to every peer (this node dials the
+  /// lower ids and accepts the higher ones), and start the reactors.  Every
+  /// node must call this at about the same time.
+  sss::Status Init() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+      return Errno("socket");
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    auto addr = Resolve(peers_[self_]);
+    RETURN_STATUSVAL_ON_ERROR(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr.val.value()),
+               sizeof(sockaddr_in)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0)
+      return Errno("listen on port " + std::to_string(peers_[self_].port));
+
+    for (uint32_t p = 0; p < self_; ++p) {
+      for (uint32_t ch = 0; ch < opts_.channels; ++ch) {
+        auto fd = Dial(p, ch);
+        RETURN_STATUSVAL_ON_ERROR(fd);
+        auto adopted = Adopt(p, ch, fd.val.value());
+        RETURN_STATUS_ON_ERROR(adopted);
+      }
+    }
+    for (uint32_t left = (size() - self_ - 1) * opts_.channels; left > 0;
+         --left) {
+      int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0)
+        return Errno("accept");
+      uint32_t hello[2];
+      if (!ReadFully(fd, hello, sizeof(hello))) {
+        ::close(fd);
+        return Errno("handshake");
+      }
+      auto adopted = Adopt(hello[0], hello[1], fd);
+      RETURN_STATUS_ON_ERROR(adopted);
+    }
+
+    for (uint32_t i = 0; i < opts_.reactors; ++i) {
+      auto r = std::make_unique<Reactor>();
+      r->epfd = ::epoll_create1(0);
+      r->wake = ::eventfd(0, EFD_NONBLOCK);
+      if (r->epfd < 0 || r->wake < 0)
+        return Errno("epoll");
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.ptr = nullptr;
+      ::epoll_ctl(r->epfd, EPOLL_CTL_ADD, r->wake, &ev);
+      reactors_.push_back(std::move(r));
+    }
+    uint32_t next = 0;
+    for (auto &c : conns_) {
+      if (c->fd < 0)
+        continue;
+      c->reactor = reactors_[next++ % reactors_.size()].get();
+      epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.ptr = c.get();
+      if (::epoll_ctl(c->reactor->epfd, EPOLL_CTL_ADD, c->fd, &ev) != 0)
+        return Errno("epoll_ctl");
+    }
+    for (auto &r : reactors_)
+      r->thread = std::thread([this, r = r.get()]() { Run(r); });
+    return sss::Status::Ok();
+  }
+
+  /// Stop the reactors and close every socket.  Messages still queued are
+  /// dropped.
+  void Stop() {
+    for (auto &r : reactors_) {
+      uint64_t one = 1;
+      if (r->thread.joinable()) {
+        [[maybe_unused]] auto w = ::write(r->wake, &one, sizeof(one));
+        r->thread.join();
+      }
+      ::close(r->wake);
+      ::close(r->epfd);
+    }
+    reactors_.clear();
+    for (auto &c : conns_) {
+      if (c->fd < 0)
+        continue;
+      c->closed.store(true);
+      ::close(c->fd);
+      c->fd = -1;
+      std::lock_guard<std::mutex> lock(c->recv_mu);
+      c->arrived.notify_all();
+    }
+    if (listen_fd_ >= 0)
+      ::close(listen_fd_);
+    listen_fd_ = -1;
+  }
+
+  /// This node's end of `channel` to `peer`, or nullptr if there is none.
+  /// Valid after Init().
+  Connection *connection(uint32_t peer, uint32_t channel = 0) {
+    if (conn(peer, channel) == nullptr)
+      return nullptr;
+    return connections_[peer * opts_.channels + channel].get();
+  }
+
+  sss::Status Send(uint32_t to, const message::Msg &msg) {
+    Conn *c = conn(to, 0);
+    if (c == nullptr) {
+      sss::Status err = {sss::InvalidArgument, "No connection to "};
+      return err << to;
+    }
+    return SendFrame(c, msg);
+  }
+
+  std::optional<message::Msg> TryReceive(uint32_t from) {
+    auto bytes = Pop(conn(from, 0));
+    if (!bytes.has_value())
+      return std::nullopt;
+    message::Msg msg;
+    if (!msg.ParseFromString(bytes.value())) {
+      ROME_WARN("Dropping a malformed message from node {}", from);
+      return std::nullopt;
+    }
+    return msg;
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <logging/logging.h>
+#include <metrics/stopwatch.h>
+
+namespace rabia {
+
+/// Nanoseconds since the first call, from the TSC.  The frequency is
+/// calibrated once per process, the way rome::metrics::Stopwatch does it.
+inline uint64_t TscNanos() {
+  static const auto sw = rome::metrics::Stopwatch::Create("rabia_tsc_clock");
+  return sw->GetSplit().GetRuntimeNanoseconds().count();
+}
+
+/// Identifies a scheduled timer.  kNoTimer is never issued, so it can mark
+/// "no timer armed".
+using TimerId = uint64_t;
+static constexpr TimerId kNoTimer = 0;
+
+struct TimerWheelOptions {
+  std::chrono::nanoseconds tick{1000}; // The granularity of deadlines
+  uint32_t capacity = 1024; // Timers allocated up front; doubles when short
+};
+
+/// TimerWheel is a hierarchical timing wheel (Varghese and Lauck): kLevels
+/// wheels of kSlots slots, where a slot of level l spans kSlots^l ticks.  A
+/// timer goes in the lowest level whose span covers how far its deadline is
+/// from now, so scheduling and cancelling are O(1), and expiring costs O(1)
+/// per timer plus one relink per level it drops through on the way down (at
+/// most kLevels - 1).  Deadlines up to 2^32 ticks out are exact; later ones
+/// fire at that horizon.
+///
+/// Timers live in one preallocated array of nodes, linked into their slots
+/// by index, so there is no allocation per timer: the array only grows (by
+/// doubling) when more timers are pending at once than it holds.  A timer
+/// fires a plain function pointer with a context pointer and a 64-bit cookie
+/// instead of a std::function, for the same reason.  A TimerId carries the
+/// node's generation, so cancelling a timer that already fired (and whose
+/// node was reused) is a harmless no-op; that is what lets the owner cancel
+/// on decide without tracking whether the timer got there first.
+///
+/// The wheel has no clock of its own.  Advance() takes the time, so an
+/// EventLoop poller can drive it from the TSC (see TscNanos()) and a
+/// simulation from its virtual clock.  Empty stretches are skipped with a
+/// bitmap of occupied slots, so an idle loop costs nothing per tick.
+///
+/// NB: Not thread-safe; one event loop owns a wheel.
+class TimerWheel {
+public:
+  using Options = TimerWheelOptions;
+  /// Called when a timer expires, with what it was scheduled with.  It may
+  /// schedule and cancel timers, including rescheduling itself.
+  using Fn = void (*)(void *ctx, uint64_t cookie);
+
+  static constexpr uint32_t kLevels = 4;
+  static constexpr uint32_t kSlotBits = 8;
+  static constexpr uint32_t kSlots = 1u << kSlotBits;
+
+private:
+  static constexpr uint32_t kNil = ~0u;
+  static constexpr uint64_t kHorizon = 1ull << (kLevels * kSlotBits);
+
+  struct Node {
+    uint64_t expiry = 0; // In ticks
+    Fn fn = nullptr;
+    void *ctx = nullptr;
+    uint64_t cookie = 0;
+    uint32_t prev = kNil;  // In its slot's list
+    uint32_t next = kNil;  // In its slot's list, or the free list
+    uint32_t gen = 1;      // Bumped whenever the node is freed; never 0
+    uint32_t where = kNil; // level * kSlots + slot, or kNil if free
+  };
+
+  struct Level {
+    uint32_t head[kSlots];
+    uint64_t occupied[kSlots / 64];
+  };
+
+  const Options opts_;
+  const uint64_t tick_ns_;
+  std::vector<Node> nodes_;
+  uint32_t free_ = kNil;
+  Level levels_[kLevels];
+  uint64_t now_ = 0;    // The next tick to expire
+  uint64_t now_ns_ = 0; // As of the last Advance()
+  size_t size_ = 0;
+
+  uint64_t num_fired_ = 0;
+
+  static TimerId MakeId(uint32_t idx, uint32_t gen) {
+    return (uint64_t(gen) << 32) | idx;
+  }
+
+  uint32_t Alloc() {
+    if (free_ == kNil) {
+      const uint32_t old = nodes_.size();
+      nodes_.resize(std::max<size_t>(2 * old, opts_.capacity));
+      for (uint32_t i = nodes_.size(); i-- > old;) {
+        nodes_[i].next = free_;
+        free_ = i;
+      }
+    }
+    uint32_t i = free_;
+    free_ = nodes_[i].next;
+    return i;
+  }
+
+  void Free(uint32_t i) {
+    Node &n = nodes_[i];
+    if (++n.gen == 0)
+      n.gen = 1;
+    n.where = kNil;
+    n.next = free_;
+    free_ = i;
+  }
+
+  /// Put node `i` in the slot for its expiry, relative to `now_`
+  void Link(uint32_t i) {
+    Node &n = nodes_[i];
+    const uint64_t diff = n.expiry ^ now_;
+    const uint32_t level = diff == 0 ? 0
+                                     : std::min<uint32_t>(
+                                           (63 - std::countl_zero(diff)) /
+                                               kSlotBits,
+                                           kLevels - 1);
+    const uint32_t slot =
+        uint32_t(n.expiry >> (kSlotBits * level)) & (kSlots - 1);
+    Level &l = levels_[level];
+    n.where = level * kSlots + slot;
+    n.prev = kNil;
+    n.next = l.head[slot];
+    if (n.next != kNil)
+      nodes_[n.next].prev = i;
+    l.head[slot] = i;
+    l.occupied[slot / 64] |= 1ull << (slot % 64);
+  }
+
+  void Unlink(uint32_t i) {
+    Node &n = nodes_[i];
+    Level &l = levels_[n.where / kSlots];
+    const uint32_t slot = n.where % kSlots;
+    if (n.prev != kNil)
+      nodes_[n.prev].next = n.next;
+    else
+      l.head[slot] = n.next;
+    if (n.next != kNil)
+      nodes_[n.next].prev = n.prev;
+    if (l.head[slot] == kNil)
+      l.occupied[slot / 64] &= ~(1ull << (slot % 64));
+  }
+
+  /// `now_` is at the start of a turn of one or more levels: move the timers
+  /// in the slots those levels have just reached down to where they now
+  /// belong, highest level first so that they can drop more than one level
+  void Cascade() {
+    for (uint32_t level = kLevels - 1; level > 0; --level) {
+      if ((now_ & ((1ull << (kSlotBits * level)) - 1)) != 0)
+        continue;
+      Level &l = levels_[level];
+      const uint32_t slot =
+          uint32_t(now_ >> (kSlotBits * level)) & (kSlots - 1);
+      uint32_t i = l.head[slot];
+      l.head[slot] = kNil;
+      l.occupied[slot / 64] &= ~(1ull << (slot % 64));
+      while (i != kNil) {
+        uint32_t next = nodes_[i].next;
+        Link(i);
+        i = next;
+      }
+    }
+  }
+
+  /// The first occupied slot of level 0 at or after `from`, or kSlots
+  uint32_t NextOccupied(uint32_t from) const {
+    const Level &l = levels_[0];
+    for (uint32_t w = from / 64; w < kSlots / 64; ++w) {
+      uint64_t bits = l.occupied[w];
+      if (w == from / 64)
+        bits &= ~0ull << (from % 64);
+      if (bits != 0)
+        return w * 64 + std::countr_zero(bits);
+    }
+    return kSlots;
+  }
+
+public:
+  explicit TimerWheel(Options opts = Options())
+      : opts_(opts), tick_ns_(opts.tick.count()) {
+    ROME_ASSERT(tick_ns_ > 0 && opts_.capacity > 0,
+                "A timer wheel needs a positive tick and capacity");
+    for (auto &l : levels_) {
+      std::fill(std::begin(l.head), std::end(l.head), kNil);
+      std::memset(l.occupied, 0, sizeof(l.occupied));
+    }
+    nodes_.reserve(opts_.capacity);
+  }
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel(TimerWheel &&) = delete;
+
+  // Getters.
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  uint64_t now_ns() const { return now_ns_; }
+  uint64_t num_fired() const { return num_fired_; }
+
+  /// Call `fn(ctx, cookie)` from the first Advance() at or after
+  /// `deadline_ns`, rounded up to a whole tick.  A deadline that has already
+  /// passed fires on the next Advance().
+  TimerId Schedule(uint64_t deadline_ns, Fn fn, void *ctx, uint64_t cookie) {
+    const uint32_t i = Alloc();
+    Node &n = nodes_[i];
+    const uint64_t tick = (deadline_ns + tick_ns_ - 1) / tick_ns_;
+    n.expiry = std::clamp(tick, now_, now_ + kHorizon - 1);
+    n.fn = fn;
+    n.ctx = ctx;
+    n.cookie = cookie;
+    Link(i);
+    ++size_;
+    return MakeId(i, n.gen);
+  }
+
+  /// Schedule a timer `delay` after the last Advance()
+  TimerId ScheduleAfter(std::chrono::nanoseconds delay, Fn fn, void *ctx,
+                        uint64_t cookie) {
+    return Schedule(now_ns_ + delay.count(), fn, ctx, cookie);
+  }
+
+  /// Stop timer `id` from firing
+  ///
+  /// @return False if it already fired or was cancelled
+  bool Cancel(TimerId id) {
+    const uint32_t i = uint32_t(id);
+    if (i >= nodes_.size() || nodes_[i].gen != uint32_t(id >> 32) ||
+        nodes_[i].where == kNil)
+      return false;
+    Unlink(i);
+    Free(i);
+    --size_;
+    return true;
+  }
+
+  /// Fire every timer whose deadline is at or before `now_ns`, in deadline
+  /// order (timers due in the same tick fire in no particular order)
+  ///
+  /// @return The number of timers fired
+  int Advance(uint64_t now_ns) {
+    now_ns_ = std::max(now_ns_, now_ns);
+    const uint64_t to = now_ns_ / tick_ns_;
+    int fired = 0;
+    while (now_ <= to) {
+      if (size_ == 0) {
+        now_ = to + 1;
+        break;
+      }
+      if ((now_ & (kSlots - 1)) == 0)
+        Cascade();
+      // Skip to the next occupied slot in this turn of level 0, or the end of
+      // the turn
+      const uint32_t slot = NextOccupied(uint32_t(now_) & (kSlots - 1));
+      const uint64_t at = (now_ & ~uint64_t(kSlots - 1)) + slot;
+      if (at > to) {
+        now_ = to + 1;
+        break;
+      }
+      if (slot == kSlots) {
+        now_ = at;
+        continue;
+      }
+      now_ = at + 1;
+      // A timer that reschedules itself for now lands in a later slot, since
+      // `now_` has moved past this one
+      Level &l = levels_[0];
+      while (l.head[slot] != kNil) {
+        const uint32_t i = l.head[slot];
+        Unlink(i);
+        const Node n = nodes_[i];
+        Free(i);
+        --size_;
+        ++num_fired_;
+        ++fired;
+        n.fn(n.ctx, n.cookie);
+      }
+    }
+    return fired;
+  }
+};
+
+} // namespace rabia
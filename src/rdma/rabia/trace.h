@@ -0,0 +1,235 @@
+#pragma once
+
+#include <x86intrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <logging/logging.h>
+#include <vendor/sss/status.h>
+
+/// Per-slot phase tracing.  Build with RABIA_TRACE=1 (CMake: -DSLOT_TRACE=ON)
+/// to record a timestamp each time a replica moves a slot from one phase to
+/// the next; with RABIA_TRACE=0, the default, every RABIA_TRACE_EVENT is
+/// compiled out, the way ROME_LOG_LEVEL removes log statements.
+#ifndef RABIA_TRACE
+#define RABIA_TRACE 0
+#endif
+
+namespace rabia::trace {
+
+/// Where a slot is.  Each point is recorded once per slot and phase.
+enum Point : uint8_t {
+  kPropose = 0, // Broadcast a proposal (or NULL)
+  kState,       // Broadcast a State; `phase` is the phase it starts
+  kVote,        // Broadcast a Vote
+  kCoin,        // Flipped the common coin for the next phase
+  kDecide,      // Decided by its own votes
+  kLearn,       // Decided by a peer's Decision (or a catch-up reply)
+  kRelease,     // Delivered in slot order
+  kExecute,     // Applied by the KvExecutor
+  kNumPoints,
+};
+
+inline const char *PointName(uint32_t p) {
+  static const char *kNames[] = {"propose", "state",   "vote",    "coin",
+                                 "decide",  "learn",   "release", "execute"};
+  return p < kNumPoints ? kNames[p] : "unknown";
+}
+
+/// One timestamp.  In a ring, `time` is in TSC cycles; in a file, it is in
+/// nanoseconds since the earliest event.
+struct Event {
+  uint64_t time;
+  uint32_t slot;
+  uint16_t phase;
+  uint8_t point;
+  uint8_t node;
+};
+static_assert(sizeof(Event) == 16);
+
+/// The events one thread recorded
+struct ThreadTrace {
+  uint32_t thread;
+  std::vector<Event> events; // In the order recorded
+};
+
+/// Ring holds one thread's events.  Only its thread writes to it, with no
+/// locks or atomic read-modify-writes: an event is a 16-byte store and a
+/// release store of the head.  When it is full, new events overwrite the
+/// oldest, so a long run keeps its last kEvents events.
+///
+/// NB: Copy() may run while the thread is still recording.  It copies, then
+///     rereads the head and throws away anything that was overwritten in the
+///     meantime, so what it returns is a consistent suffix.
+class Ring {
+public:
+  static constexpr uint64_t kEvents = 1 << 20; // 16 MiB per thread
+
+private:
+  std::unique_ptr<Event[]> events_;
+  std::atomic<uint64_t> head_; // Events ever recorded
+
+public:
+  Ring() : events_(std::make_unique<Event[]>(kEvents)), head_(0) {}
+
+  void Push(const Event &e) {
+    const uint64_t h = head_.load(std::memory_order_relaxed);
+    events_[h & (kEvents - 1)] = e;
+    head_.store(h + 1, std::memory_order_release);
+  }
+
+  /// The events still in the ring, oldest first
+  std::vector<Event> Copy() const {
+    const uint64_t end = head_.load(std::memory_order_acquire);
+    uint64_t begin = end > kEvents ? end - kEvents : 0;
+    std::vector<Event> out;
+    out.reserve(end - begin);
+    for (uint64_t i = begin; i < end; ++i)
+      out.push_back(events_[i & (kEvents - 1)]);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t now = head_.load(std::memory_order_relaxed);
+    // The writer may also be partway through event `now`, which overwrites
+    // event `now - kEvents`
+    if (now >= begin + kEvents) {
+      const uint64_t lost = std::min(now - kEvents + 1 - begin, end - begin);
+      out.erase(out.begin(), out.begin() + lost);
+    }
+    return out;
+  }
+};
+
+/// Registry owns every thread's Ring.  A thread registers the first time it
+/// records, and its ring outlives it, so a trace can be written after the
+/// replicas' threads have been joined.  It also calibrates the TSC: the
+/// cycle count and the steady clock are read when it is created and again
+/// when the trace is collected.
+class Registry {
+  std::mutex mu_;
+  std::vector<std::unique_ptr<Ring>> rings_;
+  const uint64_t start_tsc_;
+  const std::chrono::steady_clock::time_point start_;
+
+  Registry()
+      : start_tsc_(__rdtsc()), start_(std::chrono::steady_clock::now()) {}
+
+public:
+  static Registry &Get() {
+    static Registry registry;
+    return registry;
+  }
+
+  Ring *Register() {
+    std::lock_guard<std::mutex> lock(mu_);
+    rings_.push_back(std::make_unique<Ring>());
+    return rings_.back().get();
+  }
+
+  /// Every thread's events, with times converted to nanoseconds since the
+  /// earliest one
+  std::vector<ThreadTrace> Collect() {
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start_;
+    const uint64_t cycles = __rdtsc() - start_tsc_;
+    const double ns_per_cycle = cycles > 0 ? elapsed.count() / cycles : 1;
+
+    std::vector<ThreadTrace> out;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      for (uint32_t t = 0; t < rings_.size(); ++t)
+        out.push_back({t, rings_[t]->Copy()});
+    }
+    uint64_t first = UINT64_MAX;
+    for (const auto &t : out)
+      for (const auto &e : t.events)
+        first = std::min(first, e.time);
+    for (auto &t : out)
+      for (auto &e : t.events)
+        e.time = uint64_t((e.time - first) * ns_per_cycle);
+    return out;
+  }
+};
+
+/// Record that this thread's `node` reached `point` of `slot`'s `phase`.
+/// Use RABIA_TRACE_EVENT rather than calling this directly.
+inline void Record(uint32_t node, uint32_t slot, uint32_t phase, Point point) {
+  thread_local Ring *ring = Registry::Get().Register();
+  ring->Push({__rdtsc(), slot, uint16_t(phase), point, uint8_t(node)});
+}
+
+/// The file is a FileHeader, then per thread a ThreadHeader and its events
+struct FileHeader {
+  uint32_t magic = kMagic;
+  uint32_t threads = 0;
+  static constexpr uint32_t kMagic = 0x52425452; // "RTBR"
+};
+
+struct ThreadHeader {
+  uint32_t thread;
+  uint32_t events;
+};
+
+/// Write everything recorded so far (see Registry::Collect()) to `path`
+inline sss::Status WriteFile(const std::string &path) {
+  auto threads = Registry::Get().Collect();
+  FILE *f = std::fopen(path.c_str(), "wb");
+  if (f == nullptr)
+    return {sss::InternalError, "Can't create trace file " + path};
+  FileHeader fh;
+  fh.threads = threads.size();
+  bool ok = std::fwrite(&fh, sizeof(fh), 1, f) == 1;
+  for (const auto &t : threads) {
+    ThreadHeader th{t.thread, uint32_t(t.events.size())};
+    ok = ok && std::fwrite(&th, sizeof(th), 1, f) == 1;
+    ok = ok && std::fwrite(t.events.data(), sizeof(Event), t.events.size(),
+                           f) == t.events.size();
+  }
+  ok = std::fclose(f) == 0 && ok;
+  if (!ok)
+    return {sss::InternalError, "Can't write trace file " + path};
+  return sss::Status::Ok();
+}
+
+/// Read a file written by WriteFile()
+inline sss::StatusVal<std::vector<ThreadTrace>>
+ReadFile(const std::string &path) {
+  FILE *f = std::fopen(path.c_str(), "rb");
+  if (f == nullptr)
+    return {{sss::NotFound, "Can't open trace file " + path}, {}};
+  std::vector<ThreadTrace> out;
+  FileHeader fh;
+  bool ok = std::fread(&fh, sizeof(fh), 1, f) == 1 &&
+            fh.magic == FileHeader::kMagic;
+  for (uint32_t i = 0; ok && i < fh.threads; ++i) {
+    ThreadHeader th;
+    ok = std::fread(&th, sizeof(th), 1, f) == 1;
+    if (!ok)
+      break;
+    ThreadTrace &t = out.emplace_back();
+    t.thread = th.thread;
+    t.events.resize(th.events);
+    ok = std::fread(t.events.data(), sizeof(Event), th.events, f) == th.events;
+  }
+  std::fclose(f);
+  if (!ok)
+    return {{sss::InternalError, path + " is not a complete trace file"}, {}};
+  return {sss::Status::Ok(), std::move(out)};
+}
+
+} // namespace rabia::trace
+
+/// Record a phase transition of `slot`: RABIA_TRACE_EVENT(self_, slot, phase,
+/// kVote).  Nothing is evaluated unless RABIA_TRACE is 1.
+#if RABIA_TRACE
+#define RABIA_TRACE_EVENT(node, slot, phase, point)                            \
+  ::rabia::trace::Record((node), (slot), (phase), ::rabia::trace::point)
+#else
+#define RABIA_TRACE_EVENT(node, slot, phase, point) ((void)0)
+#endif
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vendor/sss/status.h>
+
+#include "trace.h"
+
+namespace rabia::trace {
+
+/// The stretches of a slot's life that TraceReport times, each between two
+/// of its trace points
+enum Span : uint32_t {
+  kProposalSpan = 0, // Propose -> phase 1 State: waiting for a quorum of
+                     // proposals
+  kStateSpan,        // Phase 1 State -> Vote: waiting for a quorum of States
+  kVoteSpan,         // Phase 1 Vote -> decided or phase 2: ditto, Votes
+  kExtraPhasesSpan,  // Phase 2 State -> decided: every phase after the first
+  kLearnSpan,        // Propose -> a peer's Decision arrived
+  kReleaseSpan,      // Decided or learned -> released: waiting on lower slots
+  kExecuteSpan,      // Released -> applied
+  kTotalSpan,        // Propose -> released
+  kNumSpans,
+};
+
+inline const char *SpanName(uint32_t s) {
+  static const char *kNames[] = {"proposal", "state",        "vote",
+                                 "extra_phases", "learn", "release_wait",
+                                 "execute",  "total"};
+  return s < kNumSpans ? kNames[s] : "unknown";
+}
+
+/// TraceReport turns the events of a trace (see trace.h) into a per-phase
+/// latency breakdown: for each slot on each traced thread, the time between
+/// consecutive phase transitions.  Histograms() summarizes each Span over
+/// every slot, and WriteChromeTrace() lays the spans out per slot for
+/// chrome://tracing or Perfetto.
+class TraceReport {
+public:
+  /// One timed Span of one slot
+  struct Interval {
+    uint32_t thread;
+    uint32_t node;
+    uint32_t slot;
+    uint32_t span;
+    uint64_t start; // ns
+    uint64_t end;   // ns
+  };
+
+private:
+  std::vector<Interval> intervals_; // By thread, then slot
+  std::vector<uint64_t> durations_[kNumSpans];
+  uint64_t num_slots_ = 0;
+  uint64_t num_coins_ = 0;
+
+  /// Time the spans of one slot, from its events in the order recorded
+  void AddSlot(uint32_t thread, uint32_t node, uint32_t slot,
+               const std::vector<Event> &events) {
+    constexpr uint64_t kNone = UINT64_MAX;
+    uint64_t propose = kNone, state1 = kNone, vote1 = kNone, state2 = kNone,
+             decide = kNone, learn = kNone, release = kNone, execute = kNone;
+    for (const Event &e : events) {
+      switch (e.point) {
+      case kPropose:
+        propose = e.time;
+        break;
+      case kState:
+        if (e.phase == 1)
+          state1 = e.time;
+        else if (e.phase == 2)
+          state2 = e.time;
+        break;
+      case kVote:
+        if (e.phase == 1)
+          vote1 = e.time;
+        break;
+      case kCoin:
+        ++num_coins_;
+        break;
+      case kDecide:
+        decide = e.time;
+        break;
+      case kLearn:
+        learn = e.time;
+        break;
+      case kRelease:
+        release = e.time;
+        break;
+      case kExecute:
+        execute = e.time;
+        break;
+      }
+    }
+    ++num_slots_;
+    auto add = [&](Span span, uint64_t start, uint64_t end) {
+      if (start == kNone || end == kNone || end < start)
+        return;
+      intervals_.push_back({thread, node, slot, span, start, end});
+      durations_[span].push_back(end - start);
+    };
+    const uint64_t decided = decide != kNone ? decide : learn;
+    add(kProposalSpan, propose, state1);
+    add(kStateSpan, state1, vote1);
+    add(kVoteSpan, vote1, state2 != kNone ? state2 : decide);
+    add(kExtraPhasesSpan, state2, decide);
+    if (decide == kNone)
+      add(kLearnSpan, propose, learn);
+    add(kReleaseSpan, decided, release);
+    add(kExecuteSpan, release, execute);
+    add(kTotalSpan, propose, release);
+  }
+
+  static uint64_t Percentile(const std::vector<uint64_t> &sorted, double p) {
+    if (sorted.empty())
+      return 0;
+    const size_t i = p / 100 * sorted.size();
+    return sorted[std::min(sorted.size() - 1, i)];
+  }
+
+public:
+  explicit TraceReport(const std::vector<ThreadTrace> &threads) {
+    for (const auto &t : threads) {
+      // (node, slot) -> its events, in the order recorded
+      std::map<std::pair<uint32_t, uint32_t>, std::vector<Event>> slots;
+      for (const Event &e : t.events)
+        slots[{e.node, e.slot}].push_back(e);
+      for (const auto &[key, events] : slots)
+        AddSlot(t.thread, key.first, key.second, events);
+    }
+    for (auto &d : durations_)
+      std::sort(d.begin(), d.end());
+  }
+
+  // Getters.
+  const std::vector<Interval> &intervals() const { return intervals_; }
+  uint64_t num_slots() const { return num_slots_; }
+  uint64_t num_coins() const { return num_coins_; }
+  /// Every duration of `span` seen, in ns, sorted
+  const std::vector<uint64_t> &durations(Span span) const {
+    return durations_[span];
+  }
+
+  /// A table of percentiles per span, in microseconds, followed by a
+  /// histogram of each span with one power-of-two bucket of ns per row
+  std::string Histograms() const {
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "%llu slots, %llu coin flips\n"
+                  "%-13s %9s %9s %9s %9s %9s %9s\n",
+                  (unsigned long long)num_slots_,
+                  (unsigned long long)num_coins_, "span", "count", "mean_us",
+                  "p50_us", "p90_us", "p99_us", "max_us");
+    out += line;
+    for (uint32_t s = 0; s < kNumSpans; ++s) {
+      const auto &d = durations_[s];
+      double sum = 0;
+      for (uint64_t v : d)
+        sum += v;
+      std::snprintf(line, sizeof(line),
+                    "%-13s %9zu %9.1f %9.1f %9.1f %9.1f %9.1f\n", SpanName(s),
+                    d.size(), d.empty() ? 0 : sum / d.size() / 1e3,
+                    Percentile(d, 50) / 1e3, Percentile(d, 90) / 1e3,
+                    Percentile(d, 99) / 1e3,
+                    d.empty() ? 0 : d.back() / 1e3);
+      out += line;
+    }
+    for (uint32_t s = 0; s < kNumSpans; ++s) {
+      const auto &d = durations_[s];
+      if (d.empty())
+        continue;
+      uint64_t buckets[65] = {};
+      for (uint64_t v : d)
+        ++buckets[std::bit_width(v)];
+      const uint64_t most =
+          *std::max_element(std::begin(buckets), std::end(buckets));
+      out += std::string("\n") + SpanName(s) + " (ns)\n";
+      for (uint32_t b = 0; b < 65; ++b) {
+        if (buckets[b] == 0)
+          continue;
+        const uint64_t lo = b == 0 ? 0 : 1ull << (b - 1);
+        const uint64_t hi = b == 0 ? 1 : lo * 2;
+        std::snprintf(line, sizeof(line), "  [%10llu, %10llu) %9llu ",
+                      (unsigned long long)lo, (unsigned long long)hi,
+                      (unsigned long long)buckets[b]);
+        out += line;
+        out += std::string(std::max<uint64_t>(1, buckets[b] * 50 / most),
+                           '#');
+        out += '\n';
+      }
+    }
+    return out;
+  }
+
+  /// Write the spans of the first `max_slots` slots of each thread as Chrome
+  /// trace events ("X" complete events, one row per slot and one process
+  /// per traced thread), to open in chrome://tracing or ui.perfetto.dev
+  sss::Status WriteChromeTrace(const std::string &path,
+                               uint32_t max_slots) const {
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (f == nullptr)
+      return {sss::InternalError, "Can't create " + path};
+    std::fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    std::map<uint32_t, uint32_t> threads; // thread -> node
+    std::map<uint32_t, uint32_t> slots;   // thread -> slots written
+    std::set<std::pair<uint32_t, uint32_t>> seen; // (thread, slot)
+    for (const Interval &i : intervals_) {
+      threads.emplace(i.thread, i.node);
+      if (seen.emplace(i.thread, i.slot).second)
+        ++slots[i.thread];
+      if (slots[i.thread] > max_slots || i.span == kTotalSpan)
+        continue;
+      // Chrome trace times are in microseconds
+      std::fprintf(f,
+                   "%s{\"name\":\"%s\",\"cat\":\"slot\",\"ph\":\"X\","
+                   "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u,"
+                   "\"args\":{\"slot\":%u}}",
+                   first ? "" : ",\n", SpanName(i.span), i.start / 1e3,
+                   (i.end - i.start) / 1e3, i.thread, i.slot, i.slot);
+      first = false;
+    }
+    for (const auto &[thread, node] : threads) {
+      std::fprintf(f,
+                   "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,"
+                   "\"args\":{\"name\":\"node %u (thread %u)\"}}",
+                   first ? "" : ",\n", thread, node, thread);
+      first = false;
+    }
+    std::fprintf(f, "\n]}\n");
+    if (std::fclose(f) != 0)
+      return {sss::InternalError, "Can't write " + path};
+    return sss::Status::Ok();
+  }
+};
+
+} // namespace rabia::trace
@@ -0,0 +1,712 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <message.pb.h>
+#include <logging/logging.h>
+
+#include "catchup_log.h"
+#include "coin.h"
+#include "pending_queue.h"
+#include "tally.h"
+#include "timer_wheel.h"
+#include "trace.h"
+
+namespace rabia {
+
+/// WeakMvc is one replica's instance of Rabia's Weak-MVC consensus.  Replicas
+/// decide the contents of a sequence of slots.  For each slot:
+///
+/// 1. Every replica broadcasts a pending object as a Proposal (or a NULL
+///    proposal, if it has nothing to propose but a peer has started the slot).
+/// 2. Once a replica has proposals from a majority, it enters phase 1 with
+///    state 1 if a majority of *all* replicas proposed the same object, and 0
+///    otherwise.
+/// 3. Each phase is two rounds.  In the State round, a replica broadcasts its
+///    state and waits for a majority of states; if a majority agree on `v` it
+///    votes `v`, otherwise it votes `?`.  In the Vote round, it waits for a
+///    majority of votes; if a majority voted `v` it decides `v`.  Otherwise it
+///    carries any non-`?` vote into the next phase, or flips the common coin
+///    if all votes were `?`.
+/// 4. Deciding 1 commits the majority proposal; deciding 0 commits NULL.  The
+///    decider broadcasts a Decision, which lets slower replicas adopt the
+///    outcome without finishing the rounds themselves.
+///
+/// Up to `window` slots run at once.  Each in-flight slot gets the first
+/// pending object that this replica hasn't already proposed in another
+/// in-flight slot, so replicas with the same queue propose the same objects
+/// for the same slots.  Slots can decide in any order; decisions are held
+/// back and released to the DecideFn strictly in slot (SvrSeq) order, and the
+/// window only slides when its lowest slot is released.
+///
+/// All messages for a slot carry the slot number in `Obj.SvrSeq`; the sender
+/// is known from the link it arrived on.  Messages for slots this replica
+/// hasn't started are kept until it does.
+///
+/// A replica that falls behind (it was down, or partitioned away) catches up
+/// rather than running every slot it missed.  Once a peer proposes `lag` or
+/// more slots past this replica's window, the peer has released every slot up
+/// to its own window, so this replica asks it for them: one ProposalRequest
+/// names a whole range (`Obj.SvrSeq` is the first slot, `Value` the count, and
+/// `Phase` the requester), and the peer streams back one ProposalReply per
+/// slot from its CatchupLog, up to `catchup_chunk` per Poll(), each carrying
+/// the decision in `Value` and the decided object.  A reply whose `Value` is
+/// `kQuestion` ends the stream early at its `Obj.SvrSeq`, the first slot the
+/// peer no longer has (or doesn't have yet).  A replayed slot is released as
+/// if this replica had decided it, but not broadcast.  With a TimerWheel, a
+/// request that isn't fully answered within `catchup_timeout` (the peer
+/// crashed, say) is given up on, so that the next Proposal asks again; the
+/// timer is cancelled once the batch is released.  If the transport can
+/// READ a peer's log directly (see RdmaMailboxTransport::ReadCatchup), the
+/// resident part of the range is fetched that way first, without the peer's
+/// CPU.  Slots older than the peer's log need a snapshot instead (see
+/// SnapshotStore).
+///
+/// The engine never blocks.  `Poll()` drains the transport, handles whatever
+/// arrived, and returns, so it is meant to be registered with an EventLoop.
+///
+/// @tparam Transport See LocalNetwork for the interface a Transport provides
+template <class Transport> class WeakMvc {
+public:
+  /// Called once per slot, in slot order, with the decided object.  A slot
+  /// that decided NULL gets an object with `IsNull` set.
+  using DecideFn =
+      std::function<void(uint32_t slot, const message::ConsensusObj &obj)>;
+
+  struct Options {
+    uint32_t window = 1;                  // Slots in flight at once
+    uint64_t coin_seed = kDefaultCoinSeed; // Must match on every replica
+    CoinTable *coins = nullptr; // If set, flips are looked up in it (not owned)
+    uint32_t first_slot = 0;    // Where to start, e.g. after recovery
+    CatchupLog *log = nullptr;  // Serves peers' catch-up (not owned); if
+                                // null, the replica keeps its own
+    uint32_t catchup_lag = 64;     // How far past the window a peer must be
+                                   // for this replica to catch up (0: never)
+    uint32_t catchup_batch = 4096; // The most slots one request asks for
+    uint32_t catchup_chunk = 64;   // The most replies sent a peer per Poll()
+    TimerWheel *timers = nullptr;  // Times catch-up out (not owned); if null,
+                                   // a request waits for its replies forever
+    std::chrono::microseconds catchup_timeout{10000};
+    /// How many slots back this replica remembers which objects were decided,
+    /// so as not to propose one again when a late ClientRequest brings it.
+    /// Past that, a duplicate decision needs a majority to get the late copy.
+    uint32_t decided_horizon = 1 << 18;
+  };
+
+private:
+  /// Everything this replica knows about one slot
+  struct Slot {
+    bool proposed = false; // Did this replica broadcast its proposal?
+    uint64_t my_key = 0;   // ProposalKey of what it proposed, if not NULL
+    std::vector<std::optional<message::ConsensusObj>> proposals;
+    uint32_t num_proposals = 0;
+    uint32_t phase = 0; // 0 until a majority of proposals arrive
+    uint32_t state = kZero;
+    bool voted = false; // Did this replica vote in `phase`?
+    std::optional<uint32_t> decision;
+    std::optional<message::ConsensusObj> value; // Known once decision is
+    bool learned = false; // Was the decision adopted from a peer's Decision?
+    bool done = false;    // Decided, with a value, waiting to be released
+
+    explicit Slot(uint32_t n) : proposals(n) {}
+  };
+
+  Transport *transport_; //! NOT OWNED
+  const uint32_t self_;
+  const uint32_t n_;
+  const uint32_t quorum_;
+  const Options opts_;
+  DecideFn on_decide_;
+
+  /// The lowest slot not yet released; all earlier slots are delivered
+  uint32_t base_ = 0;
+  /// The next slot this replica will propose in, in [base_, base_ + window)
+  uint32_t next_start_ = 0;
+  std::map<uint32_t, Slot> slots_;
+  /// The State and Vote messages of the slots in `slots_`
+  TallyTable tallies_;
+
+  /// Client requests that are not decided yet, ordered by (ProSeq, ProId) so
+  /// that replicas that received the same requests propose the same objects.
+  /// ConsensusObj carries no timestamp, so ProSeq stands in for one.
+  PendingQueue pending_;
+
+  /// Pending objects that this replica has proposed in a slot that is still
+  /// undecided, by ProposalKey.  They leave `pending_` while they are here, so
+  /// an object is in at most one in-flight proposal at a time, which is what
+  /// keeps it from being decided in two slots.
+  std::unordered_map<uint64_t, message::ConsensusObj> proposed_;
+
+  /// Keys of decided objects, so a late ClientRequest isn't proposed again
+  std::unordered_set<uint64_t> decided_keys_;
+  /// The same keys, with the slots they were decided in, in decision order
+  /// (so nearly slot order).  Release() forgets those older than
+  /// `decided_horizon`, which keeps `decided_keys_` bounded.
+  std::deque<std::pair<uint32_t, uint64_t>> decided_order_;
+
+  /// Messages this replica sent to itself
+  std::deque<message::Msg> loopback_;
+
+  /// The slots this replica has released, for peers that fall behind
+  std::unique_ptr<CatchupLog> own_log_;
+  CatchupLog *log_; //! NOT OWNED, unless it is own_log_
+
+  /// The catch-up a peer asked for: the slots [next, end) still to send
+  struct Stream {
+    uint32_t next = 0;
+    uint32_t end = 0;
+  };
+  std::vector<Stream> streams_; // By peer
+
+  /// One past the last slot this replica has asked a peer for
+  uint32_t catchup_end_;
+  TimerId catchup_timer_ = kNoTimer; // Until the slots up to there arrive
+
+  uint64_t num_decided_ = 0;
+  uint64_t num_null_ = 0;
+  uint64_t num_extra_phases_ = 0; // Phases that ended without a decision
+  uint64_t num_coin_flips_ = 0;   // Of those, the ones with no vote to carry
+  uint64_t num_catchup_requests_ = 0;
+  uint64_t num_catchup_timeouts_ = 0;
+  uint64_t num_caught_up_ = 0; // Slots learned from a peer's log
+  uint64_t num_send_failures_ = 0;
+
+  /// The most messages taken from one peer per Poll(), so that a chatty peer
+  /// can't starve the others
+  static constexpr int kMaxPollPerPeer = 32;
+
+public:
+  /// Construct a replica
+  ///
+  /// @param transport  The links to the other replicas (not owned)
+  /// @param on_decide  Called in slot order as slots are decided
+  /// @param opts       The window size, coin seed and catch-up settings
+  WeakMvc(Transport *transport, DecideFn on_decide, Options opts = Options())
+      : transport_(transport), self_(transport->self()), n_(transport->size()),
+        quorum_(transport->size() / 2 + 1), opts_(opts),
+        on_decide_(std::move(on_decide)), base_(opts.first_slot),
+        next_start_(opts.first_slot),
+        tallies_(transport->size(), std::max(4 * opts.window, 16u)),
+        log_(opts.log), streams_(transport->size()),
+        catchup_end_(opts.first_slot) {
+    ROME_ASSERT(self_ < n_, "Replica id {} out of range for {} replicas",
+                self_, n_);
+    ROME_ASSERT(opts_.window > 0, "Window must hold at least one slot");
+    ROME_ASSERT(opts_.coins == nullptr || opts_.coins->seed() == opts_.coin_seed,
+                "The coin table's seed doesn't match coin_seed");
+    ROME_ASSERT(opts_.catchup_chunk > 0 && opts_.catchup_batch > 0,
+                "Catch-up chunks and batches must hold at least one slot");
+    if (log_ == nullptr) {
+      own_log_ = std::make_unique<CatchupLog>(CatchupLogOptions());
+      log_ = own_log_.get();
+    }
+  }
+
+  WeakMvc(const WeakMvc &) = delete;
+  WeakMvc(WeakMvc &&) = delete;
+
+  // Getters.
+  uint32_t self() const { return self_; }
+  uint32_t next_slot() const { return base_; }
+  uint32_t window() const { return opts_.window; }
+  size_t pending() const { return pending_.size() + proposed_.size(); }
+  uint64_t num_decided() const { return num_decided_; }
+  uint64_t num_null() const { return num_null_; }
+  uint64_t num_extra_phases() const { return num_extra_phases_; }
+  uint64_t num_coin_flips() const { return num_coin_flips_; }
+  uint64_t num_catchup_requests() const { return num_catchup_requests_; }
+  uint64_t num_catchup_timeouts() const { return num_catchup_timeouts_; }
+  uint64_t num_caught_up() const { return num_caught_up_; }
+  uint64_t num_send_failures() const { return num_send_failures_; }
+  const CatchupLog &log() const { return *log_; }
+
+  /// Submit a batch of client commands for ordering.  The object is forwarded
+  /// to every replica as a ClientRequest, so that all of them queue it.
+  ///
+  /// @param obj A non-NULL object; ProId and ProSeq must identify it uniquely
+  void Submit(const message::ConsensusObj &obj) {
+    message::Msg msg;
+    msg.set_type(message::ClientRequest);
+    *msg.mutable_obj() = obj;
+    Broadcast(msg);
+  }
+
+  /// Handle everything that has arrived, and make whatever progress that
+  /// allows.  Never blocks.
+  ///
+  /// @return The number of messages handled
+  int Poll() {
+    int handled = DrainLoopback();
+    for (uint32_t peer = 0; peer < n_; ++peer) {
+      if (peer == self_)
+        continue;
+      for (int i = 0; i < kMaxPollPerPeer; ++i) {
+        auto msg = transport_->TryReceive(peer);
+        if (!msg.has_value())
+          break;
+        Handle(peer, msg.value());
+        ++handled;
+      }
+    }
+    handled += DrainLoopback();
+    handled += StreamCatchup();
+    return handled;
+  }
+
+private:
+  /// Can the transport READ a peer's CatchupLog?
+  static constexpr bool kCanReadLog =
+      requires(Transport &t, std::vector<message::Msg> *out) {
+        t.ReadCatchup(uint32_t(), uint32_t(), uint32_t(), out);
+      };
+
+  int DrainLoopback() {
+    int handled = 0;
+    while (!loopback_.empty()) {
+      message::Msg msg = std::move(loopback_.front());
+      loopback_.pop_front();
+      Handle(self_, msg);
+      ++handled;
+    }
+    return handled;
+  }
+
+  /// Send `msg` to every peer, and queue it for this replica too
+  void Broadcast(const message::Msg &msg) {
+    SendToPeers(msg);
+    loopback_.push_back(msg);
+  }
+
+  void SendToPeers(const message::Msg &msg) {
+    for (uint32_t peer = 0; peer < n_; ++peer) {
+      if (peer == self_)
+        continue;
+      SendTo(peer, msg);
+    }
+  }
+
+  /// Send `msg` to `peer`.  A peer that has crashed or closed its link just
+  /// misses the message, which Rabia tolerates for a minority of replicas.
+  void SendTo(uint32_t peer, const message::Msg &msg) {
+    auto s = transport_->Send(peer, msg);
+    if (s.t != sss::Ok) {
+      ROME_DEBUG("Replica {} failed to send to {}: {}", self_, peer,
+                 s.message.value_or(""));
+      ++num_send_failures_;
+    }
+  }
+
+  Slot &GetSlot(uint32_t slot) {
+    return slots_.try_emplace(slot, n_).first->second;
+  }
+
+  void Handle(uint32_t from, const message::Msg &msg) {
+    uint32_t slot = msg.obj().svrseq();
+    switch (msg.type()) {
+    case message::ClientRequest:
+      Enqueue(msg.obj());
+      StartSlots();
+      return;
+    case message::ProposalRequest:
+      // The peer is done with whatever it asked for before
+      streams_[from] = {slot, slot + msg.value()};
+      return;
+    case message::ProposalReply:
+      if (msg.value() == kQuestion) {
+        // The peer stopped short; ask again from there later
+        catchup_end_ = std::min(catchup_end_, std::max(slot, base_));
+        return;
+      }
+      break;
+    default:
+      break;
+    }
+    if (slot < base_)
+      return; // Already released here
+    switch (msg.type()) {
+    case message::Proposal:
+      OnProposal(from, slot, msg.obj());
+      MaybeCatchUp(from, slot);
+      break;
+    case message::State:
+      GetSlot(slot);
+      tallies_.Add(slot, msg.phase(), kStateTally, from, msg.value());
+      break;
+    case message::Vote:
+      GetSlot(slot);
+      tallies_.Add(slot, msg.phase(), kVoteTally, from, msg.value());
+      break;
+    case message::Decision:
+      OnDecision(slot, msg);
+      break;
+    case message::ProposalReply:
+      OnDecision(slot, msg);
+      ++num_caught_up_;
+      break;
+    default:
+      ROME_WARN("Ignoring message of type {} from {}", int(msg.type()), from);
+      return;
+    }
+    StartSlots();
+    Advance(slot);
+  }
+
+  /// `from` proposed in `slot`, so it has released every slot before
+  /// `slot - window + 1`.  If that is far enough past this replica's window,
+  /// ask `from` for the next batch of them.  One batch is asked for at a time,
+  /// so the next one goes out once this replica has replayed the last.
+  void MaybeCatchUp(uint32_t from, uint32_t slot) {
+    if (opts_.catchup_lag == 0 || catchup_end_ > base_ ||
+        slot < base_ + opts_.window + opts_.catchup_lag)
+      return;
+    uint32_t first = base_;
+    uint32_t count = std::min(slot - opts_.window + 1 - first,
+                              opts_.catchup_batch);
+    catchup_end_ = first + count;
+
+    if constexpr (kCanReadLog) {
+      // Fetch what is resident in the peer's log; stop at the first miss
+      std::vector<message::Msg> got;
+      while (count > 0) {
+        got.clear();
+        transport_->ReadCatchup(from, first, count, &got);
+        if (got.empty())
+          break;
+        for (const auto &m : got) {
+          OnDecision(first, m);
+          ++num_caught_up_;
+          Advance(first++);
+        }
+        count -= got.size();
+      }
+      if (count == 0)
+        return;
+    }
+
+    message::Msg msg;
+    msg.set_type(message::ProposalRequest);
+    msg.set_phase(self_);
+    msg.set_value(count);
+    msg.mutable_obj()->set_svrseq(first);
+    SendTo(from, msg);
+    ++num_catchup_requests_;
+    if (opts_.timers != nullptr) {
+      opts_.timers->Cancel(catchup_timer_);
+      catchup_timer_ = opts_.timers->ScheduleAfter(
+          opts_.catchup_timeout, &OnCatchupTimeout, this, catchup_end_);
+    }
+  }
+
+  static void OnCatchupTimeout(void *ctx, uint64_t end) {
+    auto *self = static_cast<WeakMvc *>(ctx);
+    self->catchup_timer_ = kNoTimer;
+    if (self->base_ >= end)
+      return;
+    ROME_DEBUG("Replica {} gave up on catching up to slot {} at {}",
+               self->self_, end, self->base_);
+    ++self->num_catchup_timeouts_;
+    self->catchup_end_ = self->base_;
+  }
+
+  /// Send each peer's catch-up stream its next chunk of slots from the log
+  ///
+  /// @return The number of replies sent
+  int StreamCatchup() {
+    int sent = 0;
+    for (uint32_t peer = 0; peer < n_; ++peer) {
+      Stream &st = streams_[peer];
+      for (uint32_t i = 0; i < opts_.catchup_chunk && st.next < st.end; ++i) {
+        auto msg = log_->Get(st.next);
+        if (!msg.has_value()) {
+          // Gone from the log, or not released yet: end the stream here
+          msg.emplace();
+          msg->set_type(message::ProposalReply);
+          msg->set_value(kQuestion);
+          msg->mutable_obj()->set_svrseq(st.next);
+          st.end = st.next;
+        } else {
+          ++st.next;
+        }
+        msg->set_phase(peer);
+        SendTo(peer, msg.value());
+        ++sent;
+      }
+    }
+    return sent;
+  }
+
+  void Enqueue(const message::ConsensusObj &obj) {
+    uint64_t key = ProposalKey(obj);
+    if (obj.isnull() || decided_keys_.contains(key) || proposed_.contains(key))
+      return;
+    pending_.Push(obj.proseq(), obj);
+  }
+
+  void OnProposal(uint32_t from, uint32_t slot,
+                  const message::ConsensusObj &obj) {
+    Slot &s = GetSlot(slot);
+    if (s.proposals[from].has_value())
+      return;
+    s.proposals[from] = obj;
+    ++s.num_proposals;
+  }
+
+  void OnDecision(uint32_t slot, const message::Msg &msg) {
+    Slot &s = GetSlot(slot);
+    if (s.value.has_value())
+      return;
+    s.decision = msg.value();
+    s.value = msg.obj();
+    s.learned = true;
+  }
+
+  /// The object to propose in `slot`.  If a peer has already proposed there,
+  /// and this replica has that object queued and free, it follows the peer, so
+  /// that replicas whose queues differ in order still tend to line up.
+  /// Otherwise it is the head of the queue.  (Objects in this replica's
+  /// in-flight proposals are not in the queue.)
+  ///
+  /// @return The object, or nullptr if there is nothing to propose
+  const message::ConsensusObj *NextProposal(uint32_t slot) {
+    if (auto it = slots_.find(slot); it != slots_.end()) {
+      for (const auto &p : it->second.proposals) {
+        if (!p.has_value() || p->isnull())
+          continue;
+        if (const auto *q = pending_.Find(ProposalKey(p.value())))
+          return q;
+      }
+    }
+    return pending_.Top();
+  }
+
+  /// Propose in as many new slots as the window allows, in slot order.
+  ///
+  /// A replica joins any slot that a peer has started (or any slot below one a
+  /// peer has started), proposing NULL if it has nothing to offer.  It opens a
+  /// slot on its own only if the slot is the lowest unreleased one, or if the
+  /// slot is its turn (`slot % n == self`).  Were every replica free to open
+  /// every slot, replicas would fill the window at the same moment with
+  /// different heads of queue, and most slots would decide NULL.  Anyone may
+  /// still open the lowest slot, so a crashed replica's turn can't stall the
+  /// window.
+  void StartSlots() {
+    while (next_start_ < base_ + opts_.window) {
+      const message::ConsensusObj *obj = NextProposal(next_start_);
+      bool peer_started = slots_.lower_bound(next_start_) != slots_.end();
+      bool my_turn = next_start_ == base_ || next_start_ % n_ == self_;
+      if (!peer_started && (obj == nullptr || !my_turn))
+        return;
+      Propose(next_start_++, obj);
+    }
+  }
+
+  /// Broadcast this replica's proposal for `slot`
+  ///
+  /// @param obj The object to propose, or nullptr to propose NULL
+  void Propose(uint32_t slot, const message::ConsensusObj *obj) {
+    Slot &s = GetSlot(slot);
+    if (s.proposed || s.decision.has_value())
+      return;
+    message::Msg msg;
+    msg.set_type(message::Proposal);
+    auto *p = msg.mutable_obj();
+    if (obj != nullptr) {
+      *p = *obj;
+      s.my_key = ProposalKey(*obj);
+      proposed_.emplace(s.my_key, pending_.Take(s.my_key).value());
+    } else {
+      p->set_proid(self_);
+      p->set_isnull(true);
+    }
+    p->set_svrseq(slot);
+    s.proposed = true;
+    RABIA_TRACE_EVENT(self_, slot, 0, kPropose);
+    Broadcast(msg);
+  }
+
+  /// The object proposed by a majority of all replicas, if there is one yet
+  std::optional<message::ConsensusObj> MajorityProposal(const Slot &s) const {
+    for (uint32_t i = 0; i < n_; ++i) {
+      if (!s.proposals[i].has_value())
+        continue;
+      uint64_t key = ProposalKey(s.proposals[i].value());
+      uint32_t same = 0;
+      for (uint32_t j = 0; j < n_; ++j) {
+        if (s.proposals[j].has_value() &&
+            ProposalKey(s.proposals[j].value()) == key)
+          ++same;
+      }
+      if (same >= quorum_)
+        return s.proposals[i];
+    }
+    return std::nullopt;
+  }
+
+  void SendBinary(message::MsgType type, uint32_t slot, uint32_t phase,
+                  uint32_t value) {
+    message::Msg msg;
+    msg.set_type(type);
+    msg.set_phase(phase);
+    msg.set_value(value);
+    msg.mutable_obj()->set_svrseq(slot);
+    Broadcast(msg);
+  }
+
+  /// Run `slot`'s state machine as far as the messages that have arrived
+  /// allow, then release whatever decided slots are next in order.
+  void Advance(uint32_t slot) {
+    Slot &s = GetSlot(slot);
+    while (!s.done) {
+      if (s.decision.has_value()) {
+        if (!s.value.has_value()) {
+          // Decided 1, but this replica hasn't seen the majority proposal yet.
+          // A majority sent it, so it is on its way.
+          s.value = MajorityProposal(s);
+          if (!s.value.has_value())
+            break;
+        }
+        Decided(slot, s);
+        break;
+      }
+
+      if (s.phase == 0) {
+        if (s.num_proposals < quorum_)
+          break;
+        s.state = MajorityProposal(s).has_value() ? kOne : kZero;
+        s.phase = 1;
+        RABIA_TRACE_EVENT(self_, slot, s.phase, kState);
+        SendBinary(message::State, slot, s.phase, s.state);
+        continue;
+      }
+
+      if (!s.voted) {
+        const TallyCounts states = tallies_.Counts(slot, s.phase, kStateTally);
+        if (states.total < quorum_)
+          break;
+        uint32_t vote = kQuestion;
+        if (states.count[kZero] >= quorum_)
+          vote = kZero;
+        else if (states.count[kOne] >= quorum_)
+          vote = kOne;
+        s.voted = true;
+        RABIA_TRACE_EVENT(self_, slot, s.phase, kVote);
+        SendBinary(message::Vote, slot, s.phase, vote);
+        continue;
+      }
+
+      const TallyCounts votes = tallies_.Counts(slot, s.phase, kVoteTally);
+      if (votes.total < quorum_)
+        break;
+      if (votes.count[kOne] >= quorum_) {
+        s.decision = kOne;
+        s.value = MajorityProposal(s);
+      } else if (votes.count[kZero] >= quorum_) {
+        s.decision = kZero;
+        message::ConsensusObj null;
+        null.set_isnull(true);
+        s.value = null;
+      } else {
+        // No decision in this phase.  A non-? vote can only be for the value
+        // that a majority of states agreed on, so carry it forward; otherwise
+        // everyone flips the same coin.
+        if (votes.count[kOne] > 0)
+          s.state = kOne;
+        else if (votes.count[kZero] > 0)
+          s.state = kZero;
+        else {
+          s.state = opts_.coins != nullptr
+                        ? opts_.coins->Flip(slot, s.phase)
+                        : CommonCoin(opts_.coin_seed, slot, s.phase);
+          ++num_coin_flips_;
+          RABIA_TRACE_EVENT(self_, slot, s.phase + 1, kCoin);
+        }
+        ++num_extra_phases_;
+        ++s.phase;
+        s.voted = false;
+        tallies_.Advance(slot, s.phase);
+        RABIA_TRACE_EVENT(self_, slot, s.phase, kState);
+        SendBinary(message::State, slot, s.phase, s.state);
+      }
+    }
+    Release();
+  }
+
+  /// `slot` has a decision and a value: tell the peers, retire the decided
+  /// object, and free this replica's proposal for use in another slot
+  void Decided(uint32_t slot, Slot &s) {
+    s.done = true;
+    if (s.learned)
+      RABIA_TRACE_EVENT(self_, slot, s.phase, kLearn);
+    else
+      RABIA_TRACE_EVENT(self_, slot, s.phase, kDecide);
+    s.value->set_svrseq(slot);
+    if (!s.learned) {
+      message::Msg msg;
+      msg.set_type(message::Decision);
+      msg.set_phase(s.phase);
+      msg.set_value(s.decision.value());
+      *msg.mutable_obj() = s.value.value();
+      SendToPeers(msg);
+    }
+    const auto &obj = s.value.value();
+    if (!obj.isnull()) {
+      if (decided_keys_.insert(ProposalKey(obj)).second)
+        decided_order_.emplace_back(slot, ProposalKey(obj));
+      pending_.Remove(ProposalKey(obj));
+    }
+    // Put this replica's proposal back in line, unless it has been decided
+    // (here or in another slot)
+    if (s.my_key != 0) {
+      auto it = proposed_.find(s.my_key);
+      if (!decided_keys_.contains(s.my_key)) {
+        uint32_t ts = it->second.proseq();
+        pending_.Push(ts, std::move(it->second));
+      }
+      proposed_.erase(it);
+    }
+  }
+
+  /// Deliver decided slots in order, starting at `base_`, and slide the
+  /// window past them
+  void Release() {
+    for (auto it = slots_.find(base_); it != slots_.end() && it->second.done;
+         it = slots_.find(base_)) {
+      const auto &obj = it->second.value.value();
+      if (obj.isnull())
+        ++num_null_;
+      ++num_decided_;
+      RABIA_TRACE_EVENT(self_, base_, it->second.phase, kRelease);
+      on_decide_(base_, obj);
+      log_->Append(base_, it->second.decision.value(), obj);
+      slots_.erase(it);
+      tallies_.Release(base_);
+      ++base_;
+    }
+    if (next_start_ < base_)
+      next_start_ = base_;
+    while (!decided_order_.empty() &&
+           uint64_t(decided_order_.front().first) + opts_.decided_horizon <
+               base_) {
+      decided_keys_.erase(decided_order_.front().second);
+      decided_order_.pop_front();
+    }
+    if (catchup_timer_ != kNoTimer && base_ >= catchup_end_) {
+      opts_.timers->Cancel(catchup_timer_);
+      catchup_timer_ = kNoTimer;
+    }
+    StartSlots();
+  }
+};
+
+} // namespace rabia
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include <message.pb.h>
+#include <vendor/sss/status.h>
+
+namespace rabia::wire {
+
+/// A fixed-layout encoding of `message::Msg`, for when protobuf's varints and
+/// heap-allocated strings cost more than the consensus round itself.
+///
+/// Every frame starts with the MsgType in its first byte, which says which of
+/// two layouts follows:
+///
+/// - State and Vote are a 16-byte BinaryFrame.  They never carry an object,
+///   only the slot (which protobuf puts in `Obj.SvrSeq`), the phase, and the
+///   value.
+/// - Everything else is an ObjFrame header followed by the object's payload:
+///   `num_clients` CliIds, then `num_clients` CliSeqs (4 bytes each), then
+///   `num_commands` commands of kCommandBytes each, back to back.  The
+///   header's `length` covers the header and the payload.
+///
+/// Integers are in host byte order; replicas are assumed to share an
+/// architecture, as they already do for the RDMA paths.
+///
+/// Nothing here allocates.  Encode() writes into a caller-provided buffer, and
+/// a View reads fields and commands straight out of a received buffer.
+
+/// The size of one command (see the Command comment in message.proto)
+static constexpr uint32_t kCommandBytes = 17;
+
+/// `flags` bits
+static constexpr uint8_t kIsNull = 1;
+
+struct BinaryFrame {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t reserved;
+  uint32_t slot;
+  uint32_t phase;
+  uint32_t value;
+};
+static_assert(sizeof(BinaryFrame) == 16);
+static_assert(std::is_trivially_copyable_v<BinaryFrame>);
+
+struct ObjFrame {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t reserved;
+  uint32_t length; // Of the whole frame, in bytes
+  uint32_t phase;
+  uint32_t value;
+  uint32_t proid;
+  uint32_t proseq;
+  uint32_t svrseq;
+  uint32_t num_clients;
+  uint32_t num_commands;
+};
+static_assert(sizeof(ObjFrame) == 36);
+static_assert(std::is_trivially_copyable_v<ObjFrame>);
+
+/// Does `type` use a BinaryFrame?
+inline bool IsBinary(uint32_t type) {
+  return type == message::State || type == message::Vote;
+}
+
+/// The number of bytes EncodeObj() will write for `obj`
+inline size_t EncodedSize(const message::ConsensusObj &obj) {
+  return sizeof(ObjFrame) + 2 * sizeof(uint32_t) * obj.cliids_size() +
+         size_t(kCommandBytes) * obj.commands_size();
+}
+
+/// The number of bytes Encode() will write for `msg`
+inline size_t EncodedSize(const message::Msg &msg) {
+  if (IsBinary(msg.type()))
+    return sizeof(BinaryFrame);
+  return EncodedSize(msg.obj());
+}
+
+/// Encode `obj` into `buf` as an ObjFrame of the given type, phase and value
+///
+/// @return The bytes written; InvalidArgument if a command isn't
+///         kCommandBytes long or the CliIds and CliSeqs differ in number,
+///         ResourceExhausted if `cap` is too small
+inline sss::StatusVal<size_t> EncodeObj(message::MsgType type, uint32_t phase,
+                                        uint32_t value,
+                                        const message::ConsensusObj &obj,
+                                        uint8_t *buf, size_t cap) {
+  size_t size = EncodedSize(obj);
+  if (size > cap)
+    return {sss::Status{sss::ResourceExhausted, "Buffer too small"}, {}};
+  if (obj.cliids_size() != obj.cliseqs_size())
+    return {sss::Status{sss::InvalidArgument, "CliIds and CliSeqs differ"}, {}};
+  ObjFrame f{uint8_t(type),
+             uint8_t(obj.isnull() ? kIsNull : 0),
+             0,
+             uint32_t(size),
+             phase,
+             value,
+             obj.proid(),
+             obj.proseq(),
+             obj.svrseq(),
+             uint32_t(obj.cliids_size()),
+             uint32_t(obj.commands_size())};
+  std::memcpy(buf, &f, sizeof(f));
+  uint8_t *p = buf + sizeof(f);
+  size_t ids = sizeof(uint32_t) * obj.cliids_size();
+  if (ids != 0) {
+    std::memcpy(p, obj.cliids().data(), ids);
+    std::memcpy(p + ids, obj.cliseqs().data(), ids);
+    p += 2 * ids;
+  }
+  for (const auto &c : obj.commands()) {
+    if (c.size() != kCommandBytes)
+      return {sss::Status{sss::InvalidArgument, "Command is not 17 bytes"},
+              {}};
+    std::memcpy(p, c.data(), kCommandBytes);
+    p += kCommandBytes;
+  }
+  return {sss::Status::Ok(), size};
+}
+
+/// Encode `msg` into `buf`
+///
+/// @return See EncodeObj()
+inline sss::StatusVal<size_t> Encode(const message::Msg &msg, uint8_t *buf,
+                                     size_t cap) {
+  if (IsBinary(msg.type())) {
+    if (cap < sizeof(BinaryFrame))
+      return {sss::Status{sss::ResourceExhausted, "Buffer too small"}, {}};
+    BinaryFrame f{uint8_t(msg.type()), 0, 0, msg.obj().svrseq(), msg.phase(),
+                  msg.value()};
+    std::memcpy(buf, &f, sizeof(f));
+    return {sss::Status::Ok(), sizeof(BinaryFrame)};
+  }
+  return EncodeObj(msg.type(), msg.phase(), msg.value(), msg.obj(), buf, cap);
+}
+
+/// A read-only view of one encoded frame.  The View points into the buffer it
+/// was parsed from, which must outlive it.
+class View {
+  const uint8_t *buf_;
+  BinaryFrame bin_{};
+  ObjFrame obj_{};
+  bool binary_;
+
+  View(const uint8_t *buf, bool binary) : buf_(buf), binary_(binary) {}
+
+  uint32_t ReadU32(size_t offset) const {
+    uint32_t v;
+    std::memcpy(&v, buf_ + offset, sizeof(v));
+    return v;
+  }
+
+public:
+  /// Check that `buf` holds a whole, well-formed frame
+  ///
+  /// @return The View; InvalidArgument if the frame is short or its counts
+  ///         don't match its length
+  static sss::StatusVal<View> Parse(const uint8_t *buf, size_t len) {
+    if (len < 1)
+      return {sss::Status{sss::InvalidArgument, "Empty frame"}, {}};
+    if (IsBinary(buf[0])) {
+      if (len < sizeof(BinaryFrame))
+        return {sss::Status{sss::InvalidArgument, "Short binary frame"}, {}};
+      View v(buf, true);
+      std::memcpy(&v.bin_, buf, sizeof(BinaryFrame));
+      return {sss::Status::Ok(), v};
+    }
+    if (len < sizeof(ObjFrame))
+      return {sss::Status{sss::InvalidArgument, "Short object frame"}, {}};
+    View v(buf, false);
+    std::memcpy(&v.obj_, buf, sizeof(ObjFrame));
+    uint64_t want = sizeof(ObjFrame) +
+                    2 * sizeof(uint32_t) * uint64_t(v.obj_.num_clients) +
+                    uint64_t(kCommandBytes) * v.obj_.num_commands;
+    if (want != v.obj_.length || want > len)
+      return {sss::Status{sss::InvalidArgument, "Bad object frame length"},
+              {}};
+    return {sss::Status::Ok(), v};
+  }
+
+  // Getters.  The object fields of a binary frame read as zero, except the
+  // slot, which is its SvrSeq.
+  bool binary() const { return binary_; }
+  message::MsgType type() const {
+    return message::MsgType(binary_ ? bin_.type : obj_.type);
+  }
+  uint32_t size() const { return binary_ ? sizeof(BinaryFrame) : obj_.length; }
+  uint32_t phase() const { return binary_ ? bin_.phase : obj_.phase; }
+  uint32_t value() const { return binary_ ? bin_.value : obj_.value; }
+  uint32_t svrseq() const { return binary_ ? bin_.slot : obj_.svrseq; }
+  uint32_t proid() const { return obj_.proid; }
+  uint32_t proseq() const { return obj_.proseq; }
+  bool isnull() const { return obj_.flags & kIsNull; }
+  uint32_t num_clients() const { return obj_.num_clients; }
+  uint32_t num_commands() const { return obj_.num_commands; }
+
+  uint32_t cliid(uint32_t i) const {
+    return ReadU32(sizeof(ObjFrame) + sizeof(uint32_t) * i);
+  }
+  uint32_t cliseq(uint32_t i) const {
+    return ReadU32(sizeof(ObjFrame) +
+                   sizeof(uint32_t) * (obj_.num_clients + i));
+  }
+  std::string_view command(uint32_t i) const {
+    size_t offset = sizeof(ObjFrame) + 2 * sizeof(uint32_t) * obj_.num_clients +
+                    size_t(kCommandBytes) * i;
+    return {reinterpret_cast<const char *>(buf_ + offset), kCommandBytes};
+  }
+
+  /// Fill in `msg` from this frame.  Protobuf reuses the storage of a cleared
+  /// message, so a `msg` that is reused across calls settles into not
+  /// allocating either.
+  void ToMsg(message::Msg *msg) const {
+    msg->Clear();
+    msg->set_type(type());
+    msg->set_phase(phase());
+    msg->set_value(value());
+    auto *obj = msg->mutable_obj();
+    obj->set_svrseq(svrseq());
+    if (binary_)
+      return;
+    obj->set_proid(proid());
+    obj->set_proseq(proseq());
+    obj->set_isnull(isnull());
+    for (uint32_t i = 0; i < num_clients(); ++i) {
+      obj->add_cliids(cliid(i));
+      obj->add_cliseqs(cliseq(i));
+    }
+    for (uint32_t i = 0; i < num_commands(); ++i) {
+      auto c = command(i);
+      obj->add_commands(c.data(), c.size());
+    }
+  }
+};
+
+} // namespace rabia::wire